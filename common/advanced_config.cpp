@@ -72,6 +72,19 @@ static const wxChar RealtimeConnectivity[] = wxT( "RealtimeConnectivity" );
  */
 static const wxChar AllowLegacyCanvasInGtk3[] = wxT( "AllowLegacyCanvasInGtk3" );
 
+/**
+ * Store the zone fills of a board in its zone fill cache when it is saved, and restore
+ * their triangulations from the cache when it is opened again (see ZONE_FILL_CACHE).
+ */
+static const wxChar RestoreZoneFills[] = wxT( "RestoreZoneFills" );
+
+/**
+ * Append each routing and dragging session of the interactive router to a
+ * `.pns_sessions` file next to the board file.  The sessions can be replayed against
+ * the board as saved before the first one, by the router replay QA tool.
+ */
+static const wxChar RecordRouterSessions[] = wxT( "RecordRouterSessions" );
+
 } // namespace KEYS
 
 
@@ -152,6 +165,8 @@ ADVANCED_CFG::ADVANCED_CFG()
     m_enableSvgImport = false;
     m_allowLegacyCanvasInGtk3 = false;
     m_realTimeConnectivity = true;
+    m_restoreZoneFills = false;
+    m_recordRouterSessions = false;
 
     loadFromConfigFile();
 }
@@ -194,6 +209,12 @@ void ADVANCED_CFG::loadSettings( wxConfigBase& aCfg )
     configParams.push_back(
             new PARAM_CFG_BOOL( true, AC_KEYS::RealtimeConnectivity, &m_realTimeConnectivity, false ) );
 
+    configParams.push_back(
+            new PARAM_CFG_BOOL( true, AC_KEYS::RestoreZoneFills, &m_restoreZoneFills, false ) );
+
+    configParams.push_back( new PARAM_CFG_BOOL(
+            true, AC_KEYS::RecordRouterSessions, &m_recordRouterSessions, false ) );
+
     wxConfigLoadSetups( &aCfg, configParams );
 
     dumpCfg( configParams );
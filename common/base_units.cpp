@@ -34,6 +34,8 @@
  *       depending on the application.
  */
 
+#include <cstdint>
+
 #include <macros.h>
 #include <base_struct.h>
 #include <title_block.h>
@@ -456,6 +458,52 @@ wxString GetAbbreviatedUnitsLabel( EDA_UNITS_T aUnit, bool aUseMils )
 
 std::string FormatInternalUnits( int aValue )
 {
+#if defined( PCBNEW ) || defined( CVPCB ) || defined( GERBVIEW )
+    // The internal units are a power of ten of mm: write the exact decimal value in mm,
+    // which is what the "%.10g" format below gives for them, without the cost of printf.
+    const int64_t scale = (int64_t) IU_PER_MM;
+    char          buf[32];
+    char*         end = buf + sizeof( buf );
+    char*         p = end;
+    int64_t       value = aValue;
+    bool          negative = value < 0;
+
+    if( negative )
+        value = -value;
+
+    int64_t integral = value / scale;
+    int64_t fraction = value % scale;
+
+    if( fraction )
+    {
+        bool significant = false;   // the trailing zeros are not written
+
+        for( int64_t div = scale; div > 1; div /= 10 )
+        {
+            int digit = fraction % 10;
+            fraction /= 10;
+
+            if( digit || significant )
+            {
+                *--p = '0' + digit;
+                significant = true;
+            }
+        }
+
+        *--p = '.';
+    }
+
+    do
+    {
+        *--p = '0' + integral % 10;
+        integral /= 10;
+    } while( integral );
+
+    if( negative )
+        *--p = '-';
+
+    return std::string( p, end );
+#else
     char    buf[50];
     double  engUnits = aValue;
     int     len;
@@ -484,6 +532,7 @@ std::string FormatInternalUnits( int aValue )
     }
 
     return std::string( buf, len );
+#endif
 }
 
 
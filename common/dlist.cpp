@@ -23,6 +23,8 @@
  */
 
 
+#include <mutex>
+
 #include <fctsys.h>
 #include <dlist.h>
 #include <base_struct.h>
@@ -57,6 +59,52 @@ void DHEAD::DeleteAll()
     first = 0;
     last  = 0;
     count = 0;
+    ++generation;
+}
+
+
+std::shared_ptr<const DHEAD::ITEM_INDEX> DHEAD::GetIndex() const
+{
+    // Serializes the index builds of all the lists.  They only happen on the first walk
+    // after a change, so there is no point in one mutex per list.
+    static std::mutex buildMutex;
+
+    if( count < INDEX_MIN_COUNT )
+        return nullptr;
+
+    std::shared_ptr<const ITEM_INDEX> current = std::atomic_load( &itemIndex );
+
+    if( current && current->m_generation == generation )
+        return current;
+
+    std::lock_guard<std::mutex> lock( buildMutex );
+
+    // Another thread may have built the index meanwhile
+    current = std::atomic_load( &itemIndex );
+
+    if( current && current->m_generation == generation )
+        return current;
+
+    // The first walk after a change follows Next(): the index pays off only if the
+    // list is walked again before it changes
+    if( unindexedWalkGeneration != generation )
+    {
+        unindexedWalkGeneration = generation;
+        return nullptr;
+    }
+
+    auto newIndex = std::make_shared<ITEM_INDEX>();
+
+    newIndex->m_generation = generation;
+    newIndex->m_items.reserve( count );
+
+    for( EDA_ITEM* item = first;  item;  item = item->Next() )
+        newIndex->m_items.push_back( item );
+
+    current = newIndex;
+    std::atomic_store( &itemIndex, current );
+
+    return current;
 }
 
 
@@ -91,6 +139,7 @@ void DHEAD::append( EDA_ITEM* aNewElement )
     aNewElement->SetList( this );
 
     ++count;
+    ++generation;
 }
 
 
@@ -120,10 +169,12 @@ void DHEAD::append( DHEAD& aList )
         }
 
         count += aList.count;
+        ++generation;
 
         aList.count = 0;
         aList.first = NULL;
         aList.last  = NULL;
+        ++aList.generation;
     }
 }
 
@@ -166,6 +217,7 @@ void DHEAD::insert( EDA_ITEM* aNewElement, EDA_ITEM* aAfterMe )
         aNewElement->SetList( this );
 
         ++count;
+        ++generation;
     }
 }
 
@@ -199,6 +251,7 @@ void DHEAD::remove( EDA_ITEM* aElement )
     aElement->SetList( 0 );
 
     --count;
+    ++generation;
     wxASSERT( ( first && last ) || count == 0 );
 }
 
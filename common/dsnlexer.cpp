@@ -28,6 +28,7 @@
 #include <cstdio>
 #include <cstdlib>         // bsearch()
 #include <cctype>
+#include <cstdint>
 
 #include <macros.h>
 #include <fctsys.h>
@@ -54,6 +55,9 @@ void DSNLEXER::init()
 
     curOffset = 0;
 
+    curNumber = 0.0;
+    curNumberValid = false;
+
 #if 1
     if( keywordCount > 11 )
     {
@@ -537,6 +541,98 @@ static bool isNumber( const char* cp, const char* limit )
 }
 
 
+/**
+ * Function parseNumber
+ * converts a token accepted by isNumber() when this can be done exactly with a
+ * single floating point operation: when the decimal mantissa fits in 53 bits and
+ * the power of ten is at most 22, both are exact doubles and the result is correctly
+ * rounded, i.e. identical to the strtod() result in the "C" locale.
+ *
+ * @param cp is the start of the current token.
+ * @param limit is the end of the current token.
+ * @param aValue is set to the value of the token.
+ *
+ * @return bool - true if @a aValue was set, false if the token must be converted by strtod().
+ */
+static bool parseNumber( const char* cp, const char* limit, double& aValue )
+{
+    static const double pow10[] =
+    {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    const uint64_t maxMantissa = uint64_t( 1 ) << 53;
+
+    uint64_t    mantissa = 0;
+    int         digits = 0;     // significant digits in mantissa
+    int         exp10 = 0;
+    bool        negative = false;
+
+    if( *cp == '-' || *cp == '+' )
+        negative = *cp++ == '-';
+
+    for( bool fraction = false; cp < limit; ++cp )
+    {
+        if( *cp == '.' )
+        {
+            fraction = true;
+            continue;
+        }
+
+        if( !isDigit( *cp ) )
+            break;
+
+        if( mantissa || *cp != '0' )
+        {
+            if( ++digits > 19 )     // would overflow 64 bits
+                return false;
+
+            mantissa = mantissa * 10 + ( *cp - '0' );
+        }
+
+        if( fraction )
+            --exp10;
+    }
+
+    if( cp < limit )    // an exponent, isNumber() has checked its syntax
+    {
+        bool    negativeExp = false;
+        int     exp = 0;
+
+        if( *++cp == '-' || *cp == '+' )
+            negativeExp = *cp++ == '-';
+
+        for( ; cp < limit; ++cp )
+        {
+            exp = exp * 10 + ( *cp - '0' );
+
+            if( exp > 1000 )
+                return false;
+        }
+
+        exp10 += negativeExp ? -exp : exp;
+    }
+
+    if( mantissa > maxMantissa )
+        return false;
+
+    double value = (double) mantissa;
+
+    if( mantissa == 0 )
+        ;
+    else if( exp10 < 0 && exp10 >= -22 )
+        value /= pow10[-exp10];
+    else if( exp10 >= 0 && exp10 <= 22 )
+        value *= pow10[exp10];
+    else
+        return false;
+
+    aValue = negative ? -value : value;
+    return true;
+}
+
+
 int DSNLEXER::NextTok()
 {
     const char*   cur  = next;
@@ -655,7 +751,7 @@ L_read:
                     case 'v':   c = '\x0b';     break;
 
                     case 'x':   // 1 or 2 byte hex escape sequence
-                        for( i=0; i<2; ++i )
+                        for( i=0; i<2 && head+i<limit; ++i )
                         {
                             if( !isxdigit( head[i] ) )
                                 break;
@@ -671,7 +767,7 @@ L_read:
 
                     default:    // 1-3 byte octal escape sequence
                         --head;
-                        for( i=0; i<3; ++i )
+                        for( i=0; i<3 && head+i<limit; ++i )
                         {
                             if( head[i] < '0' || head[i] > '7' )
                                 break;
@@ -697,7 +793,15 @@ L_read:
                 }
 
                 else
-                    curText += *head++;
+                {
+                    // copy the run of plain characters at once
+                    const char* run = head;
+
+                    while( head<limit && *head != '\\' && *head != '"' )
+                        ++head;
+
+                    curText.append( run, head );
+                }
 
             }   // while
 
@@ -777,14 +881,15 @@ L_read:
     }           // specctraMode
 
     // non-quoted token, read it into curText.
-    curText.clear();
-
     head = cur;
     while( head<limit && !isSep( *head ) )
-        curText += *head++;
+        ++head;
 
-    if( isNumber( curText.c_str(), curText.c_str() + curText.size() ) )
+    curText.assign( cur, head );
+
+    if( isNumber( cur, head ) )
     {
+        curNumberValid = parseNumber( cur, head, curNumber );
         curTok = DSN_NUMBER;
         goto exit;
     }
@@ -808,6 +913,76 @@ exit:   // single point of exit, no returns elsewhere please.
 }
 
 
+void DSNLEXER::ReadListText( std::string& aText )
+{
+    const char* cur = start + curOffset;
+    int         depth = 1;
+    bool        inString = false;
+
+    // blank the beginning of the line, but keep an opening parenthesis
+    aText.assign( curOffset ? curOffset : 1, ' ' );
+    aText.back() = '(';
+
+    for(;;)
+    {
+        const char* head = cur;
+
+        for( ; head<limit; ++head )
+        {
+            if( inString )
+            {
+                if( *head == '\\' && head+1<limit )
+                    ++head;
+                else if( *head == stringDelimiter )
+                    inString = false;
+            }
+            else if( *head == stringDelimiter && ( head == start || isSep( head[-1] ) ) )
+                inString = true;
+            else if( *head == '(' )
+                ++depth;
+            else if( *head == ')' && --depth == 0 )
+                break;
+        }
+
+        if( head<limit )
+        {
+            aText.append( cur, head + 1 );
+            aText += '\n';
+
+            next = head + 1;
+            break;
+        }
+
+        aText.append( cur, limit );
+
+        // a quoted string cannot span lines, leave the error to the parser of aText
+        inString = false;
+
+        if( readLine() == 0 )
+        {
+            curTok = DSN_EOF;
+            Expecting( DSN_RIGHT );
+        }
+
+        cur = start;
+
+        // skip comment lines, like NextTok() does
+        while( cur<limit && isSpace( *cur ) )
+            ++cur;
+
+        if( cur<limit && *cur == '#' )
+            cur = limit;
+
+        aText.append( start, cur );
+    }
+
+    prevTok   = curTok;
+    curTok    = DSN_RIGHT;
+    curText   = ')';
+    curOffset = next - 1 - start;
+}
+
+
 wxArrayString* DSNLEXER::ReadCommentLines()
 {
     wxArrayString*  ret = 0;
@@ -117,10 +117,16 @@ EDGE_PTR TRIANGULATION::InitTwoEnclosingTriangles( NODES_CONTAINER::iterator aFi
     double dx = ( xmax - xmin ) / fac;
     double dy = ( ymax - ymin ) / fac;
 
-    NODE_PTR n1 = std::make_shared<NODE>( xmin - dx, ymin - dy );
-    NODE_PTR n2 = std::make_shared<NODE>( xmax + dx, ymin - dy );
-    NODE_PTR n3 = std::make_shared<NODE>( xmax + dx, ymax + dy );
-    NODE_PTR n4 = std::make_shared<NODE>( xmin - dx, ymax + dy );
+    return InitTwoEnclosingTriangles( xmin - dx, ymin - dy, xmax + dx, ymax + dy );
+}
+
+
+EDGE_PTR TRIANGULATION::InitTwoEnclosingTriangles( int aXmin, int aYmin, int aXmax, int aYmax )
+{
+    NODE_PTR n1 = std::make_shared<NODE>( aXmin, aYmin );
+    NODE_PTR n2 = std::make_shared<NODE>( aXmax, aYmin );
+    NODE_PTR n3 = std::make_shared<NODE>( aXmax, aYmax );
+    NODE_PTR n4 = std::make_shared<NODE>( aXmin, aYmax );
 
     // diagonal
     EDGE_PTR e1d = std::make_shared<EDGE>();
@@ -211,6 +217,50 @@ void TRIANGULATION::CreateDelaunay( NODES_CONTAINER::iterator aFirst,
 }
 
 
+void TRIANGULATION::CreateDelaunay( NODES_CONTAINER::iterator aFirst,
+                                    NODES_CONTAINER::iterator aLast,
+                                    int aXmin, int aYmin, int aXmax, int aYmax )
+{
+    cleanAll();
+    m_leadingEdges.clear();
+
+    EDGE_PTR bedge = InitTwoEnclosingTriangles( aXmin, aYmin, aXmax, aYmax );
+    DART d_iter( bedge );
+
+    for( NODES_CONTAINER::iterator it = aFirst; it != aLast; ++it )
+        m_helper->InsertNode<TTLtraits>( d_iter, *it );
+}
+
+
+bool TRIANGULATION::InsertNode( const NODE_PTR& aNode )
+{
+    DART dart = CreateDart();
+    NODE_PTR node = aNode;
+
+    return m_helper->InsertNode<TTLtraits>( dart, node );
+}
+
+
+bool TRIANGULATION::RemoveNode( const NODE_PTR& aNode )
+{
+    DART dart = CreateDart();
+
+    if( !ttl::TRIANGULATION_HELPER::LocateFaceSimplest<TTLtraits>( aNode, dart ) )
+        return false;
+
+    // Find the dart of the located face having the node as source
+    for( int i = 0; i < 3 && dart.GetNode() != aNode; ++i )
+        dart.Alpha0().Alpha1();
+
+    if( dart.GetNode() != aNode || ttl::TRIANGULATION_HELPER::IsBoundaryNode( dart ) )
+        return false;
+
+    m_helper->RemoveInteriorNode<TTLtraits>( dart );
+
+    return true;
+}
+
+
 void TRIANGULATION::RemoveTriangle( EDGE_PTR& aEdge )
 {
   EDGE_PTR e1 = getLeadingEdgeInTriangle( aEdge );
@@ -296,24 +346,15 @@ bool TRIANGULATION::removeLeadingEdgeFromList( EDGE_PTR& aLeadingEdge )
     // Remove the edge from the list of leading edges,
     // but don't delete it.
     // Also set flag for leading edge to false.
-    // Must search from start of list. Since edges are added to the
-    // start of the list during triangulation, this operation will
-    // normally be fast (when used in the triangulation algorithm)
-    std::list<EDGE_PTR>::iterator it;
-    for( it = m_leadingEdges.begin(); it != m_leadingEdges.end(); ++it )
-    {
-        EDGE_PTR edge = *it;
+    // Leading edges remember their position in the list, so there is no need to
+    // search for it (the search was slow when removing nodes from a large triangulation)
+    if( !aLeadingEdge->IsLeadingEdge() )
+        return false;
 
-        if( edge == aLeadingEdge )
-        {
-            edge->SetAsLeadingEdge( false );
-            it = m_leadingEdges.erase( it );
-
-            return true;
-        }
-    }
+    aLeadingEdge->SetAsLeadingEdge( false );
+    m_leadingEdges.erase( aLeadingEdge->m_leadingEdgeIt );
 
-    return false;
+    return true;
 }
 
 
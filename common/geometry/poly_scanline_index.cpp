@@ -0,0 +1,258 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <algorithm>
+#include <climits>
+
+#include <math/math_util.h>
+#include <geometry/poly_scanline_index.h>
+
+// Edges spanning several rows are stored once per row: the row count is reduced until
+// the index holds at most this number of entries per edge on average.
+static const int MAX_ENTRIES_PER_EDGE = 8;
+
+
+POLY_SCANLINE_INDEX::POLY_SCANLINE_INDEX( const SHAPE_LINE_CHAIN& aPath ) :
+    m_path( &aPath )
+{
+    m_bbox = aPath.BBox();
+    m_edgeCount = aPath.SegmentCount();
+
+    // The rows cover the bounding box inflated by 1, to hold all the edges closer than
+    // 1 to a point (see PointOnEdge())
+    m_y0 = m_bbox.GetY() - 1;
+
+    SEG::ecoord height = (SEG::ecoord) m_bbox.GetHeight() + 3;
+
+    m_rowCount = (int) std::max<SEG::ecoord>( 1, std::min<SEG::ecoord>( m_edgeCount, height ) );
+
+    std::vector<int> firstRow( m_edgeCount );
+    std::vector<int> lastRow( m_edgeCount );
+
+    while( true )
+    {
+        m_rowHeight = ( height + m_rowCount - 1 ) / m_rowCount;
+
+        SEG::ecoord entries = 0;
+
+        for( int ii = 0; ii < m_edgeCount; ++ii )
+        {
+            const SEG edge = aPath.CSegment( ii );
+
+            firstRow[ii] = rowOf( std::min( edge.A.y, edge.B.y ) - 1 );
+            lastRow[ii] = rowOf( std::max( edge.A.y, edge.B.y ) + 1 );
+            entries += lastRow[ii] - firstRow[ii] + 1;
+        }
+
+        if( m_rowCount == 1 || entries <= (SEG::ecoord) MAX_ENTRIES_PER_EDGE * m_edgeCount )
+            break;
+
+        m_rowCount /= 2;
+    }
+
+    m_rowStart.assign( m_rowCount + 1, 0 );
+
+    for( int ii = 0; ii < m_edgeCount; ++ii )
+    {
+        for( int row = firstRow[ii]; row <= lastRow[ii]; ++row )
+            m_rowStart[row + 1]++;
+    }
+
+    for( int row = 0; row < m_rowCount; ++row )
+        m_rowStart[row + 1] += m_rowStart[row];
+
+    m_rowEdges.resize( m_rowStart.back() );
+
+    std::vector<int> fill( m_rowStart.begin(), m_rowStart.end() - 1 );
+
+    for( int ii = 0; ii < m_edgeCount; ++ii )
+    {
+        for( int row = firstRow[ii]; row <= lastRow[ii]; ++row )
+            m_rowEdges[fill[row]++] = ii;
+    }
+}
+
+
+int POLY_SCANLINE_INDEX::rowOf( int aY ) const
+{
+    SEG::ecoord offset = (SEG::ecoord) aY - m_y0;
+
+    if( offset <= 0 )
+        return 0;
+
+    return (int) std::min<SEG::ecoord>( offset / m_rowHeight, m_rowCount - 1 );
+}
+
+
+SEG::ecoord POLY_SCANLINE_INDEX::rowGap( int aRow, int aMin, int aMax ) const
+{
+    // The row holds the edges crossing the heights [top, bottom[
+    SEG::ecoord top = m_y0 + aRow * m_rowHeight;
+    SEG::ecoord bottom = top + m_rowHeight;
+
+    return std::max<SEG::ecoord>( 0, std::max( top - aMax, aMin - bottom ) );
+}
+
+
+///> Returns a lower bound of the distance between aEdge and aBox
+static SEG::ecoord segBoxGap( const SEG& aEdge, const BOX2I& aBox )
+{
+    SEG::ecoord dx = std::max<SEG::ecoord>( (SEG::ecoord) std::min( aEdge.A.x, aEdge.B.x )
+                                                    - aBox.GetRight(),
+                                            (SEG::ecoord) aBox.GetX()
+                                                    - std::max( aEdge.A.x, aEdge.B.x ) );
+    SEG::ecoord dy = std::max<SEG::ecoord>( (SEG::ecoord) std::min( aEdge.A.y, aEdge.B.y )
+                                                    - aBox.GetBottom(),
+                                            (SEG::ecoord) aBox.GetY()
+                                                    - std::max( aEdge.A.y, aEdge.B.y ) );
+
+    return std::max<SEG::ecoord>( 0, std::max( dx, dy ) );
+}
+
+
+template <class FUNC>
+int POLY_SCANLINE_INDEX::visitByDistance( int aMin, int aMax, FUNC aFunc ) const
+{
+    int best = INT_MAX;
+
+    auto visitRow = [&]( int aRow )
+    {
+        for( int ii = m_rowStart[aRow]; ii < m_rowStart[aRow + 1] && best > 0; ++ii )
+            best = std::min( best, aFunc( m_rowEdges[ii], best ) );
+    };
+
+    int first = rowOf( aMin );
+    int last = rowOf( aMax );
+
+    for( int row = first; row <= last && best > 0; ++row )
+        visitRow( row );
+
+    // The closest point of an edge lies in one of the rows holding it, at least as far
+    // as the row itself: the search stops at the first row farther than the best edge.
+    int below = first - 1;
+    int above = last + 1;
+
+    while( best > 0 && ( below >= 0 || above < m_rowCount ) )
+    {
+        SEG::ecoord gapBelow = below >= 0 ? rowGap( below, aMin, aMax ) : LLONG_MAX;
+        SEG::ecoord gapAbove = above < m_rowCount ? rowGap( above, aMin, aMax ) : LLONG_MAX;
+
+        if( std::min( gapBelow, gapAbove ) > best )
+            break;
+
+        if( gapBelow <= gapAbove )
+            visitRow( below-- );
+        else
+            visitRow( above++ );
+    }
+
+    return best;
+}
+
+
+bool POLY_SCANLINE_INDEX::PointInside( const VECTOR2I& aP ) const
+{
+    if( !m_path->IsClosed() || m_path->PointCount() < 3 || !m_bbox.Contains( aP ) )
+        return false;
+
+    bool inside = false;
+    int  row = rowOf( aP.y );
+
+    // Same crossing test as SHAPE_LINE_CHAIN::PointInside(), restricted to the edges
+    // crossing the row: the other ones cannot cross the horizontal line through aP.
+    for( int ii = m_rowStart[row]; ii < m_rowStart[row + 1]; ++ii )
+    {
+        const int  edge = m_rowEdges[ii];
+        const auto p1 = m_path->CPoint( edge );
+        const auto p2 = m_path->CPoint( edge + 1 );
+        const auto diff = p2 - p1;
+
+        if( diff.y != 0 )
+        {
+            const int d = rescale( diff.x, ( aP.y - p1.y ), diff.y );
+
+            if( ( ( p1.y > aP.y ) != ( p2.y > aP.y ) ) && ( aP.x - p1.x < d ) )
+                inside = !inside;
+        }
+    }
+
+    return inside && !PointOnEdge( aP );
+}
+
+
+bool POLY_SCANLINE_INDEX::PointOnEdge( const VECTOR2I& aP ) const
+{
+    if( m_path->PointCount() < 2 )
+        return m_path->PointOnEdge( aP );
+
+    BOX2I area = m_bbox;
+    area.Inflate( 1 );
+
+    if( !area.Contains( aP ) )
+        return false;
+
+    int row = rowOf( aP.y );
+
+    for( int ii = m_rowStart[row]; ii < m_rowStart[row + 1]; ++ii )
+    {
+        const SEG edge = m_path->CSegment( m_rowEdges[ii] );
+
+        if( edge.A == aP || edge.B == aP || edge.Distance( aP ) <= 1 )
+            return true;
+    }
+
+    return false;
+}
+
+
+int POLY_SCANLINE_INDEX::Distance( const VECTOR2I& aP ) const
+{
+    const BOX2I box( aP, VECTOR2I( 0, 0 ) );
+
+    return visitByDistance( aP.y, aP.y, [&]( int aEdge, int aBest )
+            {
+                const SEG edge = m_path->CSegment( aEdge );
+
+                if( segBoxGap( edge, box ) > aBest )
+                    return aBest;
+
+                return edge.Distance( aP );
+            } );
+}
+
+
+int POLY_SCANLINE_INDEX::Distance( const SEG& aSeg ) const
+{
+    BOX2I box( aSeg.A, aSeg.B - aSeg.A );
+    box.Normalize();
+
+    return visitByDistance( box.GetY(), box.GetBottom(), [&]( int aEdge, int aBest )
+            {
+                const SEG edge = m_path->CSegment( aEdge );
+
+                if( segBoxGap( edge, box ) > aBest )
+                    return aBest;
+
+                return edge.Distance( aSeg );
+            } );
+}
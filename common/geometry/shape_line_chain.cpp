@@ -34,16 +34,26 @@ ClipperLib::Path SHAPE_LINE_CHAIN::convertToClipper( bool aRequiredOrientation )
 {
     ClipperLib::Path c_path;
 
+    convertToClipper( aRequiredOrientation, c_path );
+
+    return c_path;
+}
+
+
+void SHAPE_LINE_CHAIN::convertToClipper( bool aRequiredOrientation,
+                                         ClipperLib::Path& aPath ) const
+{
+    aPath.clear();
+    aPath.reserve( PointCount() );
+
     for( int i = 0; i < PointCount(); i++ )
     {
         const VECTOR2I& vertex = CPoint( i );
-        c_path.push_back( ClipperLib::IntPoint( vertex.x, vertex.y ) );
+        aPath.push_back( ClipperLib::IntPoint( vertex.x, vertex.y ) );
     }
 
-    if( Orientation( c_path ) != aRequiredOrientation )
-        ReversePath( c_path );
-
-    return c_path;
+    if( Orientation( aPath ) != aRequiredOrientation )
+        ReversePath( aPath );
 }
 
 
@@ -34,28 +34,51 @@
 #include <algorithm>
 #include <unordered_set>
 #include <memory>
+#include <climits>
+#include <future>
+#include <thread>
 
 #include <md5_hash.h>
 #include <map>
 
 #include <make_unique.h>
+#include <core/arena.h>
 
 #include <geometry/geometry_utils.h>
 #include <geometry/shape.h>
 #include <geometry/shape_line_chain.h>
 #include <geometry/shape_poly_set.h>
 #include <geometry/polygon_triangulation.h>
+#include <geometry/poly_scanline_index.h>
 
 using namespace ClipperLib;
 
+// Sets having less vertices are queried fast enough without spatial index
+static const int SPATIAL_INDEX_MIN_VERTICES = 256;
+
+// Number of queries on an unmodified set before its spatial index is built
+static const int SPATIAL_INDEX_MIN_QUERIES = 4;
+
+// Vertices to triangulate per thread: smaller sets are not worth starting threads
+static const int TRIANGULATION_MIN_VERTICES_PER_THREAD = 4096;
+
+
+struct SHAPE_POLY_SET::SPATIAL_INDEX
+{
+    ///> Indexes of the contours of each polygon, outline first
+    std::vector<std::vector<POLY_SCANLINE_INDEX>> m_polygons;
+};
+
+
 SHAPE_POLY_SET::SHAPE_POLY_SET() :
-    SHAPE( SH_POLY_SET )
+    SHAPE( SH_POLY_SET ), m_spatialIndex( nullptr ), m_spatialIndexQueries( 0 )
 {
 }
 
 
 SHAPE_POLY_SET::SHAPE_POLY_SET( const SHAPE_POLY_SET& aOther, bool aDeepCopy ) :
-    SHAPE( SH_POLY_SET ), m_polys( aOther.m_polys )
+    SHAPE( SH_POLY_SET ), m_polys( aOther.m_polys ), m_spatialIndex( nullptr ),
+    m_spatialIndexQueries( 0 )
 {
     if( aOther.IsTriangulationUpToDate() )
     {
@@ -71,6 +94,7 @@ SHAPE_POLY_SET::SHAPE_POLY_SET( const SHAPE_POLY_SET& aOther, bool aDeepCopy ) :
 
 SHAPE_POLY_SET::~SHAPE_POLY_SET()
 {
+    delete m_spatialIndex.load();
 }
 
 
@@ -165,6 +189,8 @@ bool SHAPE_POLY_SET::GetGlobalIndex( SHAPE_POLY_SET::VERTEX_INDEX aRelativeIndic
 
 int SHAPE_POLY_SET::NewOutline()
 {
+    InvalidateSpatialIndex();
+
     SHAPE_LINE_CHAIN empty_path;
     POLYGON poly;
 
@@ -177,6 +203,8 @@ int SHAPE_POLY_SET::NewOutline()
 
 int SHAPE_POLY_SET::NewHole( int aOutline )
 {
+    InvalidateSpatialIndex();
+
     SHAPE_LINE_CHAIN empty_path;
 
     empty_path.SetClosed( true );
@@ -194,6 +222,8 @@ int SHAPE_POLY_SET::NewHole( int aOutline )
 
 int SHAPE_POLY_SET::Append( int x, int y, int aOutline, int aHole, bool aAllowDuplication )
 {
+    InvalidateSpatialIndex();
+
     if( aOutline < 0 )
         aOutline += m_polys.size();
 
@@ -217,6 +247,8 @@ void SHAPE_POLY_SET::InsertVertex( int aGlobalIndex, VECTOR2I aNewVertex )
 {
     VERTEX_INDEX index;
 
+    InvalidateSpatialIndex();
+
     if( aGlobalIndex < 0 )
         aGlobalIndex = 0;
 
@@ -277,6 +309,8 @@ SHAPE_POLY_SET SHAPE_POLY_SET::Subset( int aFirstPolygon, int aLastPolygon )
 
 VECTOR2I& SHAPE_POLY_SET::Vertex( int aIndex, int aOutline, int aHole )
 {
+    InvalidateSpatialIndex();
+
     if( aOutline < 0 )
         aOutline += m_polys.size();
 
@@ -321,6 +355,8 @@ VECTOR2I& SHAPE_POLY_SET::Vertex( int aGlobalIndex )
     if( !GetRelativeIndices( aGlobalIndex, &index ) )
         throw( std::out_of_range( "aGlobalIndex-th vertex does not exist" ) );
 
+    InvalidateSpatialIndex();
+
     return m_polys[index.m_polygon][index.m_contour].Point( index.m_vertex );
 }
 
@@ -439,6 +475,8 @@ int SHAPE_POLY_SET::AddOutline( const SHAPE_LINE_CHAIN& aOutline )
 {
     assert( aOutline.IsClosed() );
 
+    InvalidateSpatialIndex();
+
     POLYGON poly;
 
     poly.push_back( aOutline );
@@ -453,6 +491,8 @@ int SHAPE_POLY_SET::AddHole( const SHAPE_LINE_CHAIN& aHole, int aOutline )
 {
     assert( m_polys.size() );
 
+    InvalidateSpatialIndex();
+
     if( aOutline < 0 )
         aOutline += m_polys.size();
 
@@ -482,16 +522,25 @@ void SHAPE_POLY_SET::booleanOp( ClipperLib::ClipType aType,
 
     c.StrictlySimple( aFastMode == PM_STRICTLY_SIMPLE );
 
-    for( auto poly : aShape.m_polys )
+    // Clipper copies the paths: one buffer is enough for all the contours
+    Path path;
+
+    for( const POLYGON& poly : aShape.m_polys )
     {
         for( size_t i = 0 ; i < poly.size(); i++ )
-            c.AddPath( poly[i].convertToClipper( i == 0 ), ptSubject, true );
+        {
+            poly[i].convertToClipper( i == 0, path );
+            c.AddPath( path, ptSubject, true );
+        }
     }
 
-    for( auto poly : aOtherShape.m_polys )
+    for( const POLYGON& poly : aOtherShape.m_polys )
     {
         for( size_t i = 0; i < poly.size(); i++ )
-            c.AddPath( poly[i].convertToClipper( i == 0 ), ptClip, true );
+        {
+            poly[i].convertToClipper( i == 0, path );
+            c.AddPath( path, ptClip, true );
+        }
     }
 
     PolyTree solution;
@@ -565,11 +614,15 @@ void SHAPE_POLY_SET::Inflate( int aFactor, int aCircleSegmentsCount, bool aPrese
     // N.B. using jtSquare here does not create square corners.  They end up mitered by
     // aFactor.  Setting jtMiter and forcing the limit to be aFactor creates sharp corners.
     JoinType type = aPreseveCorners ? jtMiter : jtRound;
+    Path     path;
 
     for( const POLYGON& poly : m_polys )
     {
         for( size_t i = 0; i < poly.size(); i++ )
-            c.AddPath( poly[i].convertToClipper( i == 0 ), type, etClosedPolygon );
+        {
+            poly[i].convertToClipper( i == 0, path );
+            c.AddPath( path, type, etClosedPolygon );
+        }
     }
 
     PolyTree solution;
@@ -605,20 +658,23 @@ void SHAPE_POLY_SET::Inflate( int aFactor, int aCircleSegmentsCount, bool aPrese
 
 void SHAPE_POLY_SET::importTree( PolyTree* tree )
 {
+    InvalidateSpatialIndex();
+
     m_polys.clear();
 
     for( PolyNode* n = tree->GetFirst(); n; n = n->GetNext() )
     {
         if( !n->IsHole() )
         {
-            POLYGON paths;
+            // Build the polygon in place, the contours are not copied again
+            m_polys.emplace_back();
+
+            POLYGON& paths = m_polys.back();
             paths.reserve( n->Childs.size() + 1 );
-            paths.push_back( n->Contour );
+            paths.emplace_back( n->Contour );
 
             for( unsigned int i = 0; i < n->Childs.size(); i++ )
-                paths.push_back( n->Childs[i]->Contour );
-
-            m_polys.push_back( paths );
+                paths.emplace_back( n->Childs[i]->Contour );
         }
     }
 }
@@ -665,8 +721,11 @@ struct FractureEdge
 
 typedef std::vector<FractureEdge*> FractureEdgeSet;
 
+// The edges of a fractured polygon are all freed together at the end of fractureSingle()
+typedef ARENA<FractureEdge> FractureEdgeArena;
+
 
-static int processEdge( FractureEdgeSet& edges, FractureEdge* edge )
+static int processEdge( FractureEdgeArena& arena, FractureEdgeSet& edges, FractureEdge* edge )
 {
     int x   = edge->m_p1.x;
     int y   = edge->m_p1.y;
@@ -703,11 +762,11 @@ static int processEdge( FractureEdgeSet& edges, FractureEdge* edge )
         int count = 0;
 
         FractureEdge* lead1 =
-            new FractureEdge( true, VECTOR2I( x_nearest, y ), VECTOR2I( x, y ) );
+            arena.Create( true, VECTOR2I( x_nearest, y ), VECTOR2I( x, y ) );
         FractureEdge* lead2 =
-            new FractureEdge( true, VECTOR2I( x, y ), VECTOR2I( x_nearest, y ) );
+            arena.Create( true, VECTOR2I( x, y ), VECTOR2I( x_nearest, y ) );
         FractureEdge* split_2 =
-            new FractureEdge( true, VECTOR2I( x_nearest, y ), e_nearest->m_p2 );
+            arena.Create( true, VECTOR2I( x_nearest, y ), e_nearest->m_p2 );
 
         edges.push_back( split_2 );
         edges.push_back( lead1 );
@@ -741,9 +800,10 @@ static int processEdge( FractureEdgeSet& edges, FractureEdge* edge )
 
 void SHAPE_POLY_SET::fractureSingle( POLYGON& paths )
 {
-    FractureEdgeSet edges;
-    FractureEdgeSet border_edges;
-    FractureEdge*   root = NULL;
+    FractureEdgeArena arena;
+    FractureEdgeSet   edges;
+    FractureEdgeSet   border_edges;
+    FractureEdge*     root = NULL;
 
     bool first = true;
 
@@ -751,6 +811,13 @@ void SHAPE_POLY_SET::fractureSingle( POLYGON& paths )
         return;
 
     int num_unconnected = 0;
+    int num_vertices = 0;
+
+    for( const SHAPE_LINE_CHAIN& path : paths )
+        num_vertices += path.PointCount();
+
+    // each hole adds 3 edges when connected
+    edges.reserve( num_vertices + 3 * paths.size() );
 
     for( SHAPE_LINE_CHAIN& path : paths )
     {
@@ -770,7 +837,7 @@ void SHAPE_POLY_SET::fractureSingle( POLYGON& paths )
 
         for( int i = 0; i < path.PointCount(); i++ )
         {
-            FractureEdge* fe = new FractureEdge( first, &path, index++ );
+            FractureEdge* fe = arena.Create( first, &path, index++ );
 
             if( !root )
                 root = fe;
@@ -819,13 +886,16 @@ void SHAPE_POLY_SET::fractureSingle( POLYGON& paths )
             }
         }
 
-        num_unconnected -= processEdge( edges, smallestX );
+        num_unconnected -= processEdge( arena, edges, smallestX );
     }
 
     paths.clear();
-    SHAPE_LINE_CHAIN newPath;
+    paths.emplace_back();
+
+    SHAPE_LINE_CHAIN& newPath = paths.back();
 
     newPath.SetClosed( true );
+    newPath.Reserve( edges.size() );
 
     FractureEdge* e;
 
@@ -833,11 +903,6 @@ void SHAPE_POLY_SET::fractureSingle( POLYGON& paths )
         newPath.Append( e->m_p1 );
 
     newPath.Append( e->m_p1 );
-
-    for( FractureEdgeSet::iterator i = edges.begin(); i != edges.end(); ++i )
-        delete *i;
-
-    paths.push_back( newPath );
 }
 
 
@@ -845,6 +910,8 @@ void SHAPE_POLY_SET::Fracture( POLYGON_MODE aFastMode )
 {
     Simplify( aFastMode );    // remove overlapping holes/degeneracy
 
+    InvalidateSpatialIndex();
+
     for( POLYGON& paths : m_polys )
     {
         fractureSingle( paths );
@@ -906,6 +973,8 @@ void SHAPE_POLY_SET::unfractureSingle( SHAPE_POLY_SET::POLYGON& aPoly )
     auto lc = aPoly[0];
     lc.Simplify();
 
+    uniqueEdges.reserve( lc.SegmentCount() );
+
     auto edgeList = std::make_unique<EDGE_LIST_ENTRY []>( lc.SegmentCount() );
 
     for( int i = 0; i < lc.SegmentCount(); i++ )
@@ -916,6 +985,8 @@ void SHAPE_POLY_SET::unfractureSingle( SHAPE_POLY_SET::POLYGON& aPoly )
 
     std::unordered_set<EDGE_LIST_ENTRY*> queue;
 
+    queue.reserve( lc.SegmentCount() );
+
     for( int i = 0; i < lc.SegmentCount(); i++ )
     {
         EDGE e( &lc, i );
@@ -988,6 +1059,8 @@ void SHAPE_POLY_SET::unfractureSingle( SHAPE_POLY_SET::POLYGON& aPoly )
 
         SHAPE_LINE_CHAIN outl;
 
+        outl.Reserve( cnt );
+
         for( int i = 0; i < cnt; i++ )
         {
             auto p = lc.CPoint( edgeBuf[i]->index );
@@ -1002,14 +1075,14 @@ void SHAPE_POLY_SET::unfractureSingle( SHAPE_POLY_SET::POLYGON& aPoly )
         if( cw )
             outline = n;
 
-        result.push_back( outl );
+        result.push_back( std::move( outl ) );
         n++;
     }
 
     if( outline > 0 )
         std::swap( result[0], result[outline] );
 
-    aPoly = result;
+    aPoly.swap( result );
 }
 
 
@@ -1030,6 +1103,8 @@ bool SHAPE_POLY_SET::HasHoles() const
 
 void SHAPE_POLY_SET::Unfracture( POLYGON_MODE aFastMode )
 {
+    InvalidateSpatialIndex();
+
     for( POLYGON& path : m_polys )
     {
         unfractureSingle( path );
@@ -1109,6 +1184,8 @@ bool SHAPE_POLY_SET::Parse( std::stringstream& aStream )
 {
     std::string tmp;
 
+    InvalidateSpatialIndex();
+
     aStream >> tmp;
 
     if( tmp != "polyset" )
@@ -1200,29 +1277,40 @@ bool SHAPE_POLY_SET::PointOnEdge( const VECTOR2I& aP ) const
 
 bool SHAPE_POLY_SET::Collide( const SEG& aSeg, int aClearance ) const
 {
-
-    SHAPE_POLY_SET polySet = SHAPE_POLY_SET( *this );
-
-    // Inflate the polygon if necessary.
-    if( aClearance > 0 )
-    {
-        // fixme: the number of arc segments should not be hardcoded
-        polySet.Inflate( aClearance, 8 );
-    }
+    const SPATIAL_INDEX* index = spatialIndex();
 
     // We are going to check to see if the segment crosses an external
     // boundary.  However, if the full segment is inside the polyset, this
     // will not be true.  So we first test to see if one of the points is
     // inside.  If true, then we collide
-    if( polySet.Contains( aSeg.A ) )
+    if( Contains( aSeg.A ) )
         return true;
 
-    for( SEGMENT_ITERATOR iterator = polySet.IterateSegmentsWithHoles(); iterator; iterator++ )
+    for( int polygonIdx = 0; polygonIdx < OutlineCount(); polygonIdx++ )
     {
-        SEG polygonEdge = *iterator;
+        int distance = edgeDistance( aSeg, polygonIdx, index );
 
-        if( polygonEdge.Intersect( aSeg, true ) )
-            return true;
+        // The clearance is measured from the edges, like an inflated polygon would do
+        if( aClearance > 0 )
+        {
+            if( distance <= aClearance )
+                return true;
+
+            continue;
+        }
+
+        // Only the edges near enough can cross the segment
+        if( distance > 0 )
+            continue;
+
+        for( const SHAPE_LINE_CHAIN& contour : m_polys[polygonIdx] )
+        {
+            for( int ii = 0; ii < contour.SegmentCount(); ii++ )
+            {
+                if( contour.CSegment( ii ).Intersect( aSeg, true ) )
+                    return true;
+            }
+        }
     }
 
     return false;
@@ -1231,28 +1319,34 @@ bool SHAPE_POLY_SET::Collide( const SEG& aSeg, int aClearance ) const
 
 bool SHAPE_POLY_SET::Collide( const VECTOR2I& aP, int aClearance ) const
 {
-    SHAPE_POLY_SET polySet = SHAPE_POLY_SET( *this );
+    const SPATIAL_INDEX* index = spatialIndex();
 
-    // Inflate the polygon if necessary.
-    if( aClearance > 0 )
+    // There is a collision if the point is inside of the polygon, or near enough
+    // of its edges
+    for( int polygonIdx = 0; polygonIdx < OutlineCount(); polygonIdx++ )
     {
-        // fixme: the number of arc segments should not be hardcoded
-        polySet.Inflate( aClearance, 8 );
+        if( containsSingle( aP, polygonIdx, false, index ) )
+            return true;
+
+        if( aClearance > 0 && edgeDistance( aP, polygonIdx, index ) <= aClearance )
+            return true;
     }
 
-    // There is a collision if and only if the point is inside of the polygon.
-    return polySet.Contains( aP );
+    return false;
 }
 
 
 void SHAPE_POLY_SET::RemoveAllContours()
 {
+    InvalidateSpatialIndex();
     m_polys.clear();
 }
 
 
 void SHAPE_POLY_SET::RemoveContour( int aContourIdx, int aPolygonIdx )
 {
+    InvalidateSpatialIndex();
+
     // Default polygon is the last one
     if( aPolygonIdx < 0 )
         aPolygonIdx += m_polys.size();
@@ -1265,7 +1359,9 @@ int SHAPE_POLY_SET::RemoveNullSegments()
 {
     int removed = 0;
 
-    ITERATOR iterator = IterateWithHoles();
+    // Only read the set until a vertex is removed: the spatial index must not be dropped
+    // while other threads query an unchanged set
+    CONST_ITERATOR iterator = CIterateWithHoles();
 
     VECTOR2I    contourStart = *iterator;
     VECTOR2I    segmentStart, segmentEnd;
@@ -1316,12 +1412,14 @@ int SHAPE_POLY_SET::RemoveNullSegments()
 
 void SHAPE_POLY_SET::DeletePolygon( int aIdx )
 {
+    InvalidateSpatialIndex();
     m_polys.erase( m_polys.begin() + aIdx );
 }
 
 
 void SHAPE_POLY_SET::Append( const SHAPE_POLY_SET& aSet )
 {
+    InvalidateSpatialIndex();
     m_polys.insert( m_polys.end(), aSet.m_polys.begin(), aSet.m_polys.end() );
 }
 
@@ -1405,14 +1503,16 @@ bool SHAPE_POLY_SET::Contains( const VECTOR2I& aP, int aSubpolyIndex, bool aIgno
     if( m_polys.size() == 0 ) // empty set?
         return false;
 
+    const SPATIAL_INDEX* index = spatialIndex();
+
     // If there is a polygon specified, check the condition against that polygon
     if( aSubpolyIndex >= 0 )
-        return containsSingle( aP, aSubpolyIndex, aIgnoreHoles );
+        return containsSingle( aP, aSubpolyIndex, aIgnoreHoles, index );
 
     // In any other case, check it against all polygons in the set
     for( int polygonIdx = 0; polygonIdx < OutlineCount(); polygonIdx++ )
     {
-        if( containsSingle( aP, polygonIdx, aIgnoreHoles ) )
+        if( containsSingle( aP, polygonIdx, aIgnoreHoles, index ) )
             return true;
     }
 
@@ -1434,12 +1534,39 @@ void SHAPE_POLY_SET::RemoveVertex( int aGlobalIndex )
 
 void SHAPE_POLY_SET::RemoveVertex( VERTEX_INDEX aIndex )
 {
+    InvalidateSpatialIndex();
     m_polys[aIndex.m_polygon][aIndex.m_contour].Remove( aIndex.m_vertex );
 }
 
 
 bool SHAPE_POLY_SET::containsSingle( const VECTOR2I& aP, int aSubpolyIndex, bool aIgnoreHoles ) const
 {
+    return containsSingle( aP, aSubpolyIndex, aIgnoreHoles, spatialIndex() );
+}
+
+
+bool SHAPE_POLY_SET::containsSingle( const VECTOR2I& aP, int aSubpolyIndex, bool aIgnoreHoles,
+                                     const SPATIAL_INDEX* aIndex ) const
+{
+    if( aIndex )
+    {
+        const std::vector<POLY_SCANLINE_INDEX>& contours = aIndex->m_polygons[aSubpolyIndex];
+
+        if( !contours[0].PointInside( aP ) )
+            return false;
+
+        if( !aIgnoreHoles )
+        {
+            for( size_t ii = 1; ii < contours.size(); ii++ )
+            {
+                if( contours[ii].PointInside( aP ) && !contours[ii].PointOnEdge( aP ) )
+                    return false;
+            }
+        }
+
+        return true;
+    }
+
     // Check that the point is inside the outline
     if( pointInPolygon( aP, m_polys[aSubpolyIndex][0] ) )
     {
@@ -1448,7 +1575,7 @@ bool SHAPE_POLY_SET::containsSingle( const VECTOR2I& aP, int aSubpolyIndex, bool
             // Check that the point is not in any of the holes
             for( int holeIdx = 0; holeIdx < HoleCount( aSubpolyIndex ); holeIdx++ )
             {
-                const SHAPE_LINE_CHAIN hole = CHole( aSubpolyIndex, holeIdx );
+                const SHAPE_LINE_CHAIN& hole = CHole( aSubpolyIndex, holeIdx );
 
                 // If the point is inside a hole (and not on its edge),
                 // it is outside of the polygon
@@ -1472,6 +1599,8 @@ bool SHAPE_POLY_SET::pointInPolygon( const VECTOR2I& aP, const SHAPE_LINE_CHAIN&
 
 void SHAPE_POLY_SET::Move( const VECTOR2I& aVector )
 {
+    InvalidateSpatialIndex();
+
     for( POLYGON& poly : m_polys )
     {
         for( SHAPE_LINE_CHAIN& path : poly )
@@ -1484,6 +1613,8 @@ void SHAPE_POLY_SET::Move( const VECTOR2I& aVector )
 
 void SHAPE_POLY_SET::Rotate( double aAngle, const VECTOR2I& aCenter )
 {
+    InvalidateSpatialIndex();
+
     for( POLYGON& poly : m_polys )
     {
         for( SHAPE_LINE_CHAIN& path : poly )
@@ -1526,55 +1657,31 @@ SHAPE_POLY_SET::POLYGON SHAPE_POLY_SET::FilletPolygon( unsigned int aRadius,
 
 int SHAPE_POLY_SET::DistanceToPolygon( VECTOR2I aPoint, int aPolygonIndex )
 {
+    const SPATIAL_INDEX* index = spatialIndex();
+
     // We calculate the min dist between the segment and each outline segment
     // However, if the segment to test is inside the outline, and does not cross
     // any edge, it can be seen outside the polygon.
     // Therefore test if a segment end is inside ( testing only one end is enough )
-    if( containsSingle( aPoint, aPolygonIndex ) )
+    if( containsSingle( aPoint, aPolygonIndex, false, index ) )
         return 0;
 
-    SEGMENT_ITERATOR iterator = IterateSegmentsWithHoles( aPolygonIndex );
-
-    SEG polygonEdge = *iterator;
-    int minDistance = polygonEdge.Distance( aPoint );
-
-    for( iterator++; iterator && minDistance > 0; iterator++ )
-    {
-        polygonEdge = *iterator;
-
-        int currentDistance = polygonEdge.Distance( aPoint );
-
-        if( currentDistance < minDistance )
-            minDistance = currentDistance;
-    }
-
-    return minDistance;
+    return edgeDistance( aPoint, aPolygonIndex, index );
 }
 
 
 int SHAPE_POLY_SET::DistanceToPolygon( SEG aSegment, int aPolygonIndex, int aSegmentWidth )
 {
+    const SPATIAL_INDEX* index = spatialIndex();
+
     // We calculate the min dist between the segment and each outline segment
     // However, if the segment to test is inside the outline, and does not cross
     // any edge, it can be seen outside the polygon.
     // Therefore test if a segment end is inside ( testing only one end is enough )
-    if( containsSingle( aSegment.A, aPolygonIndex ) )
+    if( containsSingle( aSegment.A, aPolygonIndex, false, index ) )
         return 0;
 
-    SEGMENT_ITERATOR iterator = IterateSegmentsWithHoles( aPolygonIndex );
-
-    SEG polygonEdge = *iterator;
-    int minDistance = polygonEdge.Distance( aSegment );
-
-    for( iterator++; iterator && minDistance > 0; iterator++ )
-    {
-        polygonEdge = *iterator;
-
-        int currentDistance = polygonEdge.Distance( aSegment );
-
-        if( currentDistance < minDistance )
-            minDistance = currentDistance;
-    }
+    int minDistance = edgeDistance( aSegment, aPolygonIndex, index );
 
     // Take into account the width of the segment
     if( aSegmentWidth > 0 )
@@ -1591,7 +1698,7 @@ int SHAPE_POLY_SET::Distance( VECTOR2I aPoint )
     int minDistance = DistanceToPolygon( aPoint, 0 );
 
     // Iterate through all the polygons and get the minimum distance.
-    for( unsigned int polygonIdx = 1; polygonIdx < m_polys.size(); polygonIdx++ )
+    for( unsigned int polygonIdx = 1; polygonIdx < m_polys.size() && minDistance > 0; polygonIdx++ )
     {
         currentDistance = DistanceToPolygon( aPoint, polygonIdx );
 
@@ -1609,7 +1716,7 @@ int SHAPE_POLY_SET::Distance( const SEG& aSegment, int aSegmentWidth )
     int minDistance = DistanceToPolygon( aSegment, 0, aSegmentWidth );
 
     // Iterate through all the polygons and get the minimum distance.
-    for( unsigned int polygonIdx = 1; polygonIdx < m_polys.size(); polygonIdx++ )
+    for( unsigned int polygonIdx = 1; polygonIdx < m_polys.size() && minDistance > 0; polygonIdx++ )
     {
         currentDistance = DistanceToPolygon( aSegment, polygonIdx, aSegmentWidth );
 
@@ -1621,6 +1728,58 @@ int SHAPE_POLY_SET::Distance( const SEG& aSegment, int aSegmentWidth )
 }
 
 
+int SHAPE_POLY_SET::edgeDistance( const VECTOR2I& aP, int aPolygonIndex,
+                                  const SPATIAL_INDEX* aIndex ) const
+{
+    const POLYGON& polygon = m_polys[aPolygonIndex];
+    int            minDistance = INT_MAX;
+
+    for( size_t ii = 0; ii < polygon.size() && minDistance > 0; ii++ )
+    {
+        if( aIndex )
+        {
+            const POLY_SCANLINE_INDEX& contourIndex = aIndex->m_polygons[aPolygonIndex][ii];
+
+            minDistance = std::min( minDistance, contourIndex.Distance( aP ) );
+            continue;
+        }
+
+        const SHAPE_LINE_CHAIN& contour = polygon[ii];
+
+        for( int jj = 0; jj < contour.SegmentCount() && minDistance > 0; jj++ )
+            minDistance = std::min( minDistance, contour.CSegment( jj ).Distance( aP ) );
+    }
+
+    return minDistance;
+}
+
+
+int SHAPE_POLY_SET::edgeDistance( const SEG& aSeg, int aPolygonIndex,
+                                  const SPATIAL_INDEX* aIndex ) const
+{
+    const POLYGON& polygon = m_polys[aPolygonIndex];
+    int            minDistance = INT_MAX;
+
+    for( size_t ii = 0; ii < polygon.size() && minDistance > 0; ii++ )
+    {
+        if( aIndex )
+        {
+            const POLY_SCANLINE_INDEX& contourIndex = aIndex->m_polygons[aPolygonIndex][ii];
+
+            minDistance = std::min( minDistance, contourIndex.Distance( aSeg ) );
+            continue;
+        }
+
+        const SHAPE_LINE_CHAIN& contour = polygon[ii];
+
+        for( int jj = 0; jj < contour.SegmentCount() && minDistance > 0; jj++ )
+            minDistance = std::min( minDistance, contour.CSegment( jj ).Distance( aSeg ) );
+    }
+
+    return minDistance;
+}
+
+
 bool SHAPE_POLY_SET::IsVertexInHole( int aGlobalIdx )
 {
     VERTEX_INDEX index;
@@ -1661,10 +1820,18 @@ SHAPE_POLY_SET::POLYGON SHAPE_POLY_SET::chamferFilletPolygon( CORNER_MODE aMode,
         int aIndex,
         int aErrorMax )
 {
-    // Null segments create serious issues in calculations. Remove them:
-    RemoveNullSegments();
+    SHAPE_POLY_SET::POLYGON currentPoly = CPolygon( aIndex );
 
-    SHAPE_POLY_SET::POLYGON currentPoly = Polygon( aIndex );
+    // Null segments create serious issues in calculations.  Remove them from the copy only:
+    // the set is left untouched, so it can be chamfered while other threads query it
+    for( SHAPE_LINE_CHAIN& contour : currentPoly )
+    {
+        for( int ii = contour.PointCount() - 1; ii >= 0 && contour.PointCount() > 1; ii-- )
+        {
+            if( contour.CPoint( ii ) == contour.CPoint( ( ii + 1 ) % contour.PointCount() ) )
+                contour.Remove( ii );
+        }
+    }
     SHAPE_POLY_SET::POLYGON newPoly;
 
     // If the chamfering distance is zero, then the polygon remain intact.
@@ -1824,6 +1991,8 @@ SHAPE_POLY_SET &SHAPE_POLY_SET::operator=( const SHAPE_POLY_SET& aOther )
     static_cast<SHAPE&>(*this) = aOther;
     m_polys = aOther.m_polys;
 
+    InvalidateSpatialIndex();
+
     // reset poly cache:
     m_hash = MD5_HASH{};
     m_triangulationValid = false;
@@ -1831,6 +2000,65 @@ SHAPE_POLY_SET &SHAPE_POLY_SET::operator=( const SHAPE_POLY_SET& aOther )
     return *this;
 }
 
+const SHAPE_POLY_SET::SPATIAL_INDEX* SHAPE_POLY_SET::spatialIndex() const
+{
+    const SPATIAL_INDEX* index = m_spatialIndex.load( std::memory_order_acquire );
+
+    if( index )
+        return index;
+
+    // Building the index costs a few brute force queries: only the sets queried
+    // several times since their last change are indexed
+    if( ++m_spatialIndexQueries < SPATIAL_INDEX_MIN_QUERIES )
+        return nullptr;
+
+    if( TotalVertices() < SPATIAL_INDEX_MIN_VERTICES )
+        return nullptr;
+
+    return buildSpatialIndex();
+}
+
+
+const SHAPE_POLY_SET::SPATIAL_INDEX* SHAPE_POLY_SET::buildSpatialIndex() const
+{
+    SPATIAL_INDEX* index = new SPATIAL_INDEX;
+
+    index->m_polygons.resize( m_polys.size() );
+
+    for( size_t ii = 0; ii < m_polys.size(); ii++ )
+    {
+        index->m_polygons[ii].reserve( m_polys[ii].size() );
+
+        for( const SHAPE_LINE_CHAIN& contour : m_polys[ii] )
+            index->m_polygons[ii].emplace_back( contour );
+    }
+
+    // Another thread may have built the index meanwhile: keep the first one
+    const SPATIAL_INDEX* stored = nullptr;
+
+    if( !m_spatialIndex.compare_exchange_strong( stored, index, std::memory_order_acq_rel ) )
+    {
+        delete index;
+        return stored;
+    }
+
+    return index;
+}
+
+
+void SHAPE_POLY_SET::freeSpatialIndex()
+{
+    delete m_spatialIndex.exchange( nullptr );
+}
+
+
+void SHAPE_POLY_SET::CacheSpatialIndex()
+{
+    if( !m_spatialIndex.load() )
+        buildSpatialIndex();
+}
+
+
 MD5_HASH SHAPE_POLY_SET::GetHash() const
 {
     if( !m_hash.IsValid() )
@@ -1854,7 +2082,7 @@ bool SHAPE_POLY_SET::IsTriangulationUpToDate() const
 }
 
 
-void SHAPE_POLY_SET::CacheTriangulation()
+void SHAPE_POLY_SET::CacheTriangulation( size_t aMaxThreads )
 {
     bool recalculate = !m_hash.IsValid();
     MD5_HASH hash;
@@ -1884,23 +2112,88 @@ void SHAPE_POLY_SET::CacheTriangulation()
     m_triangulatedPolys.clear();
     m_triangulationValid = true;
 
-    while( tmpSet.OutlineCount() > 0 )
+    // The outlines of the fractured set are triangulated independently, each one in
+    // its own slot to keep the order of the outlines whatever the thread count
+    const size_t outlineCount = tmpSet.OutlineCount();
+    std::vector<std::unique_ptr<TRIANGULATED_POLYGON>> triangulated( outlineCount );
+    std::atomic<size_t> nextOutline( 0 );
+
+    auto tri_lambda = [&]() -> size_t
+    {
+        size_t num = 0;
+
+        for( size_t i = nextOutline++; i < outlineCount; i = nextOutline++ )
+        {
+            auto tri = std::make_unique<TRIANGULATED_POLYGON>();
+            PolygonTriangulation tess( *tri );
+
+            if( tess.TesselatePolygon( tmpSet.CPolygon( i ).front() ) )
+                triangulated[i] = std::move( tri );
+
+            num++;
+        }
+
+        return num;
+    };
+
+    size_t parallelThreadCount = aMaxThreads;
+
+    if( parallelThreadCount == 0 )
+        parallelThreadCount = std::max<size_t>( std::thread::hardware_concurrency(), 1 );
+
+    parallelThreadCount = std::min<size_t>( parallelThreadCount, outlineCount );
+    parallelThreadCount = std::min<size_t>( parallelThreadCount,
+            tmpSet.TotalVertices() / TRIANGULATION_MIN_VERTICES_PER_THREAD );
+
+    if( parallelThreadCount <= 1 )
+        tri_lambda();
+    else
     {
-        m_triangulatedPolys.push_back( std::make_unique<TRIANGULATED_POLYGON>() );
-        PolygonTriangulation tess( *m_triangulatedPolys.back() );
+        std::vector<std::future<size_t>> returns( parallelThreadCount - 1 );
 
-        // If the tesselation fails, we re-fracture the polygon, which will
-        // first simplify the system before fracturing and removing the holes
-        // This may result in multiple, disjoint polygons.
-        if( !tess.TesselatePolygon( tmpSet.Polygon( 0 ).front() ) )
+        for( size_t ii = 0; ii < returns.size(); ++ii )
+            returns[ii] = std::async( std::launch::async, tri_lambda );
+
+        // The calling thread takes its share of the outlines too
+        tri_lambda();
+
+        for( auto& ret : returns )
+            ret.wait();
+    }
+
+    for( size_t i = 0; i < outlineCount; ++i )
+    {
+        if( triangulated[i] )
         {
-            tmpSet.Fracture( PM_FAST );
-            m_triangulationValid = false;
+            m_triangulatedPolys.push_back( std::move( triangulated[i] ) );
             continue;
         }
 
-        tmpSet.DeletePolygon( 0 );
-        m_triangulationValid = true;
+        // If the tesselation fails, we re-fracture the outline, which will
+        // first simplify it before fracturing and removing the holes
+        // This may result in multiple, disjoint polygons, which take the
+        // place of the outline to keep the order of the outlines.
+        SHAPE_POLY_SET failedSet;
+
+        failedSet.AddOutline( tmpSet.COutline( i ) );
+        failedSet.Fracture( PM_FAST );
+        m_triangulationValid = false;
+
+        while( failedSet.OutlineCount() > 0 )
+        {
+            m_triangulatedPolys.push_back( std::make_unique<TRIANGULATED_POLYGON>() );
+            PolygonTriangulation tess( *m_triangulatedPolys.back() );
+
+            if( !tess.TesselatePolygon( failedSet.Polygon( 0 ).front() ) )
+            {
+                failedSet.Fracture( PM_FAST );
+                m_triangulationValid = false;
+                continue;
+            }
+
+            failedSet.DeletePolygon( 0 );
+            m_triangulationValid = true;
+        }
     }
 
     if( m_triangulationValid )
@@ -1908,6 +2201,18 @@ void SHAPE_POLY_SET::CacheTriangulation()
 }
 
 
+void SHAPE_POLY_SET::SetTriangulation( const std::vector<TRIANGULATED_POLYGON>& aTriangulation )
+{
+    m_triangulatedPolys.clear();
+
+    for( const TRIANGULATED_POLYGON& tri : aTriangulation )
+        m_triangulatedPolys.push_back( std::make_unique<TRIANGULATED_POLYGON>( tri ) );
+
+    m_triangulationValid = true;
+    m_hash = checksum();
+}
+
+
 MD5_HASH SHAPE_POLY_SET::checksum() const
 {
     MD5_HASH hash;
@@ -92,6 +92,13 @@ bool MD5_HASH::operator!=( const MD5_HASH& aOther ) const
 }
 
 
+void MD5_HASH::SetDigest( const uint8_t* aDigest )
+{
+    memcpy( m_hash, aDigest, 16 );
+    m_valid = true;
+}
+
+
 std::string MD5_HASH::Format()
 {
     std::string data;
@@ -43,6 +43,49 @@
 #include <gbr_metadata.h>
 
 
+/// Size of the stdio buffers of the gerber file and of the temporary file
+#define GERBER_FILE_BUFSIZE     ( 1 << 20 )
+
+
+/**
+ * Write the decimal representation of an integer.  The gerber files contain
+ * mainly integer coordinates, and this is much faster than a printf.
+ * @return the end of the written string (not null terminated)
+ */
+static char* formatInt( char* aBuffer, int aValue )
+{
+    char     digits[16];
+    char*    d = digits;
+    unsigned value = aValue < 0 ? 0U - (unsigned) aValue : (unsigned) aValue;
+
+    if( aValue < 0 )
+        *aBuffer++ = '-';
+
+    do
+    {
+        *d++ = (char) ( '0' + value % 10 );
+        value /= 10;
+    } while( value );
+
+    while( d != digits )
+        *aBuffer++ = *--d;
+
+    return aBuffer;
+}
+
+
+size_t GERBER_PLOTTER::APERTURE_KEY_HASH::operator()( const APERTURE_KEY& aKey ) const
+{
+    uint64_t hash = (uint32_t) aKey.m_Size.x;
+
+    hash = hash * 0x9E3779B97F4A7C15ULL ^ (uint32_t) aKey.m_Size.y;
+    hash = hash * 0x9E3779B97F4A7C15ULL ^ (uint32_t) aKey.m_Type;
+    hash = hash * 0x9E3779B97F4A7C15ULL ^ (uint32_t) aKey.m_ApertureAttribute;
+
+    return (size_t) ( hash ^ ( hash >> 32 ) );
+}
+
+
 GERBER_PLOTTER::GERBER_PLOTTER()
 {
     workFile  = NULL;
@@ -100,9 +143,24 @@ void GERBER_PLOTTER::SetGerberCoordinatesFormat( int aResolution, bool aUseInche
 
 void GERBER_PLOTTER::emitDcode( const DPOINT& pt, int dcode )
 {
+    // Same as fprintf( outputFile, "X%dY%dD%02d*\n", ... )
+    char  buffer[64];
+    char* text = buffer;
+
+    *text++ = 'X';
+    text = formatInt( text, KiROUND( pt.x ) );
+    *text++ = 'Y';
+    text = formatInt( text, KiROUND( pt.y ) );
+    *text++ = 'D';
+
+    if( dcode >= 0 && dcode < 10 )
+        *text++ = '0';
 
-    fprintf( outputFile, "X%dY%dD%02d*\n",
-	    KiROUND( pt.x ), KiROUND( pt.y ), dcode );
+    text = formatInt( text, dcode );
+    *text++ = '*';
+    *text++ = '\n';
+
+    fwrite( buffer, 1, text - buffer, outputFile );
 }
 
 
@@ -168,18 +226,12 @@ bool GERBER_PLOTTER::StartPlot()
 {
     wxASSERT( outputFile );
 
-    finalFile = outputFile;     // the actual gerber file will be created later
-
-    // Create a temporary filename to store gerber file
-    // note tmpfile() does not work under Vista and W7 in user mode
-    m_workFilename = filename + wxT(".tmp");
-    workFile   = wxFopen( m_workFilename, wxT( "wt" ));
-    outputFile = workFile;
-    wxASSERT( outputFile );
-
-    if( outputFile == NULL )
-        return false;
+    finalFile = outputFile;     // the actual gerber file will be completed by EndPlot()
+    setvbuf( finalFile, NULL, _IOFBF, GERBER_FILE_BUFSIZE );
 
+    // The header is written directly to the gerber file.  The aperture list, that
+    // follows the header, is known only at the end of the plot: the plot itself is
+    // written to a temporary file and appended to the gerber file by EndPlot().
     for( unsigned ii = 0; ii < m_headerExtraLines.GetCount(); ii++ )
     {
         if( ! m_headerExtraLines[ii].IsEmpty() )
@@ -219,37 +271,44 @@ bool GERBER_PLOTTER::StartPlot()
 
     fputs( "G04 APERTURE LIST*\n", outputFile );
 
+    // Create a temporary filename to store the plot, read back by EndPlot()
+    // note tmpfile() does not work under Vista and W7 in user mode
+    m_workFilename = filename + wxT(".tmp");
+    workFile   = wxFopen( m_workFilename, wxT( "w+b" ));
+    outputFile = workFile;
+    wxASSERT( outputFile );
+
+    if( outputFile == NULL )
+        return false;
+
+    setvbuf( workFile, NULL, _IOFBF, GERBER_FILE_BUFSIZE );
+
     return true;
 }
 
 
 bool GERBER_PLOTTER::EndPlot()
 {
-    char     line[1024];
-    wxString msg;
-
     wxASSERT( outputFile );
 
     /* Outfile is actually a temporary file i.e. workFile */
     fputs( "M02*\n", outputFile );
-    fflush( outputFile );
 
-    fclose( workFile );
-    workFile   = wxFopen( m_workFilename, wxT( "rt" ));
-    wxASSERT( workFile );
     outputFile = finalFile;
 
-    // Placement of apertures in RS274X
-    while( fgets( line, 1024, workFile ) )
-    {
-        fputs( line, outputFile );
+    // Placement of apertures in RS274X, after the header already written
+    writeApertureList();
+    fputs( "G04 APERTURE END LIST*\n", outputFile );
 
-        if( strcmp( strtok( line, "\n\r" ), "G04 APERTURE LIST*" ) == 0 )
-        {
-            writeApertureList();
-            fputs( "G04 APERTURE END LIST*\n", outputFile );
-        }
-    }
+    // Append the plot.  The temporary file is a binary file: the end of lines are
+    // translated (if needed) only once, when written to the gerber file.
+    std::vector<char> buffer( GERBER_FILE_BUFSIZE );
+    size_t            count;
+
+    rewind( workFile );
+
+    while( ( count = fread( buffer.data(), 1, buffer.size(), workFile ) ) > 0 )
+        fwrite( buffer.data(), 1, count, outputFile );
 
     fclose( workFile );
     fclose( finalFile );
@@ -290,29 +349,21 @@ void GERBER_PLOTTER::SetCurrentLineWidth( int width, void* aData )
 std::vector<APERTURE>::iterator GERBER_PLOTTER::getAperture( const wxSize& aSize,
                         APERTURE::APERTURE_TYPE aType, int aApertureAttribute )
 {
-    int last_D_code = 9;
-
     // Search an existing aperture
-    std::vector<APERTURE>::iterator tool = apertures.begin();
+    APERTURE_KEY key = { aSize, aType, aApertureAttribute };
+    auto         it = m_apertureIndex.find( key );
 
-    while( tool != apertures.end() )
-    {
-        last_D_code = tool->m_DCode;
-
-        if( (tool->m_Type == aType) && (tool->m_Size == aSize) &&
-            (tool->m_ApertureAttribute == aApertureAttribute) )
-            return tool;
-
-        ++tool;
-    }
+    if( it != m_apertureIndex.end() )
+        return apertures.begin() + it->second;
 
     // Allocate a new aperture
     APERTURE new_tool;
     new_tool.m_Size  = aSize;
     new_tool.m_Type  = aType;
-    new_tool.m_DCode = last_D_code + 1;
+    new_tool.m_DCode = apertures.empty() ? FIRST_DCODE_VALUE : apertures.back().m_DCode + 1;
     new_tool.m_ApertureAttribute = aApertureAttribute;
 
+    m_apertureIndex[key] = (int) apertures.size();
     apertures.push_back( new_tool );
 
     return apertures.end() - 1;
@@ -336,7 +387,16 @@ void GERBER_PLOTTER::selectAperture( const wxSize&           aSize,
     {
         // Pick an existing aperture or create a new one
         currentAperture = getAperture( aSize, aType, aApertureAttribute );
-        fprintf( outputFile, "D%d*\n", currentAperture->m_DCode );
+
+        char  buffer[32];
+        char* text = buffer;
+
+        *text++ = 'D';
+        text = formatInt( text, currentAperture->m_DCode );
+        *text++ = '*';
+        *text++ = '\n';
+
+        fwrite( buffer, 1, text - buffer, outputFile );
     }
 }
 
@@ -23,10 +23,15 @@
  */
 
 
+#include <algorithm>
 #include <cstdarg>
 #include <config.h> // HAVE_FGETC_NOLOCK
 
 #include <richio.h>
+#include <wx/filename.h>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
 
 
 // Fall back to getc() when getc_unlocked() is not available on the target platform.
@@ -225,13 +230,93 @@ char* FILE_LINE_READER::ReadLine()
 }
 
 
-STRING_LINE_READER::STRING_LINE_READER( const std::string& aString, const wxString& aSource ):
+struct MAPPED_FILE_LINE_READER::MAPPING
+{
+    boost::interprocess::file_mapping   m_file;
+    boost::interprocess::mapped_region  m_region;
+};
+
+
+MAPPED_FILE_LINE_READER::MAPPED_FILE_LINE_READER( const wxString& aFileName,
+            unsigned aMaxLineLength ) :
+    LINE_READER( 0 ),       // no line buffer: lines are read in place
+    m_data( "" ),
+    m_size( 0 ),
+    m_ndx( 0 )
+{
+    m_maxLineLength = aMaxLineLength;
+    m_source = aFileName;
+
+    if( !wxFileName::FileExists( aFileName ) )
+    {
+        wxString msg = wxString::Format(
+            _( "Unable to open filename \"%s\" for reading" ), aFileName.GetData() );
+        THROW_IO_ERROR( msg );
+    }
+
+    // A zero length file cannot be mapped
+    if( wxFileName::GetSize( aFileName ) == 0 )
+        return;
+
+    try
+    {
+        using namespace boost::interprocess;
+
+        m_mapping.reset( new MAPPING );
+        m_mapping->m_file = file_mapping( aFileName.fn_str(), read_only );
+        m_mapping->m_region = mapped_region( m_mapping->m_file, read_only );
+        m_mapping->m_region.advise( mapped_region::advice_sequential );
+    }
+    catch( const boost::interprocess::interprocess_exception& e )
+    {
+        wxString msg = wxString::Format( _( "Unable to map file \"%s\" in memory: %s" ),
+                                         aFileName.GetData(), e.what() );
+        THROW_IO_ERROR( msg );
+    }
+
+    m_data = static_cast<const char*>( m_mapping->m_region.get_address() );
+    m_size = m_mapping->m_region.get_size();
+}
+
+
+MAPPED_FILE_LINE_READER::~MAPPED_FILE_LINE_READER()
+{
+    // m_line points into the mapped file, it must not be deleted by LINE_READER
+    m_line = NULL;
+}
+
+
+char* MAPPED_FILE_LINE_READER::ReadLine()
+{
+    const char* line = m_data + m_ndx;
+    const char* nl = static_cast<const char*>( memchr( line, '\n', m_size - m_ndx ) );
+
+    if( nl )
+        m_length = nl - line + 1;   // include the newline, so +1
+    else
+        m_length = m_size - m_ndx;
+
+    if( m_length >= m_maxLineLength )
+        THROW_IO_ERROR( _( "Line length exceeded" ) );
+
+    m_ndx += m_length;
+    m_line = const_cast<char*>( line );
+
+    ++m_lineNum;      // this gets incremented even if no bytes were read
+
+    return m_length ? m_line : NULL;
+}
+
+
+STRING_LINE_READER::STRING_LINE_READER( const std::string& aString, const wxString& aSource,
+                                        unsigned aStartingLineNumber ):
     LINE_READER( LINE_READER_LINE_DEFAULT_MAX ),
     m_lines( aString ), m_ndx( 0 )
 {
     // Clipboard text should be nice and _use multiple lines_ so that
     // we can report _line number_ oriented error messages when parsing.
-    m_source = aSource;
+    m_source  = aSource;
+    m_lineNum = aStartingLineNumber;
 }
 
 
@@ -409,13 +494,17 @@ int OUTPUTFORMATTER::Print( int nestLevel, const char* fmt, ... )
 
     va_start( args, fmt );
 
+    static const char spaces[] = "                                ";   // 32 spaces
+    const int         spaceCount = sizeof( spaces ) - 1;
+
     int result = 0;
     int total  = 0;
 
-    for( int i=0; i<nestLevel;  ++i )
+    // no error checking needed, an exception indicates an error.
+    for( int count = nestLevel * NESTWIDTH;  count > 0;  count -= spaceCount )
     {
-        // no error checking needed, an exception indicates an error.
-        result = sprint( "%*c", NESTWIDTH, ' ' );
+        result = std::min( count, spaceCount );
+        write( spaces, result );
 
         total += result;
     }
@@ -513,6 +602,10 @@ FILE_OUTPUTFORMATTER::FILE_OUTPUTFORMATTER( const wxString& aFileName, const wxC
 
     if( !m_fp )
         THROW_IO_ERROR( strerror( errno ) );
+
+    // Boards are written by many small writes: use a large buffer to write the
+    // file by large blocks
+    setvbuf( m_fp, NULL, _IOFBF, FILE_OUTPUTFMTBUFZ );
 }
 
 
@@ -24,6 +24,10 @@
 
 /* DLIST python iteration code, to allow standard iteration over DLIST */
 
+// The list index is a C++ speedup only
+%ignore DHEAD::ITEM_INDEX;
+%ignore DHEAD::GetIndex;
+
 %include <dlist.h>
 
 %{
@@ -78,6 +78,17 @@ public:
      */
     bool m_realTimeConnectivity;
 
+    /**
+     * Keep the zone fills of the saved boards in their zone fill cache, and restore the
+     * zone triangulations from it when reopening them.
+     */
+    bool m_restoreZoneFills;
+
+    /**
+     * Record the interactive router sessions next to the board file, to replay them.
+     */
+    bool m_recordRouterSessions;
+
     /**
      * Helper to determine if legacy canvas is allowed (according to platform
      * and config)
@@ -25,6 +25,8 @@
 #ifndef BASIC_GAL_H
 #define BASIC_GAL_H
 
+#include <mutex>
+
 #include <eda_rect.h>
 
 #include <gal/stroke_font.h>
@@ -167,4 +169,10 @@ private:
 
 extern BASIC_GAL basic_gal;
 
+/**
+ * basic_gal is shared by all the text functions: it must be locked while in use, because
+ * texts can be plotted or converted to polygons from several threads.
+ */
+extern std::recursive_mutex basic_gal_mutex;
+
 #endif      // define BASIC_GAL_H
@@ -0,0 +1,115 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * Class ARENA
+ *
+ * Allocates objects of type T by blocks of BLOCK_SIZE, and destroys them all at once
+ * with the arena.  Meant for the many small short-lived objects built by an algorithm,
+ * that would otherwise each cost a heap allocation and a free.
+ *
+ * Objects cannot be released one by one, and the arena is not thread safe: each task
+ * uses its own.
+ */
+template <class T, size_t BLOCK_SIZE = 1024>
+class ARENA
+{
+public:
+    ARENA() :
+        m_used( BLOCK_SIZE )
+    {
+    }
+
+    ~ARENA()
+    {
+        Clear();
+    }
+
+    /**
+     * Function Create()
+     * Builds a new object from aArgs in the arena.
+     * @return the new object, owned by the arena.
+     */
+    template <class... ARGS>
+    T* Create( ARGS&&... aArgs )
+    {
+        if( m_used == BLOCK_SIZE )
+        {
+            m_blocks.emplace_back( new STORAGE[BLOCK_SIZE] );
+            m_used = 0;
+        }
+
+        T* item = new( &m_blocks.back()[m_used] ) T( std::forward<ARGS>( aArgs )... );
+        m_used++;
+
+        return item;
+    }
+
+    /**
+     * Function Clear()
+     * Destroys all the objects of the arena and frees its memory.
+     */
+    void Clear()
+    {
+        for( size_t block = 0; block < m_blocks.size(); block++ )
+        {
+            size_t count = ( block + 1 == m_blocks.size() ) ? m_used : BLOCK_SIZE;
+
+            for( size_t ii = 0; ii < count; ii++ )
+                reinterpret_cast<T*>( &m_blocks[block][ii] )->~T();
+        }
+
+        m_blocks.clear();
+        m_used = BLOCK_SIZE;
+    }
+
+    ///> Returns the number of objects in the arena
+    size_t Size() const
+    {
+        return m_blocks.empty() ? 0 : ( m_blocks.size() - 1 ) * BLOCK_SIZE + m_used;
+    }
+
+private:
+    // Copy is not allowed: objects are owned by this arena
+    ARENA( const ARENA& ) = delete;
+    ARENA& operator=( const ARENA& ) = delete;
+
+    typedef typename std::aligned_storage<sizeof( T ), alignof( T )>::type STORAGE;
+
+    std::vector<std::unique_ptr<STORAGE[]>> m_blocks;
+
+    ///> Number of objects built in the last block
+    size_t m_used;
+};
+
+#endif // ARENA_H
@@ -27,34 +27,78 @@
 #include <dlist.h>
 #include <iterator>
 
+/**
+ * Class DLIST_ITERATOR
+ * walks a DLIST using its contiguous index (see DHEAD::GetIndex()), or the Next() pointers
+ * of the elements if the list has no index.  If the list is modified during the walk, the
+ * iterator falls back to the Next() pointers, so that it behaves as a plain linked list walk.
+ */
 template <class T>
 class DLIST_ITERATOR : public std::iterator<std::bidirectional_iterator_tag, T>
 {
 private:
     T m_obj;
+    const DHEAD* m_list;
+    std::shared_ptr<const DHEAD::ITEM_INDEX> m_index;
+    size_t m_pos;
 
     using reference = typename DLIST_ITERATOR<T>::reference;
 
+    bool indexValid() const
+    {
+        return m_index && m_index->m_generation == m_list->GetGeneration();
+    }
+
 public:
     explicit DLIST_ITERATOR<T>( T obj ) :
-        m_obj(obj) {}
+        m_obj( obj ), m_list( nullptr ), m_pos( 0 ) {}
+
+    DLIST_ITERATOR<T>( const DHEAD& aList, std::shared_ptr<const DHEAD::ITEM_INDEX> aIndex ) :
+        m_obj( nullptr ), m_list( &aList ), m_index( aIndex ), m_pos( 0 )
+    {
+        if( !m_index->m_items.empty() )
+            m_obj = static_cast<T>( m_index->m_items[0] );
+    }
 
     DLIST_ITERATOR<T>& operator++()
     {
-        m_obj = m_obj->Next(); return *this;
+        if( indexValid() )
+        {
+            ++m_pos;
+            m_obj = m_pos < m_index->m_items.size() ?
+                    static_cast<T>( m_index->m_items[m_pos] ) : nullptr;
+        }
+        else
+        {
+            m_index.reset();
+            m_obj = m_obj->Next();
+        }
+
+        return *this;
     }
 
     DLIST_ITERATOR<T>& operator--()
     {
-        m_obj = m_obj->Prev(); return *this;
+        if( indexValid() && m_pos > 0 )
+        {
+            --m_pos;
+            m_obj = static_cast<T>( m_index->m_items[m_pos] );
+        }
+        else
+        {
+            m_index.reset();
+            m_obj = m_obj->Prev();
+        }
+
+        return *this;
     }
 
-    bool operator==( DLIST_ITERATOR<T> other ) const
+    bool operator==( const DLIST_ITERATOR<T>& other ) const
     {
         return m_obj == other.m_obj;
     }
 
-    bool operator!=( DLIST_ITERATOR<T> other ) const
+    bool operator!=( const DLIST_ITERATOR<T>& other ) const
     {
         return !(*this == other);
     }
@@ -70,15 +114,20 @@ template <class T>
 class DLIST_ITERATOR_WRAPPER
 {
 public:
-    explicit DLIST_ITERATOR_WRAPPER<T> ( DLIST<T>& list ) :
+    explicit DLIST_ITERATOR_WRAPPER<T> ( const DLIST<T>& list ) :
         m_list(list) {}
 
-    DLIST_ITERATOR<T*> begin()
+    DLIST_ITERATOR<T*> begin() const
     {
-        return DLIST_ITERATOR<T*> ( m_list.GetFirst() );
+        auto index = m_list.GetIndex();
+
+        if( !index )
+            return DLIST_ITERATOR<T*> ( m_list.GetFirst() );
+
+        return DLIST_ITERATOR<T*> ( m_list, index );
     }
 
-    DLIST_ITERATOR<T*> end()
+    DLIST_ITERATOR<T*> end() const
     {
         return DLIST_ITERATOR<T*> ( nullptr );
     }
@@ -89,7 +138,7 @@ public:
     }
 
 private:
-    DLIST<T>& m_list;
+    const DLIST<T>& m_list;
 };
 
 #endif
@@ -28,6 +28,8 @@
 
 
 #include <stdio.h>          // NULL definition.
+#include <memory>
+#include <vector>
 
 
 class EDA_ITEM;
@@ -39,11 +41,30 @@ class EDA_ITEM;
  */
 class DHEAD
 {
+public:
+    /**
+     * Struct ITEM_INDEX
+     * is a contiguous copy of the list sequence, valid as long as the list generation
+     * is m_generation.
+     */
+    struct ITEM_INDEX
+    {
+        unsigned               m_generation;
+        std::vector<EDA_ITEM*> m_items;
+    };
+
 protected:
     EDA_ITEM*     first;          ///< first element in list, or NULL if list empty
     EDA_ITEM*     last;           ///< last elment in list, or NULL if empty
     unsigned      count;          ///< how many elements are in the list, automatically maintained.
     bool          meOwner;        ///< I must delete the objects I hold in my destructor
+    unsigned      generation;     ///< incremented each time the list sequence changes
+
+    ///> the index of the list sequence, built on demand by GetIndex()
+    mutable std::shared_ptr<const ITEM_INDEX> itemIndex;
+
+    ///> the generation of the last walk which did not use an index
+    mutable unsigned  unindexedWalkGeneration;
 
     /**
      * Constructor DHEAD
@@ -54,7 +75,9 @@ protected:
         first(0),
         last(0),
         count(0),
-        meOwner(true)
+        meOwner(true),
+        generation(0),
+        unindexedWalkGeneration( (unsigned) -1 )
     {
     }
 
@@ -125,6 +148,28 @@ public:
      */
     unsigned GetCount() const { return count; }
 
+    /**
+     * Function GetGeneration
+     * returns a number which changes each time an element is added to or removed from
+     * the list.
+     */
+    unsigned GetGeneration() const { return generation; }
+
+    /**
+     * Function GetIndex
+     * returns a contiguous copy of the list sequence, so that the list can be walked
+     * without chasing the Next() pointers of its elements.
+     * Building the index costs about as much as a walk, so it is built only for lists of
+     * at least INDEX_MIN_COUNT elements, and only on the second walk after a change: a list
+     * modified between each walk never gets an index.
+     * It can be called from several threads, as long as the list is not modified meanwhile.
+     * @return the index, or nullptr if the list must be walked through Next()
+     */
+    std::shared_ptr<const ITEM_INDEX> GetIndex() const;
+
+    ///> the minimal element count of an indexed list
+    static const unsigned INDEX_MIN_COUNT = 128;
+
 #if defined(DEBUG)
     void VerifyListIntegrity();
 #endif
@@ -107,6 +107,9 @@ protected:
 
     int                 curTok;                 ///< the current token obtained on last NextTok()
     std::string         curText;                ///< the text of the current token
+    double              curNumber;              ///< the value of the current DSN_NUMBER token
+    bool                curNumberValid;         ///< true if curNumber holds the current token value
+    std::string         curLine;                ///< a nul terminated copy of the current line
 
     const KEYWORD*      keywords;               ///< table sorted by CMake for bsearch()
     unsigned            keywordCount;           ///< count of keywords table
@@ -284,6 +287,21 @@ public:
      */
     int NextTok();
 
+    /**
+     * Function ReadListText
+     * copies the text of the current list up to and including its closing right
+     * parenthesis, without tokenizing it, so it can be handed to another lexer.
+     * The current token must be the first one of the list.  The lines are copied
+     * whole, to keep the line structure for error reporting: the part of the first line
+     * before the current token is blanked, except for the opening parenthesis, and the
+     * rest of the last line after the closing parenthesis is left to this lexer.
+     * Quoted strings are recognized as in non-specctraMode.
+     *
+     * @param aText receives the text of the list.
+     * @throw PARSE_ERROR if the input ends before the list is closed.
+     */
+    void ReadListText( std::string& aText );
+
     /**
      * Function NeedSYMBOL
      * calls NextTok() and then verifies that the token read in
@@ -490,6 +508,24 @@ public:
         return curText;
     }
 
+    /**
+     * Function CurNumber
+     * gives the value of the current DSN_NUMBER token, when it could be converted
+     * exactly while reading it.
+     *
+     * @param aValue is set to the value of the current token.
+     * @return bool - true if @a aValue was set, false if the caller must convert CurText()
+     *         itself.
+     */
+    bool CurNumber( double& aValue ) const
+    {
+        if( curTok != DSN_NUMBER || !curNumberValid )
+            return false;
+
+        aValue = curNumber;
+        return true;
+    }
+
     /**
      * Function FromUTF8
      * returns the current token text as a wxString, assuming that the input
@@ -512,11 +548,13 @@ public:
     /**
      * Function CurLine
      * returns the current line of text, from which the CurText() would return
-     * its token.
+     * its token.  The line given by the reader is not always nul terminated
+     * (see MAPPED_FILE_LINE_READER), so a copy of it is returned.
      */
     const char* CurLine()
     {
-        return (const char*)(*reader);
+        curLine.assign( reader->Line(), reader->Length() );
+        return curLine.c_str();
     }
 
     /**
@@ -0,0 +1,104 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef __POLY_SCANLINE_INDEX_H
+#define __POLY_SCANLINE_INDEX_H
+
+#include <vector>
+
+#include <math/box2.h>
+#include <geometry/seg.h>
+#include <geometry/shape_line_chain.h>
+
+/**
+ * Class POLY_SCANLINE_INDEX
+ *
+ * Speeds up the point inside/on edge and distance queries on a line chain by splitting
+ * its bounding box into horizontal rows, each one holding the edges crossing it.
+ * A query only visits the edges of the rows it overlaps, so for the usual polygons
+ * its cost depends on the number of edges crossed by a horizontal line, not on the
+ * number of vertices.
+ *
+ * The results are exactly the ones of the SHAPE_LINE_CHAIN methods of the same name.
+ * The index refers to the line chain it was built from, which must not be modified
+ * or moved during the index lifetime.
+ */
+class POLY_SCANLINE_INDEX
+{
+public:
+    POLY_SCANLINE_INDEX( const SHAPE_LINE_CHAIN& aPath );
+
+    ///> Same as SHAPE_LINE_CHAIN::PointInside( aP )
+    bool PointInside( const VECTOR2I& aP ) const;
+
+    ///> Same as SHAPE_LINE_CHAIN::PointOnEdge( aP )
+    bool PointOnEdge( const VECTOR2I& aP ) const;
+
+    /**
+     * Function Distance()
+     * @return the minimum distance between aP and the edges of the chain, whether aP is
+     * inside of the chain or not.
+     */
+    int Distance( const VECTOR2I& aP ) const;
+
+    /**
+     * Function Distance()
+     * @return the minimum distance between aSeg and the edges of the chain, whether aSeg is
+     * inside of the chain or not.
+     */
+    int Distance( const SEG& aSeg ) const;
+
+    const BOX2I& BBox() const
+    {
+        return m_bbox;
+    }
+
+private:
+    ///> Returns the row holding the line at height aY, clamped to the existing rows
+    int rowOf( int aY ) const;
+
+    ///> Returns the distance between the row aRow and the height range [aMin, aMax]
+    SEG::ecoord rowGap( int aRow, int aMin, int aMax ) const;
+
+    /**
+     * Visits the rows by increasing distance to the height range [aMin, aMax], and calls
+     * aFunc( edge index, best distance so far ) for each of their edges, until the next
+     * row is farther than the best distance returned by aFunc.
+     * @return the smallest value returned by aFunc
+     */
+    template <class FUNC>
+    int visitByDistance( int aMin, int aMax, FUNC aFunc ) const;
+
+    const SHAPE_LINE_CHAIN* m_path;
+    BOX2I                   m_bbox;
+    int                     m_edgeCount;
+    int                     m_y0;
+    SEG::ecoord             m_rowHeight;
+    int                     m_rowCount;
+
+    ///> Edges of the row r are m_rowEdges[m_rowStart[r]] to m_rowEdges[m_rowStart[r+1]-1]
+    std::vector<int>        m_rowStart;
+    std::vector<int>        m_rowEdges;
+};
+
+#endif
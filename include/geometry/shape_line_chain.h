@@ -85,6 +85,18 @@ public:
         SHAPE( SH_LINE_CHAIN ), m_points( aShape.m_points ), m_closed( aShape.m_closed )
     {}
 
+    /**
+     * Move Constructor
+     * Takes the vertices of aShape without copying them.
+     */
+    SHAPE_LINE_CHAIN( SHAPE_LINE_CHAIN&& aShape ) noexcept :
+        SHAPE( SH_LINE_CHAIN ), m_points( std::move( aShape.m_points ) ),
+        m_closed( aShape.m_closed )
+    {}
+
+    SHAPE_LINE_CHAIN& operator=( const SHAPE_LINE_CHAIN& aShape ) = default;
+    SHAPE_LINE_CHAIN& operator=( SHAPE_LINE_CHAIN&& aShape ) = default;
+
     /**
      * Constructor
      * Initializes a 2-point line chain (a single segment)
@@ -152,6 +164,15 @@ public:
         m_closed = false;
     }
 
+    /**
+     * Function Reserve()
+     * Allocates room for aCount points, to append them without reallocation.
+     */
+    void Reserve( int aCount )
+    {
+        m_points.reserve( aCount );
+    }
+
     /**
      * Function SetClosed()
      *
@@ -613,6 +634,12 @@ public:
      */
     ClipperLib::Path convertToClipper( bool aRequiredOrientation ) const;
 
+    /**
+     * Converts the SHAPE_LINE_CHAIN to a Clipper path in a given orientation, reusing
+     * the storage of aPath
+     */
+    void convertToClipper( bool aRequiredOrientation, ClipperLib::Path& aPath ) const;
+
     /**
      * Function NearestPoint()
      *
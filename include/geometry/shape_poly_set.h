@@ -29,6 +29,7 @@
 #include <vector>
 #include <cstdio>
 #include <memory>
+#include <atomic>
 #include <geometry/shape.h>
 #include <geometry/shape_line_chain.h>
 
@@ -49,7 +50,13 @@
  *      outline or a hole.
  *      - Vertex (or corner): each one of the points that define a contour.
  *
- * TODO: add convex partitioning & spatial index
+ * The point containment, distance and collision queries use a spatial index of the
+ * contours, built on demand once a large set has been queried several times, and dropped
+ * by the non-const methods which can change the contours.  A contour modified through a reference obtained before the
+ * index was built (by Outline(), Polygon(), an ITERATOR...) leaves the index out of date:
+ * call InvalidateSpatialIndex() after such a change.
+ *
+ * TODO: add convex partitioning
  */
 class SHAPE_POLY_SET : public SHAPE
 {
@@ -100,6 +107,16 @@ class SHAPE_POLY_SET : public SHAPE
                 m_vertices.push_back( aP );
             }
 
+            const TRI& GetTriangleIndices( int index ) const
+            {
+                return m_triangles[ index ];
+            }
+
+            const VECTOR2I& GetVertex( int index ) const
+            {
+                return m_vertices[ index ];
+            }
+
             size_t GetTriangleCount() const
             {
                 return m_triangles.size();
@@ -226,7 +243,7 @@ class SHAPE_POLY_SET : public SHAPE
 
             T& Get()
             {
-                return m_poly->Polygon( m_currentPolygon )[m_currentContour].Point( m_currentVertex );
+                return m_poly->m_polys[m_currentPolygon][m_currentContour].Point( m_currentVertex );
             }
 
             T& operator*()
@@ -348,7 +365,7 @@ class SHAPE_POLY_SET : public SHAPE
 
             T Get()
             {
-                return m_poly->Polygon( m_currentPolygon )[m_currentContour].Segment( m_currentSegment );
+                return m_poly->m_polys[m_currentPolygon][m_currentContour].Segment( m_currentSegment );
             }
 
             T operator*()
@@ -574,6 +591,7 @@ class SHAPE_POLY_SET : public SHAPE
         ///> Returns the reference to aIndex-th outline in the set
         SHAPE_LINE_CHAIN& Outline( int aIndex )
         {
+            InvalidateSpatialIndex();
             return m_polys[aIndex][0];
         }
 
@@ -596,12 +614,14 @@ class SHAPE_POLY_SET : public SHAPE
         ///> Returns the reference to aHole-th hole in the aIndex-th outline
         SHAPE_LINE_CHAIN& Hole( int aOutline, int aHole )
         {
+            InvalidateSpatialIndex();
             return m_polys[aOutline][aHole + 1];
         }
 
         ///> Returns the aIndex-th subpolygon in the set
         POLYGON& Polygon( int aIndex )
         {
+            InvalidateSpatialIndex();
             return m_polys[aIndex];
         }
 
@@ -644,6 +664,8 @@ class SHAPE_POLY_SET : public SHAPE
         {
             ITERATOR iter;
 
+            InvalidateSpatialIndex();
+
             iter.m_poly = this;
             iter.m_currentPolygon = aFirst;
             iter.m_lastPolygon = aLast < 0 ? OutlineCount() - 1 : aLast;
@@ -756,6 +778,7 @@ class SHAPE_POLY_SET : public SHAPE
         {
             SEGMENT_ITERATOR iter;
 
+            // The segments are returned by value: iterating over them keeps the spatial index
             iter.m_poly = this;
             iter.m_currentPolygon = aFirst;
             iter.m_lastPolygon = aLast < 0 ? OutlineCount() - 1 : aLast;
@@ -1116,6 +1139,9 @@ class SHAPE_POLY_SET : public SHAPE
 
     private:
 
+        ///> The per contour indexes of the set, defined in shape_poly_set.cpp
+        struct SPATIAL_INDEX;
+
         SHAPE_LINE_CHAIN& getContourForCorner( int aCornerId, int& aIndexWithinContour );
         VECTOR2I& vertex( int aCornerId );
         const VECTOR2I& cvertex( int aCornerId ) const;
@@ -1159,6 +1185,9 @@ class SHAPE_POLY_SET : public SHAPE
          */
         bool containsSingle( const VECTOR2I& aP, int aSubpolyIndex, bool aIgnoreHoles = false ) const;
 
+        bool containsSingle( const VECTOR2I& aP, int aSubpolyIndex, bool aIgnoreHoles,
+                             const SPATIAL_INDEX* aIndex ) const;
+
         /**
          * Operations ChamferPolygon and FilletPolygon are computed under the private chamferFillet
          * method; this enum is defined to make the necessary distinction when calling this method
@@ -1200,19 +1229,77 @@ class SHAPE_POLY_SET : public SHAPE
 
         SHAPE_POLY_SET& operator=( const SHAPE_POLY_SET& );
 
-        void CacheTriangulation();
+        /**
+         * Builds the spatial index used by Contains(), Collide() and Distance() now,
+         * whatever the size of the set.  It is otherwise built by the queries themselves,
+         * for the large sets only.
+         */
+        void CacheSpatialIndex();
+
+        ///> Returns true if the spatial index is built
+        bool IsSpatialIndexValid() const
+        {
+            return m_spatialIndex.load() != nullptr;
+        }
+
+        /**
+         * Drops the spatial index.  Called by all non-const methods, it must be called
+         * explicitly only after modifying the set through a reference kept from before
+         * the index was built.
+         */
+        void InvalidateSpatialIndex()
+        {
+            if( m_spatialIndex.load( std::memory_order_relaxed ) )
+                freeSpatialIndex();
+
+            m_spatialIndexQueries.store( 0, std::memory_order_relaxed );
+        }
+
+        /**
+         * Function CacheTriangulation
+         * Triangulates the polygons of the set, if they changed since the last call.
+         * The outlines are triangulated independently: when the set is large enough, they
+         * are shared between several threads.
+         * @param aMaxThreads is the maximum number of threads to use, 0 for as many as the
+         *                    hardware supports, 1 to run in the calling thread only.
+         */
+        void CacheTriangulation( size_t aMaxThreads = 0 );
         bool IsTriangulationUpToDate() const;
 
+        /**
+         * Sets the triangulation of the polygon set, as built by CacheTriangulation() for
+         * the same outlines (for instance, restored from a cache file).
+         */
+        void SetTriangulation( const std::vector<TRIANGULATED_POLYGON>& aTriangulation );
+
         MD5_HASH GetHash() const;
 
     private:
 
+        ///> Returns the spatial index, after building it if the set is worth it, or nullptr
+        const SPATIAL_INDEX* spatialIndex() const;
+
+        const SPATIAL_INDEX* buildSpatialIndex() const;
+
+        void freeSpatialIndex();
+
+        ///> Returns the distance between aP and the edges of the aPolygonIndex-th polygon
+        int edgeDistance( const VECTOR2I& aP, int aPolygonIndex,
+                          const SPATIAL_INDEX* aIndex ) const;
+
+        ///> Returns the distance between aSeg and the edges of the aPolygonIndex-th polygon
+        int edgeDistance( const SEG& aSeg, int aPolygonIndex, const SPATIAL_INDEX* aIndex ) const;
+
         MD5_HASH checksum() const;
 
         std::vector<std::unique_ptr<TRIANGULATED_POLYGON>> m_triangulatedPolys;
         bool m_triangulationValid = false;
         MD5_HASH m_hash;
 
+        // Built concurrently by the const queries: the first one stored wins
+        mutable std::atomic<const SPATIAL_INDEX*> m_spatialIndex;
+        mutable std::atomic<int> m_spatialIndexQueries;
+
 };
 
 #endif
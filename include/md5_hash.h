@@ -35,6 +35,14 @@ public:
      */
     std::string Format();
 
+    /** @return the 16 bytes of the digest, meaningful once the hash is finalized
+     */
+    const uint8_t* GetDigest() const { return m_hash; }
+
+    /** Sets the 16 bytes of the digest of a finalized hash, for instance read from a file
+     */
+    void SetDigest( const uint8_t* aDigest );
+
 private:
     struct MD5_CTX {
        uint8_t data[64];
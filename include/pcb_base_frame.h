@@ -60,6 +60,21 @@ class PCB_PLOT_PARAMS;
 class FP_LIB_TABLE;
 class PCB_GENERAL_SETTINGS ;
 
+/**
+ * A board item removed by a commit, as reported to PCB_BASE_FRAME::OnBoardItemsChanged().
+ * It is captured while the item is still valid: the item may be deleted afterwards, so
+ * the pointers must only be used for comparisons.
+ */
+struct REMOVED_BOARD_ITEM
+{
+    REMOVED_BOARD_ITEM( const BOARD_ITEM* aItem );
+
+    const BOARD_ITEM*              m_item;
+    KICAD_T                        m_type;
+    const BOARD_ITEM*              m_module;    ///< the module of a module item
+    std::vector<const BOARD_ITEM*> m_children;  ///< the pads and graphic items of a module
+};
+
 /**
  * class PCB_BASE_FRAME
  * basic PCB main window class for Pcbnew, Gerbview, and CvPcb footprint viewer.
@@ -314,6 +329,21 @@ public:
      */
     virtual void OnModify();
 
+    /**
+     * Function OnBoardItemsChanged
+     * Virtual
+     * Called by BOARD_COMMIT::Push() once the changes of a commit are applied to the board,
+     * before OnModify().
+     * Also called after an undo or a redo, with the items it restored.
+     * @param aChangedItems are the items added or modified by the commit
+     * @param aRemovedItems are the items removed by the commit, captured before their
+     * removal.
+     * @param aModified is true if OnModify() is called next for these changes
+     */
+    virtual void OnBoardItemsChanged( const std::vector<BOARD_ITEM*>& aChangedItems,
+                                      const std::vector<REMOVED_BOARD_ITEM>& aRemovedItems,
+                                      bool aModified ) {}
+
     // Modules (footprints)
 
     /**
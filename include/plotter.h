@@ -33,6 +33,7 @@
 #define PLOT_COMMON_H_
 
 #include <vector>
+#include <unordered_map>
 #include <math/box2.h>
 #include <draw_graphic_text.h>
 #include <page_info.h>
@@ -1213,6 +1214,27 @@ protected:
     std::vector<APERTURE>::iterator getAperture( const wxSize& aSize,
                     APERTURE::APERTURE_TYPE aType, int aApertureAttribute );
 
+    /**
+     * The key of the aperture index: the size, type and attribute of an aperture
+     */
+    struct APERTURE_KEY
+    {
+        wxSize                  m_Size;
+        APERTURE::APERTURE_TYPE m_Type;
+        int                     m_ApertureAttribute;
+
+        bool operator==( const APERTURE_KEY& aOther ) const
+        {
+            return m_Type == aOther.m_Type && m_Size == aOther.m_Size
+                   && m_ApertureAttribute == aOther.m_ApertureAttribute;
+        }
+    };
+
+    struct APERTURE_KEY_HASH
+    {
+        size_t operator()( const APERTURE_KEY& aKey ) const;
+    };
+
     // the attributes dictionnary created/modifed by %TO, attached the objects, when they are created
     // by D01, D03 G36/G37 commands
     // standard attributes are .P, .C and .N
@@ -1237,6 +1259,9 @@ protected:
     std::vector<APERTURE>           apertures;
     std::vector<APERTURE>::iterator currentAperture;
 
+    /// The position of each aperture in apertures, to find an aperture without a linear search
+    std::unordered_map<APERTURE_KEY, int, APERTURE_KEY_HASH> m_apertureIndex;
+
     bool     m_gerberUnitInch;  // true if the gerber units are inches, false for mm
     int      m_gerberUnitFmt;   // number of digits in mantissa.
                                 // usually 6 in Inches and 5 or 6  in mm
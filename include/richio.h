@@ -29,6 +29,7 @@
 // "richio" after its author, Richard Hollenbeck, aka Dick Hollenbeck.
 
 
+#include <memory>
 #include <vector>
 #include <utf8.h>
 
@@ -247,6 +248,42 @@ public:
 };
 
 
+/**
+ * Class MAPPED_FILE_LINE_READER
+ * is a LINE_READER that maps a whole file in memory and returns its lines without
+ * copying them.  Line() points into the mapped file and the line is <b>not</b> nul
+ * terminated: this reader can only be given to clients relying on Length(), like DSNLEXER.
+ */
+class MAPPED_FILE_LINE_READER : public LINE_READER
+{
+protected:
+    struct MAPPING;
+
+    std::unique_ptr<MAPPING> m_mapping;    ///< the mapped file, none if the file is empty
+    const char*     m_data;                ///< start of the mapped file
+    size_t          m_size;                ///< size of the mapped file
+    size_t          m_ndx;                 ///< offset of the next line
+
+public:
+
+    /**
+     * Constructor MAPPED_FILE_LINE_READER
+     * opens @a aFileName and maps it in memory.
+     *
+     * @param aFileName is the name of the file to map and to use for error reporting purposes.
+     * @param aMaxLineLength is the maximum length of a line.
+     *
+     * @throw IO_ERROR if @a aFileName cannot be opened or mapped.
+     */
+    MAPPED_FILE_LINE_READER( const wxString& aFileName,
+            unsigned aMaxLineLength = LINE_READER_LINE_DEFAULT_MAX );
+
+    ~MAPPED_FILE_LINE_READER();
+
+    char* ReadLine() override;
+};
+
+
 /**
  * Class STRING_LINE_READER
  * is a LINE_READER that reads from a multiline 8 bit wide std::string
@@ -268,8 +305,12 @@ public:
      *
      * @param aSource describes the source of aString for error reporting purposes
      *  can be anything meaninful, such as wxT( "clipboard" ).
+     *
+     * @param aStartingLineNumber is the initial line number to report on error, and is
+     *  accessible here for the case where aString is a part of a larger text.
      */
-    STRING_LINE_READER( const std::string& aString, const wxString& aSource );
+    STRING_LINE_READER( const std::string& aString, const wxString& aSource,
+                        unsigned aStartingLineNumber = 0 );
 
     /**
      * Constructor STRING_LINE_READER( const STRING_LINE_READER& )
@@ -307,6 +348,7 @@ public:
 
 
 #define OUTPUTFMTBUFZ    500        ///< default buffer size for any OUTPUT_FORMATTER
+#define FILE_OUTPUTFMTBUFZ  ( 1 << 20 ) ///< size of the file buffer of a FILE_OUTPUTFORMATTER
 
 /**
  * Class OUTPUTFORMATTER
@@ -396,6 +438,20 @@ public:
      */
     int PRINTF_FUNC Print( int nestLevel, const char* fmt, ... );
 
+    /**
+     * Function Write
+     * writes text which was formatted beforehand, for instance by a STRING_FORMATTER,
+     * to the output stream as is.
+     *
+     * @param aText is the text to output.
+     * @throw IO_ERROR, if there is a problem outputting, such as a full disk.
+     */
+    void Write( const std::string& aText )
+    {
+        if( !aText.empty() )
+            write( aText.data(), (int) aText.size() );
+    }
+
     /**
      * Function GetQuoteChar
      * performs quote character need determination.
@@ -71,6 +71,7 @@ namespace hed
 // Helper typedefs
 class NODE;
 class EDGE;
+class TRIANGULATION;
 typedef std::shared_ptr<NODE> NODE_PTR;
 typedef std::shared_ptr<EDGE> EDGE_PTR;
 typedef std::weak_ptr<EDGE> EDGE_WEAK_PTR;
@@ -270,6 +271,11 @@ protected:
     EDGE_WEAK_PTR   m_twinEdge;
     EDGE_PTR        m_nextEdgeInFace;
     bool            m_isLeadingEdge;
+
+    /// Position of a leading edge in the list of its triangulation, for a constant time removal
+    std::list<EDGE_PTR>::iterator m_leadingEdgeIt;
+
+    friend class TRIANGULATION;
 };
 
 class DART; // Forward declaration (class in this namespace)
@@ -290,6 +296,7 @@ protected:
     {
         aEdge->SetAsLeadingEdge();
         m_leadingEdges.push_front( aEdge );
+        aEdge->m_leadingEdgeIt = m_leadingEdges.begin();
     }
 
     bool removeLeadingEdgeFromList( EDGE_PTR& aLeadingEdge );
@@ -365,6 +372,24 @@ public:
     EDGE_PTR InitTwoEnclosingTriangles( NODES_CONTAINER::iterator aFirst,
                                         NODES_CONTAINER::iterator aLast );
 
+    /// Creates an initial Delaunay triangulation from two triangles forming the given rectangle
+    EDGE_PTR InitTwoEnclosingTriangles( int aXmin, int aYmin, int aXmax, int aYmax );
+
+    /// Creates a Delaunay triangulation from a set of points, keeping the rectangular
+    /// boundary (aXmin, aYmin) - (aXmax, aYmax) so nodes can be inserted and removed later.
+    /// All the points must lie strictly inside the boundary.
+    void CreateDelaunay( NODES_CONTAINER::iterator aFirst, NODES_CONTAINER::iterator aLast,
+                         int aXmin, int aYmin, int aXmax, int aYmax );
+
+    /// Inserts a node in a triangulation created with a rectangular boundary.
+    /// The node must lie strictly inside the boundary and must not coincide with another node.
+    /// @return false if no triangle containing the node was found
+    bool InsertNode( const NODE_PTR& aNode );
+
+    /// Removes an interior node from a triangulation and updates it to be Delaunay.
+    /// @return false if the node was not found, or lies on the boundary
+    bool RemoveNode( const NODE_PTR& aNode );
+
     // These two functions are required by TTL for Delaunay triangulation
 
     /// Swaps the edge associated with diagonal
@@ -25,6 +25,11 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
 
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <thread>
+
 #include <fctsys.h>
 #include <class_drawpanel.h>
 #include <confirm.h>
@@ -57,6 +62,13 @@
 
 #define STEP_AR_MM 1.0
 
+// The placement grids having at least AR_COARSE_MIN_POSITIONS positions are searched
+// coarse to fine: every AR_COARSE_STEP positions first, then in full only around the
+// AR_COARSE_KEEP best coarse positions.
+#define AR_COARSE_MIN_POSITIONS 4096
+#define AR_COARSE_STEP          4
+#define AR_COARSE_KEEP          8
+
 /* Penalty (cost) for CntRot90 and CntRot180:
  * CntRot90 and CntRot180 are from 0 (rotation allowed) to 10 (rotation not allowed)
  */
@@ -561,9 +573,10 @@ unsigned int AR_AUTOPLACER::calculateKeepOutArea( const EDA_RECT& aRect, int sid
 
 /* Test if the module can be placed on the board.
  * Returns the value TstRectangle().
- * Module is known by its bounding box
+ * Module is known by its bounding box aFpBBox, at the module position
  */
-int AR_AUTOPLACER::testModuleOnBoard( MODULE* aModule, bool TstOtherSide, const wxPoint& aOffset )
+int AR_AUTOPLACER::testModuleOnBoard( MODULE* aModule, const EDA_RECT& aFpBBox,
+                                      bool TstOtherSide, const wxPoint& aOffset )
 {
     int side = AR_SIDE_TOP;
     int otherside = AR_SIDE_BOTTOM;
@@ -573,14 +586,12 @@ int AR_AUTOPLACER::testModuleOnBoard( MODULE* aModule, bool TstOtherSide, const
         side = AR_SIDE_BOTTOM; otherside = AR_SIDE_TOP;
     }
 
-    EDA_RECT    fpBBox = aModule->GetFootprintRect();
+    EDA_RECT    fpBBox = aFpBBox;
     fpBBox.Move( -aOffset );
 
-    buildFpAreas( aModule, 0 );
-
     int diag = //testModuleByPolygon( aModule, side, aOffset );
         testRectangle( fpBBox, side );
-//printf("test %p diag %d\n", aModule, diag);fflush(0);
+
     if( diag != AR_FREE_CELL )
         return diag;
 
@@ -600,20 +611,220 @@ int AR_AUTOPLACER::testModuleOnBoard( MODULE* aModule, bool TstOtherSide, const
 }
 
 
+AR_PLACEMENT_SCANNER::AR_PLACEMENT_SCANNER( int aCols, int aRows, COST_FUNCTION aCost,
+                                            size_t aMaxThreads ) :
+    m_cols( aCols ),
+    m_rows( aRows ),
+    m_cost( std::move( aCost ) ),
+    m_maxThreads( aMaxThreads ),
+    m_scanCount( 0 ),
+    m_busyWorkers( 0 ),
+    m_quit( false ),
+    m_nextColumn( 0 ),
+    m_keep( 1 )
+{
+}
+
+
+bool AR_PLACEMENT_SCANNER::FindBest( CANDIDATE& aBest )
+{
+    if( m_cols <= 0 || m_rows <= 0 )
+        return false;
+
+    m_quit = false;
+
+    size_t parallelThreadCount = m_maxThreads;
+
+    if( parallelThreadCount == 0 )
+        parallelThreadCount = std::max<size_t>( std::thread::hardware_concurrency(), 1 );
+
+    parallelThreadCount = std::min<size_t>( parallelThreadCount, m_cols );
+
+    // The calling thread scans too, alongside the workers
+    std::vector<std::future<void>> workers( parallelThreadCount - 1 );
+
+    for( auto& worker : workers )
+        worker = std::async( std::launch::async, [this]() { workerLoop(); } );
+
+    const WINDOW fullGrid = { 0, m_cols - 1, 0, m_rows - 1, 1 };
+
+    // Large grids are first searched every AR_COARSE_STEP positions.  Then only the
+    // positions around the AR_COARSE_KEEP best coarse positions are searched in full.
+    if( (int64_t) m_cols * m_rows >= AR_COARSE_MIN_POSITIONS )
+    {
+        scan( { { 0, m_cols - 1, 0, m_rows - 1, AR_COARSE_STEP } }, AR_COARSE_KEEP );
+
+        std::vector<WINDOW> windows;
+
+        for( const CANDIDATE& candidate : m_best )
+        {
+            windows.push_back( { std::max( 0, candidate.m_col - AR_COARSE_STEP + 1 ),
+                                 std::min( m_cols - 1, candidate.m_col + AR_COARSE_STEP - 1 ),
+                                 std::max( 0, candidate.m_row - AR_COARSE_STEP + 1 ),
+                                 std::min( m_rows - 1, candidate.m_row + AR_COARSE_STEP - 1 ),
+                                 1 } );
+        }
+
+        if( !windows.empty() )
+            scan( windows, 1 );
+    }
+
+    // Small grids, and the grids where the coarse positions found no room, are
+    // searched in full
+    if( m_best.empty() )
+        scan( { fullGrid }, 1 );
+
+    {
+        std::lock_guard<std::mutex> lock( m_lock );
+        m_quit = true;
+    }
+
+    m_scanStarted.notify_all();
+
+    for( auto& worker : workers )
+        worker.wait();
+
+    if( m_best.empty() )
+        return false;
+
+    aBest = m_best.front();
+    return true;
+}
+
+
+void AR_PLACEMENT_SCANNER::scan( const std::vector<WINDOW>& aWindows, size_t aKeep )
+{
+    std::unique_lock<std::mutex> lock( m_lock );
+
+    // A worker woken late may still be looking at the previous windows
+    m_scanDone.wait( lock, [this]() { return m_busyWorkers == 0; } );
+
+    m_windows = aWindows;
+    m_windowEnds.clear();
+
+    size_t columns = 0;
+
+    for( const WINDOW& window : m_windows )
+    {
+        columns += ( window.m_colMax - window.m_colMin ) / window.m_step + 1;
+        m_windowEnds.push_back( columns );
+    }
+
+    m_nextColumn = 0;
+    m_keep = aKeep;
+    m_best.clear();
+    m_busyWorkers = 1;      // the calling thread
+    m_scanCount++;
+
+    lock.unlock();
+    m_scanStarted.notify_all();
+
+    scanColumns();
+
+    lock.lock();
+    m_busyWorkers--;
+    m_scanDone.wait( lock, [this]() { return m_busyWorkers == 0; } );
+}
+
+
+void AR_PLACEMENT_SCANNER::scanColumns()
+{
+    std::vector<CANDIDATE> found;
+    CANDIDATE              candidate;
+
+    for( size_t i = m_nextColumn++; i < m_windowEnds.back(); i = m_nextColumn++ )
+    {
+        size_t ndx = std::upper_bound( m_windowEnds.begin(), m_windowEnds.end(), i )
+                     - m_windowEnds.begin();
+        const WINDOW& window = m_windows[ndx];
+        size_t        col = i - ( ndx > 0 ? m_windowEnds[ndx - 1] : 0 );
+
+        candidate.m_col = window.m_colMin + (int) col * window.m_step;
+
+        for( candidate.m_row = window.m_rowMin; candidate.m_row <= window.m_rowMax;
+             candidate.m_row += window.m_step )
+        {
+            if( m_cost( candidate.m_col, candidate.m_row, candidate.m_score ) )
+                keep( found, candidate );
+        }
+    }
+
+    std::lock_guard<std::mutex> lock( m_lock );
+
+    for( const CANDIDATE& c : found )
+        keep( m_best, c );
+}
+
+
+void AR_PLACEMENT_SCANNER::workerLoop()
+{
+    int scanCount = 0;
+
+    while( true )
+    {
+        {
+            std::unique_lock<std::mutex> lock( m_lock );
+
+            m_scanStarted.wait( lock, [&]() { return m_quit || m_scanCount != scanCount; } );
+
+            if( m_quit )
+                return;
+
+            scanCount = m_scanCount;
+            m_busyWorkers++;
+        }
+
+        scanColumns();
+
+        {
+            std::lock_guard<std::mutex> lock( m_lock );
+            m_busyWorkers--;
+        }
+
+        m_scanDone.notify_all();
+    }
+}
+
+
+void AR_PLACEMENT_SCANNER::keep( std::vector<CANDIDATE>& aList, const CANDIDATE& aCandidate ) const
+{
+    // On equal scores, the last position of a column by column scan wins
+    auto better = [this]( const CANDIDATE& aA, const CANDIDATE& aB )
+    {
+        if( aA.m_score != aB.m_score )
+            return aA.m_score < aB.m_score;
+
+        return (int64_t) aA.m_col * m_rows + aA.m_row > (int64_t) aB.m_col * m_rows + aB.m_row;
+    };
+
+    auto it = std::find_if( aList.begin(), aList.end(),
+            [&]( const CANDIDATE& aOther )
+            {
+                return better( aCandidate, aOther );
+            } );
+
+    if( it == aList.end() && aList.size() >= m_keep )
+        return;
+
+    aList.insert( it, aCandidate );
+
+    if( aList.size() > m_keep )
+        aList.pop_back();
+}
+
+
 int AR_AUTOPLACER::getOptimalModulePlacement(MODULE* aModule)
 {
-    int     error = 1;
-    wxPoint LastPosOK;
-    double  min_cost, curr_cost, Score;
-    bool    TstOtherSide;
+    int grid = m_matrix.m_GridRouting;
 
     aModule->CalculateBoundingBox();
 
-    LastPosOK = m_matrix.m_BrdBox.GetOrigin();
-
     wxPoint     mod_pos = aModule->GetPosition();
     EDA_RECT    fpBBox  = aModule->GetFootprintRect();
 
+    // The footprint rect at the footprint position
+    const EDA_RECT modBBox = fpBBox;
+
     // Move fpBBox to have the footprint position at (0,0)
     fpBBox.Move( -mod_pos );
     wxPoint fpBBoxOrg = fpBBox.GetOrigin();
@@ -625,16 +836,18 @@ int AR_AUTOPLACER::getOptimalModulePlacement(MODULE* aModule)
     wxPoint initialPos = m_matrix.m_BrdBox.GetOrigin() - fpBBoxOrg;
 
     // Stay on grid.
-    initialPos.x    -= initialPos.x % m_matrix.m_GridRouting;
-    initialPos.y    -= initialPos.y % m_matrix.m_GridRouting;
+    initialPos.x    -= initialPos.x % grid;
+    initialPos.y    -= initialPos.y % grid;
 
-    m_curPosition = initialPos;
-    auto moduleOffset = mod_pos - m_curPosition;
+    auto positionCount = [grid]( int aStart, int aLimit )
+    {
+        return aLimit > aStart ? ( aLimit - aStart + grid - 1 ) / grid : 0;
+    };
 
     /* Examine pads, and set TstOtherSide to true if a footprint
      * has at least 1 pad through.
      */
-    TstOtherSide = false;
+    bool tstOtherSide = false;
 
     if( m_matrix.m_RoutingLayersCount > 1 )
     {
@@ -645,91 +858,85 @@ int AR_AUTOPLACER::getOptimalModulePlacement(MODULE* aModule)
             if( !( pad->GetLayerSet() & other ).any() )
                 continue;
 
-            TstOtherSide = true;
+            tstOtherSide = true;
             break;
         }
     }
 
-    fpBBox.SetOrigin( fpBBoxOrg + m_curPosition );
-
-    min_cost = -1.0;
-//    m_frame->SetStatusText( wxT( "Score ??, pos ??" ) );
+    // The footprint areas and the connections do not depend on the tested position,
+    // and the search threads only read them.
+    std::vector<PAD_CONNECTIONS> connections;
 
+    buildFpAreas( aModule, 0 );
+    buildPadConnections( aModule, connections );
 
-    for( ; m_curPosition.x < xylimit.x; m_curPosition.x += m_matrix.m_GridRouting )
+    auto placementCost = [&]( int aCol, int aRow, double& aScore )
     {
-        m_curPosition.y = initialPos.y;
+        wxPoint position = initialPos + wxPoint( aCol * grid, aRow * grid );
+        wxPoint moduleOffset = mod_pos - position;
+        int     keepOutCost = testModuleOnBoard( aModule, modBBox, tstOtherSide, moduleOffset );
 
-        for( ; m_curPosition.y < xylimit.y; m_curPosition.y += m_matrix.m_GridRouting )
-        {
+        if( keepOutCost < 0 )    // i.e. if the module cannot be put here
+            return false;
 
-            fpBBox.SetOrigin( fpBBoxOrg + m_curPosition );
-            moduleOffset = mod_pos - m_curPosition;
-            int keepOutCost = testModuleOnBoard( aModule, TstOtherSide, moduleOffset );
+        aScore = computePlacementRatsnestCost( connections, moduleOffset ) + keepOutCost;
+        return true;
+    };
 
-            if( keepOutCost >= 0 )    // i.e. if the module can be put here
-            {
-                error = 0;
-                // m_frame->build_ratsnest_module( aModule ); // fixme
-                curr_cost   = computePlacementRatsnestCost( aModule, moduleOffset );
-                Score       = curr_cost + keepOutCost;
-
-                if( (min_cost >= Score ) || (min_cost < 0 ) )
-                {
-                    LastPosOK   = m_curPosition;
-                    min_cost    = Score;
-                    wxString msg;
-/*                    msg.Printf( wxT( "Score %g, pos %s, %s" ),
-                                min_cost,
-                                GetChars( ::CoordinateToString( LastPosOK.x ) ),
-                                GetChars( ::CoordinateToString( LastPosOK.y ) ) );
-                    m_frame->SetStatusText( msg );*/
-                }
-            }
-        }
-    }
+    AR_PLACEMENT_SCANNER scanner( positionCount( initialPos.x, xylimit.x ),
+                                  positionCount( initialPos.y, xylimit.y ), placementCost );
+    AR_PLACEMENT_SCANNER::CANDIDATE best;
 
-    // Regeneration of the modified variable.
-    m_curPosition = LastPosOK;
+    if( !scanner.FindBest( best ) )
+    {
+        m_curPosition = m_matrix.m_BrdBox.GetOrigin();
+        m_minCost = -1.0;
+        return 1;
+    }
 
-    m_minCost = min_cost;
-    return error;
+    m_curPosition = initialPos + wxPoint( best.m_col * grid, best.m_row * grid );
+    m_minCost = best.m_score;
+    return 0;
 }
 
 
-const D_PAD* AR_AUTOPLACER::nearestPad( MODULE *aRefModule, D_PAD* aRefPad, const wxPoint& aOffset)
+void AR_AUTOPLACER::buildPadConnections( MODULE* aModule,
+                                         std::vector<PAD_CONNECTIONS>& aConnections )
 {
-    const D_PAD* nearest = nullptr;
-    int64_t nearestDist = INT64_MAX;
+    aConnections.clear();
 
-    for ( auto mod : m_board->Modules() )
+    for( auto pad : aModule->Pads() )
     {
-        if ( mod == aRefModule )
+        if( pad->GetNetCode() <= 0 )
             continue;
 
-        if( !m_matrix.m_BrdBox.Contains( mod->GetPosition() ) )
-            continue;
+        PAD_CONNECTIONS connections;
+        connections.m_padPos = pad->GetPosition();
 
-        for ( auto pad: mod->Pads() )
+        for( auto mod : m_board->Modules() )
         {
-            if ( pad->GetNetCode() != aRefPad->GetNetCode() || pad->GetNetCode() <= 0 )
+            if( mod == aModule )
                 continue;
 
-            auto dist = (VECTOR2I( aRefPad->GetPosition() - aOffset ) - VECTOR2I( pad->GetPosition() ) ).EuclideanNorm();
+            if( !m_matrix.m_BrdBox.Contains( mod->GetPosition() ) )
+                continue;
 
-            if ( dist < nearestDist )
+            for( auto other : mod->Pads() )
             {
-                nearestDist = dist;
-                nearest = pad;
+                if( other->GetNetCode() == pad->GetNetCode() )
+                    connections.m_targets.push_back( other->GetPosition() );
             }
         }
-    }
 
-    return nearest;
+        // A pad connected to nothing placed yet costs nothing
+        if( !connections.m_targets.empty() )
+            aConnections.push_back( std::move( connections ) );
+    }
 }
 
 
-double AR_AUTOPLACER::computePlacementRatsnestCost( MODULE *aModule, const wxPoint& aOffset )
+double AR_AUTOPLACER::computePlacementRatsnestCost(
+        const std::vector<PAD_CONNECTIONS>& aConnections, const wxPoint& aOffset )
 {
     double  curr_cost;
     VECTOR2I start;      // start point of a ratsnest
@@ -738,21 +945,23 @@ double AR_AUTOPLACER::computePlacementRatsnestCost( MODULE *aModule, const wxPoi
 
     curr_cost = 0;
 
-    for ( auto pad : aModule->Pads() )
+    for( const PAD_CONNECTIONS& connections : aConnections )
     {
-        auto nearest = nearestPad( aModule, pad, aOffset );
+        start = VECTOR2I( connections.m_padPos ) - VECTOR2I( aOffset );
 
-        if( !nearest )
-            continue;
-
-        //printf("pad %s nearest %s\n", (const char *)aModule->GetReference().c_str(), (const char *)nearest->GetParent()->GetReference().c_str());
+        // The ratsnest goes to the nearest pad of the net
+        int64_t nearestDist = INT64_MAX;
 
-        start   = VECTOR2I( pad->GetPosition() ) - VECTOR2I(aOffset);
-        end     = VECTOR2I( nearest->GetPosition() );
+        for( const wxPoint& target : connections.m_targets )
+        {
+            auto dist = ( start - VECTOR2I( target ) ).EuclideanNorm();
 
-        //m_overlay->SetIsStroke( true );
-        //m_overlay->SetStrokeColor( COLOR4D(0.0, 1.0, 0.0, 1.0) );
-        //m_overlay->Line( start, end );
+            if( dist < nearestDist )
+            {
+                nearestDist = dist;
+                end = VECTOR2I( target );
+            }
+        }
 
         // Cost of the ratsnest.
         dx  = end.x - start.x;
@@ -29,6 +29,11 @@
 #ifndef __AR_AUTOPLACER_H
 #define __AR_AUTOPLACER_H
 
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+
 #include "ar_cell.h"
 #include "ar_matrix.h"
 
@@ -55,6 +60,91 @@ enum AR_RESULT
 
 class PROGRESS_REPORTER;
 
+
+/**
+ * Class AR_PLACEMENT_SCANNER
+ * searches the best position of a footprint on a grid of candidate positions.
+ *
+ * The worker threads are started once per search and handed the windows of the grid to
+ * scan, column by column: the whole grid when it is small, else every AR_COARSE_STEP-th
+ * position first, then the windows around the best coarse positions.
+ */
+class AR_PLACEMENT_SCANNER
+{
+public:
+    /// A position of the footprint on the search grid, with its cost
+    struct CANDIDATE
+    {
+        int    m_col;
+        int    m_row;
+        double m_score;
+    };
+
+    /**
+     * Gives in aScore the cost of the footprint at the column aCol and the row aRow of
+     * the grid, or returns false if the footprint cannot be put there.  It is called
+     * from several threads at once.
+     */
+    using COST_FUNCTION = std::function<bool( int aCol, int aRow, double& aScore )>;
+
+    /**
+     * @param aCols, aRows are the size of the grid.
+     * @param aCost gives the cost of each position.
+     * @param aMaxThreads is the maximum number of threads, 0 for the hardware concurrency.
+     */
+    AR_PLACEMENT_SCANNER( int aCols, int aRows, COST_FUNCTION aCost, size_t aMaxThreads = 0 );
+
+    /**
+     * Finds the position of lowest cost.  On equal costs, the last position of a column
+     * by column scan wins.
+     *
+     * @return false if the footprint cannot be put anywhere on the grid.
+     */
+    bool FindBest( CANDIDATE& aBest );
+
+private:
+    /// Every m_step-th position of a rectangle of the grid
+    struct WINDOW
+    {
+        int m_colMin;
+        int m_colMax;
+        int m_rowMin;
+        int m_rowMax;
+        int m_step;
+    };
+
+    ///> Hands aWindows to the workers, and keeps the aKeep best positions they find
+    void scan( const std::vector<WINDOW>& aWindows, size_t aKeep );
+
+    ///> Scans the columns of the current windows until there are none left
+    void scanColumns();
+
+    ///> Waits for the windows to scan, until the search is over
+    void workerLoop();
+
+    ///> Inserts aCandidate in the best first list aList, if it is one of the m_keep best
+    void keep( std::vector<CANDIDATE>& aList, const CANDIDATE& aCandidate ) const;
+
+    int           m_cols;
+    int           m_rows;
+    COST_FUNCTION m_cost;
+    size_t        m_maxThreads;
+
+    std::mutex              m_lock;
+    std::condition_variable m_scanStarted;
+    std::condition_variable m_scanDone;
+    int                     m_scanCount;      ///< number of the current scan
+    size_t                  m_busyWorkers;    ///< workers still scanning the current windows
+    bool                    m_quit;
+
+    std::vector<WINDOW>    m_windows;
+    std::vector<size_t>    m_windowEnds;     ///< columns in the windows up to each window
+    std::atomic<size_t>    m_nextColumn;
+    size_t                 m_keep;
+    std::vector<CANDIDATE> m_best;
+};
+
+
 class AR_AUTOPLACER
 {
 public:
@@ -103,12 +193,22 @@ private:
     bool         fillMatrix();
     void         genModuleOnRoutingMatrix( MODULE* Module );
 
+    /// The pad of the footprint being placed, and the pads of the other footprints it
+    /// connects to, gathered once before searching the footprint position
+    struct PAD_CONNECTIONS
+    {
+        wxPoint              m_padPos;
+        std::vector<wxPoint> m_targets;
+    };
+
     int          testRectangle( const EDA_RECT& aRect, int side );
     int          testModuleByPolygon( MODULE* aModule,int aSide, const wxPoint& aOffset );
     unsigned int calculateKeepOutArea( const EDA_RECT& aRect, int side );
-    int          testModuleOnBoard( MODULE* aModule, bool TstOtherSide, const wxPoint& aOffset );
+    int          testModuleOnBoard( MODULE* aModule, const EDA_RECT& aFpBBox, bool TstOtherSide,
+                                    const wxPoint& aOffset );
     int          getOptimalModulePlacement( MODULE* aModule );
-    double       computePlacementRatsnestCost( MODULE* aModule, const wxPoint& aOffset );
+    double       computePlacementRatsnestCost( const std::vector<PAD_CONNECTIONS>& aConnections,
+                                               const wxPoint& aOffset );
 
     /**
      * Find the "best" module place. The criteria are:
@@ -118,7 +218,9 @@ private:
     MODULE*      pickModule();
 
     void         placeModule( MODULE* aModule, bool aDoNotRecreateRatsnest, const wxPoint& aPos );
-    const D_PAD* nearestPad( MODULE* aRefModule, D_PAD* aRefPad, const wxPoint& aOffset );
+
+    // Gather the pads of the other footprints on the board area the pads of aModule connect to
+    void         buildPadConnections( MODULE* aModule, std::vector<PAD_CONNECTIONS>& aConnections );
 
     // Add a polygonal shape (rectangle) to m_fpAreaFront and/or m_fpAreaBack
     void         addFpBody( wxPoint aStart, wxPoint aEnd, LSET aLayerMask );
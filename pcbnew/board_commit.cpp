@@ -65,8 +65,10 @@ void BOARD_COMMIT::Push( const wxString& aMessage, bool aCreateUndoEntry, bool a
     BOARD*            board = (BOARD*) m_toolMgr->GetModel();
     PCB_BASE_FRAME*   frame = (PCB_BASE_FRAME*) m_toolMgr->GetEditFrame();
     auto              connectivity = board->GetConnectivity();
-    std::set<EDA_ITEM*>      savedModules;
-    std::vector<BOARD_ITEM*> itemsToDeselect;
+    std::set<EDA_ITEM*>             savedModules;
+    std::vector<BOARD_ITEM*>        itemsToDeselect;
+    std::vector<BOARD_ITEM*>        changedItems;
+    std::vector<REMOVED_BOARD_ITEM> removedItems;
 
     if( Empty() )
         return;
@@ -136,6 +138,10 @@ void BOARD_COMMIT::Push( const wxString& aMessage, bool aCreateUndoEntry, bool a
                 }
 
                 view->Add( boardItem );
+
+                if( !m_editModules && boardItem->Type() != PCB_MARKER_T )
+                    changedItems.push_back( boardItem );
+
                 break;
             }
 
@@ -185,6 +191,9 @@ void BOARD_COMMIT::Push( const wxString& aMessage, bool aCreateUndoEntry, bool a
                 case PCB_TARGET_T:              // a target (graphic item)
                 case PCB_MARKER_T:              // a marker used to show something
                 case PCB_ZONE_AREA_T:
+                    if( !m_editModules && boardItem->Type() != PCB_MARKER_T )
+                        removedItems.emplace_back( boardItem );   // before it can be deleted
+
                     itemsToDeselect.push_back( boardItem );
 
                     view->Remove( boardItem );
@@ -201,6 +210,8 @@ void BOARD_COMMIT::Push( const wxString& aMessage, bool aCreateUndoEntry, bool a
                     // There are no modules inside a module yet
                     wxASSERT( !m_editModules );
 
+                    removedItems.emplace_back( boardItem );   // before it can be deleted
+
                     MODULE* module = static_cast<MODULE*>( boardItem );
                     view->Remove( module );
                     module->ClearFlags();
@@ -237,6 +248,9 @@ void BOARD_COMMIT::Push( const wxString& aMessage, bool aCreateUndoEntry, bool a
                 connectivity->Update( boardItem );
                 view->Update( boardItem );
 
+                if( !m_editModules && boardItem->Type() != PCB_MARKER_T )
+                    changedItems.push_back( boardItem );
+
                 // if no undo entry is needed, the copy would create a memory leak
                 if( !aCreateUndoEntry )
                     delete ent.m_copy;
@@ -270,6 +284,12 @@ void BOARD_COMMIT::Push( const wxString& aMessage, bool aCreateUndoEntry, bool a
         panel->RedrawRatsnest();
     }
 
+    // Let the frame update what depends on the changed items (incremental DRC, router
+    // world), before OnModify() so the frame knows the modification was reported.
+    // Markers are not reported, so committing DRC markers does not trigger a new test.
+    if( !changedItems.empty() || !removedItems.empty() )
+        frame->OnBoardItemsChanged( changedItems, removedItems, aSetDirtyBit );
+
     if( aSetDirtyBit )
         frame->OnModify();
 
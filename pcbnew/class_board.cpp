@@ -1106,7 +1106,7 @@ EDA_RECT BOARD::ComputeBoundingBox( bool aBoardEdgesOnly ) const
     EDA_RECT area;
 
     // Check segments, dimensions, texts, and fiducials
-    for( BOARD_ITEM* item = m_Drawings;  item;  item = item->Next() )
+    for( BOARD_ITEM* item : Drawings() )
     {
         if( aBoardEdgesOnly && (item->Type() != PCB_LINE_T || item->GetLayer() != Edge_Cuts ) )
             continue;
@@ -1122,7 +1122,7 @@ EDA_RECT BOARD::ComputeBoundingBox( bool aBoardEdgesOnly ) const
     if( !aBoardEdgesOnly )
     {
         // Check modules
-        for( MODULE* module = m_Modules; module; module = module->Next() )
+        for( MODULE* module : Modules() )
         {
             if( !hasItems )
                 area = module->GetBoundingBox();
@@ -1133,7 +1133,7 @@ EDA_RECT BOARD::ComputeBoundingBox( bool aBoardEdgesOnly ) const
         }
 
         // Check tracks
-        for( TRACK* track = m_Track; track; track = track->Next() )
+        for( TRACK* track : Tracks() )
         {
             if( !hasItems )
                 area = track->GetBoundingBox();
@@ -2516,9 +2516,9 @@ D_PAD* BOARD::GetPad( unsigned aIndex ) const
 {
     unsigned count = 0;
 
-    for( MODULE* mod = m_Modules; mod ; mod = mod->Next() ) // FIXME: const DLIST_ITERATOR
+    for( MODULE* mod : Modules() )
     {
-        for( D_PAD* pad = mod->PadsList(); pad; pad = pad->Next() )
+        for( D_PAD* pad : mod->Pads() )
         {
             if( count == aIndex )
                 return pad;
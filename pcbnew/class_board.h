@@ -248,9 +248,9 @@ public:
     DLIST<MODULE>               m_Modules;              // linked list of MODULEs
     DLIST<TRACK>                m_Track;                // linked list of TRACKs and VIAs
 
-    DLIST_ITERATOR_WRAPPER<TRACK> Tracks() { return DLIST_ITERATOR_WRAPPER<TRACK>(m_Track); }
-    DLIST_ITERATOR_WRAPPER<MODULE> Modules() { return DLIST_ITERATOR_WRAPPER<MODULE>(m_Modules); }
-    DLIST_ITERATOR_WRAPPER<BOARD_ITEM> Drawings() { return DLIST_ITERATOR_WRAPPER<BOARD_ITEM>(m_Drawings); }
+    DLIST_ITERATOR_WRAPPER<TRACK> Tracks() const { return DLIST_ITERATOR_WRAPPER<TRACK>(m_Track); }
+    DLIST_ITERATOR_WRAPPER<MODULE> Modules() const { return DLIST_ITERATOR_WRAPPER<MODULE>(m_Modules); }
+    DLIST_ITERATOR_WRAPPER<BOARD_ITEM> Drawings() const { return DLIST_ITERATOR_WRAPPER<BOARD_ITEM>(m_Drawings); }
     ZONE_CONTAINERS& Zones() { return m_ZoneDescriptorList; }
     const std::vector<BOARD_CONNECTED_ITEM*> AllConnectedItems();
 
@@ -166,12 +166,12 @@ public:
     DLIST<BOARD_ITEM>& GraphicalItemsList()         { return m_Drawings; }
     const DLIST<BOARD_ITEM>& GraphicalItemsList() const { return m_Drawings; }
 
-    DLIST_ITERATOR_WRAPPER<D_PAD> Pads()
+    DLIST_ITERATOR_WRAPPER<D_PAD> Pads() const
     {
          return DLIST_ITERATOR_WRAPPER<D_PAD>( m_Pads );
     }
 
-    DLIST_ITERATOR_WRAPPER<BOARD_ITEM> GraphicalItems()
+    DLIST_ITERATOR_WRAPPER<BOARD_ITEM> GraphicalItems() const
     {
         return DLIST_ITERATOR_WRAPPER<BOARD_ITEM>( m_Drawings );
     }
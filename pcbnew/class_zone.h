@@ -632,6 +632,11 @@ public:
         return m_RawPolysList;
     }
 
+    SHAPE_POLY_SET& FilledPolysList()
+    {
+        return m_FilledPolysList;
+    }
+
     wxString GetSelectMenuText( EDA_UNITS_T aUnits ) const override;
 
     BITMAP_DEF GetMenuImage() const override;
@@ -714,6 +719,14 @@ public:
      */
     void BuildHashValue() { m_filledPolysHash = m_FilledPolysList.GetHash(); }
 
+    /** @return the hash of the zone settings and of the items around the zone, stored
+     * by the zone filler when the zone was filled.  Invalid if the zone was never filled
+     * by the zone filler, or was unfilled since.
+     */
+    const MD5_HASH& GetObstaclesHash() const { return m_obstaclesHash; }
+
+    void SetObstaclesHash( const MD5_HASH& aHash ) { m_obstaclesHash = aHash; }
+
 
 
 #if defined(DEBUG)
@@ -818,6 +831,9 @@ private:
     SHAPE_POLY_SET        m_RawPolysList;
     MD5_HASH              m_filledPolysHash;    // A hash value used in zone filling calculations
                                                 // to see if the filled areas are up to date
+    MD5_HASH              m_obstaclesHash;      // The hash of the items the filled areas were
+                                                // built from, to skip the refill of a zone
+                                                // when none of them changed
 
     HATCH_STYLE           m_hatchStyle;     // hatch style, see enum above
     int                   m_hatchPitch;     // for DIAGONAL_EDGE, distance between 2 hatch lines
@@ -26,6 +26,7 @@
 #include <widgets/progress_reporter.h>
 #include <geometry/geometry_utils.h>
 
+#include <atomic>
 #include <thread>
 #include <mutex>
 #include <algorithm>
@@ -102,7 +103,7 @@ void CN_CONNECTIVITY_ALGO::markItemNetAsDirty( const BOARD_ITEM* aItem )
         {
             auto mod = static_cast <const MODULE*>( aItem );
 
-            for( D_PAD* pad = mod->PadsList(); pad; pad = pad->Next() )
+            for( D_PAD* pad : mod->Pads() )
                 MarkNetAsDirty( pad->GetNetCode() );
         }
     }
@@ -289,90 +290,170 @@ const CN_CONNECTIVITY_ALGO::CLUSTERS CN_CONNECTIVITY_ALGO::SearchClusters( CLUST
 }
 
 
+/**
+ * Class CN_UNION_FIND
+ * Disjoint sets of the items taking part in a cluster search, which can be joined from
+ * several threads without locking.  A set is always represented by its lowest index.
+ */
+class CN_UNION_FIND
+{
+public:
+    CN_UNION_FIND( size_t aSize ) :
+        m_parent( aSize )
+    {
+        for( size_t i = 0; i < aSize; i++ )
+            m_parent[i] = i;
+    }
+
+    int Find( int aIndex )
+    {
+        for( ;; )
+        {
+            int parent = m_parent[aIndex];
+
+            if( parent == aIndex )
+                return aIndex;
+
+            int grandParent = m_parent[parent];
+
+            // Path halving: a failure only means another thread shortened the path first
+            if( grandParent != parent )
+                m_parent[aIndex].compare_exchange_weak( parent, grandParent );
+
+            aIndex = grandParent;
+        }
+    }
+
+    void Join( int aA, int aB )
+    {
+        for( ;; )
+        {
+            aA = Find( aA );
+            aB = Find( aB );
+
+            if( aA == aB )
+                return;
+
+            if( aA < aB )
+                std::swap( aA, aB );
+
+            // Link the root with the higher index, unless it was linked in the meantime
+            int expected = aA;
+
+            if( m_parent[aA].compare_exchange_strong( expected, aB ) )
+                return;
+        }
+    }
+
+private:
+    std::vector<std::atomic<int>> m_parent;
+};
+
+
 const CN_CONNECTIVITY_ALGO::CLUSTERS CN_CONNECTIVITY_ALGO::SearchClusters( CLUSTER_SEARCH_MODE aMode,
         const KICAD_T aTypes[], int aSingleNet )
 {
     bool withinAnyNet = ( aMode != CSM_PROPAGATE );
 
-    std::deque<CN_ITEM*> Q;
-    CN_ITEM* head = nullptr;
     CLUSTERS clusters;
 
     if( m_itemList.IsDirty() )
         searchConnections();
 
-    auto addToSearchList = [&head, withinAnyNet, aSingleNet, aTypes] ( CN_ITEM *aItem )
+    auto isSearched = [withinAnyNet, aSingleNet, aTypes] ( CN_ITEM *aItem )
     {
         if( withinAnyNet && aItem->Net() <= 0 )
-            return;
+            return false;
 
         if( !aItem->Valid() )
-            return;
+            return false;
 
         if( aSingleNet >=0 && aItem->Net() != aSingleNet )
-            return;
-
-        bool found = false;
+            return false;
 
         for( int i = 0; aTypes[i] != EOT; i++ )
         {
             if( aItem->Parent()->Type() == aTypes[i] )
-            {
-                found = true;
-                break;
-            }
+                return true;
         }
 
-        if( !found )
-            return;
-
-        aItem->ListClear();
-        aItem->SetVisited( false );
-
-        if( !head )
-            head = aItem;
-        else
-            head->ListInsert( aItem );
+        return false;
     };
 
-    std::for_each( m_itemList.begin(), m_itemList.end(), addToSearchList );
+    std::vector<CN_ITEM*> items;
+    items.reserve( m_itemList.Size() );
 
-    while( head )
+    for( auto item : m_itemList )
     {
-        CN_CLUSTER_PTR cluster ( new CN_CLUSTER() );
+        if( isSearched( item ) )
+        {
+            item->SetClusterIndex( items.size() );
+            items.push_back( item );
+        }
+        else
+        {
+            item->SetClusterIndex( -1 );
+        }
+    }
 
-        Q.clear();
-        CN_ITEM* root = head;
-        root->SetVisited ( true );
+    // Join the connected items.  Unless nets are being propagated, the connections
+    // between items of different nets are ignored.
+    CN_UNION_FIND sets( items.size() );
 
-        head = root->ListRemove();
+    size_t parallelThreadCount = std::min<size_t>( std::thread::hardware_concurrency(),
+            ( items.size() + 1023 ) / 1024 );
 
-        Q.push_back( root );
+    std::atomic<size_t> nextItem( 0 );
+    std::vector<std::future<size_t>> returns( parallelThreadCount );
 
-        while( Q.size() )
+    auto join_lambda = [&nextItem, &items, &sets, withinAnyNet] () -> size_t
+    {
+        for( size_t i = nextItem++; i < items.size(); i = nextItem++ )
         {
-            CN_ITEM* current = Q.front();
+            CN_ITEM* item = items[i];
 
-            Q.pop_front();
-            cluster->Add( current );
-
-            for( auto n : current->ConnectedItems() )
+            for( auto n : item->ConnectedItems() )
             {
-                if( withinAnyNet && n->Net() != root->Net() )
+                if( n->ClusterIndex() < 0 )
                     continue;
 
-                if( !n->Visited() && n->Valid() )
-                {
-                    n->SetVisited( true );
-                    Q.push_back( n );
-                    head = n->ListRemove();
-                }
+                if( withinAnyNet && n->Net() != item->Net() )
+                    continue;
+
+                sets.Join( i, n->ClusterIndex() );
             }
         }
 
-        clusters.push_back( cluster );
+        return 1;
+    };
+
+    if( parallelThreadCount <= 1 )
+        join_lambda();
+    else
+    {
+        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+            returns[ii] = std::async( std::launch::async, join_lambda );
+
+        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+            returns[ii].wait();
     }
 
+    // The root of a set is its first item, so the clusters are created and filled
+    // in the order of the item list
+    std::vector<CN_CLUSTER_PTR> setClusters( items.size() );
+
+    for( size_t i = 0; i < items.size(); i++ )
+    {
+        CN_CLUSTER_PTR& cluster = setClusters[ sets.Find( i ) ];
+
+        if( !cluster )
+        {
+            cluster.reset( new CN_CLUSTER() );
+            clusters.push_back( cluster );
+        }
+
+        cluster->Add( items[i] );
+    }
 
     std::sort( clusters.begin(), clusters.end(), []( CN_CLUSTER_PTR a, CN_CLUSTER_PTR b ) {
         return a->OriginNet() < b->OriginNet();
@@ -394,10 +475,66 @@ const CN_CONNECTIVITY_ALGO::CLUSTERS CN_CONNECTIVITY_ALGO::SearchClusters( CLUST
 
 void CN_CONNECTIVITY_ALGO::Build( BOARD* aBoard )
 {
+    std::vector<ZONE_CONTAINER*> zones;
+
     for( int i = 0; i<aBoard->GetAreaCount(); i++ )
     {
         auto zone = aBoard->GetArea( i );
-        Add( zone );
+
+        if( IsCopperLayer( zone->GetLayer() ) && !ItemExists( zone ) )
+            zones.push_back( zone );
+    }
+
+    // Creating the zone items is the costly part: the outline of each filled polygon is
+    // partitioned for the hit tests.  Do it on several threads, then add all the items.
+    std::vector<std::vector<CN_ITEM*>> zoneItems( zones.size() );
+
+    size_t parallelThreadCount = std::min<size_t>( std::thread::hardware_concurrency(),
+            zones.size() );
+
+    std::atomic<size_t> nextZone( 0 );
+    std::vector<std::future<size_t>> returns( parallelThreadCount );
+
+    auto zone_lambda = [&nextZone, &zones, &zoneItems] () -> size_t
+    {
+        for( size_t i = nextZone++; i < zones.size(); i = nextZone++ )
+            zoneItems[i] = CN_LIST::CreateItems( zones[i] );
+
+        return 1;
+    };
+
+    if( parallelThreadCount <= 1 )
+        zone_lambda();
+    else
+    {
+        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+            returns[ii] = std::async( std::launch::async, zone_lambda );
+
+        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+            returns[ii].wait();
+    }
+
+    int itemCount = m_itemList.Size() + aBoard->m_Track.GetCount();
+
+    for( auto mod : aBoard->Modules() )
+        itemCount += mod->Pads().Size();
+
+    for( const auto& items : zoneItems )
+        itemCount += items.size();
+
+    m_itemList.Reserve( itemCount );
+    m_itemMap.reserve( m_itemMap.size() + itemCount );
+
+    for( size_t i = 0; i < zones.size(); i++ )
+    {
+        markItemNetAsDirty( zones[i] );
+
+        auto& entry = m_itemMap[ zones[i] ];
+
+        for( auto zitem : zoneItems[i] )
+            entry.Link( zitem );
+
+        m_itemList.Add( zoneItems[i] );
     }
 
     for( auto tv : aBoard->Tracks() )
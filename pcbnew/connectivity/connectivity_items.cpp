@@ -179,29 +179,51 @@ CN_ITEM* CN_LIST::Add( D_PAD* pad )
      return item;
  }
 
- const std::vector<CN_ITEM*> CN_LIST::Add( ZONE_CONTAINER* zone )
- {
-     const auto& polys = zone->GetFilledPolysList();
+const std::vector<CN_ITEM*> CN_LIST::CreateItems( ZONE_CONTAINER* zone )
+{
+    const auto& polys = zone->GetFilledPolysList();
 
-     std::vector<CN_ITEM*> rv;
+    std::vector<CN_ITEM*> rv;
 
-     for( int j = 0; j < polys.OutlineCount(); j++ )
-     {
-         CN_ZONE* zitem = new CN_ZONE( zone, false, j );
-         const auto& outline = zone->GetFilledPolysList().COutline( j );
+    for( int j = 0; j < polys.OutlineCount(); j++ )
+    {
+        CN_ZONE* zitem = new CN_ZONE( zone, false, j );
+        const auto& outline = zone->GetFilledPolysList().COutline( j );
 
-         for( int k = 0; k < outline.PointCount(); k++ )
-             zitem->AddAnchor( outline.CPoint( k ) );
+        for( int k = 0; k < outline.PointCount(); k++ )
+            zitem->AddAnchor( outline.CPoint( k ) );
 
-         m_items.push_back( zitem );
-         zitem->SetLayer( zone->GetLayer() );
-         addItemtoTree( zitem );
-         rv.push_back( zitem );
-         SetDirty();
-     }
+        zitem->SetLayer( zone->GetLayer() );
+        rv.push_back( zitem );
+    }
 
-     return rv;
- }
+    return rv;
+}
+
+
+const std::vector<CN_ITEM*> CN_LIST::Add( ZONE_CONTAINER* zone )
+{
+    const std::vector<CN_ITEM*> rv = CreateItems( zone );
+
+    Add( rv );
+
+    return rv;
+}
+
+
+void CN_LIST::Add( const std::vector<CN_ITEM*>& aItems )
+{
+    if( aItems.empty() )
+        return;
+
+    for( CN_ITEM* item : aItems )
+    {
+        m_items.push_back( item );
+        addItemtoTree( item );
+    }
+
+    SetDirty();
+}
 
 
 void CN_LIST::RemoveInvalidItems( std::vector<CN_ITEM*>& aGarbage )
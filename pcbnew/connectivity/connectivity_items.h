@@ -163,8 +163,8 @@ private:
 
     CN_ANCHORS m_anchors;
 
-    ///> visited flag for the BFS scan
-    bool m_visited;
+    ///> index of the item in the current cluster search, -1 if the item is not searched
+    int m_clusterIndex;
 
     ///> can the net propagator modify the netcode?
     bool m_canChangeNet;
@@ -192,7 +192,7 @@ public:
     {
         m_parent = aParent;
         m_canChangeNet = aCanChangeNet;
-        m_visited = false;
+        m_clusterIndex = -1;
         m_valid = true;
         m_dirty = true;
         m_anchors.reserve( 2 );
@@ -296,14 +296,14 @@ public:
         m_connected.clear();
     }
 
-    void SetVisited( bool aVisited )
+    void SetClusterIndex( int aIndex )
     {
-        m_visited = aVisited;
+        m_clusterIndex = aIndex;
     }
 
-    bool Visited() const
+    int ClusterIndex() const
     {
-        return m_visited;
+        return m_clusterIndex;
     }
 
     bool CanChangeNet() const
@@ -458,6 +458,11 @@ public:
         return m_items.size();
     }
 
+    void Reserve( int aSize )
+    {
+        m_items.reserve( aSize );
+    }
+
     CN_ITEM* Add( D_PAD* pad );
 
     CN_ITEM* Add( TRACK* track );
@@ -465,6 +470,19 @@ public:
     CN_ITEM* Add( VIA* via );
 
     const std::vector<CN_ITEM*> Add( ZONE_CONTAINER* zone );
+
+    /**
+     * Function Add()
+     * Adds a batch of items, created by CreateItems(), to the list.
+     */
+    void Add( const std::vector<CN_ITEM*>& aItems );
+
+    /**
+     * Function CreateItems()
+     * Creates the items of a zone (one for each filled polygon) without adding them to the
+     * list.  The list is not modified, so the items of several zones can be created in parallel.
+     */
+    static const std::vector<CN_ITEM*> CreateItems( ZONE_CONTAINER* zone );
 };
 
 class CN_CLUSTER
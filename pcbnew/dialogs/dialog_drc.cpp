@@ -54,6 +54,7 @@
 #define DrcRefillZonesKey        wxT( "RefillZonesBeforeDrc" )
 #define DrcTrackToZoneTestKey    wxT( "DrcTrackToZoneTest" )
 #define DrcTestFootprintsKey     wxT( "DrcTestFootprints" )
+#define DrcIncrementalKey        wxT( "DrcIncrementalTest" )
 
 
 DIALOG_DRC_CONTROL::DIALOG_DRC_CONTROL( DRC* aTester, PCB_EDIT_FRAME* aEditorFrame,
@@ -112,6 +113,9 @@ DIALOG_DRC_CONTROL::~DIALOG_DRC_CONTROL()
     m_config->Write( DrcRefillZonesKey, m_cbRefillZones->GetValue() );
     m_config->Write( DrcTrackToZoneTestKey, m_cbReportTracksToZonesErrors->GetValue() );
     m_config->Write( DrcTestFootprintsKey, m_cbTestFootprints->GetValue() );
+    m_config->Write( DrcIncrementalKey, m_cbIncrementalDrc->GetValue() );
+
+    m_tester->SetIncrementalTest( m_cbIncrementalDrc->GetValue() );
 
     // Disconnect events
     m_ClearanceListBox->Disconnect( ID_CLEARANCE_LIST, wxEVT_LEFT_DCLICK,
@@ -182,6 +186,8 @@ void DIALOG_DRC_CONTROL::InitValues()
     m_cbReportTracksToZonesErrors->SetValue( value );
     m_config->Read( DrcTestFootprintsKey, &value, false );
     m_cbTestFootprints->SetValue( value );
+    m_config->Read( DrcIncrementalKey, &value, false );
+    m_cbIncrementalDrc->SetValue( value );
 
     Layout();      // adding the units above expanded Clearance text, now resize.
 
@@ -241,6 +247,7 @@ void DIALOG_DRC_CONTROL::OnStartdrcClick( wxCommandEvent& event )
     m_tester->m_drcInLegacyRoutingMode = false;
     m_tester->m_reportAllTrackErrors   = m_cbReportAllTrackErrors->GetValue();
     m_tester->m_testFootprints         = m_cbTestFootprints->GetValue();
+    m_tester->m_doIncrementalTest      = m_cbIncrementalDrc->GetValue();
 
     DelDRCMarkers();
 
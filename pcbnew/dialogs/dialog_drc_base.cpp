@@ -99,6 +99,11 @@ DIALOG_DRC_CONTROL_BASE::DIALOG_DRC_CONTROL_BASE( wxWindow* parent, wxWindowID i
 	m_cbTestFootprints = new wxCheckBox( this, wxID_ANY, _("Test footprints against schematic"), wxDefaultPosition, wxDefaultSize, 0 );
 	bSizerOptSettings->Add( m_cbTestFootprints, 0, wxBOTTOM|wxRIGHT|wxLEFT, 5 );
 
+	m_cbIncrementalDrc = new wxCheckBox( this, wxID_ANY, _("Re-test modified items after each change"), wxDefaultPosition, wxDefaultSize, 0 );
+	m_cbIncrementalDrc->SetToolTip( _("If selected, once a DRC was run, the tracks, vias and pads modified by each edit are tested again and their markers updated.") );
+
+	bSizerOptSettings->Add( m_cbIncrementalDrc, 0, wxBOTTOM|wxRIGHT|wxLEFT, 5 );
+
 
 	bSizerOptions->Add( bSizerOptSettings, 1, wxEXPAND, 5 );
 
@@ -61,6 +61,7 @@ class DIALOG_DRC_CONTROL_BASE : public DIALOG_SHIM
 		wxCheckBox* m_cbReportAllTrackErrors;
 		wxCheckBox* m_cbReportTracksToZonesErrors;
 		wxCheckBox* m_cbTestFootprints;
+		wxCheckBox* m_cbIncrementalDrc;
 		wxTextCtrl* m_Messages;
 		wxCheckBox* m_CreateRptCtrl;
 		wxTextCtrl* m_RptFilenameCtrl;
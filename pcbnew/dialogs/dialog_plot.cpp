@@ -27,7 +27,7 @@
 #include <confirm.h>
 #include <pcb_edit_frame.h>
 #include <pcbplot.h>
-#include <gerber_jobfile_writer.h>
+#include <fabrication_job.h>
 #include <reporter.h>
 #include <wildcards_and_files_ext.h>
 #include <bitmaps.h>
@@ -780,8 +780,6 @@ void DIALOG_PLOT::Plot( wxCommandEvent& event )
         m_plotOpts.SetWidthAdjust( m_PSWidthAdjust );
     }
 
-    wxString file_ext( GetDefaultPlotExtension( m_plotOpts.GetFormat() ) );
-
     // Test for a reasonable scale value
     // XXX could this actually happen? isn't it constrained in the apply
     // function?
@@ -791,69 +789,16 @@ void DIALOG_PLOT::Plot( wxCommandEvent& event )
     if( m_plotOpts.GetScale() > PLOT_MAX_SCALE )
         DisplayInfoMessage( this, _( "Warning: Scale option set to a very large value" ) );
 
-    GERBER_JOBFILE_WRITER jobfile_writer( board, &reporter );
-
     // Save the current plot options in the board
     m_parent->SetPlotSettings( m_plotOpts );
 
     wxBusyCursor dummy;
 
-    for( LSEQ seq = m_plotOpts.GetLayerSelection().UIOrder();  seq;  ++seq )
-    {
-        PCB_LAYER_ID layer = *seq;
-
-        // All copper layers that are disabled are actually selected
-        // This is due to wonkyness in automatically selecting copper layers
-        // for plotting when adding more than two layers to a board.
-        // If plot options become accessible to the layers setup dialog
-        // please move this functionality there!
-        // This skips a copper layer if it is actually disabled on the board.
-        if( ( LSET::AllCuMask() & ~board->GetEnabledLayers() )[layer] )
-            continue;
-
-        // Pick the basename from the board file
-        wxFileName fn( boardFilename );
+    // Plot the layers and create the gerber job file
+    FABRICATION_JOB job( board, m_plotOpts, outputDir.GetPath() );
 
-        // Use Gerber Extensions based on layer number
-        // (See http://en.wikipedia.org/wiki/Gerber_File)
-        if( m_plotOpts.GetFormat() == PLOT_FORMAT_GERBER && m_useGerberExtensions->GetValue() )
-            file_ext = GetGerberProtelExtension( layer );
-
-        BuildPlotFileName( &fn, outputDir.GetPath(), board->GetLayerName( layer ), file_ext );
-        wxString fullname = fn.GetFullName();
-        jobfile_writer.AddGbrFile( layer, fullname );
-
-        LOCALE_IO toggle;
-
-        PLOTTER*    plotter = StartPlotBoard( board, &m_plotOpts, layer, fn.GetFullPath(), wxEmptyString );
-
-        // Print diags in messages box:
-        wxString msg;
-
-        if( plotter )
-        {
-            PlotOneBoardLayer( board, plotter, layer, m_plotOpts );
-            plotter->EndPlot();
-            delete plotter;
-
-            msg.Printf( _( "Plot file \"%s\" created." ), GetChars( fn.GetFullPath() ) );
-            reporter.Report( msg, REPORTER::RPT_ACTION );
-        }
-        else
-        {
-            msg.Printf( _( "Unable to create file \"%s\"." ), GetChars( fn.GetFullPath() ) );
-            reporter.Report( msg, REPORTER::RPT_ERROR );
-        }
-    }
-
-    if( m_plotOpts.GetFormat() == PLOT_FORMAT_GERBER && m_plotOpts.GetCreateGerberJobFile() )
-    {
-        // Pick the basename from the board file
-        wxFileName fn( boardFilename );
-        // Build gerber job file from basename
-        BuildPlotFileName( &fn, outputDir.GetPath(), "job", GerberJobFileExtension );
-        jobfile_writer.CreateJobFile( fn.GetFullPath() );
-    }
+    job.SetUseGerberExtensions( m_useGerberExtensions->GetValue() );
+    job.Run( &reporter );
 }
 
 
@@ -45,6 +45,7 @@ DIALOG_PNS_SETTINGS::DIALOG_PNS_SETTINGS( wxWindow* aParent, PNS::ROUTING_SETTIN
     m_effort->SetValue( m_settings.OptimizerEffort() );
     m_smoothDragged->SetValue( m_settings.SmoothDraggedSegments() );
     m_violateDrc->SetValue( m_settings.CanViolateDRC() );
+    m_speculative->SetValue( m_settings.SpeculativeRouting() );
     m_freeAngleMode->SetValue( m_settings.GetFreeAngleMode() );
     m_dragToolMode->SetSelection ( m_settings.InlineDragEnabled() ? 1 : 0 );
     // Enable/disable some options
@@ -73,6 +74,7 @@ void DIALOG_PNS_SETTINGS::OnOkClick( wxCommandEvent& aEvent )
     m_settings.SetOptimizerEffort( (PNS::PNS_OPTIMIZATION_EFFORT) m_effort->GetValue() );
     m_settings.SetSmoothDraggedSegments( m_smoothDragged->GetValue() );
     m_settings.SetCanViolateDRC( m_violateDrc->GetValue() );
+    m_settings.SetSpeculativeRouting( m_speculative->GetValue() );
     m_settings.SetFreeAngleMode( m_freeAngleMode->GetValue() );
     m_settings.SetInlineDragEnabled( m_dragToolMode->GetSelection () ? true : false );
 
@@ -86,6 +88,9 @@ void DIALOG_PNS_SETTINGS::onModeChange( wxCommandEvent& aEvent )
     {
         m_freeAngleMode->Enable();
         m_violateDrc->Enable();
+
+        // Nothing is walked around when highlighting the collisions
+        m_speculative->Enable( false );
     }
     else
     {
@@ -94,5 +99,7 @@ void DIALOG_PNS_SETTINGS::onModeChange( wxCommandEvent& aEvent )
 
         m_violateDrc->SetValue( false );
         m_violateDrc->Enable( false );
+
+        m_speculative->Enable();
     }
 }
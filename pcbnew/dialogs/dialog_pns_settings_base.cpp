@@ -78,6 +78,11 @@ DIALOG_PNS_SETTINGS_BASE::DIALOG_PNS_SETTINGS_BASE( wxWindow* parent, wxWindowID
 	
 	bOptions->Add( m_violateDrc, 0, wxTOP|wxRIGHT|wxLEFT, 5 );
 	
+	m_speculative = new wxCheckBox( bOptions->GetStaticBox(), wxID_ANY, _("Walk around in both directions at once"), wxDefaultPosition, wxDefaultSize, 0 );
+	m_speculative->SetToolTip( _("When enabled, the walkaround explores the clockwise and counter-clockwise paths on separate threads, and keeps the best optimized one instead of the first one found.") );
+	
+	bOptions->Add( m_speculative, 0, wxTOP|wxRIGHT|wxLEFT, 5 );
+	
 	m_suggestEnding = new wxCheckBox( bOptions->GetStaticBox(), wxID_ANY, _("Suggest track finish"), wxDefaultPosition, wxDefaultSize, 0 );
 	m_suggestEnding->Enable( false );
 	
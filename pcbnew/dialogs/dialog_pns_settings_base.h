@@ -49,6 +49,7 @@ class DIALOG_PNS_SETTINGS_BASE : public DIALOG_SHIM
 		wxCheckBox* m_smartPads;
 		wxCheckBox* m_smoothDragged;
 		wxCheckBox* m_violateDrc;
+		wxCheckBox* m_speculative;
 		wxCheckBox* m_suggestEnding;
 		wxStaticLine* m_staticline1;
 		wxStaticText* m_effortLabel;
@@ -27,6 +27,11 @@
  * @file drc.cpp
  */
 
+#include <atomic>
+#include <ctime>
+#include <future>
+#include <thread>
+
 #include <fctsys.h>
 #include <pcb_edit_frame.h>
 #include <trigo.h>
@@ -55,7 +60,7 @@
 #include <pcb_netlist.h>
 
 #include <dialog_drc.h>
-#include <wx/progdlg.h>
+#include <widgets/progress_reporter.h>
 #include <board_commit.h>
 #include <geometry/shape_segment.h>
 #include <geometry/shape_arc.h>
@@ -103,9 +108,14 @@ void DRC::ShowDRCDialog( wxWindow* aParent )
 
 void DRC::addMarkerToPcb( MARKER_PCB* aMarker )
 {
+    // DRC workers only collect their markers
+    if( m_markerSink )
+    {
+        m_markerSink->push_back( aMarker );
+    }
     // In legacy routing mode, do not add markers to the board.
     // only shows the drc error message
-    if( m_drcInLegacyRoutingMode )
+    else if( m_drcInLegacyRoutingMode )
     {
         m_pcbEditorFrame->SetMsgPanel( aMarker );
         delete aMarker;
@@ -120,6 +130,107 @@ void DRC::addMarkerToPcb( MARKER_PCB* aMarker )
 }
 
 
+void DRC::addMarkersToPcb( std::vector<MARKER_PCB*>& aMarkers )
+{
+    if( m_markerSink )
+    {
+        m_markerSink->insert( m_markerSink->end(), aMarkers.begin(), aMarkers.end() );
+    }
+    else if( m_drcInLegacyRoutingMode )
+    {
+        while( aMarkers.size() > 0 )
+        {
+            m_pcbEditorFrame->SetMsgPanel( aMarkers.back() );
+            delete aMarkers.back();
+            aMarkers.pop_back();
+        }
+    }
+    else if( aMarkers.size() > 0 )
+    {
+        BOARD_COMMIT commit( m_pcbEditorFrame );
+
+        for( MARKER_PCB* marker : aMarkers )
+            commit.Add( marker );
+
+        commit.Push( wxEmptyString, false, false );
+    }
+
+    aMarkers.clear();
+}
+
+
+void DRC::runJobs( const std::vector<DRC_JOB>& aJobs, PROGRESS_REPORTER* aReporter )
+{
+    std::vector<std::vector<MARKER_PCB*>> jobMarkers( aJobs.size() );
+    std::atomic<size_t> nextJob( 0 );
+    std::atomic<bool>   cancelled( false );
+    size_t              threadCount = m_maxThreadCount ? m_maxThreadCount
+                                                       : std::thread::hardware_concurrency();
+    size_t              parallelThreadCount = std::min<size_t>(
+            std::max<size_t>( threadCount, 1 ), aJobs.size() );
+    std::vector<std::future<size_t>> returns( parallelThreadCount );
+    EDA_UNITS_T         units = userUnits();
+
+    auto job_lambda = [&]() -> size_t
+    {
+        // Each thread works with its own DRC object: the test functions store the
+        // geometry of the item under test in DRC members.
+        DRC worker( m_pcb, units );
+
+        worker.m_board_outlines = m_board_outlines;
+        worker.m_doZonesTest = m_doZonesTest;
+        worker.m_reportAllTrackErrors = m_reportAllTrackErrors;
+
+        size_t num = 0;
+
+        for( size_t i = nextJob++; i < aJobs.size(); i = nextJob++ )
+        {
+            if( cancelled )
+                continue;
+
+            worker.m_markerSink = &jobMarkers[i];
+            aJobs[i]( worker );
+
+            if( aReporter )
+                aReporter->AdvanceProgress();
+
+            num++;
+        }
+
+        return num;
+    };
+
+    if( parallelThreadCount <= 1 )
+        job_lambda();
+    else
+    {
+        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+            returns[ii] = std::async( std::launch::async, job_lambda );
+
+        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+        {
+            // Here we balance returns with a 100ms timeout to allow UI updating
+            std::future_status status;
+            do
+            {
+                if( aReporter && !aReporter->KeepRefreshing() )
+                    cancelled = true;
+
+                status = returns[ii].wait_for( std::chrono::milliseconds( 100 ) );
+            } while( status != std::future_status::ready );
+        }
+    }
+
+    // Merge the markers in job order
+    std::vector<MARKER_PCB*> markers;
+
+    for( std::vector<MARKER_PCB*>& list : jobMarkers )
+        markers.insert( markers.end(), list.begin(), list.end() );
+
+    addMarkersToPcb( markers );
+}
+
+
 void DRC::DestroyDRCDialog( int aReason )
 {
     if( m_drcDialog )
@@ -136,6 +247,28 @@ DRC::DRC( PCB_EDIT_FRAME* aPcbWindow )
 {
     m_pcbEditorFrame = aPcbWindow;
     m_pcb = aPcbWindow->GetBoard();
+    m_units = aPcbWindow->GetUserUnits();
+
+    init();
+
+    m_markerFactory.SetUnitsProvider( [=]() { return aPcbWindow->GetUserUnits(); } );
+}
+
+
+DRC::DRC( BOARD* aBoard, EDA_UNITS_T aUnits )
+{
+    m_pcbEditorFrame = nullptr;
+    m_pcb = aBoard;
+    m_units = aUnits;
+
+    init();
+
+    m_markerFactory.SetUnits( aUnits );
+}
+
+
+void DRC::init()
+{
     m_drcDialog  = NULL;
 
     // establish initial values for everything:
@@ -151,10 +284,15 @@ DRC::DRC( PCB_EDIT_FRAME* aPcbWindow )
     m_drcRun = false;
     m_footprintsTested = false;
 
+    m_doIncrementalTest = false;
+    m_incrementalTestRunning = false;
+    m_maxThreadCount = 0;
+
     m_doCreateRptFile = false;
     // m_rptFilename set to empty by its constructor
 
     m_currentMarker = NULL;
+    m_markerSink = nullptr;
 
     m_segmAngle  = 0;
     m_segmLength = 0;
@@ -163,8 +301,12 @@ DRC::DRC( PCB_EDIT_FRAME* aPcbWindow )
     m_ycliplo = 0;
     m_xcliphi = 0;
     m_ycliphi = 0;
+}
 
-    m_markerFactory.SetUnitsProvider( [=]() { return aPcbWindow->GetUserUnits(); } );
+
+EDA_UNITS_T DRC::userUnits() const
+{
+    return m_pcbEditorFrame ? m_pcbEditorFrame->GetUserUnits() : m_units;
 }
 
 
@@ -188,8 +330,13 @@ int DRC::DrcOnCreatingTrack( TRACK* aRefSegm, TRACK* aList )
     int rpt_state = m_reportAllTrackErrors;
     m_reportAllTrackErrors = false;
 
+    std::vector<TRACK*> tracks;
+
+    for( TRACK* track = aList; track; track = track->Next() )
+        tracks.push_back( track );
+
     // Test new segment against tracks and pads, not against copper zones
-    if( !doTrackDrc( aRefSegm, aList, true, false ) )
+    if( !doTrackDrc( aRefSegm, tracks, m_pcb->GetPads(), false ) )
     {
         if( m_currentMarker )
         {
@@ -225,8 +372,8 @@ int DRC::DrcOnCreatingTrack( TRACK* aRefSegm, TRACK* aList )
 
 int DRC::TestZoneToZoneOutline( ZONE_CONTAINER* aZone, bool aCreateMarkers )
 {
-    BOARD* board = m_pcbEditorFrame->GetBoard();
-    BOARD_COMMIT commit( m_pcbEditorFrame );
+    BOARD* board = m_pcb;
+    std::vector<MARKER_PCB*> markers;
     int nerrors = 0;
 
     std::vector<SHAPE_POLY_SET> smoothed_polys;
@@ -296,7 +443,7 @@ int DRC::TestZoneToZoneOutline( ZONE_CONTAINER* aZone, bool aCreateMarkers )
                 if( smoothed_polys[ia2].Contains( currentVertex ) )
                 {
                     if( aCreateMarkers )
-                        commit.Add( m_markerFactory.NewMarker(
+                        markers.push_back( m_markerFactory.NewMarker(
                                 pt, zoneRef, zoneToTest, DRCE_ZONES_INTERSECT ) );
 
                     nerrors++;
@@ -312,7 +459,7 @@ int DRC::TestZoneToZoneOutline( ZONE_CONTAINER* aZone, bool aCreateMarkers )
                 if( smoothed_polys[ia].Contains( currentVertex ) )
                 {
                     if( aCreateMarkers )
-                        commit.Add( m_markerFactory.NewMarker(
+                        markers.push_back( m_markerFactory.NewMarker(
                                 pt, zoneToTest, zoneRef, DRCE_ZONES_INTERSECT ) );
 
                     nerrors++;
@@ -361,7 +508,7 @@ int DRC::TestZoneToZoneOutline( ZONE_CONTAINER* aZone, bool aCreateMarkers )
             for( wxPoint pt : conflictPoints )
             {
                 if( aCreateMarkers )
-                    commit.Add( m_markerFactory.NewMarker(
+                    markers.push_back( m_markerFactory.NewMarker(
                             pt, zoneRef, zoneToTest, DRCE_ZONES_TOO_CLOSE ) );
 
                 nerrors++;
@@ -370,7 +517,7 @@ int DRC::TestZoneToZoneOutline( ZONE_CONTAINER* aZone, bool aCreateMarkers )
     }
 
     if( aCreateMarkers )
-        commit.Push( wxEmptyString, false, false );
+        addMarkersToPcb( markers );
 
     return nerrors;
 }
@@ -433,30 +580,10 @@ void DRC::RunTests( wxTextCtrl* aMessages )
         return;
     }
 
-    // test pad to pad clearances, nothing to do with tracks, vias or zones.
-    if( m_doPad2PadTest )
-    {
-        if( aMessages )
-        {
-            aMessages->AppendText( _( "Pad clearances...\n" ) );
-            wxSafeYield();
-        }
-
-        testPad2Pad();
-    }
-
-    // test clearances between drilled holes
-    if( aMessages )
-    {
-        aMessages->AppendText( _( "Drill clearances...\n" ) );
-        wxSafeYield();
-    }
-
-    testDrilledHoles();
-
     // caller (a wxTopLevelFrame) is the wxDialog or the Pcb Editor frame that call DRC:
     wxWindow* caller = aMessages ? aMessages->GetParent() : m_pcbEditorFrame;
 
+    // The zone fills must be up to date before the clearance tests
     if( m_refillZones )
     {
         if( aMessages )
@@ -472,68 +599,58 @@ void DRC::RunTests( wxTextCtrl* aMessages )
         m_pcbEditorFrame->Check_All_Zones( caller );
     }
 
-    // test track and via clearances to other tracks, pads, and vias
-    if( aMessages )
-    {
-        aMessages->AppendText( _( "Track clearances...\n" ) );
-        wxSafeYield();
-    }
+    // The following tests only read the board and the caches built before they run, and
+    // each of them only creates markers.  They are queued as jobs and run concurrently.
+    // The zone outlines are shared by the jobs: they must only be queried (or chamfered,
+    // which builds a copy), as any change to them drops their spatial index under the
+    // other jobs.
+    std::vector<CLEARANCE_TEST> tests;
+    std::vector<DRC_JOB>        jobs;
 
-    testTracks( aMessages ? aMessages->GetParent() : m_pcbEditorFrame, true );
+    buildClearanceTests( tests );
 
-    // test zone clearances to other zones
-    if( aMessages )
+    for( CLEARANCE_TEST& test : tests )
     {
-        aMessages->AppendText( _( "Zone to zone clearances...\n" ) );
-        wxSafeYield();
+        if( aMessages )
+            aMessages->AppendText( test.m_message );
+
+        jobs.insert( jobs.end(), test.m_jobs.begin(), test.m_jobs.end() );
     }
 
-    testZones();
+    if( aMessages )
+        wxSafeYield();
 
-    // find and gather unconnected pads.
-    if( m_doUnconnectedTest )
     {
-        if( aMessages )
-        {
-            aMessages->AppendText( _( "Unconnected pads...\n" ) );
-            aMessages->Refresh();
-        }
+        WX_PROGRESS_REPORTER reporter( caller, _( "Design Rules Check" ), 1 );
+        reporter.Report( _( "Testing clearances..." ) );
+        reporter.SetMaxProgress( jobs.size() );
 
-        testUnconnected();
+        runJobs( jobs, &reporter );
     }
 
-    // find and gather vias, tracks, pads inside keepout areas.
-    if( m_doKeepoutTest )
+    // find overlapping courtyard ares.  This test rebuilds the courtyard polygons of the
+    // footprints, so it runs after the concurrent tests.
+    if( courtyardTestEnabled() )
     {
         if( aMessages )
         {
-            aMessages->AppendText( _( "Keepout areas ...\n" ) );
+            aMessages->AppendText( _( "Courtyard areas...\n" ) );
             aMessages->Refresh();
         }
 
-        testKeepoutAreas();
-    }
-
-    // find and gather vias, tracks, pads inside text boxes.
-    if( aMessages )
-    {
-        aMessages->AppendText( _( "Text and graphic clearances...\n" ) );
-        wxSafeYield();
+        doFootprintOverlappingDrc();
     }
 
-    testCopperTextAndGraphics();
-
-    // find overlapping courtyard ares.
-    if( m_pcb->GetDesignSettings().m_ProhibitOverlappingCourtyards
-        || m_pcb->GetDesignSettings().m_RequireCourtyards )
+    // find and gather unconnected pads.
+    if( m_doUnconnectedTest )
     {
         if( aMessages )
         {
-            aMessages->AppendText( _( "Courtyard areas...\n" ) );
+            aMessages->AppendText( _( "Unconnected pads...\n" ) );
             aMessages->Refresh();
         }
 
-        doFootprintOverlappingDrc();
+        testUnconnected();
     }
 
     for( DRC_ITEM* footprintItem : m_footprints )
@@ -583,6 +700,107 @@ void DRC::RunTests( wxTextCtrl* aMessages )
 }
 
 
+void DRC::buildClearanceTests( std::vector<CLEARANCE_TEST>& aTests )
+{
+    auto newTest = [&]( const std::string& aName, const wxString& aMessage ) -> CLEARANCE_TEST&
+    {
+        aTests.push_back( { aName, aMessage, {} } );
+        return aTests.back();
+    };
+
+    // test pad to pad clearances, nothing to do with tracks, vias or zones.
+    if( m_doPad2PadTest )
+        testPad2Pad( newTest( "pad_clearances", _( "Pad clearances...\n" ) ).m_jobs );
+
+    // test clearances between drilled holes
+    newTest( "drill_clearances", _( "Drill clearances...\n" ) ).m_jobs.push_back(
+            []( DRC& aWorker ) { aWorker.testDrilledHoles(); } );
+
+    // test track and via clearances to other tracks, pads, and vias
+    testTracks( newTest( "track_clearances", _( "Track clearances...\n" ) ).m_jobs );
+
+    // test zone clearances to other zones
+    newTest( "zone_clearances", _( "Zone to zone clearances...\n" ) ).m_jobs.push_back(
+            []( DRC& aWorker ) { aWorker.testZones(); } );
+
+    // find and gather vias, tracks, pads inside keepout areas.
+    if( m_doKeepoutTest )
+    {
+        newTest( "keepout_areas", _( "Keepout areas ...\n" ) ).m_jobs.push_back(
+                []( DRC& aWorker ) { aWorker.testKeepoutAreas(); } );
+    }
+
+    // find and gather vias, tracks, pads inside text boxes.
+    newTest( "text_clearances", _( "Text and graphic clearances...\n" ) ).m_jobs.push_back(
+            []( DRC& aWorker ) { aWorker.testCopperTextAndGraphics(); } );
+}
+
+
+bool DRC::courtyardTestEnabled() const
+{
+    return m_pcb->GetDesignSettings().m_ProhibitOverlappingCourtyards
+           || m_pcb->GetDesignSettings().m_RequireCourtyards;
+}
+
+
+void DRC::RunTestsHeadless( const DRC_PROVIDER::MARKER_HANDLER& aHandler, DRC_TIMINGS* aTimings )
+{
+    std::vector<MARKER_PCB*> markers;
+
+    // Run a test and record its duration
+    auto timeTest = [&]( const std::string& aName, const std::function<void()>& aTest )
+    {
+        auto         wallStart = std::chrono::steady_clock::now();
+        std::clock_t cpuStart = std::clock();
+
+        aTest();
+
+        if( aTimings )
+        {
+            double cpuTime = double( std::clock() - cpuStart ) / CLOCKS_PER_SEC;
+
+            aTimings->push_back( { aName,
+                    std::chrono::duration_cast<std::chrono::microseconds>(
+                            std::chrono::steady_clock::now() - wallStart ),
+                    std::chrono::microseconds( (long long) ( cpuTime * 1e6 ) ) } );
+        }
+    };
+
+    m_markerSink = &markers;
+
+    timeTest( "outline", [&]() { testOutline(); } );
+
+    bool netclassesOk = true;
+
+    timeTest( "netclasses", [&]() { netclassesOk = testNetClasses(); } );
+
+    // Same as RunTests(): all the items of a netclass would fail the next tests
+    if( netclassesOk )
+    {
+        std::vector<CLEARANCE_TEST> tests;
+
+        buildClearanceTests( tests );
+
+        // Each test is run on its own, to get its duration
+        for( const CLEARANCE_TEST& test : tests )
+            timeTest( test.m_name, [&]() { runJobs( test.m_jobs, nullptr ); } );
+
+        if( courtyardTestEnabled() )
+            timeTest( "courtyards", [&]() { doFootprintOverlappingDrc(); } );
+
+        if( m_doUnconnectedTest )
+            timeTest( "unconnected", [&]() { testUnconnected(); } );
+
+        timeTest( "disabled_layers", [&]() { testDisabledLayers(); } );
+    }
+
+    m_markerSink = nullptr;
+
+    for( MARKER_PCB* marker : markers )
+        aHandler( marker );
+}
+
+
 void DRC::updatePointers()
 {
     // update my pointers, m_pcbEditorFrame is the only unchangeable one
@@ -608,7 +826,7 @@ bool DRC::doNetClass( const NETCLASSPTR& nc, wxString& msg )
 
     const BOARD_DESIGN_SETTINGS& g = m_pcb->GetDesignSettings();
 
-#define FmtVal( x ) GetChars( StringFromValue( m_pcbEditorFrame->GetUserUnits(), x ) )
+#define FmtVal( x ) GetChars( StringFromValue( userUnits(), x ) )
 
 #if 0   // set to 1 when (if...) BOARD_DESIGN_SETTINGS has a m_MinClearance value
     if( nc->GetClearance() < g.m_MinClearance )
@@ -710,46 +928,64 @@ bool DRC::testNetClasses()
 }
 
 
-void DRC::testPad2Pad()
+void DRC::testPad2Pad( std::vector<DRC_JOB>& aJobs )
 {
-    std::vector<D_PAD*> sortedPads;
+    auto sortedPads = std::make_shared<std::vector<D_PAD*>>();
 
-    m_pcb->GetSortedPadListByXthenYCoord( sortedPads );
+    m_pcb->GetSortedPadListByXthenYCoord( *sortedPads );
 
-    if( sortedPads.size() == 0 )
+    if( sortedPads->size() == 0 )
         return;
 
     // find the max size of the pads (used to stop the test)
     int max_size = 0;
 
-    for( unsigned i = 0; i < sortedPads.size(); ++i )
+    for( unsigned i = 0; i < sortedPads->size(); ++i )
     {
-        D_PAD* pad = sortedPads[i];
+        D_PAD* pad = (*sortedPads)[i];
 
         // GetBoundingRadius() is the radius of the minimum sized circle fully containing the pad
+        // Note: it is cached by the pad, so this also computes it before the jobs are run
         int radius = pad->GetBoundingRadius();
 
         if( radius > max_size )
             max_size = radius;
     }
 
-    // Upper limit of pad list (limit not included)
-    D_PAD** listEnd = &sortedPads[0] + sortedPads.size();
+    // Each job tests a strip of pads against all the pads following them in the list
+    const size_t stripSize = 500;
 
-    // Test the pads
-    for( unsigned i = 0; i< sortedPads.size(); ++i )
+    for( size_t first = 0; first < sortedPads->size(); first += stripSize )
     {
-        D_PAD* pad = sortedPads[i];
-
-        int    x_limit = max_size + pad->GetClearance() +
-                         pad->GetBoundingRadius() + pad->GetPosition().x;
+        size_t last = std::min( first + stripSize, sortedPads->size() );
 
-        if( !doPadToPadsDrc( pad, &sortedPads[i], listEnd, x_limit ) )
+        aJobs.push_back( [sortedPads, first, last, max_size]( DRC& aWorker )
         {
-            wxASSERT( m_currentMarker );
-            addMarkerToPcb ( m_currentMarker );
-            m_currentMarker = nullptr;
-        }
+            // Upper limit of pad list (limit not included)
+            D_PAD** listEnd = &(*sortedPads)[0] + sortedPads->size();
+
+            // The pad used to test the holes.  A pad must have a parent because some
+            // functions expect a non null parent to find the parent board.
+            MODULE  holeModule( aWorker.m_pcb );
+            D_PAD   holePad( &holeModule );
+
+            // Test the pads
+            for( size_t i = first; i < last; ++i )
+            {
+                D_PAD* pad = (*sortedPads)[i];
+
+                int    x_limit = max_size + pad->GetClearance() +
+                                 pad->GetBoundingRadius() + pad->GetPosition().x;
+
+                if( !aWorker.doPadToPadsDrc( pad, &(*sortedPads)[i], listEnd, x_limit,
+                                             holePad ) )
+                {
+                    wxASSERT( aWorker.m_currentMarker );
+                    aWorker.addMarkerToPcb( aWorker.m_currentMarker );
+                    aWorker.m_currentMarker = nullptr;
+                }
+            }
+        } );
     }
 }
 
@@ -817,7 +1053,7 @@ void DRC::testDrilledHoles()
             if( KiROUND( GetLineLength( checkHole.m_location, refHole.m_location ) )
                     <  checkHole.m_drillRadius + refHole.m_drillRadius + holeToHoleMin )
             {
-                addMarkerToPcb( new MARKER_PCB( m_pcbEditorFrame->GetUserUnits(),
+                addMarkerToPcb( new MARKER_PCB( userUnits(),
                                                 DRCE_DRILLED_HOLES_TOO_CLOSE, refHole.m_location,
                                                 refHole.m_owner, refHole.m_location,
                                                 checkHole.m_owner, checkHole.m_location ) );
@@ -827,63 +1063,119 @@ void DRC::testDrilledHoles()
 }
 
 
-void DRC::testTracks( wxWindow *aActiveWindow, bool aShowProgressBar )
+EDA_RECT DRC::padBoundingBox( const D_PAD* aPad )
 {
-    wxProgressDialog * progressDialog = NULL;
-    const int delta = 500;  // This is the number of tests between 2 calls to the
-                            // progress bar
-    int count = 0;
+    EDA_RECT bbox( aPad->ShapePos(), wxSize( 0, 0 ) );
+    bbox.Inflate( aPad->GetBoundingRadius() );
 
-    for( TRACK* segm = m_pcb->m_Track; segm && segm->Next(); segm = segm->Next() )
-        count++;
+    if( aPad->GetDrillSize().x )
+    {
+        EDA_RECT hole( aPad->GetPosition(), wxSize( 0, 0 ) );
+        hole.Inflate( std::max( aPad->GetDrillSize().x, aPad->GetDrillSize().y ) / 2 );
+        bbox.Merge( hole );
+    }
+
+    return bbox;
+}
 
-    int deltamax = count/delta;
 
-    if( aShowProgressBar && deltamax > 3 )
+void DRC::buildClearanceIndex( CLEARANCE_INDEX& aIndex )
+{
+    for( TRACK* segm : m_pcb->Tracks() )
+        aIndex.m_tracks.push_back( segm );
+
+    // Sort the tracks by X coordinate, so a range of consecutive tracks is a vertical strip
+    // of the board.  The sort is stable to keep the result independent of the sort algorithm.
+    std::stable_sort( aIndex.m_tracks.begin(), aIndex.m_tracks.end(),
+            []( const TRACK* a, const TRACK* b )
+            {
+                return std::min( a->GetStart().x, a->GetEnd().x )
+                        < std::min( b->GetStart().x, b->GetEnd().x );
+            } );
+
+    aIndex.m_pads = m_pcb->GetPads();
+
+    // Items are stored by their index in the lists, so query results come back in list order.
+    // The search area around each item is the biggest clearance in use on the board.
+    aIndex.m_maxClearance = m_pcb->GetDesignSettings().GetBiggestClearanceValue();
+
+    for( int ii = 0; ii < (int) aIndex.m_tracks.size(); ++ii )
+    {
+        TRACK* segm = aIndex.m_tracks[ii];
+
+        aIndex.m_trackTree.Insert( ii, segm->GetBoundingBox(), segm->GetLayerSet() );
+        aIndex.m_maxClearance = std::max( aIndex.m_maxClearance, segm->GetClearance() );
+    }
+
+    for( int ii = 0; ii < (int) aIndex.m_pads.size(); ++ii )
     {
-        // Do not use wxPD_APP_MODAL style here: it is not necessary and create issues
-        // on OSX
-        progressDialog = new wxProgressDialog( _( "Track clearances" ), wxEmptyString,
-                                               deltamax, aActiveWindow,
-                                               wxPD_AUTO_HIDE | wxPD_CAN_ABORT | wxPD_ELAPSED_TIME );
-        progressDialog->Update( 0, wxEmptyString );
+        D_PAD* pad = aIndex.m_pads[ii];
+
+        // The pad hole is tested on all copper layers, even if the pad is not
+        LSET layers = pad->GetDrillSize().x ? LSET::AllCuMask() : pad->GetLayerSet();
+
+        aIndex.m_padTree.Insert( ii, padBoundingBox( pad ), layers );
+        aIndex.m_maxClearance = std::max( aIndex.m_maxClearance, pad->GetClearance() );
     }
+}
+
+
+void DRC::testTracks( std::vector<DRC_JOB>& aJobs )
+{
+    // The index is shared by all the track test jobs
+    auto data = std::make_shared<CLEARANCE_INDEX>();
+
+    buildClearanceIndex( *data );
 
-    int ii = 0;
-    count = 0;
+    // Each job tests a strip of tracks
+    const int stripSize = 1000;
 
-    for( TRACK* segm = m_pcb->m_Track; segm; segm = segm->Next() )
+    for( int first = 0; first < (int) data->m_tracks.size(); first += stripSize )
     {
-        if( ii++ > delta )
+        int last = std::min( first + stripSize, (int) data->m_tracks.size() );
+
+        aJobs.push_back( [data, first, last]( DRC& aWorker )
         {
-            ii = 0;
-            count++;
+            std::vector<int>    hits;
+            std::vector<TRACK*> nearTracks;
+            std::vector<D_PAD*> nearPads;
 
-            if( progressDialog )
+            for( int idx = first; idx < last; ++idx )
             {
-                if( !progressDialog->Update( count, wxEmptyString ) )
-                    break;  // Aborted by user
-#ifdef __WXMAC__
-                // Work around a dialog z-order issue on OS X
-                if( count == deltamax )
-                    aActiveWindow->Raise();
-#endif
-            }
-        }
+                TRACK*   segm = data->m_tracks[idx];
+                EDA_RECT area = segm->GetBoundingBox();
 
-        // Test new segment against tracks and pads, optionally against copper zones
-        if( !doTrackDrc( segm, segm->Next(), true, m_doZonesTest ) )
-        {
-            if( m_currentMarker )
-            {
-                addMarkerToPcb ( m_currentMarker );
-                m_currentMarker = nullptr;
+                area.Inflate( data->m_maxClearance );
+
+                // Each pair of tracks is tested only once: only the tracks following the
+                // reference segment in the list are candidates
+                data->m_trackTree.Query( area, segm->GetLayerSet(), hits );
+                nearTracks.clear();
+
+                for( int hit : hits )
+                {
+                    if( hit > idx )
+                        nearTracks.push_back( data->m_tracks[hit] );
+                }
+
+                data->m_padTree.Query( area, segm->GetLayerSet(), hits );
+                nearPads.clear();
+
+                for( int hit : hits )
+                    nearPads.push_back( data->m_pads[hit] );
+
+                // Test new segment against tracks and pads, optionally against copper zones
+                if( !aWorker.doTrackDrc( segm, nearTracks, nearPads, aWorker.m_doZonesTest ) )
+                {
+                    if( aWorker.m_currentMarker )
+                    {
+                        aWorker.addMarkerToPcb( aWorker.m_currentMarker );
+                        aWorker.m_currentMarker = nullptr;
+                    }
+                }
             }
-        }
+        } );
     }
-
-    if( progressDialog )
-        progressDialog->Destroy();
 }
 
 
@@ -908,7 +1200,7 @@ void DRC::testUnconnected()
         auto src = edge.GetSourcePos();
         auto dst = edge.GetTargetPos();
 
-        m_unconnected.emplace_back( new DRC_ITEM( m_pcbEditorFrame->GetUserUnits(),
+        m_unconnected.emplace_back( new DRC_ITEM( userUnits(),
                                                   DRCE_UNCONNECTED_ITEMS,
                                                   edge.GetSourceNode()->Parent(),
                                                   wxPoint( src.x, src.y ),
@@ -967,39 +1259,42 @@ void DRC::testKeepoutAreas()
             continue;
         }
 
-        for( TRACK* segm = m_pcb->m_Track; segm != NULL; segm = segm->Next() )
-        {
-            if( segm->Type() == PCB_TRACE_T )
-            {
-                if( !area->GetDoNotAllowTracks()  )
-                    continue;
+        for( TRACK* segm : m_pcb->Tracks() )
+            testTrackInKeepout( segm, area );
 
-                // Ignore if the keepout zone is not on the same layer
-                if( !area->IsOnLayer( segm->GetLayer() ) )
-                    continue;
+        // Test pads: TODO
+    }
+}
 
-                SEG trackSeg( segm->GetStart(), segm->GetEnd() );
 
-                if( area->Outline()->Distance( trackSeg, segm->GetWidth() ) == 0 )
-                    addMarkerToPcb(
-                            m_markerFactory.NewMarker( segm, area, DRCE_TRACK_INSIDE_KEEPOUT ) );
-            }
-            else if( segm->Type() == PCB_VIA_T )
-            {
-                if( ! area->GetDoNotAllowVias()  )
-                    continue;
+void DRC::testTrackInKeepout( TRACK* aSegm, ZONE_CONTAINER* aArea )
+{
+    if( aSegm->Type() == PCB_TRACE_T )
+    {
+        if( !aArea->GetDoNotAllowTracks()  )
+            return;
 
-                auto viaLayers = segm->GetLayerSet();
+        // Ignore if the keepout zone is not on the same layer
+        if( !aArea->IsOnLayer( aSegm->GetLayer() ) )
+            return;
 
-                if( !area->CommonLayerExists( viaLayers ) )
-                    continue;
+        SEG trackSeg( aSegm->GetStart(), aSegm->GetEnd() );
 
-                if( area->Outline()->Distance( segm->GetPosition() ) < segm->GetWidth()/2 )
-                    addMarkerToPcb(
-                            m_markerFactory.NewMarker( segm, area, DRCE_VIA_INSIDE_KEEPOUT ) );
-            }
-        }
-        // Test pads: TODO
+        if( aArea->Outline()->Distance( trackSeg, aSegm->GetWidth() ) == 0 )
+            addMarkerToPcb( m_markerFactory.NewMarker( aSegm, aArea, DRCE_TRACK_INSIDE_KEEPOUT ) );
+    }
+    else if( aSegm->Type() == PCB_VIA_T )
+    {
+        if( ! aArea->GetDoNotAllowVias()  )
+            return;
+
+        auto viaLayers = aSegm->GetLayerSet();
+
+        if( !aArea->CommonLayerExists( viaLayers ) )
+            return;
+
+        if( aArea->Outline()->Distance( aSegm->GetPosition() ) < aSegm->GetWidth()/2 )
+            addMarkerToPcb( m_markerFactory.NewMarker( aSegm, aArea, DRCE_VIA_INSIDE_KEEPOUT ) );
     }
 }
 
@@ -1007,15 +1302,21 @@ void DRC::testKeepoutAreas()
 void DRC::testCopperTextAndGraphics()
 {
     // Test copper items for clearance violations with vias, tracks and pads
+    for( BOARD_ITEM* item : copperTextAndGraphics() )
+        testCopperItem( item );
+}
+
+
+std::vector<BOARD_ITEM*> DRC::copperTextAndGraphics() const
+{
+    std::vector<BOARD_ITEM*> items;
 
     for( BOARD_ITEM* brdItem : m_pcb->Drawings() )
     {
         if( IsCopperLayer( brdItem->GetLayer() ) )
         {
-            if( brdItem->Type() == PCB_TEXT_T )
-                testCopperTextItem( brdItem );
-            else if( brdItem->Type() == PCB_LINE_T )
-                testCopperDrawItem( static_cast<DRAWSEGMENT*>( brdItem ));
+            if( brdItem->Type() == PCB_TEXT_T || brdItem->Type() == PCB_LINE_T )
+                items.push_back( brdItem );
         }
     }
 
@@ -1025,25 +1326,36 @@ void DRC::testCopperTextAndGraphics()
         TEXTE_MODULE& val = module->Value();
 
         if( ref.IsVisible() && IsCopperLayer( ref.GetLayer() ) )
-            testCopperTextItem( &ref );
+            items.push_back( &ref );
 
         if( val.IsVisible() && IsCopperLayer( val.GetLayer() ) )
-            testCopperTextItem( &val );
+            items.push_back( &val );
 
         if( module->IsNetTie() )
             continue;
 
-        for( BOARD_ITEM* item = module->GraphicalItemsList();  item;  item = item->Next() )
+        for( BOARD_ITEM* item : module->GraphicalItems() )
         {
             if( IsCopperLayer( item->GetLayer() ) )
             {
                 if( item->Type() == PCB_MODULE_TEXT_T && ( (TEXTE_MODULE*) item )->IsVisible() )
-                    testCopperTextItem( item );
+                    items.push_back( item );
                 else if( item->Type() == PCB_MODULE_EDGE_T )
-                    testCopperDrawItem( static_cast<DRAWSEGMENT*>( item ));
+                    items.push_back( item );
             }
         }
     }
+
+    return items;
+}
+
+
+void DRC::testCopperItem( BOARD_ITEM* aItem )
+{
+    if( aItem->Type() == PCB_LINE_T || aItem->Type() == PCB_MODULE_EDGE_T )
+        testCopperDrawItem( static_cast<DRAWSEGMENT*>( aItem ) );
+    else
+        testCopperTextItem( aItem );
 }
 
 
@@ -1103,7 +1415,7 @@ void DRC::testCopperDrawItem( DRAWSEGMENT* aItem )
     }
 
     // Test tracks and vias
-    for( TRACK* track = m_pcb->m_Track; track != NULL; track = track->Next() )
+    for( TRACK* track : m_pcb->Tracks() )
     {
         if( !track->IsOnLayer( aItem->GetLayer() ) )
             continue;
@@ -1171,7 +1483,7 @@ void DRC::testCopperTextItem( BOARD_ITEM* aTextItem )
     SHAPE_RECT rect_area( bbox.GetX(), bbox.GetY(), bbox.GetWidth(), bbox.GetHeight() );
 
     // Test tracks and vias
-    for( TRACK* track = m_pcb->m_Track; track != NULL; track = track->Next() )
+    for( TRACK* track : m_pcb->Tracks() )
     {
         if( !track->IsOnLayer( aTextItem->GetLayer() ) )
             continue;
@@ -1249,7 +1561,7 @@ void DRC::testOutline()
 
 void DRC::testDisabledLayers()
 {
-    BOARD* board = m_pcbEditorFrame->GetBoard();
+    BOARD* board = m_pcb;
     wxCHECK( board, /*void*/ );
     LSET disabledLayers = board->GetEnabledLayers().flip();
 
@@ -1333,7 +1645,8 @@ bool DRC::doTrackKeepoutDrc( TRACK* aRefSeg )
 }
 
 
-bool DRC::doPadToPadsDrc( D_PAD* aRefPad, D_PAD** aStart, D_PAD** aEnd, int x_limit )
+bool DRC::doPadToPadsDrc( D_PAD* aRefPad, D_PAD** aStart, D_PAD** aEnd, int x_limit,
+                          D_PAD& aHolePad )
 {
     const static LSET all_cu = LSET::AllCuMask();
 
@@ -1342,11 +1655,8 @@ bool DRC::doPadToPadsDrc( D_PAD* aRefPad, D_PAD** aStart, D_PAD** aEnd, int x_li
     /* used to test DRC pad to holes: this dummy pad has the size and shape of the hole
      * to test pad to pad hole DRC, using the pad to pad DRC test function.
      * Therefore, this dummy pad is a circle or an oval.
-     * A pad must have a parent because some functions expect a non null parent
-     * to find the parent board, and some other data
      */
-    MODULE  dummymodule( m_pcb );    // Creates a dummy parent
-    D_PAD   dummypad( &dummymodule );
+    D_PAD&  dummypad = aHolePad;
 
     // Ensure the hole is on all copper layers
     dummypad.SetLayerSet( all_cu | dummypad.GetLayerSet() );
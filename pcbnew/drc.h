@@ -29,12 +29,18 @@
 #ifndef DRC_H
 #define DRC_H
 
+#include <chrono>
 #include <vector>
 #include <memory>
+#include <functional>
+#include <string>
+#include <unordered_map>
 #include <geometry/seg.h>
 #include <geometry/shape_poly_set.h>
 
 #include <drc/drc_marker_factory.h>
+#include <drc/drc_provider.h>
+#include <drc/drc_rtree.h>
 
 #define OK_DRC  0
 #define BAD_DRC 1
@@ -126,9 +132,11 @@ class NETCLASS;
 class EDA_TEXT;
 class DRAWSEGMENT;
 class NETLIST;
+class PROGRESS_REPORTER;
 class wxWindow;
 class wxString;
 class wxTextCtrl;
+struct REMOVED_BOARD_ITEM;
 
 
 /**
@@ -177,6 +185,20 @@ public:
 typedef std::vector<DRC_ITEM*> DRC_LIST;
 
 
+/**
+ * The time spent in one DRC test.  The CPU time is the time used by all the threads
+ * of the process, so it is larger than the wall-clock time for the parallel tests.
+ */
+struct DRC_TEST_TIMING
+{
+    std::string               m_testName;
+    std::chrono::microseconds m_wallTime;
+    std::chrono::microseconds m_cpuTime;
+};
+
+typedef std::vector<DRC_TEST_TIMING> DRC_TIMINGS;
+
+
 /**
  * Design Rule Checker object that performs all the DRC tests.  The output of
  * the checking goes to the BOARD file in the form of two MARKER lists.  Those
@@ -191,6 +213,58 @@ class DRC
 
 private:
 
+    /**
+     * A piece of DRC work which can run on a worker thread.  The job is given the DRC
+     * worker to run the tests with; the markers created by this worker are collected
+     * for the job instead of being added to the board.
+     */
+    typedef std::function<void( DRC& aWorker )> DRC_JOB;
+
+    /**
+     * The copper items taking part in the track and pad clearance tests, and their
+     * spatial index.  The trees store the indices of the items in the lists.
+     */
+    struct CLEARANCE_INDEX
+    {
+        std::vector<TRACK*> m_tracks;
+        std::vector<D_PAD*> m_pads;
+        DRC_RTREE<int>      m_trackTree;
+        DRC_RTREE<int>      m_padTree;
+        int                 m_maxClearance;     ///< The search distance around a tested item
+    };
+
+    /**
+     * The clearance index of the incremental test.  It is kept between the tests and
+     * updated with the items they are given.  A removed item leaves a null entry in its
+     * list, so the indices stored in the trees stay valid.
+     */
+    struct CHANGE_INDEX : public CLEARANCE_INDEX
+    {
+        /// The list index of an item, and the area and layers it is stored with in its tree
+        struct ENTRY
+        {
+            int      m_index;
+            EDA_RECT m_bbox;
+            LSET     m_layers;
+        };
+
+        typedef std::unordered_map<const void*, ENTRY> ENTRIES;
+
+        const BOARD* m_board;
+        ENTRIES      m_trackEntries;
+        ENTRIES      m_padEntries;
+    };
+
+    /**
+     * The jobs of one of the clearance tests.
+     */
+    struct CLEARANCE_TEST
+    {
+        std::string          m_name;        ///< identifier of the test in timing reports
+        wxString             m_message;     ///< activity message displayed for the test
+        std::vector<DRC_JOB> m_jobs;
+    };
+
     //  protected or private functions() are lowercase first character.
     bool     m_doPad2PadTest;           // enable pad to pad clearance tests
     bool     m_doUnconnectedTest;       // enable unconnected tests
@@ -237,16 +311,38 @@ private:
     int                 m_ycliphi;
 
     PCB_EDIT_FRAME*     m_pcbEditorFrame;   ///< The pcb frame editor which owns the board
+                                            ///< (null when running headless)
+    EDA_UNITS_T         m_units;            ///< The units of the messages when running headless
     BOARD*              m_pcb;
     SHAPE_POLY_SET      m_board_outlines;   ///< The board outline including cutouts
     DIALOG_DRC_CONTROL* m_drcDialog;
     DRC_MARKER_FACTORY  m_markerFactory; ///< Class that generates markers
 
+    ///> When not null, markers are stored in this list instead of being added to the board
+    std::vector<MARKER_PCB*>* m_markerSink;
+
     DRC_LIST            m_unconnected;      ///< list of unconnected pads, as DRC_ITEMs
     DRC_LIST            m_footprints;       ///< list of footprint warnings, as DRC_ITEMs
     bool                m_drcRun;
     bool                m_footprintsTested;
 
+    bool                m_doIncrementalTest;    ///< re-test the items changed by each commit
+    bool                m_incrementalTestRunning;
+    size_t              m_maxThreadCount;       ///< threads running the jobs, 0 for one per core
+
+    ///> The index of the incremental test, kept between its runs
+    std::unique_ptr<CHANGE_INDEX> m_changeIndex;
+
+
+    /**
+     * Initialize the settings to their default values.
+     */
+    void init();
+
+    /**
+     * @return the units to use in the messages: the ones of the editor, if any
+     */
+    EDA_UNITS_T userUnits() const;
 
     /**
      * Update needed pointers from the one pointer which is known not to change.
@@ -258,6 +354,53 @@ private:
      */
     void addMarkerToPcb( MARKER_PCB* aMarker );
 
+    /**
+     * Adds a list of DRC markers to the PCB through a single commit, and clears the list.
+     */
+    void addMarkersToPcb( std::vector<MARKER_PCB*>& aMarkers );
+
+    /**
+     * Run a list of independent DRC jobs on a pool of worker threads.
+     *
+     * Each thread owns a DRC worker sharing the board and the settings of this DRC.
+     * The markers of each job are collected in their own list, and all the lists are
+     * added to the board in job order once every job is finished, so the result does
+     * not depend on the thread scheduling.
+     * @param aJobs is the list of jobs to run
+     * @param aReporter is an optional progress reporter, advanced for each finished job.
+     * If the user cancels it, the jobs not yet started are skipped.
+     */
+    void runJobs( const std::vector<DRC_JOB>& aJobs, PROGRESS_REPORTER* aReporter );
+
+    /**
+     * Fill aIndex with the tracks and pads of the board, and build their spatial index.
+     * The tracks are sorted by X coordinate.
+     */
+    void buildClearanceIndex( CLEARANCE_INDEX& aIndex );
+
+    /**
+     * Bring m_changeIndex up to date with the changes given to the incremental test.
+     * The index is built from the board if there is none, or if it does not match the
+     * board after the changes.
+     */
+    void updateChangeIndex( const std::vector<BOARD_ITEM*>& aChangedItems,
+                            const std::vector<REMOVED_BOARD_ITEM>& aRemovedItems );
+
+    /**
+     * @return the bounding box of a pad including its hole
+     */
+    static EDA_RECT padBoundingBox( const D_PAD* aPad );
+
+    /**
+     * Build the jobs of the enabled clearance tests, which only read the board and can
+     * be run concurrently: pads, holes, tracks, zones, keepouts, texts and graphics.
+     * The courtyard test is not one of them: it rebuilds the footprint courtyards.
+     */
+    void buildClearanceTests( std::vector<CLEARANCE_TEST>& aTests );
+
+    ///> Returns true if the board design settings enable the courtyard test
+    bool courtyardTestEnabled() const;
+
     //-----<categorical group tests>-----------------------------------------
 
     /**
@@ -274,14 +417,20 @@ private:
     /**
      * Perform the DRC on all tracks.
      *
-     * This test can take a while, a progress bar can be displayed
-     * @param aActiveWindow = the active window ued as parent for the progress bar
-     * @param aShowProgressBar = true to show a progress bar
-     * (Note: it is shown only if there are many tracks)
+     * Each track or via is only tested against the tracks, vias and pads found near it
+     * (within the biggest clearance) in a per layer R-tree.
+     * The tracks are sorted by X coordinate and split in vertical strips, each strip being
+     * tested by a separate job.
+     * @param aJobs is the job list to append the track tests to
      */
-    void testTracks( wxWindow * aActiveWindow, bool aShowProgressBar );
+    void testTracks( std::vector<DRC_JOB>& aJobs );
 
-    void testPad2Pad();
+    /**
+     * Perform the pad to pad DRC. The pads are sorted by X coordinate and split in
+     * vertical strips, each strip being tested by a separate job.
+     * @param aJobs is the job list to append the pad tests to
+     */
+    void testPad2Pad( std::vector<DRC_JOB>& aJobs );
 
     void testDrilledHoles();
 
@@ -291,13 +440,25 @@ private:
 
     void testKeepoutAreas();
 
+    ///> Tests a track or a via against a keepout area
+    void testTrackInKeepout( TRACK* aSegm, ZONE_CONTAINER* aArea );
+
     // aTextItem is type BOARD_ITEM* to accept either TEXTE_PCB or TEXTE_MODULE
     void testCopperTextItem( BOARD_ITEM* aTextItem );
 
     void testCopperDrawItem( DRAWSEGMENT* aDrawing );
 
+    ///> Tests one of the items returned by copperTextAndGraphics()
+    void testCopperItem( BOARD_ITEM* aItem );
+
     void testCopperTextAndGraphics();
 
+    /**
+     * @return the copper texts and graphic items tested by testCopperTextAndGraphics(),
+     * in test order
+     */
+    std::vector<BOARD_ITEM*> copperTextAndGraphics() const;
+
     ///> Tests for items placed on disabled layers (causing false connections).
     void testDisabledLayers();
 
@@ -321,21 +482,25 @@ private:
      * @param x_limit is used to stop the test
      * (i.e. when the current pad pos X in list exceeds this limit, because the list
      * is sorted by X coordinate)
+     * @param aHolePad is a scratch pad, owned by a footprint of the board, used to test the
+     * holes as pads.  Building one per pad list is expensive, so the caller provides it.
      */
-    bool doPadToPadsDrc( D_PAD* aRefPad, D_PAD** aStart, D_PAD** aEnd, int x_limit );
+    bool doPadToPadsDrc( D_PAD* aRefPad, D_PAD** aStart, D_PAD** aEnd, int x_limit,
+                         D_PAD& aHolePad );
 
     /**
      * Test the current segment.
      *
      * @param aRefSeg The segment to test
-     * @param aStart the first item of track list to test against (usually BOARD::m_Track)
-     * @param aTestPads true if should do pads test
+     * @param aTracks the tracks and vias to test against aRefSeg.  Usually only the
+     *                items near aRefSeg, found by a spatial query
+     * @param aPads the pads to test against aRefSeg.  Usually only the pads near aRefSeg
      * @param aTestZones true if should do copper zones test. This can be very time consumming
      * @return bool - true if no problems, else false and m_currentMarker is
      *          filled in with the problem information.
      */
-    bool doTrackDrc( TRACK* aRefSeg, TRACK* aStart,
-                     bool aTestPads, bool aTestZones );
+    bool doTrackDrc( TRACK* aRefSeg, const std::vector<TRACK*>& aTracks,
+                     const std::vector<D_PAD*>& aPads, bool aTestZones );
 
     /**
      * Test the current segment or via.
@@ -420,6 +585,13 @@ private:
 public:
     DRC( PCB_EDIT_FRAME* aPcbWindow );
 
+    /**
+     * Create a DRC for a board which is not owned by an editor frame (command line tools).
+     * Such a DRC can only run RunTestsHeadless().
+     * @param aUnits are the units used in the marker messages
+     */
+    DRC( BOARD* aBoard, EDA_UNITS_T aUnits );
+
     ~DRC();
 
     /**
@@ -498,6 +670,74 @@ public:
      */
     void RunTests( wxTextCtrl* aMessages = NULL );
 
+    /**
+     * Run the tests without any user interface.
+     *
+     * The tests are the ones of RunTests(), except the zone fill check and the test of
+     * the footprints against the schematic: the zones are tested as they are filled.
+     * The markers are not added to the board but given to aHandler, which owns them.
+     *
+     * @param aHandler receives the markers, in the order RunTests() would add them
+     * @param aTimings if not null, receives the time spent in each test
+     */
+    void RunTestsHeadless( const DRC_PROVIDER::MARKER_HANDLER& aHandler,
+                           DRC_TIMINGS* aTimings = nullptr );
+
+    /**
+     * @return the unconnected items found by the last test run
+     */
+    const DRC_LIST& GetUnconnectedItems() const { return m_unconnected; }
+
+    /**
+     * Enable or disable the incremental DRC: when enabled (and after a first full
+     * DRC run), the items changed by each BOARD_COMMIT are re-tested.
+     */
+    void SetIncrementalTest( bool aEnable ) { m_doIncrementalTest = aEnable; }
+
+    bool GetIncrementalTest() const { return m_doIncrementalTest; }
+
+    /**
+     * Drop the index of the incremental test, when the board was changed without the
+     * changes being given to TestChangedItems().  It is rebuilt by the next test.
+     */
+    void InvalidateChangeIndex() { m_changeIndex.reset(); }
+
+    /**
+     * Set the number of threads running the concurrent clearance tests.
+     * @param aCount is the thread count, 0 (the default) for one thread per core
+     */
+    void SetMaxThreadCount( size_t aCount ) { m_maxThreadCount = aCount; }
+
+    /**
+     * Re-test the items changed by a commit, an undo or a redo, and update the board markers.
+     * Does nothing if the incremental DRC is disabled or no full DRC was run.
+     *
+     * @param aChangedItems are the items added or modified by the change
+     * @param aRemovedItems are the items removed by the change
+     */
+    void TestChangedItems( const std::vector<BOARD_ITEM*>& aChangedItems,
+                           const std::vector<REMOVED_BOARD_ITEM>& aRemovedItems );
+
+    /**
+     * Re-test the items changed on m_pcb, without modifying the board.
+     *
+     * The markers involving a removed item are obsolete.  So are the markers of the track,
+     * pad, keepout and copper text tests involving a changed item: the changed tracks, vias
+     * and pads (pads of changed footprints included), the tracks near changed pads, and
+     * the copper texts and graphics changed or near a changed item are re-tested.  The
+     * courtyard test is run again if a footprint changed.  The markers of the other tests
+     * are kept until the next full run.
+     * The neighbours of the re-tested items are found with an index kept between the calls:
+     * all the changes of the board must be given, or InvalidateChangeIndex() called.
+     *
+     * @param aStaleMarkers receives the board markers made obsolete by the change
+     * @param aNewMarkers receives the markers found by the re-test, owned by the caller
+     */
+    void TestChangedItems( const std::vector<BOARD_ITEM*>& aChangedItems,
+                           const std::vector<REMOVED_BOARD_ITEM>& aRemovedItems,
+                           std::vector<MARKER_PCB*>& aStaleMarkers,
+                           std::vector<MARKER_PCB*>& aNewMarkers );
+
     /**
      * @return a pointer to the current marker (last created marker
      */
@@ -0,0 +1,163 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef DRC_RTREE__H
+#define DRC_RTREE__H
+
+#include <algorithm>
+#include <vector>
+
+#include <eda_rect.h>
+#include <layers_id_colors_and_visibility.h>
+
+#include <geometry/rtree.h>
+
+
+/**
+ * Class DRC_RTREE -
+ * Implements a set of R-trees, one per copper layer, for fast spatial lookup of
+ * the items taking part in clearance checks.  An item living on several copper
+ * layers (vias, through-hole pads) is inserted in the tree of each of them.
+ * Non-owning.
+ */
+template< class T >
+class DRC_RTREE
+{
+public:
+    typedef RTree<T, int, 2, double> TREE;
+
+    DRC_RTREE()
+    {
+        for( int layer = 0; layer < PCB_LAYER_ID_COUNT; ++layer )
+            m_tree[layer] = nullptr;
+    }
+
+    ~DRC_RTREE()
+    {
+        for( int layer = 0; layer < PCB_LAYER_ID_COUNT; ++layer )
+            delete m_tree[layer];
+    }
+
+    /**
+     * Function Insert()
+     * Inserts an item into the trees of each copper layer of aLayers.
+     * @param aItem is the item to store
+     * @param aBBox is the bounding box of the item (its copper shape, holes included)
+     * @param aLayers are the layers the item lives on. Non copper layers are ignored.
+     */
+    void Insert( const T& aItem, const EDA_RECT& aBBox, LSET aLayers )
+    {
+        EDA_RECT  bbox = aBBox;
+        bbox.Normalize();
+
+        const int mmin[2] = { bbox.GetX(), bbox.GetY() };
+        const int mmax[2] = { bbox.GetRight(), bbox.GetBottom() };
+
+        for( PCB_LAYER_ID layer : ( aLayers & LSET::AllCuMask() ).Seq() )
+        {
+            if( !m_tree[layer] )
+                m_tree[layer] = new TREE();
+
+            m_tree[layer]->Insert( mmin, mmax, aItem );
+        }
+    }
+
+    /**
+     * Function Remove()
+     * Removes an item from the trees of each copper layer of aLayers.
+     * @param aItem is the item to remove
+     * @param aBBox is the bounding box the item was inserted with
+     * @param aLayers are the layers the item was inserted with
+     */
+    void Remove( const T& aItem, const EDA_RECT& aBBox, LSET aLayers )
+    {
+        EDA_RECT  bbox = aBBox;
+        bbox.Normalize();
+
+        const int mmin[2] = { bbox.GetX(), bbox.GetY() };
+        const int mmax[2] = { bbox.GetRight(), bbox.GetBottom() };
+
+        for( PCB_LAYER_ID layer : ( aLayers & LSET::AllCuMask() ).Seq() )
+        {
+            if( m_tree[layer] )
+                m_tree[layer]->Remove( mmin, mmax, aItem );
+        }
+    }
+
+    /**
+     * Function RemoveAll()
+     * Removes all items from the trees
+     */
+    void RemoveAll()
+    {
+        for( int layer = 0; layer < PCB_LAYER_ID_COUNT; ++layer )
+        {
+            delete m_tree[layer];
+            m_tree[layer] = nullptr;
+        }
+    }
+
+    /**
+     * Function Query()
+     * Collects the items whose bounding box intersects aBounds on at least one
+     * copper layer of aLayers.
+     * The result is sorted and does not contain duplicates, even if an item was found
+     * on several layers.  This method does not modify the trees and can be called
+     * concurrently from several threads.
+     */
+    void Query( const EDA_RECT& aBounds, LSET aLayers, std::vector<T>& aResult ) const
+    {
+        EDA_RECT  bbox = aBounds;
+        bbox.Normalize();
+
+        const int mmin[2] = { bbox.GetX(), bbox.GetY() };
+        const int mmax[2] = { bbox.GetRight(), bbox.GetBottom() };
+
+        aResult.clear();
+
+        for( PCB_LAYER_ID layer : ( aLayers & LSET::AllCuMask() ).Seq() )
+        {
+            if( !m_tree[layer] )
+                continue;
+
+            m_tree[layer]->Search( mmin, mmax, [&aResult]( const T& aItem )
+                    {
+                        aResult.push_back( aItem );
+                        return true;
+                    } );
+        }
+
+        std::sort( aResult.begin(), aResult.end() );
+        aResult.erase( std::unique( aResult.begin(), aResult.end() ), aResult.end() );
+    }
+
+private:
+    // Copy is not allowed: trees are owned by this object
+    DRC_RTREE( const DRC_RTREE& ) = delete;
+    DRC_RTREE& operator=( const DRC_RTREE& ) = delete;
+
+    TREE* m_tree[PCB_LAYER_ID_COUNT];
+};
+
+
+#endif // DRC_RTREE__H
@@ -0,0 +1,610 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file drc_incremental.cpp
+ * Re-test of the items changed by a commit, an undo or a redo, after a full DRC run.
+ */
+
+#include <climits>
+#include <unordered_set>
+
+#include <fctsys.h>
+#include <pcb_edit_frame.h>
+#include <class_board.h>
+#include <class_module.h>
+#include <class_track.h>
+#include <class_zone.h>
+#include <class_pad.h>
+#include <class_marker_pcb.h>
+#include <board_commit.h>
+
+#include <drc.h>
+
+
+/**
+ * @return true if the error code is reported by the track tests (DRC::doTrackDrc)
+ * and is therefore re-tested when a track or a via is changed.
+ */
+static bool isTrackErrorCode( int aErrorCode )
+{
+    switch( aErrorCode )
+    {
+    case DRCE_TRACK_NEAR_THROUGH_HOLE:
+    case DRCE_TRACK_NEAR_PAD:
+    case DRCE_TRACK_NEAR_VIA:
+    case DRCE_VIA_NEAR_VIA:
+    case DRCE_VIA_NEAR_TRACK:
+    case DRCE_TRACK_ENDS1:
+    case DRCE_TRACK_ENDS2:
+    case DRCE_TRACK_ENDS3:
+    case DRCE_TRACK_ENDS4:
+    case DRCE_TRACK_SEGMENTS_TOO_CLOSE:
+    case DRCE_TRACKS_CROSSING:
+    case DRCE_ENDS_PROBLEM1:
+    case DRCE_ENDS_PROBLEM2:
+    case DRCE_ENDS_PROBLEM3:
+    case DRCE_ENDS_PROBLEM4:
+    case DRCE_ENDS_PROBLEM5:
+    case DRCE_VIA_HOLE_BIGGER:
+    case DRCE_MICRO_VIA_INCORRECT_LAYER_PAIR:
+    case DRCE_TOO_SMALL_TRACK_WIDTH:
+    case DRCE_TOO_SMALL_VIA:
+    case DRCE_TOO_SMALL_MICROVIA:
+    case DRCE_TOO_SMALL_VIA_DRILL:
+    case DRCE_TOO_SMALL_MICROVIA_DRILL:
+    case DRCE_TRACK_NEAR_ZONE:
+    case DRCE_MICRO_VIA_NOT_ALLOWED:
+    case DRCE_BURIED_VIA_NOT_ALLOWED:
+    case DRCE_TRACK_NEAR_EDGE:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+
+/**
+ * @return true if the error code is reported by the pad to pad test (DRC::doPadToPadsDrc)
+ */
+static bool isPadErrorCode( int aErrorCode )
+{
+    return aErrorCode == DRCE_PAD_NEAR_PAD1 || aErrorCode == DRCE_HOLE_NEAR_PAD;
+}
+
+
+/**
+ * @return true if the error code is reported by the keepout test (DRC::testKeepoutAreas)
+ */
+static bool isKeepoutErrorCode( int aErrorCode )
+{
+    return aErrorCode == DRCE_VIA_INSIDE_KEEPOUT || aErrorCode == DRCE_TRACK_INSIDE_KEEPOUT;
+}
+
+
+/**
+ * @return true if the error code is reported by the copper text and graphics test
+ * (DRC::testCopperTextAndGraphics)
+ */
+static bool isCopperTextErrorCode( int aErrorCode )
+{
+    return aErrorCode == DRCE_TRACK_NEAR_COPPER || aErrorCode == DRCE_VIA_NEAR_COPPER
+           || aErrorCode == DRCE_PAD_NEAR_COPPER;
+}
+
+
+/**
+ * @return true if the error code is reported by the courtyard test
+ * (DRC::doFootprintOverlappingDrc)
+ */
+static bool isCourtyardErrorCode( int aErrorCode )
+{
+    return aErrorCode == DRCE_OVERLAPPING_FOOTPRINTS
+           || aErrorCode == DRCE_MISSING_COURTYARD_IN_FOOTPRINT
+           || aErrorCode == DRCE_MALFORMED_COURTYARD_IN_FOOTPRINT;
+}
+
+
+void DRC::TestChangedItems( const std::vector<BOARD_ITEM*>& aChangedItems,
+                            const std::vector<REMOVED_BOARD_ITEM>& aRemovedItems )
+{
+    // The commit pushed by this function must not trigger a new test
+    if( m_incrementalTestRunning )
+        return;
+
+    // Markers are only maintained after a full DRC run.  The index misses the changes
+    // which are not tested.
+    if( !m_doIncrementalTest || !m_drcRun || m_markerSink )
+    {
+        m_changeIndex.reset();
+        return;
+    }
+
+    m_pcb = m_pcbEditorFrame->GetBoard();
+
+    std::vector<MARKER_PCB*> staleMarkers;
+    std::vector<MARKER_PCB*> newMarkers;
+
+    TestChangedItems( aChangedItems, aRemovedItems, staleMarkers, newMarkers );
+
+    if( staleMarkers.empty() && newMarkers.empty() )
+        return;
+
+    // The current item could be a marker about to be deleted
+    for( MARKER_PCB* marker : staleMarkers )
+    {
+        if( m_pcbEditorFrame->GetCurItem() == marker )
+            m_pcbEditorFrame->SetCurItem( nullptr );
+    }
+
+    BOARD_COMMIT commit( m_pcbEditorFrame );
+
+    for( MARKER_PCB* marker : staleMarkers )
+        commit.Remove( marker );
+
+    for( MARKER_PCB* marker : newMarkers )
+        commit.Add( marker );
+
+    m_incrementalTestRunning = true;
+    commit.Push( wxEmptyString, false, false );
+    m_incrementalTestRunning = false;
+
+    // No undo entry was created: the removed markers are owned by nobody
+    for( MARKER_PCB* marker : staleMarkers )
+        delete marker;
+
+    updatePointers();
+}
+
+
+void DRC::TestChangedItems( const std::vector<BOARD_ITEM*>& aChangedItems,
+                            const std::vector<REMOVED_BOARD_ITEM>& aRemovedItems,
+                            std::vector<MARKER_PCB*>& aStaleMarkers,
+                            std::vector<MARKER_PCB*>& aNewMarkers )
+{
+    std::unordered_set<const void*> dirtyItems;         // tracks, vias and pads
+    std::unordered_set<const void*> dirtyCopperItems;   // copper texts and graphics
+    std::unordered_set<const void*> dirtyKeepouts;
+    std::unordered_set<const void*> dirtyModules;
+    std::unordered_set<const void*> removedItems;
+    bool                            modulesChanged = false;
+
+    for( BOARD_ITEM* item : aChangedItems )
+    {
+        switch( item->Type() )
+        {
+        case PCB_TRACE_T:
+        case PCB_VIA_T:
+        case PCB_PAD_T:
+            dirtyItems.insert( item );
+            break;
+
+        case PCB_TEXT_T:
+        case PCB_LINE_T:
+        case PCB_MODULE_TEXT_T:
+        case PCB_MODULE_EDGE_T:
+            dirtyCopperItems.insert( item );
+            break;
+
+        case PCB_ZONE_AREA_T:
+            if( static_cast<ZONE_CONTAINER*>( item )->GetIsKeepout() )
+                dirtyKeepouts.insert( item );
+
+            break;
+
+        case PCB_MODULE_T:
+            for( D_PAD* pad : static_cast<MODULE*>( item )->Pads() )
+                dirtyItems.insert( pad );
+
+            dirtyModules.insert( item );
+            modulesChanged = true;
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    // The removed items are only compared with the items of the markers
+    for( const REMOVED_BOARD_ITEM& removed : aRemovedItems )
+    {
+        removedItems.insert( removed.m_item );
+        removedItems.insert( removed.m_children.begin(), removed.m_children.end() );
+
+        if( removed.m_type == PCB_MODULE_T || removed.m_module )
+            modulesChanged = true;
+    }
+
+    bool retestCourtyards = modulesChanged && courtyardTestEnabled();
+
+    if( dirtyItems.empty() && dirtyCopperItems.empty() && dirtyKeepouts.empty()
+            && removedItems.empty() && !retestCourtyards )
+    {
+        return;
+    }
+
+    updateChangeIndex( aChangedItems, aRemovedItems );
+
+    const CHANGE_INDEX& index = *m_changeIndex;
+
+    std::vector<int> hits;
+    std::vector<int> dirtyTracks;
+    std::vector<int> dirtyPads;
+
+    for( int ii = 0; ii < (int) index.m_pads.size(); ++ii )
+    {
+        if( dirtyItems.count( index.m_pads[ii] ) )
+            dirtyPads.push_back( ii );
+    }
+
+    // The track to pad tests are run from the track side: the tracks near a changed pad
+    // must be re-tested too
+    for( int ii : dirtyPads )
+    {
+        D_PAD*   pad = index.m_pads[ii];
+        EDA_RECT area = padBoundingBox( pad );
+        LSET     layers = pad->GetDrillSize().x ? LSET::AllCuMask() : pad->GetLayerSet();
+
+        area.Inflate( index.m_maxClearance );
+        index.m_trackTree.Query( area, layers, hits );
+
+        for( int hit : hits )
+            dirtyItems.insert( index.m_tracks[hit] );
+    }
+
+    for( int ii = 0; ii < (int) index.m_tracks.size(); ++ii )
+    {
+        if( dirtyItems.count( index.m_tracks[ii] ) )
+            dirtyTracks.push_back( ii );
+    }
+
+    // A copper text or graphic item is re-tested against all the tracks and pads when it
+    // changed, or when a changed track or pad is near it.  The pairs of a changed track or
+    // pad and an item too far to be re-tested cannot collide.
+    std::vector<BOARD_ITEM*> copperItems;
+
+    for( BOARD_ITEM* item : copperTextAndGraphics() )
+    {
+        bool dirty = dirtyCopperItems.count( item ) || dirtyModules.count( item->GetParent() );
+
+        if( !dirty && !dirtyItems.empty() )
+        {
+            EDA_RECT area = item->GetBoundingBox();
+            LSET     layers( item->GetLayer() );
+
+            area.Inflate( index.m_maxClearance );
+
+            index.m_trackTree.Query( area, layers, hits );
+
+            for( int hit : hits )
+                dirty = dirty || dirtyItems.count( index.m_tracks[hit] );
+
+            index.m_padTree.Query( area, layers, hits );
+
+            for( int hit : hits )
+                dirty = dirty || dirtyItems.count( index.m_pads[hit] );
+        }
+
+        if( dirty )
+        {
+            dirtyCopperItems.insert( item );
+            copperItems.push_back( item );
+        }
+    }
+
+    // Collect the markers made obsolete by the change
+    for( int ii = 0; ii < m_pcb->GetMARKERCount(); ++ii )
+    {
+        MARKER_PCB*     marker = m_pcb->GetMARKER( ii );
+        const DRC_ITEM& drcItem = marker->GetReporter();
+        const void*     itemA = drcItem.GetMainItemWeakRef();
+        const void*     itemB = drcItem.GetAuxItemWeakRef();
+        int             code = drcItem.GetErrorCode();
+
+        auto involves = [&]( const std::unordered_set<const void*>& aItems )
+        {
+            return aItems.count( itemA ) || aItems.count( itemB );
+        };
+
+        bool stale = involves( removedItems );
+
+        if( !stale && ( isTrackErrorCode( code ) || isPadErrorCode( code ) ) )
+            stale = involves( dirtyItems );
+        else if( !stale && isKeepoutErrorCode( code ) )
+            stale = involves( dirtyItems ) || involves( dirtyKeepouts );
+        else if( !stale && isCopperTextErrorCode( code ) )
+            stale = involves( dirtyItems ) || involves( dirtyCopperItems );
+        else if( !stale && isCourtyardErrorCode( code ) )
+            stale = retestCourtyards;
+
+        if( stale )
+            aStaleMarkers.push_back( marker );
+    }
+
+    // Re-test the dirty items.  A pair of dirty items is tested only once, from the
+    // item having the lower index.
+    std::vector<TRACK*> nearTracks;
+    std::vector<D_PAD*> nearPads;
+
+    m_markerSink = &aNewMarkers;
+
+    for( int idx : dirtyTracks )
+    {
+        TRACK*   segm = index.m_tracks[idx];
+        EDA_RECT area = segm->GetBoundingBox();
+
+        area.Inflate( index.m_maxClearance );
+
+        index.m_trackTree.Query( area, segm->GetLayerSet(), hits );
+        nearTracks.clear();
+
+        for( int hit : hits )
+        {
+            TRACK* candidate = index.m_tracks[hit];
+
+            if( hit == idx || ( hit < idx && dirtyItems.count( candidate ) ) )
+                continue;
+
+            nearTracks.push_back( candidate );
+        }
+
+        index.m_padTree.Query( area, segm->GetLayerSet(), hits );
+        nearPads.clear();
+
+        for( int hit : hits )
+            nearPads.push_back( index.m_pads[hit] );
+
+        if( !doTrackDrc( segm, nearTracks, nearPads, m_doZonesTest ) )
+        {
+            if( m_currentMarker )
+            {
+                addMarkerToPcb( m_currentMarker );
+                m_currentMarker = nullptr;
+            }
+        }
+    }
+
+    // The pad used to test the holes, see doPadToPadsDrc()
+    MODULE holeModule( m_pcb );
+    D_PAD  holePad( &holeModule );
+
+    if( !m_doPad2PadTest )
+        dirtyPads.clear();
+
+    for( int idx : dirtyPads )
+    {
+        D_PAD*   pad = index.m_pads[idx];
+        EDA_RECT area = padBoundingBox( pad );
+
+        area.Inflate( index.m_maxClearance );
+
+        // Pad holes are tested against pads on all copper layers
+        index.m_padTree.Query( area, LSET::AllCuMask(), hits );
+        nearPads.clear();
+
+        for( int hit : hits )
+        {
+            D_PAD* candidate = index.m_pads[hit];
+
+            if( hit == idx || ( hit < idx && dirtyItems.count( candidate ) ) )
+                continue;
+
+            nearPads.push_back( candidate );
+        }
+
+        if( nearPads.empty() )
+            continue;
+
+        if( !doPadToPadsDrc( pad, nearPads.data(), nearPads.data() + nearPads.size(), INT_MAX,
+                             holePad ) )
+        {
+            if( m_currentMarker )
+            {
+                addMarkerToPcb( m_currentMarker );
+                m_currentMarker = nullptr;
+            }
+        }
+    }
+
+    // A changed keepout area is tested against all the tracks, the other ones against the
+    // dirty tracks
+    if( m_doKeepoutTest )
+    {
+        for( int ii = 0; ii < m_pcb->GetAreaCount(); ii++ )
+        {
+            ZONE_CONTAINER* area = m_pcb->GetArea( ii );
+
+            if( !area->GetIsKeepout() )
+                continue;
+
+            if( dirtyKeepouts.count( area ) )
+            {
+                for( TRACK* segm : index.m_tracks )
+                {
+                    if( segm )
+                        testTrackInKeepout( segm, area );
+                }
+            }
+            else
+            {
+                for( int idx : dirtyTracks )
+                    testTrackInKeepout( index.m_tracks[idx], area );
+            }
+        }
+    }
+
+    for( BOARD_ITEM* item : copperItems )
+        testCopperItem( item );
+
+    if( retestCourtyards )
+        doFootprintOverlappingDrc();
+
+    m_markerSink = nullptr;
+}
+
+
+void DRC::updateChangeIndex( const std::vector<BOARD_ITEM*>& aChangedItems,
+                             const std::vector<REMOVED_BOARD_ITEM>& aRemovedItems )
+{
+    // Store an item in a tree with its current area and layers, in place of the ones it
+    // was stored with.  A new item gets the index aNewIndex.
+    // @return true if the item is new
+    auto store = [&]( CHANGE_INDEX::ENTRIES& aEntries, DRC_RTREE<int>& aTree,
+                      const BOARD_ITEM* aItem, int aNewIndex, const EDA_RECT& aBBox,
+                      LSET aLayers ) -> bool
+    {
+        auto it = aEntries.find( aItem );
+        bool isNew = it == aEntries.end();
+
+        if( isNew )
+            it = aEntries.emplace( aItem, CHANGE_INDEX::ENTRY{ aNewIndex, aBBox, aLayers } ).first;
+        else
+            aTree.Remove( it->second.m_index, it->second.m_bbox, it->second.m_layers );
+
+        it->second.m_bbox = aBBox;
+        it->second.m_layers = aLayers;
+        aTree.Insert( it->second.m_index, aBBox, aLayers );
+
+        return isNew;
+    };
+
+    auto storeTrack = [&]( TRACK* aTrack )
+    {
+        CHANGE_INDEX& index = *m_changeIndex;
+
+        if( store( index.m_trackEntries, index.m_trackTree, aTrack, (int) index.m_tracks.size(),
+                   aTrack->GetBoundingBox(), aTrack->GetLayerSet() ) )
+        {
+            index.m_tracks.push_back( aTrack );
+        }
+
+        index.m_maxClearance = std::max( index.m_maxClearance, aTrack->GetClearance() );
+    };
+
+    auto storePad = [&]( D_PAD* aPad )
+    {
+        CHANGE_INDEX& index = *m_changeIndex;
+
+        // The pad hole is tested on all copper layers, even if the pad is not
+        LSET layers = aPad->GetDrillSize().x ? LSET::AllCuMask() : aPad->GetLayerSet();
+
+        if( store( index.m_padEntries, index.m_padTree, aPad, (int) index.m_pads.size(),
+                   padBoundingBox( aPad ), layers ) )
+        {
+            index.m_pads.push_back( aPad );
+        }
+
+        index.m_maxClearance = std::max( index.m_maxClearance, aPad->GetClearance() );
+    };
+
+    // The removed items may be deleted: only their pointers are used
+    auto remove = [&]( const void* aItem )
+    {
+        CHANGE_INDEX& index = *m_changeIndex;
+        auto          track = index.m_trackEntries.find( aItem );
+        auto          pad = index.m_padEntries.find( aItem );
+
+        if( track != index.m_trackEntries.end() )
+        {
+            const CHANGE_INDEX::ENTRY& entry = track->second;
+
+            index.m_trackTree.Remove( entry.m_index, entry.m_bbox, entry.m_layers );
+            index.m_tracks[entry.m_index] = nullptr;
+            index.m_trackEntries.erase( track );
+        }
+        else if( pad != index.m_padEntries.end() )
+        {
+            const CHANGE_INDEX::ENTRY& entry = pad->second;
+
+            index.m_padTree.Remove( entry.m_index, entry.m_bbox, entry.m_layers );
+            index.m_pads[entry.m_index] = nullptr;
+            index.m_padEntries.erase( pad );
+        }
+    };
+
+    bool rebuild = !m_changeIndex || m_changeIndex->m_board != m_pcb;
+
+    if( !rebuild )
+    {
+        CHANGE_INDEX& index = *m_changeIndex;
+
+        // An item both changed and removed by the change is removed
+        for( BOARD_ITEM* item : aChangedItems )
+        {
+            switch( item->Type() )
+            {
+            case PCB_TRACE_T:
+            case PCB_VIA_T:
+                storeTrack( static_cast<TRACK*>( item ) );
+                break;
+
+            case PCB_PAD_T:
+                storePad( static_cast<D_PAD*>( item ) );
+                break;
+
+            case PCB_MODULE_T:
+                for( D_PAD* pad : static_cast<MODULE*>( item )->Pads() )
+                    storePad( pad );
+
+                break;
+
+            default:
+                break;
+            }
+        }
+
+        for( const REMOVED_BOARD_ITEM& removed : aRemovedItems )
+        {
+            remove( removed.m_item );
+
+            for( const BOARD_ITEM* child : removed.m_children )
+                remove( child );
+        }
+
+        // The item counts catch most of the changes which were not given to the test.
+        // The lists are compacted when they hold more removed items than live ones.
+        size_t itemCount = index.m_trackEntries.size() + index.m_padEntries.size();
+
+        rebuild = index.m_trackEntries.size() != m_pcb->m_Track.GetCount()
+                  || index.m_padEntries.size() != m_pcb->GetPadCount()
+                  || index.m_tracks.size() + index.m_pads.size() > 2 * itemCount;
+    }
+
+    if( rebuild )
+    {
+        m_changeIndex.reset( new CHANGE_INDEX() );
+        m_changeIndex->m_board = m_pcb;
+        m_changeIndex->m_maxClearance = 0;
+
+        for( TRACK* segm : m_pcb->Tracks() )
+            storeTrack( segm );
+
+        for( D_PAD* pad : m_pcb->GetPads() )
+            storePad( pad );
+    }
+
+    // The net class clearances can change without any item change
+    m_changeIndex->m_maxClearance = std::max( m_changeIndex->m_maxClearance,
+            m_pcb->GetDesignSettings().GetBiggestClearanceValue() );
+}
@@ -0,0 +1,214 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file fabrication_job.cpp
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <future>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fctsys.h>
+#include <common.h>
+#include <plotter.h>
+#include <reporter.h>
+#include <wildcards_and_files_ext.h>
+#include <class_board.h>
+#include <pcbplot.h>
+
+#include <gerber_jobfile_writer.h>
+#include <fabrication_job.h>
+
+
+/**
+ * A reporter storing the messages of a task, reported later by the main thread:
+ * the reporters of the UI can only be used from the main thread.
+ */
+class DEFERRED_REPORTER : public REPORTER
+{
+public:
+    REPORTER& Report( const wxString& aText, SEVERITY aSeverity = RPT_UNDEFINED ) override
+    {
+        m_messages.emplace_back( aText, aSeverity );
+        return *this;
+    }
+
+    bool HasMessage() const override { return !m_messages.empty(); }
+
+    void Replay( REPORTER& aReporter ) const
+    {
+        for( const auto& msg : m_messages )
+            aReporter.Report( msg.first, msg.second );
+    }
+
+private:
+    std::vector<std::pair<wxString, SEVERITY>> m_messages;
+};
+
+
+FABRICATION_JOB::FABRICATION_JOB( BOARD* aBoard, const PCB_PLOT_PARAMS& aPlotOpts,
+                                  const wxString& aOutputDir ) :
+        m_board( aBoard ),
+        m_plotOpts( aPlotOpts ),
+        m_outputDir( aOutputDir ),
+        m_useGerberExtensions( false ),
+        m_maxThreadCount( 0 )
+{
+}
+
+
+FABRICATION_JOB::~FABRICATION_JOB()
+{
+}
+
+
+bool FABRICATION_JOB::Run( REPORTER* aReporter )
+{
+    typedef std::function<bool( REPORTER& )> TASK;
+
+    std::vector<TASK> tasks;
+    wxString          boardFilename = m_board->GetFileName();
+    wxString          file_ext( GetDefaultPlotExtension( m_plotOpts.GetFormat() ) );
+    const bool        gerber = m_plotOpts.GetFormat() == PLOT_FORMAT_GERBER;
+
+    DEFERRED_REPORTER     jobfileReporter;
+    GERBER_JOBFILE_WRITER jobfile_writer( m_board, &jobfileReporter );
+
+    // The file names are known before plotting: the job file can be written together
+    // with the layers
+    for( LSEQ seq = m_plotOpts.GetLayerSelection().UIOrder();  seq;  ++seq )
+    {
+        PCB_LAYER_ID layer = *seq;
+
+        // Copper layers selected but disabled on the board are not plotted
+        // (see DIALOG_PLOT::Plot())
+        if( ( LSET::AllCuMask() & ~m_board->GetEnabledLayers() )[layer] )
+            continue;
+
+        // Pick the basename from the board file
+        wxFileName fn( boardFilename );
+
+        if( gerber && m_useGerberExtensions )
+            file_ext = GetGerberProtelExtension( layer );
+
+        BuildPlotFileName( &fn, m_outputDir, m_board->GetLayerName( layer ), file_ext );
+        wxString fullname = fn.GetFullName();
+        jobfile_writer.AddGbrFile( layer, fullname );
+
+        const wxString fullPath = fn.GetFullPath();
+
+        tasks.push_back( [this, layer, fullPath]( REPORTER& aTaskReporter )
+        {
+            // Each task has its own copy of the options, given as non const to the plotter
+            PCB_PLOT_PARAMS plotOpts = m_plotOpts;
+            PLOTTER*        plotter = StartPlotBoard( m_board, &plotOpts, layer, fullPath,
+                                                      wxEmptyString );
+            wxString        msg;
+
+            if( !plotter )
+            {
+                msg.Printf( _( "Unable to create file \"%s\"." ), GetChars( fullPath ) );
+                aTaskReporter.Report( msg, REPORTER::RPT_ERROR );
+                return false;
+            }
+
+            PlotOneBoardLayer( m_board, plotter, layer, plotOpts );
+            plotter->EndPlot();
+            delete plotter;
+
+            msg.Printf( _( "Plot file \"%s\" created." ), GetChars( fullPath ) );
+            aTaskReporter.Report( msg, REPORTER::RPT_ACTION );
+            return true;
+        } );
+    }
+
+    if( gerber && m_plotOpts.GetCreateGerberJobFile() )
+    {
+        tasks.push_back( [&]( REPORTER& aTaskReporter )
+        {
+            // Pick the basename from the board file
+            wxFileName fn( boardFilename );
+            // Build gerber job file from basename
+            BuildPlotFileName( &fn, m_outputDir, "job", GerberJobFileExtension );
+
+            bool success = jobfile_writer.CreateJobFile( fn.GetFullPath() );
+
+            jobfileReporter.Replay( aTaskReporter );
+            return success;
+        } );
+    }
+
+    // Switch to the C locale once for all the tasks: LOCALE_IO changes the locale of the
+    // whole process, and the tasks only nest their own LOCALE_IO in this one
+    LOCALE_IO toggle;
+
+    std::vector<DEFERRED_REPORTER> reporters( tasks.size() );
+    std::vector<char>              results( tasks.size(), 0 );
+    std::atomic<size_t>            nextTask( 0 );
+
+    auto runTasks = [&]()
+    {
+        for( size_t ii = nextTask++; ii < tasks.size(); ii = nextTask++ )
+            results[ii] = tasks[ii]( reporters[ii] );
+    };
+
+    size_t threadCount = m_maxThreadCount ? m_maxThreadCount
+                                          : std::thread::hardware_concurrency();
+    size_t parallelThreadCount = std::min<size_t>( threadCount, tasks.size() );
+
+    // The frame reference is plotted from the global page layout, which is not thread safe
+    if( m_plotOpts.GetPlotFrameRef() )
+        parallelThreadCount = 1;
+
+    if( parallelThreadCount <= 1 )
+    {
+        runTasks();
+    }
+    else
+    {
+        std::vector<std::future<void>> returns( parallelThreadCount );
+
+        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+            returns[ii] = std::async( std::launch::async, runTasks );
+
+        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+            returns[ii].wait();
+    }
+
+    bool success = true;
+
+    for( size_t ii = 0; ii < tasks.size(); ++ii )
+    {
+        if( aReporter )
+            reporters[ii].Replay( *aReporter );
+
+        success = success && results[ii];
+    }
+
+    return success;
+}
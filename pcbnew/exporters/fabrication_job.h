@@ -0,0 +1,87 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file fabrication_job.h
+ * Generation of the plot files of a board, using several threads
+ */
+
+#ifndef FABRICATION_JOB_H
+#define FABRICATION_JOB_H
+
+#include <pcb_plot_params.h>
+
+class BOARD;
+class REPORTER;
+
+
+/**
+ * Class FABRICATION_JOB
+ * creates the plot files of a set of layers and the gerber job file of a board.  Each
+ * file is written by a separate task, and the tasks run concurrently on a pool of threads.
+ *
+ * The board is only read by the tasks, and must not be modified during Run().
+ * The messages of the tasks are reported in the order of the tasks, after they are all
+ * done.
+ */
+class FABRICATION_JOB
+{
+public:
+    /**
+     * @param aBoard is the board to plot
+     * @param aPlotOpts are the plot options, the selected layers included
+     * @param aOutputDir is the absolute path of the output directory, that must exist
+     */
+    FABRICATION_JOB( BOARD* aBoard, const PCB_PLOT_PARAMS& aPlotOpts,
+                     const wxString& aOutputDir );
+
+    ~FABRICATION_JOB();
+
+    /**
+     * Use the Protel file extensions (.gtl, .gbl ...) for the gerber files of the layers
+     */
+    void SetUseGerberExtensions( bool aEnable ) { m_useGerberExtensions = aEnable; }
+
+    /**
+     * Set the number of threads writing the files.
+     * @param aCount is the thread count, 0 (the default) for one thread per core
+     */
+    void SetMaxThreadCount( size_t aCount ) { m_maxThreadCount = aCount; }
+
+    /**
+     * Function Run
+     * writes all the files
+     * @param aReporter receives the messages of the tasks (can be NULL)
+     * @return true if all the files were created
+     */
+    bool Run( REPORTER* aReporter );
+
+private:
+    BOARD*          m_board;
+    PCB_PLOT_PARAMS m_plotOpts;
+    wxString        m_outputDir;
+    bool            m_useGerberExtensions;
+    size_t          m_maxThreadCount;
+};
+
+#endif  // FABRICATION_JOB_H
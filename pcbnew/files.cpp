@@ -54,6 +54,9 @@
 
 #include <class_board.h>
 #include <build_version.h>      // LEGACY_BOARD_FILE_VERSION
+#include <advanced_config.h>
+#include <zone_fill_cache.h>
+#include <tools/zone_filler_tool.h>
 
 #include <wx/stdpaths.h>
 
@@ -534,6 +537,15 @@ bool PCB_EDIT_FRAME::OpenProjectFiles( const std::vector<wxString>& aFileSet, in
             unsigned stopTime = GetRunningMicroSecs();
             printf( "PLUGIN::Load(): %u usecs\n", stopTime - startTime );
 #endif
+
+            // Restore the zone triangulations before the view computes them again
+            if( ADVANCED_CFG::GetCfg().m_restoreZoneFills )
+            {
+                ZONE_FILL_CACHE fillCache( ZONE_FILL_CACHE::GetCacheFileName( loadedBoard ) );
+
+                if( fillCache.Load() )
+                    fillCache.Restore( loadedBoard );
+            }
         }
         catch( const IO_ERROR& ioe )
         {
@@ -757,6 +769,20 @@ bool PCB_EDIT_FRAME::SavePcbFile( const wxString& aFileName, bool aCreateBackupF
     GetBoard()->SetFileName( pcbFileName.GetFullPath() );
     UpdateTitle();
 
+    // Keep the zone fills next to the board, for the next time it is opened (but not next
+    // to the autosave files)
+    if( aCreateBackupFile && ADVANCED_CFG::GetCfg().m_restoreZoneFills )
+    {
+        ZONE_FILLER_TOOL* fillerTool = GetToolManager()->GetTool<ZONE_FILLER_TOOL>();
+        ZONE_FILL_CACHE*  fillCache = fillerTool->GetFillCache();
+
+        if( fillCache )
+        {
+            fillCache->StoreFills( GetBoard() );
+            fillerTool->SaveFillCache( false );
+        }
+    }
+
     // Put the saved file in File History, unless aCreateBackupFile
     // is false.
     // aCreateBackupFile == false is mainly used to write autosave files
@@ -22,6 +22,13 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
 
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <future>
+#include <mutex>
+#include <thread>
+
 #include <fctsys.h>
 #include <kicad_string.h>
 #include <common.h>
@@ -709,39 +716,194 @@ void PCB_IO::formatHeader( BOARD* aBoard, int aNestLevel ) const
     formatNetInformation( aBoard, aNestLevel );
 }
 
+/**
+ * A range of the modules, tracks or zones of a board, formatted by a worker thread of
+ * PCB_IO::format( BOARD* ).
+ */
+struct FORMAT_CHUNK
+{
+    int                 m_section;      ///< index of the item list
+    size_t              m_first;        ///< first item of the range in the list
+    size_t              m_last;         ///< item after the last one
+    std::string         m_text;
+    std::exception_ptr  m_error;
+    bool                m_done;
+};
+
+
 void PCB_IO::format( BOARD* aBoard, int aNestLevel ) const
 {
-    formatHeader( aBoard, aNestLevel );
+    enum { MODULES, TRACKS, ZONES, SECTION_COUNT };
+
+    // Number of items formatted by a worker at once, the zones are often large
+    const size_t chunkSize[SECTION_COUNT] = { 16, 1024, 1 };
+
+    std::vector<BOARD_ITEM*> sections[SECTION_COUNT];
 
-    // Save the modules.
     for( MODULE* module = aBoard->m_Modules;  module;  module = module->Next() )
+        sections[MODULES].push_back( module );
+
+    for( TRACK* track = aBoard->m_Track;  track; track = track->Next() )
+        sections[TRACKS].push_back( track );
+
+    for( int i = 0; i < aBoard->GetAreaCount();  ++i )
+        sections[ZONES].push_back( aBoard->GetArea( i ) );
+
+    std::vector<FORMAT_CHUNK> chunks;
+
+    for( int section = 0; section < SECTION_COUNT; ++section )
     {
-        Format( module, aNestLevel );
-        m_out->Print( 0, "\n" );
+        for( size_t first = 0; first < sections[section].size(); first += chunkSize[section] )
+        {
+            FORMAT_CHUNK chunk;
+
+            chunk.m_section = section;
+            chunk.m_first = first;
+            chunk.m_last = std::min( first + chunkSize[section], sections[section].size() );
+            chunk.m_done = false;
+            chunks.push_back( chunk );
+        }
     }
 
-    // Save the graphical items on the board (not owned by a module)
-    for( auto item : aBoard->Drawings() )
-        Format( item, aNestLevel );
+    size_t parallelThreadCount = std::min<size_t>( std::thread::hardware_concurrency(),
+            ( chunks.size() + 7 ) / 8 );
 
-    if( aBoard->Drawings().Size() )
-        m_out->Print( 0, "\n" );
+    formatHeader( aBoard, aNestLevel );
 
-    // Do not save MARKER_PCBs, they can be regenerated easily.
+    // The modules, tracks and zones are formatted by worker threads, each with its own
+    // PCB_IO, into chunks of text.  The chunks are written here in file order, as soon
+    // as they are ready.
+    std::atomic<size_t>              nextChunk( 0 );
+    std::mutex                       chunkMutex;
+    std::condition_variable          chunkDone;
+    std::vector<std::future<size_t>> returns( parallelThreadCount );
 
-    // Save the tracks and vias.
-    for( TRACK* track = aBoard->m_Track;  track; track = track->Next() )
-        Format( track, aNestLevel );
+    auto format_lambda = [&] () -> size_t
+    {
+        PCB_IO worker( m_ctl );
 
-    if( aBoard->m_Track.GetCount() )
-        m_out->Print( 0, "\n" );
+        worker.m_board = m_board;
+        *worker.m_mapping = *m_mapping;
 
-    /// @todo Add warning here that the old segment filed zones are no longer supported and
-    ///       will not be saved.
+        for( size_t i = nextChunk++; i < chunks.size(); i = nextChunk++ )
+        {
+            FORMAT_CHUNK&    chunk = chunks[i];
+            STRING_FORMATTER formatter;
 
-    // Save the polygon (which are the newer technology) zones.
-    for( int i = 0; i < aBoard->GetAreaCount();  ++i )
-        Format( aBoard->GetArea( i ), aNestLevel );
+            worker.m_out = &formatter;
+
+            try
+            {
+                for( size_t j = chunk.m_first; j < chunk.m_last; ++j )
+                {
+                    worker.Format( sections[chunk.m_section][j], aNestLevel );
+
+                    if( chunk.m_section == MODULES )
+                        formatter.Print( 0, "\n" );
+                }
+            }
+            catch( ... )
+            {
+                chunk.m_error = std::current_exception();
+            }
+
+            chunk.m_text = formatter.GetString();
+
+            {
+                std::lock_guard<std::mutex> lock( chunkMutex );
+                chunk.m_done = true;
+            }
+
+            chunkDone.notify_all();
+        }
+
+        return 1;
+    };
+
+    auto writeSection = [&] ( int aSection )
+    {
+        if( parallelThreadCount <= 1 )
+        {
+            for( BOARD_ITEM* item : sections[aSection] )
+            {
+                Format( item, aNestLevel );
+
+                if( aSection == MODULES )
+                    m_out->Print( 0, "\n" );
+            }
+
+            return;
+        }
+
+        for( FORMAT_CHUNK& chunk : chunks )
+        {
+            if( chunk.m_section != aSection )
+                continue;
+
+            {
+                std::unique_lock<std::mutex> lock( chunkMutex );
+                chunkDone.wait( lock, [&chunk] () { return chunk.m_done; } );
+            }
+
+            if( chunk.m_error )
+                std::rethrow_exception( chunk.m_error );
+
+            m_out->Write( chunk.m_text );
+            std::string().swap( chunk.m_text );
+        }
+    };
+
+    if( parallelThreadCount > 1 )
+    {
+        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+            returns[ii] = std::async( std::launch::async, format_lambda );
+    }
+
+    try
+    {
+        // Save the modules.
+        writeSection( MODULES );
+
+        // Save the graphical items on the board (not owned by a module)
+        for( auto item : aBoard->Drawings() )
+            Format( item, aNestLevel );
+
+        if( aBoard->Drawings().Size() )
+            m_out->Print( 0, "\n" );
+
+        // Do not save MARKER_PCBs, they can be regenerated easily.
+
+        // Save the tracks and vias.
+        writeSection( TRACKS );
+
+        if( aBoard->m_Track.GetCount() )
+            m_out->Print( 0, "\n" );
+
+        /// @todo Add warning here that the old segment filed zones are no longer supported and
+        ///       will not be saved.
+
+        // Save the polygon (which are the newer technology) zones.
+        writeSection( ZONES );
+    }
+    catch( ... )
+    {
+        // Stop the workers before leaving
+        nextChunk = chunks.size();
+
+        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+        {
+            if( returns[ii].valid() )
+                returns[ii].wait();
+        }
+
+        throw;
+    }
+
+    for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+    {
+        if( returns[ii].valid() )
+            returns[ii].wait();
+    }
 }
 
 
@@ -1925,11 +2087,21 @@ PCB_IO::~PCB_IO()
 
 BOARD* PCB_IO::Load( const wxString& aFileName, BOARD* aAppendToMe, const PROPERTIES* aProperties )
 {
-    FILE_LINE_READER    reader( aFileName );
+    std::unique_ptr<LINE_READER> reader;
+
+    // Read the file in place when it can be mapped in memory, else read it line by line
+    try
+    {
+        reader.reset( new MAPPED_FILE_LINE_READER( aFileName ) );
+    }
+    catch( const IO_ERROR& )
+    {
+        reader.reset( new FILE_LINE_READER( aFileName ) );
+    }
 
     init( aProperties );
 
-    m_parser->SetLineReader( &reader );
+    m_parser->SetLineReader( reader.get() );
     m_parser->SetBoard( aAppendToMe );
 
     BOARD* board;
@@ -97,6 +97,41 @@ BEGIN_EVENT_TABLE( PCB_BASE_FRAME, EDA_DRAW_FRAME )
 END_EVENT_TABLE()
 
 
+REMOVED_BOARD_ITEM::REMOVED_BOARD_ITEM( const BOARD_ITEM* aItem ) :
+    m_item( aItem ),
+    m_type( aItem->Type() ),
+    m_module( nullptr )
+{
+    switch( m_type )
+    {
+    case PCB_PAD_T:
+    case PCB_MODULE_TEXT_T:
+    case PCB_MODULE_EDGE_T:
+        m_module = static_cast<const BOARD_ITEM*>( aItem->GetParent() );
+        break;
+
+    case PCB_MODULE_T:
+    {
+        const MODULE* module = static_cast<const MODULE*>( aItem );
+
+        m_children.push_back( &module->Reference() );
+        m_children.push_back( &module->Value() );
+
+        for( const D_PAD* pad : module->Pads() )
+            m_children.push_back( pad );
+
+        for( const BOARD_ITEM* item : module->GraphicalItems() )
+            m_children.push_back( item );
+
+        break;
+    }
+
+    default:
+        break;
+    }
+}
+
+
 PCB_BASE_FRAME::PCB_BASE_FRAME( KIWAY* aKiway, wxWindow* aParent, FRAME_T aFrameType,
         const wxString& aTitle, const wxPoint& aPos, const wxSize& aSize,
         long aStyle, const wxString & aFrameName ) :
@@ -296,6 +296,8 @@ PCB_EDIT_FRAME::PCB_EDIT_FRAME( KIWAY* aKiway, wxWindow* aParent ) :
     // We don't know what state board was in when it was lasat saved, so we have to
     // assume dirty
     m_ZoneFillsDirty = true;
+    m_boardChangesReported = false;
+    m_drc = nullptr;
 
     m_rotationAngle = 900;
     m_AboutTitle = "Pcbnew";
@@ -465,6 +467,9 @@ void PCB_EDIT_FRAME::SetBoard( BOARD* aBoard )
 {
     PCB_BASE_EDIT_FRAME::SetBoard( aBoard );
 
+    if( m_drc )
+        m_drc->InvalidateChangeIndex();
+
     if( IsGalCanvasActive() )
     {
         aBoard->GetConnectivity()->Build( aBoard );
@@ -1004,6 +1009,53 @@ void PCB_EDIT_FRAME::OnModify( )
     Update3DView();
 
     m_ZoneFillsDirty = true;
+
+    // The router tools and the incremental DRC update their indexes with the changes of
+    // a commit, reported just before by OnBoardItemsChanged().  They rebuild them after
+    // any other modification.
+    if( !m_boardChangesReported )
+    {
+        for( PNS::TOOL_BASE* tool : routerTools() )
+            tool->InvalidateWorld();
+
+        if( m_drc )
+            m_drc->InvalidateChangeIndex();
+    }
+
+    m_boardChangesReported = false;
+}
+
+
+void PCB_EDIT_FRAME::OnBoardItemsChanged( const std::vector<BOARD_ITEM*>& aChangedItems,
+                                          const std::vector<REMOVED_BOARD_ITEM>& aRemovedItems,
+                                          bool aModified )
+{
+    for( PNS::TOOL_BASE* tool : routerTools() )
+        tool->BoardItemsChanged( aChangedItems, aRemovedItems );
+
+    // Only the OnModify() call of these changes must keep the router world.  Without it,
+    // the next call is for other changes.
+    m_boardChangesReported = aModified;
+
+    if( m_drc )
+        m_drc->TestChangedItems( aChangedItems, aRemovedItems );
+}
+
+
+std::vector<PNS::TOOL_BASE*> PCB_EDIT_FRAME::routerTools() const
+{
+    std::vector<PNS::TOOL_BASE*> tools;
+
+    if( !m_toolManager )
+        return tools;
+
+    if( auto routerTool = m_toolManager->GetTool<ROUTER_TOOL>() )
+        tools.push_back( routerTool );
+
+    if( auto tunerTool = m_toolManager->GetTool<LENGTH_TUNER_TOOL>() )
+        tools.push_back( tunerTool );
+
+    return tools;
 }
 
 
@@ -64,6 +64,7 @@ class FP_LIB_TABLE;
 class BOARD_NETLIST_UPDATER;
 
 namespace PCB { struct IFACE; }     // KIFACE_I is in pcbnew.cpp
+namespace PNS { class TOOL_BASE; }
 
 /**
  * Enum to signify the result of editing tracks and vias
@@ -96,6 +97,9 @@ protected:
 
     DRC* m_drc;                                 ///< the DRC controller, see drc.cpp
 
+    /// True if the next OnModify() call is due to a commit reported by OnBoardItemsChanged()
+    bool m_boardChangesReported;
+
     PARAM_CFG_ARRAY   m_configParams;         ///< List of Pcbnew configuration settings.
 
     wxString          m_lastNetListRead;        ///< Last net list read with relative path.
@@ -103,6 +107,9 @@ protected:
     // The Tool Framework initalization
     void setupTools();
 
+    /// @return the interactive router tools, which keep their own copy of the board
+    std::vector<PNS::TOOL_BASE*> routerTools() const;
+
     // we'll use lower case function names for private member functions.
     void createPopUpMenuForZones( ZONE_CONTAINER* edge_zone, wxMenu* aPopMenu );
     void createPopUpMenuForFootprints( MODULE* aModule, wxMenu* aPopMenu );
@@ -589,6 +596,14 @@ public:
      */
     virtual void OnModify() override;
 
+    /**
+     * Function OnBoardItemsChanged
+     * updates the router world and runs the incremental DRC (if enabled) on the items
+     * changed by a commit, an undo or a redo.
+     */
+    virtual void OnBoardItemsChanged( const std::vector<BOARD_ITEM*>& aChangedItems,
+            const std::vector<REMOVED_BOARD_ITEM>& aRemovedItems, bool aModified ) override;
+
     /**
      * Function SetActiveLayer
      * will change the currently active layer to \a aLayer and also
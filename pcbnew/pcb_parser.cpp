@@ -28,6 +28,9 @@
  */
 
 #include <errno.h>
+#include <atomic>
+#include <future>
+#include <thread>
 #include <common.h>
 #include <confirm.h>
 #include <macros.h>
@@ -57,6 +60,7 @@ using namespace PCB_KEYS_T;
 void PCB_PARSER::init()
 {
     m_showLegacyZoneWarning = true;
+    m_readOnlyBoard = false;
     m_tooRecent = false;
     m_requiredVersion = 0;
     m_layerIndices.clear();
@@ -125,11 +129,17 @@ void PCB_PARSER::pushValueIntoMap( int aIndex, int aValue )
 
 double PCB_PARSER::parseDouble()
 {
+    double fval;
+
+    // Most numbers were already converted by the lexer
+    if( CurNumber( fval ) )
+        return fval;
+
     char* tmp;
 
     errno = 0;
 
-    double fval = strtod( CurText(), &tmp );
+    fval = strtod( CurText(), &tmp );
 
     if( errno )
     {
@@ -499,6 +509,7 @@ BOARD* PCB_PARSER::parseBOARD()
 BOARD* PCB_PARSER::parseBOARD_unchecked()
 {
     T token;
+    std::vector<DEFERRED_BLOCK> deferredBlocks;
 
     parseHeader();
 
@@ -555,20 +566,13 @@ BOARD* PCB_PARSER::parseBOARD_unchecked()
             m_board->Add( parseDIMENSION(), ADD_APPEND );
             break;
 
+        // These items are independent once the layers, nets and setup are known:
+        // parse them later, on several threads
         case T_module:
-            m_board->Add( parseMODULE(), ADD_APPEND );
-            break;
-
         case T_segment:
-            m_board->Add( parseTRACK(), ADD_INSERT );
-            break;
-
         case T_via:
-            m_board->Add( parseVIA(), ADD_INSERT );
-            break;
-
         case T_zone:
-            m_board->Add( parseZONE_CONTAINER(), ADD_APPEND );
+            deferBlock( deferredBlocks );
             break;
 
         case T_target:
@@ -582,6 +586,8 @@ BOARD* PCB_PARSER::parseBOARD_unchecked()
         }
     }
 
+    parseDeferredBlocks( deferredBlocks );
+
     if( m_undefinedLayers.size() > 0 )
     {
         bool deleteItems;
@@ -665,6 +671,176 @@ BOARD* PCB_PARSER::parseBOARD_unchecked()
 }
 
 
+void PCB_PARSER::deferBlock( std::vector<DEFERRED_BLOCK>& aBlocks )
+{
+    aBlocks.emplace_back();
+
+    DEFERRED_BLOCK& block = aBlocks.back();
+
+    block.m_lineNumber = CurLineNumber();
+    block.m_item = nullptr;
+
+    ReadListText( block.m_text );
+}
+
+
+void PCB_PARSER::parseDeferredBlocks( std::vector<DEFERRED_BLOCK>& aBlocks )
+{
+    size_t parallelThreadCount = std::min<size_t>( std::thread::hardware_concurrency(),
+            ( aBlocks.size() + 63 ) / 64 );
+
+    std::atomic<size_t> nextBlock( 0 );
+    std::vector<std::future<size_t>> returns( parallelThreadCount );
+    std::vector<PCB_PARSER*> workers( std::max<size_t>( parallelThreadCount, 1 ), nullptr );
+
+    // Each worker parser has a copy of the board header state, and is given to a single
+    // thread.  The board is only read by the workers.
+    for( PCB_PARSER*& worker : workers )
+    {
+        worker = new PCB_PARSER();
+        worker->m_board = m_board;
+        worker->m_readOnlyBoard = true;
+        worker->m_layerIndices = m_layerIndices;
+        worker->m_layerMasks = m_layerMasks;
+        worker->m_netCodes = m_netCodes;
+        worker->m_requiredVersion = m_requiredVersion;
+        worker->m_tooRecent = m_tooRecent;
+    }
+
+    auto parse_lambda = [&nextBlock, &aBlocks] ( PCB_PARSER* aParser,
+                                                 const wxString& aSource ) -> size_t
+    {
+        for( size_t i = nextBlock++; i < aBlocks.size(); i = nextBlock++ )
+        {
+            DEFERRED_BLOCK&    block = aBlocks[i];
+            STRING_LINE_READER reader( block.m_text, aSource, block.m_lineNumber - 1 );
+
+            aParser->PushReader( &reader );
+
+            try
+            {
+                block.m_item = aParser->parseDeferredItem();
+            }
+            catch( ... )
+            {
+                // Left to the main parser, which will report the error
+                block.m_item = nullptr;
+            }
+
+            aParser->PopReader();
+        }
+
+        return 1;
+    };
+
+    if( parallelThreadCount <= 1 )
+        parse_lambda( workers[0], CurSource() );
+    else
+    {
+        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+            returns[ii] = std::async( std::launch::async, parse_lambda, workers[ii],
+                                      CurSource() );
+
+        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+            returns[ii].wait();
+    }
+
+    for( PCB_PARSER* worker : workers )
+    {
+        m_undefinedLayers.insert( worker->m_undefinedLayers.begin(),
+                                  worker->m_undefinedLayers.end() );
+        m_requiredVersion = std::max( m_requiredVersion, worker->m_requiredVersion );
+        m_tooRecent = ( m_requiredVersion > SEXPR_BOARD_FILE_VERSION );
+
+        delete worker;
+    }
+
+    // PopReader() below forces a new line read: keep the position in the current line
+    const char* savedStart = start;
+    const char* savedNext = next;
+    const char* savedLimit = limit;
+
+    // Add the items in file order.  The items the workers could not parse are parsed
+    // here, when all the items before them are in the board.
+    for( size_t i = 0; i < aBlocks.size(); ++i )
+    {
+        DEFERRED_BLOCK& block = aBlocks[i];
+        BOARD_ITEM*     item = block.m_item;
+
+        if( !item )
+        {
+            STRING_LINE_READER reader( block.m_text, CurSource(), block.m_lineNumber - 1 );
+
+            PushReader( &reader );
+
+            try
+            {
+                item = parseDeferredItem();
+            }
+            catch( ... )
+            {
+                PopReader();
+
+                // The remaining items are not owned by the board yet
+                for( size_t j = i + 1; j < aBlocks.size(); ++j )
+                    delete aBlocks[j].m_item;
+
+                throw;
+            }
+
+            PopReader();
+        }
+
+        switch( item->Type() )
+        {
+        case PCB_TRACE_T:
+        case PCB_VIA_T:
+            m_board->Add( item, ADD_INSERT );
+            break;
+
+        default:
+            m_board->Add( item, ADD_APPEND );
+            break;
+        }
+
+        // Release the memory early, the text of large zones can be big
+        std::string().swap( block.m_text );
+    }
+
+    start = savedStart;
+    next = savedNext;
+    limit = savedLimit;
+}
+
+
+BOARD_ITEM* PCB_PARSER::parseDeferredItem()
+{
+    NeedLEFT();
+
+    T token = NextTok();
+
+    switch( token )
+    {
+    case T_module:
+        return parseMODULE();
+
+    case T_segment:
+        return parseTRACK();
+
+    case T_via:
+        return parseVIA();
+
+    case T_zone:
+        return parseZONE_CONTAINER();
+
+    default:
+        Expecting( "module, segment, via or zone" );
+    }
+
+    return nullptr;
+}
+
+
 void PCB_PARSER::parseHeader()
 {
     wxCHECK_RET( CurTok() == T_kicad_pcb,
@@ -3189,6 +3365,10 @@ ZONE_CONTAINER* PCB_PARSER::parseZONE_CONTAINER()
 
                     if( token == T_segment )    // deprecated
                     {
+                        // The user must be asked, this is done by the main parser
+                        if( m_readOnlyBoard )
+                            THROW_IO_ERROR( wxT( "legacy zone fill mode" ) );
+
                         // SEGMENT fill mode no longer supported.  Make sure user is OK with converting them.
                         if( m_showLegacyZoneWarning )
                         {
@@ -3442,6 +3622,8 @@ ZONE_CONTAINER* PCB_PARSER::parseZONE_CONTAINER()
 
         if( net )   // An existing net has the same net name. use it for the zone
             zone->SetNetCode( net->GetNet() );
+        else if( m_readOnlyBoard )
+            THROW_IO_ERROR( wxT( "zone net not found" ) );
         else    // Not existing net: add a new net to keep trace of the zone netname
         {
             int newnetcode = m_board->GetNetCount();
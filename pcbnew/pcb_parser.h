@@ -76,6 +76,17 @@ class PCB_PARSER : public PCB_LEXER
     int                 m_requiredVersion;  ///< set to the KiCad format version this board requires
 
     bool                m_showLegacyZoneWarning;
+    bool                m_readOnlyBoard;    ///< true in the parsers of the deferred blocks
+                                            ///< workers: m_board must not be modified
+
+    ///> A top level board item read as text, and parsed after the rest of the board
+    struct DEFERRED_BLOCK
+    {
+        std::string     m_text;             ///< the item text, see DSNLEXER::ReadListText()
+        int             m_lineNumber;       ///< the line number of the item in the file
+        BOARD_ITEM*     m_item;             ///< the parsed item, or NULL if it must be
+                                            ///< parsed again by the main parser
+    };
 
     ///> Converts net code using the mapping table if available,
     ///> otherwise returns unchanged net code if < 0 or if is is out of range
@@ -154,6 +165,26 @@ class PCB_PARSER : public PCB_LEXER
      */
     BOARD*          parseBOARD_unchecked();
 
+    /**
+     * Function deferBlock
+     * reads the text of the current top level item, without parsing it.
+     */
+    void            deferBlock( std::vector<DEFERRED_BLOCK>& aBlocks );
+
+    /**
+     * Function parseDeferredBlocks
+     * parses the deferred items on several threads, and adds them to the board in file
+     * order.  A worker parser cannot modify the board, nor show a message: the items it
+     * cannot parse alone are parsed again by this parser, which reports the errors.
+     */
+    void            parseDeferredBlocks( std::vector<DEFERRED_BLOCK>& aBlocks );
+
+    /**
+     * Function parseDeferredItem
+     * parses a deferred item: a module, a track segment, a via or a zone.
+     */
+    BOARD_ITEM*     parseDeferredItem();
+
 
     /**
      * Function lookUpLayer
@@ -88,11 +88,11 @@ void PlotSilkScreen( BOARD *aBoard, PLOTTER* aPlotter, LSET aLayerMask,
 
     if( layersmask_plotpads.any() )
     {
-        for( MODULE* Module = aBoard->m_Modules; Module; Module = Module->Next() )
+        for( MODULE* Module : aBoard->Modules() )
         {
             aPlotter->StartBlock( NULL );
 
-            for( D_PAD* pad = Module->PadsList(); pad; pad = pad->Next() )
+            for( D_PAD* pad : Module->Pads() )
             {
                 // See if the pad is on this layer
                 LSET masklayer = pad->GetLayerSet();
@@ -115,7 +115,7 @@ void PlotSilkScreen( BOARD *aBoard, PLOTTER* aPlotter, LSET aLayerMask,
     }
 
     // Plot footprints fields (ref, value ...)
-    for( MODULE* module = aBoard->m_Modules;  module;  module = module->Next() )
+    for( MODULE* module : aBoard->Modules() )
     {
         if( ! itemplotter.PlotAllTextsModule( module ) )
         {
@@ -299,7 +299,7 @@ void PlotStandardLayer( BOARD *aBoard, PLOTTER* aPlotter,
     // We plot here module texts, but they are usually on silkscreen layer,
     // so they are not plot here but plot by PlotSilkScreen()
     // Plot footprints fields (ref, value ...)
-    for( MODULE* module = aBoard->m_Modules;  module;  module = module->Next() )
+    for( MODULE* module : aBoard->Modules() )
     {
         if( ! itemplotter.PlotAllTextsModule( module ) )
         {
@@ -308,9 +308,9 @@ void PlotStandardLayer( BOARD *aBoard, PLOTTER* aPlotter,
         }
     }
 
-    for( MODULE* module = aBoard->m_Modules;  module;  module = module->Next() )
+    for( MODULE* module : aBoard->Modules() )
     {
-        for( BOARD_ITEM* item = module->GraphicalItemsList(); item; item = item->Next() )
+        for( BOARD_ITEM* item : module->GraphicalItems() )
         {
             if( !aLayerMask[ item->GetLayer() ] )
                 continue;
@@ -328,11 +328,11 @@ void PlotStandardLayer( BOARD *aBoard, PLOTTER* aPlotter,
     }
 
     // Plot footprint pads
-    for( MODULE* module = aBoard->m_Modules;  module;  module = module->Next() )
+    for( MODULE* module : aBoard->Modules() )
     {
         aPlotter->StartBlock( NULL );
 
-        for( D_PAD* pad = module->PadsList();  pad;  pad = pad->Next() )
+        for( D_PAD* pad : module->Pads() )
         {
             if( (pad->GetLayerSet() & aLayerMask) == 0 )
                 continue;
@@ -388,14 +388,12 @@ void PlotStandardLayer( BOARD *aBoard, PLOTTER* aPlotter,
 
                 // calculate the delta ( difference of lenght between 2 opposite edges )
                 // The delta.x is the delta along the X axis, therefore the delta of Y lenghts
-                wxSize delta;
+                deltaSize = wxSize( 0, 0 );
 
                 if( coord[0].y != coord[3].y )
-                    delta.x = coord[0].y - coord[3].y;
+                    deltaSize.x = coord[0].y - coord[3].y;
                 else
-                    delta.y = coord[1].x - coord[0].x;
-
-                pad->SetDelta( delta );
+                    deltaSize.y = coord[1].x - coord[0].x;
             }
             else
                 padPlotsSize = pad->GetSize() + extraSize;
@@ -412,15 +410,30 @@ void PlotStandardLayer( BOARD *aBoard, PLOTTER* aPlotter,
             if( pad->GetLayerSet()[F_Cu] )
                 color = color.LegacyMix( aBoard->Colors().GetItemColor( LAYER_PAD_FR ) );
 
-            // Temporary set the pad size to the required plot size:
-            wxSize tmppadsize = pad->GetSize();
+            // The size of a custom pad is only the size of its anchor pad.
+            // we expect margin.x = margin.y for custom pads.  Be sure the anchor pad
+            // is not bigger than the deflated shape, because this anchor will be added
+            // to the pad shape when plotting the pad
+            if( pad->GetShape() == PAD_SHAPE_CUSTOM && margin.x >= 0 )
+                padPlotsSize = pad->GetSize();
+
+            // The pad is plotted with the required plot size.  When the margins change it,
+            // a copy of the pad is plotted, to leave the board untouched (several layers
+            // can be plotted at the same time)
+            std::unique_ptr<D_PAD> resizedPad;
+
+            if( padPlotsSize != pad->GetSize() || deltaSize != pad->GetDelta() )
+            {
+                resizedPad.reset( new D_PAD( *pad ) );
+                resizedPad->SetSize( padPlotsSize );
+                resizedPad->SetDelta( deltaSize );
+                pad = resizedPad.get();
+            }
 
             switch( pad->GetShape() )
             {
             case PAD_SHAPE_CIRCLE:
             case PAD_SHAPE_OVAL:
-                pad->SetSize( padPlotsSize );
-
                 if( aPlotOpt.GetSkipPlotNPTH_Pads() &&
                     ( pad->GetSize() == pad->GetDrillSize() ) &&
                     ( pad->GetAttribute() == PAD_ATTRIB_HOLE_NOT_PLATED ) )
@@ -433,7 +446,6 @@ void PlotStandardLayer( BOARD *aBoard, PLOTTER* aPlotter,
             case PAD_SHAPE_RECT:
             case PAD_SHAPE_ROUNDRECT:
             case PAD_SHAPE_CHAMFERED_RECT:
-                pad->SetSize( padPlotsSize );
                 itemplotter.PlotPad( pad, color, plotMode );
                 break;
 
@@ -441,13 +453,6 @@ void PlotStandardLayer( BOARD *aBoard, PLOTTER* aPlotter,
                 // inflate/deflate a custom shape is a bit complex.
                 // so build a similar pad shape, and inflate/deflate the polygonal shape
                 {
-                // we expect margin.x = margin.y for custom pads
-                if( margin.x < 0 )
-                    // be sure the anchor pad is not bigger than the deflated shape
-                    // because this anchor will be added to the pad shape when plotting
-                    // the pad
-                    pad->SetSize( padPlotsSize );
-
                 D_PAD dummy( *pad );
                 SHAPE_POLY_SET shape;
                 pad->MergePrimitivesAsPolygon( &shape );
@@ -464,9 +469,6 @@ void PlotStandardLayer( BOARD *aBoard, PLOTTER* aPlotter,
                 }
                 break;
             }
-
-            pad->SetSize( tmppadsize );     // Restore the pad size
-            pad->SetDelta( deltaSize );
         }
 
         aPlotter->EndBlock( NULL );
@@ -487,7 +489,7 @@ void PlotStandardLayer( BOARD *aBoard, PLOTTER* aPlotter,
 
     aPlotter->StartBlock( NULL );
 
-    for( TRACK* track = aBoard->m_Track; track; track = track->Next() )
+    for( TRACK* track : aBoard->Tracks() )
     {
         const VIA* Via = dyn_cast<const VIA*>( track );
 
@@ -546,7 +548,7 @@ void PlotStandardLayer( BOARD *aBoard, PLOTTER* aPlotter,
     gbr_metadata.SetApertureAttrib( GBR_APERTURE_METADATA::GBR_APERTURE_ATTRIB_CONDUCTOR );
 
     // Plot tracks (not vias) :
-    for( TRACK* track = aBoard->m_Track; track; track = track->Next() )
+    for( TRACK* track : aBoard->Tracks() )
     {
         if( track->Type() == PCB_VIA_T )
             continue;
@@ -693,9 +695,9 @@ void PlotLayerOutlines( BOARD* aBoard, PLOTTER* aPlotter,
             int smallDrill = (aPlotOpt.GetDrillMarksType() == PCB_PLOT_PARAMS::SMALL_DRILL_SHAPE)
                                   ? SMALL_DRILL : INT_MAX;
 
-            for( MODULE* module = aBoard->m_Modules; module; module = module->Next() )
+            for( MODULE* module : aBoard->Modules() )
             {
-                for( D_PAD* pad = module->PadsList(); pad; pad = pad->Next() )
+                for( D_PAD* pad : module->Pads() )
                 {
                     wxSize hole = pad->GetDrillSize();
 
@@ -721,7 +723,7 @@ void PlotLayerOutlines( BOARD* aBoard, PLOTTER* aPlotter,
         }
 
         // Plot vias holes
-        for( TRACK* track = aBoard->m_Track; track; track = track->Next() )
+        for( TRACK* track : aBoard->Tracks() )
         {
             const VIA* via = dyn_cast<const VIA*>( track );
 
@@ -771,9 +773,9 @@ void PlotSolderMaskLayer( BOARD *aBoard, PLOTTER* aPlotter,
     // on this layer (like logos), not actually areas around pads.
     itemplotter.PlotBoardGraphicItems();
 
-    for( MODULE* module = aBoard->m_Modules;  module;  module = module->Next() )
+    for( MODULE* module : aBoard->Modules() )
     {
-        for( BOARD_ITEM* item = module->GraphicalItemsList(); item; item = item->Next() )
+        for( BOARD_ITEM* item : module->GraphicalItems() )
         {
             if( layer != item->GetLayer() )
                 continue;
@@ -802,7 +804,7 @@ void PlotSolderMaskLayer( BOARD *aBoard, PLOTTER* aPlotter,
     SHAPE_POLY_SET initialPolys;    // Contains exact shapes to plot
 
     // Plot pads
-    for( MODULE* module = aBoard->m_Modules; module; module = module->Next() )
+    for( MODULE* module : aBoard->Modules() )
     {
         // add shapes with exact size
         module->TransformPadsShapesWithClearanceToPolygon( layer, initialPolys, 0 );
@@ -818,7 +820,7 @@ void PlotSolderMaskLayer( BOARD *aBoard, PLOTTER* aPlotter,
         int via_clearance = aBoard->GetDesignSettings().m_SolderMaskMargin;
         int via_margin = via_clearance + inflate;
 
-        for( TRACK* track = aBoard->m_Track; track; track = track->Next() )
+        for( TRACK* track : aBoard->Tracks() )
         {
             const VIA* via = dyn_cast<const VIA*>( track );
 
@@ -38,7 +38,16 @@ using namespace std::placeholders;
 
 #include <cassert>
 #include <algorithm>
+#include <cmath>
 #include <limits>
+#include <memory>
+
+///> Nets having less distinct node positions are triangulated from scratch on each update
+static const unsigned s_incrementalMinNodes = 64;
+
+///> The triangulation of a net is rebuilt when more than 1/s_incrementalMaxChangeRatio of
+///> its node positions changed
+static const unsigned s_incrementalMaxChangeRatio = 4;
 
 static uint64_t getDistance( const CN_ANCHOR_PTR& aNode1, const CN_ANCHOR_PTR& aNode2 )
 {
@@ -155,6 +164,184 @@ class RN_NET::TRIANGULATOR_STATE
 private:
     std::vector<CN_ANCHOR_PTR>  m_allNodes;
 
+    ///> Triangulation of a large net, kept between updates together with its rectangular
+    ///> boundary, so only the nodes that moved have to be removed and inserted again
+    std::unique_ptr<hed::TRIANGULATION> m_triangulation;
+
+    ///> Nodes of m_triangulation, indexed by their position
+    std::unordered_map<uint64_t, hed::NODE_PTR> m_triNodes;
+
+    ///> Boundary of m_triangulation
+    int m_xmin, m_ymin, m_xmax, m_ymax;
+
+    static uint64_t positionKey( const hed::NODE_PTR& aNode )
+    {
+        return ( (uint64_t) (uint32_t) aNode->GetX() << 32 ) | (uint32_t) aNode->GetY();
+    }
+
+    void releaseTriangulation()
+    {
+        m_triangulation.reset();
+        m_triNodes.clear();
+    }
+
+    // Checks if the Delaunay edges between aNodes can be found in a triangulation with the
+    // rectangular boundary of m_triangulation: the corners must not lie in the circle having
+    // any pair of nodes as diameter, so the edges of the minimum spanning tree are never
+    // replaced by edges going to a corner.
+    bool boundaryFits( const std::vector<hed::NODE_PTR>& aNodes, int64_t& aXmin, int64_t& aYmin,
+                       int64_t& aXmax, int64_t& aYmax ) const
+    {
+        int64_t xmin = std::numeric_limits<int>::max();
+        int64_t ymin = std::numeric_limits<int>::max();
+        int64_t xmax = std::numeric_limits<int>::min();
+        int64_t ymax = std::numeric_limits<int>::min();
+
+        for( const auto& n : aNodes )
+        {
+            xmin = std::min<int64_t>( xmin, n->GetX() );
+            ymin = std::min<int64_t>( ymin, n->GetY() );
+            xmax = std::max<int64_t>( xmax, n->GetX() );
+            ymax = std::max<int64_t>( ymax, n->GetY() );
+        }
+
+        int64_t radius = std::ceil( std::hypot( xmax - xmin, ymax - ymin ) / 2.0 );
+
+        aXmin = xmin - radius;
+        aYmin = ymin - radius;
+        aXmax = xmax + radius;
+        aYmax = ymax + radius;
+
+        return m_triangulation && aXmin > m_xmin && aYmin > m_ymin
+               && aXmax < m_xmax && aYmax < m_ymax;
+    }
+
+    // Creates m_triangulation for aNodes, with a boundary leaving room for the nodes to move
+    void createTriangulation( std::vector<hed::NODE_PTR>& aNodes )
+    {
+        int64_t xmin, ymin, xmax, ymax;
+
+        releaseTriangulation();
+        boundaryFits( aNodes, xmin, ymin, xmax, ymax );
+
+        // Keep the coordinate differences in the int range
+        const int64_t limit = std::numeric_limits<int>::max() / 2;
+        int64_t margin = ( xmax - xmin + ymax - ymin ) / 4;
+
+        m_xmin = std::max( xmin - margin, -limit );
+        m_ymin = std::max( ymin - margin, -limit );
+        m_xmax = std::min( xmax + margin, limit );
+        m_ymax = std::min( ymax + margin, limit );
+
+        if( xmin <= m_xmin || ymin <= m_ymin || xmax >= m_xmax || ymax >= m_ymax )
+            return;
+
+        m_triangulation.reset( new hed::TRIANGULATION );
+        m_triangulation->CreateDelaunay( aNodes.begin(), aNodes.end(),
+                                         m_xmin, m_ymin, m_xmax, m_ymax );
+
+        for( const auto& n : aNodes )
+            m_triNodes[positionKey( n )] = n;
+    }
+
+    // Updates m_triangulation to contain aNodes, by removing the nodes that are gone and
+    // inserting the new ones. Returns false if the triangulation has to be created again.
+    bool updateTriangulation( std::vector<hed::NODE_PTR>& aNodes )
+    {
+        int64_t xmin, ymin, xmax, ymax;
+
+        if( !boundaryFits( aNodes, xmin, ymin, xmax, ymax ) )
+            return false;
+
+        std::unordered_map<uint64_t, hed::NODE_PTR> triNodes;
+        std::vector<hed::NODE_PTR> added;
+
+        triNodes.reserve( aNodes.size() );
+
+        for( const auto& n : aNodes )
+        {
+            uint64_t key = positionKey( n );
+            auto it = m_triNodes.find( key );
+
+            if( it != m_triNodes.end() )
+            {
+                // The triangulation node stands now for the anchors of the new one
+                it->second->SetId( n->Id() );
+                triNodes[key] = it->second;
+                m_triNodes.erase( it );
+            }
+            else
+            {
+                triNodes[key] = n;
+                added.push_back( n );
+            }
+        }
+
+        // Nodes left in m_triNodes are gone
+        if( ( added.size() + m_triNodes.size() ) * s_incrementalMaxChangeRatio > aNodes.size() )
+            return false;
+
+        for( const auto& removed : m_triNodes )
+        {
+            if( !m_triangulation->RemoveNode( removed.second ) )
+                return false;
+        }
+
+        for( const auto& n : added )
+        {
+            if( !m_triangulation->InsertNode( n ) )
+                return false;
+        }
+
+        m_triNodes = std::move( triNodes );
+
+        return true;
+    }
+
+    // Adds the Delaunay edges between aNodes (nodes with unique positions, not colinear)
+    // to aMstEdges
+    void triangulate( std::vector<hed::NODE_PTR>& aNodes, std::list<CN_EDGE>& aMstEdges )
+    {
+        if( aNodes.size() >= s_incrementalMinNodes )
+        {
+            if( !updateTriangulation( aNodes ) )
+                createTriangulation( aNodes );
+        }
+        else
+        {
+            releaseTriangulation();
+        }
+
+        // The edges are linked to their triangulation, and cleared when it is destroyed
+        hed::TRIANGULATION       triangulator;
+        std::list<hed::EDGE_PTR> triangEdges;
+
+        if( m_triangulation )
+        {
+            m_triangulation->GetEdges( triangEdges );
+
+            // Skip the edges going to the corners of the boundary (not associated with an anchor)
+            triangEdges.remove_if( [this]( const hed::EDGE_PTR& aEdge )
+                    {
+                        return !m_triNodes.count( positionKey( aEdge->GetSourceNode() ) )
+                               || !m_triNodes.count( positionKey( aEdge->GetTargetNode() ) );
+                    } );
+        }
+        else
+        {
+            triangulator.CreateDelaunay( aNodes.begin(), aNodes.end() );
+            triangulator.GetEdges( triangEdges );
+        }
+
+        for( const auto& e : triangEdges )
+        {
+            const auto& src = m_allNodes[ e->GetSourceNode()->Id() ];
+            const auto& dst = m_allNodes[ e->GetTargetNode()->Id() ];
+
+            aMstEdges.emplace_back( src, dst, getDistance( src, dst ) );
+        }
+    }
+
     std::list<hed::EDGE_PTR> hedTriangulation( std::vector<hed::NODE_PTR>& aNodes )
     {
         hed::TRIANGULATION triangulator;
@@ -204,7 +391,6 @@ public:
     const std::list<CN_EDGE> Triangulate()
     {
         std::list<CN_EDGE> mstEdges;
-        std::list<hed::EDGE_PTR> triangEdges;
         std::vector<hed::NODE_PTR> triNodes;
 
         using ANCHOR_LIST = std::vector<CN_ANCHOR_PTR>;
@@ -264,10 +450,13 @@ public:
 
         if( triNodes.size() == 1 )
         {
+            releaseTriangulation();
             return mstEdges;
         }
         else if( areNodesColinear( triNodes ) )
         {
+            releaseTriangulation();
+
             // special case: all nodes are on the same line - there's no
             // triangulation for such set. In this case, we sort along any coordinate
             // and chain the nodes together.
@@ -280,17 +469,7 @@ public:
         }
         else
         {
-            hed::TRIANGULATION triangulator;
-            triangulator.CreateDelaunay( triNodes.begin(), triNodes.end() );
-            triangulator.GetEdges( triangEdges );
-
-            for( auto e : triangEdges )
-            {
-                auto    src = m_allNodes[ e->GetSourceNode()->Id() ];
-                auto    dst = m_allNodes[ e->GetTargetNode()->Id() ];
-
-                mstEdges.emplace_back( src, dst, getDistance( src, dst ) );
-            }
+            triangulate( triNodes, mstEdges );
         }
 
         for( unsigned int i = 0; i < anchorChains.size(); i++ )
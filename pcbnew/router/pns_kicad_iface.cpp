@@ -66,39 +66,6 @@
 #include "pns_debug_decorator.h"
 #include "router_preview_item.h"
 
-class PNS_PCBNEW_RULE_RESOLVER : public PNS::RULE_RESOLVER
-{
-public:
-    PNS_PCBNEW_RULE_RESOLVER( BOARD* aBoard, PNS::ROUTER* aRouter );
-    virtual ~PNS_PCBNEW_RULE_RESOLVER();
-
-    virtual int Clearance( const PNS::ITEM* aA, const PNS::ITEM* aB ) const override;
-    virtual int Clearance( int aNetCode ) const override;
-    virtual int DpCoupledNet( int aNet ) override;
-    virtual int DpNetPolarity( int aNet ) override;
-    virtual bool DpNetPair( PNS::ITEM* aItem, int& aNetP, int& aNetN ) override;
-    virtual wxString NetName( int aNet ) override;
-
-private:
-    struct CLEARANCE_ENT
-    {
-        int coupledNet;
-        int dpClearance;
-        int clearance;
-    };
-
-    int localPadClearance( const PNS::ITEM* aItem ) const;
-    int matchDpSuffix( wxString aNetName, wxString& aComplementNet, wxString& aBaseDpName );
-
-    PNS::ROUTER* m_router;
-    BOARD*       m_board;
-
-    std::vector<CLEARANCE_ENT> m_netClearanceCache;
-    std::unordered_map<const D_PAD*, int> m_localClearanceCache;
-    int m_defaultClearance;
-};
-
-
 PNS_PCBNEW_RULE_RESOLVER::PNS_PCBNEW_RULE_RESOLVER( BOARD* aBoard, PNS::ROUTER* aRouter ) :
     m_router( aRouter ),
     m_board( aBoard )
@@ -107,6 +74,23 @@ PNS_PCBNEW_RULE_RESOLVER::PNS_PCBNEW_RULE_RESOLVER( BOARD* aBoard, PNS::ROUTER*
 
     PNS::TOPOLOGY topo( world );
     m_netClearanceCache.resize( m_board->GetNetCount() );
+    m_netClass.assign( m_board->GetNetCount(), 0 );
+    m_netLocalClearance.assign( m_board->GetNetCount(), 0 );
+
+    auto defaultRule = m_board->GetDesignSettings().m_NetClasses.Find ("Default");
+
+    if( defaultRule )
+    {
+        m_defaultClearance = defaultRule->GetClearance();
+    }
+    else
+    {
+        m_defaultClearance = Millimeter2iu(0.254);
+    }
+
+    // Clearance of each netclass, the first one being used by the items of no net
+    std::map<wxString, int> classIndex;
+    std::vector<int> classClearance = { m_defaultClearance };
 
     // Build clearance cache for net classes
     for( unsigned int i = 0; i < m_board->GetNetCount(); i++ )
@@ -127,6 +111,16 @@ PNS_PCBNEW_RULE_RESOLVER::PNS_PCBNEW_RULE_RESOLVER( BOARD* aBoard, PNS::ROUTER*
         ent.dpClearance = nc->GetDiffPairGap();
         m_netClearanceCache[i] = ent;
 
+        auto cls = classIndex.find( netClassName );
+
+        if( cls == classIndex.end() )
+        {
+            cls = classIndex.emplace( netClassName, (int) classClearance.size() ).first;
+            classClearance.push_back( clearance );
+        }
+
+        m_netClass[i] = cls->second;
+
         wxLogTrace( "PNS", "Add net %u netclass %s clearance %d Diff Pair clearance %d",
                 i, netClassName.mb_str(), clearance, ent.dpClearance );
     }
@@ -145,18 +139,26 @@ PNS_PCBNEW_RULE_RESOLVER::PNS_PCBNEW_RULE_RESOLVER( BOARD* aBoard, PNS::ROUTER*
 
             else if( moduleClearance > 0 )
                 m_localClearanceCache[ pad ] = moduleClearance;
+
+            else
+                continue;
+
+            if( pad->GetNetCode() >= 0 && pad->GetNetCode() < (int) m_netLocalClearance.size() )
+                m_netLocalClearance[ pad->GetNetCode() ] = 1;
         }
     }
 
-    auto defaultRule = m_board->GetDesignSettings().m_NetClasses.Find ("Default");
+    // Build the clearance matrix of the netclass pairs
+    m_classCount = (int) classClearance.size();
+    m_classClearance.resize( m_classCount * m_classCount );
 
-    if( defaultRule )
-    {
-        m_defaultClearance = defaultRule->GetClearance();
-    }
-    else
+    for( int i = 0; i < m_classCount; i++ )
     {
-        m_defaultClearance = Millimeter2iu(0.254);
+        for( int j = 0; j < m_classCount; j++ )
+        {
+            m_classClearance[ i * m_classCount + j ] = std::max( classClearance[i],
+                                                                 classClearance[j] );
+        }
     }
 }
 
@@ -185,13 +187,20 @@ int PNS_PCBNEW_RULE_RESOLVER::localPadClearance( const PNS::ITEM* aItem ) const
 int PNS_PCBNEW_RULE_RESOLVER::Clearance( const PNS::ITEM* aA, const PNS::ITEM* aB ) const
 {
     int net_a = aA->Net();
-    int cl_a = ( net_a >= 0 ? m_netClearanceCache[net_a].clearance : m_defaultClearance );
     int net_b = aB->Net();
-    int cl_b = ( net_b >= 0 ? m_netClearanceCache[net_b].clearance : m_defaultClearance );
+    int class_a = netClass( net_a );
+    int class_b = netClass( net_b );
+
+    // Unless a pad of their nets has its own clearance, the items follow their netclasses
+    if( !hasLocalClearance( net_a ) && !hasLocalClearance( net_b ) )
+        return m_classClearance[ class_a * m_classCount + class_b ];
+
+    int cl_a = m_classClearance[ class_a * ( m_classCount + 1 ) ];
+    int cl_b = m_classClearance[ class_b * ( m_classCount + 1 ) ];
 
     // Pad clearance is 0 if the ITEM* is not a pad
-    int pad_a = localPadClearance( aA );
-    int pad_b = localPadClearance( aB );
+    int pad_a = hasLocalClearance( net_a ) ? localPadClearance( aA ) : 0;
+    int pad_b = hasLocalClearance( net_b ) ? localPadClearance( aB ) : 0;
 
     if( pad_a > 0 )
         cl_a = pad_a;
@@ -470,6 +479,9 @@ PNS_KICAD_IFACE::PNS_KICAD_IFACE()
     m_router = nullptr;
     m_debugDecorator = nullptr;
     m_dispOptions = nullptr;
+    m_syncedWorld = nullptr;
+    m_committing = false;
+    m_worstPadClearance = 0;
 }
 
 
@@ -827,7 +839,7 @@ bool PNS_KICAD_IFACE::syncZone( PNS::NODE* aWorld, ZONE_CONTAINER* aZone )
                 solid->SetShape( triShape );
                 solid->SetRoutable( false );
 
-                aWorld->Add( std::move( solid ) );
+                addSolid( aWorld, aZone, std::move( solid ) );
             }
         }
     }
@@ -836,7 +848,8 @@ bool PNS_KICAD_IFACE::syncZone( PNS::NODE* aWorld, ZONE_CONTAINER* aZone )
 }
 
 
-bool PNS_KICAD_IFACE::syncTextItem( PNS::NODE* aWorld, EDA_TEXT* aText, PCB_LAYER_ID aLayer )
+bool PNS_KICAD_IFACE::syncTextItem( PNS::NODE* aWorld, EDA_TEXT* aText, PCB_LAYER_ID aLayer,
+                                    const BOARD_ITEM* aOwner )
 {
     if( !IsCopperLayer( aLayer ) )
         return false;
@@ -861,7 +874,7 @@ bool PNS_KICAD_IFACE::syncTextItem( PNS::NODE* aWorld, EDA_TEXT* aText, PCB_LAYE
         solid->SetShape( new SHAPE_SEGMENT( start, end, textWidth ) );
         solid->SetRoutable( false );
 
-        aWorld->Add( std::move( solid ) );
+        addSolid( aWorld, aOwner, std::move( solid ) );
     }
 
     return true;
@@ -888,7 +901,8 @@ bool PNS_KICAD_IFACE::syncTextItem( PNS::NODE* aWorld, EDA_TEXT* aText, PCB_LAYE
 }
 
 
-bool PNS_KICAD_IFACE::syncGraphicalItem( PNS::NODE* aWorld, DRAWSEGMENT* aItem )
+bool PNS_KICAD_IFACE::syncGraphicalItem( PNS::NODE* aWorld, DRAWSEGMENT* aItem,
+                                         const BOARD_ITEM* aOwner )
 {
     std::vector<SHAPE_SEGMENT*> segs;
 
@@ -975,7 +989,7 @@ bool PNS_KICAD_IFACE::syncGraphicalItem( PNS::NODE* aWorld, DRAWSEGMENT* aItem )
         solid->SetShape( seg );
         solid->SetRoutable( false );
 
-        aWorld->Add( std::move( solid ) );
+        addSolid( aWorld, aOwner, std::move( solid ) );
     }
 
     return true;
@@ -988,85 +1002,251 @@ void PNS_KICAD_IFACE::SetBoard( BOARD* aBoard )
 }
 
 
-void PNS_KICAD_IFACE::SyncWorld( PNS::NODE *aWorld )
+void PNS_KICAD_IFACE::syncModule( PNS::NODE* aWorld, MODULE* aModule )
 {
-    int worstPadClearance = 0;
-
-    if( !m_board )
+    for( auto pad : aModule->Pads() )
     {
-        wxLogTrace( "PNS", "No board attached, aborting sync." );
-        return;
+        if( auto solid = syncPad( pad ) )
+            addSolid( aWorld, aModule, std::move( solid ) );
+
+        m_worstPadClearance = std::max( m_worstPadClearance, pad->GetLocalClearance() );
     }
 
-    for( auto gitem : m_board->Drawings() )
+    syncTextItem( aWorld, &aModule->Reference(), aModule->Reference().GetLayer(), aModule );
+    syncTextItem( aWorld, &aModule->Value(), aModule->Value().GetLayer(), aModule );
+
+    if( aModule->IsNetTie() )
+        return;
+
+    for( auto mgitem : aModule->GraphicalItems() )
     {
-        if ( gitem->Type() == PCB_LINE_T )
+        if( mgitem->Type() == PCB_MODULE_EDGE_T )
         {
-            syncGraphicalItem( aWorld, static_cast<DRAWSEGMENT*>( gitem ) );
+            syncGraphicalItem( aWorld, static_cast<DRAWSEGMENT*>( mgitem ), aModule );
         }
-        else if( gitem->Type() == PCB_TEXT_T )
+        else if( mgitem->Type() == PCB_MODULE_TEXT_T )
         {
-            syncTextItem( aWorld, static_cast<TEXTE_PCB*>( gitem ), gitem->GetLayer() );
+            syncTextItem( aWorld, dynamic_cast<TEXTE_MODULE*>( mgitem ), mgitem->GetLayer(),
+                          aModule );
         }
     }
+}
 
-    for( auto zone : m_board->Zones() )
+
+void PNS_KICAD_IFACE::syncItem( PNS::NODE* aWorld, BOARD_ITEM* aItem )
+{
+    switch( aItem->Type() )
     {
-        syncZone( aWorld, zone );
+    case PCB_LINE_T:
+        syncGraphicalItem( aWorld, static_cast<DRAWSEGMENT*>( aItem ), aItem );
+        break;
+
+    case PCB_TEXT_T:
+        syncTextItem( aWorld, static_cast<TEXTE_PCB*>( aItem ), aItem->GetLayer(), aItem );
+        break;
+
+    case PCB_ZONE_AREA_T:
+        syncZone( aWorld, static_cast<ZONE_CONTAINER*>( aItem ) );
+        break;
+
+    case PCB_MODULE_T:
+        syncModule( aWorld, static_cast<MODULE*>( aItem ) );
+        break;
+
+    case PCB_TRACE_T:
+        if( auto segment = syncTrack( static_cast<TRACK*>( aItem ) ) )
+            aWorld->Add( std::move( segment ) );
+        break;
+
+    case PCB_VIA_T:
+        if( auto via = syncVia( static_cast<VIA*>( aItem ) ) )
+            aWorld->Add( std::move( via ) );
+        break;
+
+    default:
+        break;
     }
+}
 
-    for( auto module : m_board->Modules() )
-    {
-        for( auto pad : module->Pads() )
-        {
-            if( auto solid = syncPad( pad ) )
-                aWorld->Add( std::move( solid ) );
 
-            worstPadClearance = std::max( worstPadClearance, pad->GetLocalClearance() );
-        }
+void PNS_KICAD_IFACE::syncRules( PNS::NODE* aWorld )
+{
+    int worstRuleClearance = m_board->GetDesignSettings().GetBiggestClearanceValue();
 
-        syncTextItem( aWorld, &module->Reference(), module->Reference().GetLayer() );
-        syncTextItem( aWorld, &module->Value(), module->Value().GetLayer() );
+    delete m_ruleResolver;
+    m_ruleResolver = new PNS_PCBNEW_RULE_RESOLVER( m_board, m_router );
 
-        if( module->IsNetTie() )
-            continue;
+    aWorld->SetRuleResolver( m_ruleResolver );
+    aWorld->SetMaxClearance( 4 * std::max( m_worstPadClearance, worstRuleClearance ) );
+}
 
-        for( auto mgitem : module->GraphicalItems() )
-        {
-            if( mgitem->Type() == PCB_MODULE_EDGE_T )
-            {
-                syncGraphicalItem( aWorld, static_cast<DRAWSEGMENT*>( mgitem ) );
-            }
-            else if( mgitem->Type() == PCB_MODULE_TEXT_T )
-            {
-                syncTextItem( aWorld, dynamic_cast<TEXTE_MODULE*>( mgitem ), mgitem->GetLayer() );
-            }
-        }
+
+void PNS_KICAD_IFACE::addSolid( PNS::NODE* aWorld, const BOARD_ITEM* aOwner,
+                                std::unique_ptr<PNS::SOLID> aSolid )
+{
+    m_ownedSolids[aOwner].push_back( aSolid.get() );
+    aWorld->Add( std::move( aSolid ) );
+}
+
+
+void PNS_KICAD_IFACE::removeSolids( PNS::NODE* aWorld, const BOARD_ITEM* aOwner )
+{
+    auto it = m_ownedSolids.find( aOwner );
+
+    if( it == m_ownedSolids.end() )
+        return;
+
+    for( PNS::ITEM* solid : it->second )
+        aWorld->Remove( solid );
+
+    m_ownedSolids.erase( it );
+}
+
+
+void PNS_KICAD_IFACE::removeTrack( PNS::NODE* aWorld, const BOARD_CONNECTED_ITEM* aTrack )
+{
+    PNS::NODE::ITEM_VECTOR items;
+
+    // The router adds and removes segments and vias by itself: they are looked up in the
+    // world rather than recorded when synced
+    aWorld->FindItemsByParent( aTrack, items );
+
+    for( PNS::ITEM* item : items )
+        aWorld->Remove( item );
+}
+
+
+void PNS_KICAD_IFACE::SyncWorld( PNS::NODE *aWorld )
+{
+    m_ownedSolids.clear();
+    m_changedItems.clear();
+    m_removedOwners.clear();
+    m_removedTracks.clear();
+    m_syncedWorld = nullptr;
+    m_worstPadClearance = 0;
+
+    if( !m_board )
+    {
+        wxLogTrace( "PNS", "No board attached, aborting sync." );
+        return;
     }
 
+    for( auto gitem : m_board->Drawings() )
+        syncItem( aWorld, gitem );
+
+    for( auto zone : m_board->Zones() )
+        syncItem( aWorld, zone );
+
+    for( auto module : m_board->Modules() )
+        syncItem( aWorld, module );
+
     for( auto t : m_board->Tracks() )
+        syncItem( aWorld, t );
+
+    syncRules( aWorld );
+
+    m_syncedWorld = aWorld;
+}
+
+
+bool PNS_KICAD_IFACE::UpdateWorld( PNS::NODE* aWorld )
+{
+    if( !m_board || aWorld != m_syncedWorld )
+        return false;
+
+    wxLogTrace( "PNS", "Update world: %zu changed, %zu removed items", m_changedItems.size(),
+                m_removedOwners.size() + m_removedTracks.size() );
+
+    for( const BOARD_ITEM* item : m_removedOwners )
+        removeSolids( aWorld, item );
+
+    for( const BOARD_CONNECTED_ITEM* track : m_removedTracks )
+        removeTrack( aWorld, track );
+
+    // A changed item is synced again from scratch.  The worst pad clearance is not lowered
+    // by the removed pads, which only makes the collision searches a bit wider.
+    for( BOARD_ITEM* item : m_changedItems )
     {
-        KICAD_T type = t->Type();
+        if( item->Type() == PCB_TRACE_T || item->Type() == PCB_VIA_T )
+            removeTrack( aWorld, static_cast<BOARD_CONNECTED_ITEM*>( item ) );
+        else
+            removeSolids( aWorld, item );
+
+        syncItem( aWorld, item );
+    }
+
+    m_changedItems.clear();
+    m_removedOwners.clear();
+    m_removedTracks.clear();
+
+    // The rules are quick to gather, and the board setup may have changed meanwhile
+    syncRules( aWorld );
+
+    return true;
+}
+
+
+void PNS_KICAD_IFACE::BoardItemsChanged( const std::vector<BOARD_ITEM*>& aChangedItems,
+                                         const std::vector<REMOVED_BOARD_ITEM>& aRemovedItems )
+{
+    // The world is rebuilt anyway, or already holds the changes made by the router
+    if( !m_syncedWorld || m_committing )
+        return;
 
-        if( type == PCB_TRACE_T )
+    // The items of a module are synced with their module
+    auto owner = []( BOARD_ITEM* aItem ) -> BOARD_ITEM*
+    {
+        switch( aItem->Type() )
         {
-            if( auto segment = syncTrack( t ) )
-                aWorld->Add( std::move( segment ) );
+        case PCB_PAD_T:
+        case PCB_MODULE_TEXT_T:
+        case PCB_MODULE_EDGE_T:
+            return static_cast<BOARD_ITEM*>( aItem->GetParent() );
+
+        default:
+            return aItem;
         }
-        else if( type == PCB_VIA_T )
+    };
+
+    // The removed items may already be deleted: they are only looked up by pointer, in the
+    // solid owners or, for the tracks and vias, in the parents of the world items
+    std::unordered_set<const BOARD_ITEM*> removedItems;
+
+    for( const REMOVED_BOARD_ITEM& removed : aRemovedItems )
+        removedItems.insert( removed.m_item );
+
+    for( const REMOVED_BOARD_ITEM& removed : aRemovedItems )
+    {
+        const BOARD_ITEM* item = removed.m_item;
+
+        // Removing an item from a module changes the module, unless it is removed too
+        if( removed.m_module )
         {
-            if( auto via = syncVia( static_cast<VIA*>( t ) ) )
-                aWorld->Add( std::move( via ) );
+            if( !removedItems.count( removed.m_module ) )
+                m_changedItems.insert( const_cast<BOARD_ITEM*>( removed.m_module ) );
+
+            continue;
         }
+
+        m_changedItems.erase( const_cast<BOARD_ITEM*>( item ) );
+
+        if( m_ownedSolids.count( item ) )
+            m_removedOwners.insert( item );
+        else if( removed.m_type == PCB_TRACE_T || removed.m_type == PCB_VIA_T )
+            m_removedTracks.insert( static_cast<const BOARD_CONNECTED_ITEM*>( item ) );
     }
 
-    int worstRuleClearance = m_board->GetDesignSettings().GetBiggestClearanceValue();
+    for( BOARD_ITEM* item : aChangedItems )
+        m_changedItems.insert( owner( item ) );
+}
 
-    delete m_ruleResolver;
-    m_ruleResolver = new PNS_PCBNEW_RULE_RESOLVER( m_board, m_router );
 
-    aWorld->SetRuleResolver( m_ruleResolver );
-    aWorld->SetMaxClearance( 4 * std::max(worstPadClearance, worstRuleClearance ) );
+void PNS_KICAD_IFACE::InvalidateWorld()
+{
+    m_syncedWorld = nullptr;
+    m_changedItems.clear();
+    m_removedOwners.clear();
+    m_removedTracks.clear();
 }
 
 
@@ -1212,7 +1392,12 @@ void PNS_KICAD_IFACE::AddItem( PNS::ITEM* aItem )
 void PNS_KICAD_IFACE::Commit()
 {
     EraseView();
+
+    // The router applies the committed changes to its world by itself
+    m_committing = true;
     m_commit->Push( _( "Added a track" ) );
+    m_committing = false;
+
     m_commit.reset( new BOARD_COMMIT( m_tool ) );
 }
 
@@ -22,15 +22,20 @@
 #ifndef __PNS_KICAD_IFACE_H
 #define __PNS_KICAD_IFACE_H
 
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "pns_router.h"
 
-class PNS_PCBNEW_RULE_RESOLVER;
 class PNS_PCBNEW_DEBUG_DECORATOR;
 
 class BOARD;
 class BOARD_COMMIT;
+class BOARD_ITEM;
+class BOARD_CONNECTED_ITEM;
+class D_PAD;
+struct REMOVED_BOARD_ITEM;
 class PCB_DISPLAY_OPTIONS;
 class PCB_TOOL_BASE;
 
@@ -39,6 +44,64 @@ namespace KIGFX
     class VIEW;
 }
 
+/**
+ * Class PNS_PCBNEW_RULE_RESOLVER
+ * gives the router the clearances and the differential pairs of a board, from its
+ * netclasses and the local clearances of its pads.
+ */
+class PNS_PCBNEW_RULE_RESOLVER : public PNS::RULE_RESOLVER
+{
+public:
+    PNS_PCBNEW_RULE_RESOLVER( BOARD* aBoard, PNS::ROUTER* aRouter );
+    virtual ~PNS_PCBNEW_RULE_RESOLVER();
+
+    virtual int Clearance( const PNS::ITEM* aA, const PNS::ITEM* aB ) const override;
+    virtual int Clearance( int aNetCode ) const override;
+    virtual int DpCoupledNet( int aNet ) override;
+    virtual int DpNetPolarity( int aNet ) override;
+    virtual bool DpNetPair( PNS::ITEM* aItem, int& aNetP, int& aNetN ) override;
+    virtual wxString NetName( int aNet ) override;
+
+private:
+    struct CLEARANCE_ENT
+    {
+        int coupledNet;
+        int dpClearance;
+        int clearance;
+    };
+
+    int localPadClearance( const PNS::ITEM* aItem ) const;
+    int matchDpSuffix( wxString aNetName, wxString& aComplementNet, wxString& aBaseDpName );
+
+    ///> Returns the index of the netclass of aNet in the clearance matrix
+    int netClass( int aNet ) const
+    {
+        if( aNet >= 0 && aNet < (int) m_netClass.size() )
+            return m_netClass[aNet];
+
+        return 0;
+    }
+
+    ///> Returns true if a pad of aNet has a clearance of its own
+    bool hasLocalClearance( int aNet ) const
+    {
+        return aNet >= 0 && aNet < (int) m_netLocalClearance.size() && m_netLocalClearance[aNet];
+    }
+
+    PNS::ROUTER* m_router;
+    BOARD*       m_board;
+
+    std::vector<CLEARANCE_ENT> m_netClearanceCache;
+    std::unordered_map<const D_PAD*, int> m_localClearanceCache;
+    int m_defaultClearance;
+
+    std::vector<int>  m_netClass;           ///< netclass index of each net, 0 is the default
+    std::vector<char> m_netLocalClearance;  ///< nets having a pad with its own clearance
+    std::vector<int>  m_classClearance;     ///< clearance of each pair of netclasses
+    int               m_classCount;
+};
+
+
 class PNS_KICAD_IFACE : public PNS::ROUTER_IFACE {
 public:
     PNS_KICAD_IFACE();
@@ -51,6 +114,18 @@ public:
     void SetBoard( BOARD* aBoard );
     void SetView( KIGFX::VIEW* aView );
     void SyncWorld( PNS::NODE* aWorld ) override;
+    bool UpdateWorld( PNS::NODE* aWorld ) override;
+
+    /**
+     * Records the board items added, modified or removed by a commit, to apply them to the
+     * world at the next UpdateWorld() call.  The removed items are only used as keys.
+     */
+    void BoardItemsChanged( const std::vector<BOARD_ITEM*>& aChangedItems,
+                            const std::vector<REMOVED_BOARD_ITEM>& aRemovedItems );
+
+    ///> Forces the next world update to rebuild the world, for changes made outside of commits
+    void InvalidateWorld();
+
     void EraseView() override;
     void HideItem( PNS::ITEM* aItem ) override;
     void DisplayItem( const PNS::ITEM* aItem, int aColor = 0, int aClearance = 0, bool aEdit = false ) override;
@@ -70,9 +145,22 @@ private:
     std::unique_ptr<PNS::SOLID> syncPad( D_PAD* aPad );
     std::unique_ptr<PNS::SEGMENT> syncTrack( TRACK* aTrack );
     std::unique_ptr<PNS::VIA> syncVia( VIA* aVia );
-    bool syncTextItem( PNS::NODE* aWorld, EDA_TEXT* aText, PCB_LAYER_ID aLayer );
-    bool syncGraphicalItem( PNS::NODE* aWorld, DRAWSEGMENT* aItem );
+    bool syncTextItem( PNS::NODE* aWorld, EDA_TEXT* aText, PCB_LAYER_ID aLayer,
+                       const BOARD_ITEM* aOwner );
+    bool syncGraphicalItem( PNS::NODE* aWorld, DRAWSEGMENT* aItem, const BOARD_ITEM* aOwner );
     bool syncZone( PNS::NODE* aWorld, ZONE_CONTAINER* aZone );
+    void syncModule( PNS::NODE* aWorld, MODULE* aModule );
+    void syncItem( PNS::NODE* aWorld, BOARD_ITEM* aItem );
+    void syncRules( PNS::NODE* aWorld );
+
+    ///> Adds a solid to the world, as part of the board item aOwner
+    void addSolid( PNS::NODE* aWorld, const BOARD_ITEM* aOwner, std::unique_ptr<PNS::SOLID> aSolid );
+
+    ///> Removes from the world the solids of the board item aOwner
+    void removeSolids( PNS::NODE* aWorld, const BOARD_ITEM* aOwner );
+
+    ///> Removes from the world the segments or the via of a track or a via
+    void removeTrack( PNS::NODE* aWorld, const BOARD_CONNECTED_ITEM* aTrack );
 
     KIGFX::VIEW* m_view;
     KIGFX::VIEW_GROUP* m_previewItems;
@@ -83,6 +171,26 @@ private:
     PCB_TOOL_BASE* m_tool;
     std::unique_ptr<BOARD_COMMIT> m_commit;
     PCB_DISPLAY_OPTIONS* m_dispOptions;
+
+    ///> The world the recorded changes apply to, nullptr if it must be rebuilt
+    PNS::NODE* m_syncedWorld;
+
+    ///> True while pushing the router's own commit, already applied to the world
+    bool m_committing;
+
+    int m_worstPadClearance;
+
+    ///> The solids of the world, by the board item (drawing, text, zone or module) they
+    ///> were made from.  The router never removes solids, so they stay valid until the
+    ///> world is rebuilt.
+    std::unordered_map<const BOARD_ITEM*, std::vector<PNS::ITEM*>> m_ownedSolids;
+
+    ///> Board items changed since the last world update (modules instead of their items)
+    std::unordered_set<BOARD_ITEM*> m_changedItems;
+
+    ///> Board items removed since the last world update, only used as keys
+    std::unordered_set<const BOARD_ITEM*> m_removedOwners;
+    std::unordered_set<const BOARD_CONNECTED_ITEM*> m_removedTracks;
 };
 
 #endif
@@ -383,8 +383,6 @@ bool LINE_PLACER::rhWalkOnly( const VECTOR2I& aP, LINE& aNewHead )
     walkaround.SetDebugDecorator( Dbg() );
     walkaround.SetIterationLimit( Settings().WalkaroundIterationLimit() );
 
-    WALKAROUND::WALKAROUND_STATUS wf = walkaround.Route( initTrack, walkFull, false );
-
     switch( Settings().OptimizerEffort() )
     {
     case OE_LOW:
@@ -400,6 +398,12 @@ bool LINE_PLACER::rhWalkOnly( const VECTOR2I& aP, LINE& aNewHead )
     if( Settings().SmartPads() )
         effort |= OPTIMIZER::SMART_PADS;
 
+    // compare the optimized paths, as that is what the user gets
+    walkaround.SetSpeculative( Settings().SpeculativeRouting(), effort );
+
+    WALKAROUND::WALKAROUND_STATUS wf = walkaround.Route( initTrack, walkFull, false );
+    bool optimized = walkaround.PathOptimized();
+
     if( wf == WALKAROUND::STUCK )
     {
         walkFull = walkFull.ClipToNearestObstacle( m_currentNode );
@@ -408,9 +412,12 @@ bool LINE_PLACER::rhWalkOnly( const VECTOR2I& aP, LINE& aNewHead )
     else if( m_placingVia && viaOk )
     {
         walkFull.AppendVia( makeVia( walkFull.CPoint( -1 ) ) );
+        optimized = false;
     }
 
-    OPTIMIZER::Optimize( &walkFull, effort, m_currentNode );
+    // the speculative walkaround may have optimized the path with the same effort already
+    if( !optimized )
+        OPTIMIZER::Optimize( &walkFull, effort, m_currentNode );
 
     if( m_currentNode->CheckColliding( &walkFull ) )
     {
@@ -580,6 +587,7 @@ bool LINE_PLACER::rhShoveOnly( const VECTOR2I& aP, LINE& aNewHead )
     walkaround.SetSolidsOnly( true );
     walkaround.SetIterationLimit( 10 );
     walkaround.SetDebugDecorator( Dbg() );
+    walkaround.SetSpeculative( Settings().SpeculativeRouting() );
     WALKAROUND::WALKAROUND_STATUS stat_solids = walkaround.Route( initTrack, walkSolids );
 
     optimizer.SetEffortLevel( OPTIMIZER::MERGE_SEGMENTS );
@@ -25,6 +25,10 @@
 #include "pns_line.h"
 #include "pns_segment.h"
 #include "pns_solid.h"
+#include "pns_routing_settings.h"
+#include "pns_sizes_settings.h"
+
+#include <fstream>
 
 #include <geometry/shape.h>
 #include <geometry/shape_line_chain.h>
@@ -37,6 +41,7 @@ namespace PNS {
 LOGGER::LOGGER( )
 {
     m_groupOpened = false;
+    m_session = SESSION();
 }
 
 
@@ -205,4 +210,132 @@ void LOGGER::Save( const std::string& aFilename )
     fclose( f );
 }
 
+
+
+void LOGGER::NewSession( int aRouterMode, const ROUTING_SETTINGS& aSettings,
+                         const SIZES_SETTINGS& aSizes )
+{
+    m_session = SESSION();
+
+    m_session.m_routerMode = aRouterMode;
+    m_session.m_routingMode = aSettings.Mode();
+    m_session.m_optimizerEffort = aSettings.OptimizerEffort();
+    m_session.m_trackWidth = aSizes.TrackWidth();
+    m_session.m_viaDiameter = aSizes.ViaDiameter();
+    m_session.m_viaDrill = aSizes.ViaDrill();
+    m_session.m_viaType = aSizes.ViaType();
+    m_session.m_diffPairWidth = aSizes.DiffPairWidth();
+    m_session.m_diffPairGap = aSizes.DiffPairGap();
+    m_session.m_layerTop = aSizes.GetLayerTop();
+    m_session.m_layerBottom = aSizes.GetLayerBottom();
+}
+
+
+void LOGGER::LogEvent( EVENT_TYPE aType, const VECTOR2I& aP, const ITEM* aItem, int aArg )
+{
+    EVENT_ENTRY evt = EVENT_ENTRY();
+
+    evt.m_type = aType;
+    evt.m_p = aP;
+    evt.m_arg = aArg;
+
+    if( aItem )
+    {
+        evt.m_itemKind = aItem->Kind();
+        evt.m_itemNet = aItem->Net();
+        evt.m_itemLayerStart = aItem->Layers().Start();
+        evt.m_itemLayerEnd = aItem->Layers().End();
+
+        if( aItem->AnchorCount() > 0 )
+        {
+            evt.m_itemAnchorA = aItem->Anchor( 0 );
+            evt.m_itemAnchorB = aItem->Anchor( aItem->AnchorCount() - 1 );
+        }
+    }
+
+    m_session.m_events.push_back( evt );
+}
+
+
+bool LOGGER::SaveSession( const std::string& aFilename, bool aAppend ) const
+{
+    FILE* f = fopen( aFilename.c_str(), aAppend ? "ab" : "wb" );
+
+    if( !f )
+        return false;
+
+    const SESSION& s = m_session;
+
+    fprintf( f, "session %d %d %d %d %d %d %d %d %d %d %d\n", s.m_routerMode, s.m_routingMode,
+             s.m_optimizerEffort, s.m_trackWidth, s.m_viaDiameter, s.m_viaDrill, s.m_viaType,
+             s.m_diffPairWidth, s.m_diffPairGap, s.m_layerTop, s.m_layerBottom );
+
+    for( const EVENT_ENTRY& evt : s.m_events )
+    {
+        fprintf( f, "event %d %d %d %d %d %d %d %d %d %d %d %d\n", evt.m_type, evt.m_p.x,
+                 evt.m_p.y, evt.m_arg, evt.m_itemKind, evt.m_itemNet, evt.m_itemLayerStart,
+                 evt.m_itemLayerEnd, evt.m_itemAnchorA.x, evt.m_itemAnchorA.y,
+                 evt.m_itemAnchorB.x, evt.m_itemAnchorB.y );
+    }
+
+    fprintf( f, "endsession\n" );
+
+    return fclose( f ) == 0;
+}
+
+
+bool LOGGER::LoadSessions( const std::string& aFilename, std::vector<SESSION>& aSessions )
+{
+    std::ifstream f( aFilename );
+
+    if( !f )
+        return false;
+
+    std::string token;
+    SESSION*    current = nullptr;
+
+    while( f >> token )
+    {
+        if( token == "session" )
+        {
+            aSessions.push_back( SESSION() );
+            current = &aSessions.back();
+
+            f >> current->m_routerMode >> current->m_routingMode >> current->m_optimizerEffort
+              >> current->m_trackWidth >> current->m_viaDiameter >> current->m_viaDrill
+              >> current->m_viaType
+              >> current->m_diffPairWidth >> current->m_diffPairGap >> current->m_layerTop
+              >> current->m_layerBottom;
+        }
+        else if( token == "event" && current )
+        {
+            EVENT_ENTRY evt = EVENT_ENTRY();
+            int         type = 0;
+
+            f >> type >> evt.m_p.x >> evt.m_p.y >> evt.m_arg >> evt.m_itemKind >> evt.m_itemNet
+              >> evt.m_itemLayerStart >> evt.m_itemLayerEnd >> evt.m_itemAnchorA.x
+              >> evt.m_itemAnchorA.y >> evt.m_itemAnchorB.x >> evt.m_itemAnchorB.y;
+
+            if( type < EVT_START_ROUTE || type > EVT_STOP )
+                return false;
+
+            evt.m_type = (EVENT_TYPE) type;
+            current->m_events.push_back( evt );
+        }
+        else if( token == "endsession" && current )
+        {
+            current = nullptr;
+        }
+        else
+        {
+            return false;
+        }
+
+        if( f.fail() )
+            return false;
+    }
+
+    return true;
+}
+
 }
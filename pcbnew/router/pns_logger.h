@@ -35,10 +35,56 @@ class SHAPE;
 namespace PNS {
 
 class ITEM;
+class ROUTING_SETTINGS;
+class SIZES_SETTINGS;
 
 class LOGGER
 {
 public:
+    ///> Router calls recorded by a session log, see ROUTER::SetSessionLogger()
+    enum EVENT_TYPE
+    {
+        EVT_START_ROUTE = 0,
+        EVT_START_DRAG,
+        EVT_MOVE,
+        EVT_FIX,
+        EVT_SWITCH_LAYER,
+        EVT_TOGGLE_VIA,
+        EVT_FLIP_POSTURE,
+        EVT_STOP
+    };
+
+    struct EVENT_ENTRY
+    {
+        EVENT_TYPE m_type;
+        VECTOR2I   m_p;
+        int        m_arg;             ///< the layer, drag mode or force finish flag of the call
+        int        m_itemKind;        ///< kind of the item passed to the router, 0 if none
+        int        m_itemNet;
+        int        m_itemLayerStart;
+        int        m_itemLayerEnd;
+        VECTOR2I   m_itemAnchorA;     ///< first and last anchors, to find the item on replay
+        VECTOR2I   m_itemAnchorB;
+    };
+
+    ///> A routing or dragging session: the router settings at its start, and the calls made
+    struct SESSION
+    {
+        int m_routerMode;             ///< ROUTER_MODE
+        int m_routingMode;            ///< PNS_MODE
+        int m_optimizerEffort;        ///< PNS_OPTIMIZATION_EFFORT
+        int m_trackWidth;
+        int m_viaDiameter;
+        int m_viaDrill;
+        int m_viaType;
+        int m_diffPairWidth;
+        int m_diffPairGap;
+        int m_layerTop;               ///< layer pair used to place vias
+        int m_layerBottom;
+
+        std::vector<EVENT_ENTRY> m_events;
+    };
+
     LOGGER();
     ~LOGGER();
 
@@ -53,11 +99,40 @@ public:
     void Log( const VECTOR2I& aStart, const VECTOR2I& aEnd, int aKind = 0,
               const std::string& aName = std::string() );
 
+    ///> Starts recording a new session, with the given router settings
+    void NewSession( int aRouterMode, const ROUTING_SETTINGS& aSettings,
+                     const SIZES_SETTINGS& aSizes );
+
+    ///> Records a router call in the current session
+    void LogEvent( EVENT_TYPE aType, const VECTOR2I& aP, const ITEM* aItem = nullptr,
+                   int aArg = 0 );
+
+    const SESSION& Session() const
+    {
+        return m_session;
+    }
+
+    /**
+     * Writes the current session to a file.
+     * @param aAppend adds the session after the ones already in the file, instead of
+     * replacing them.
+     * @return false if the file could not be written
+     */
+    bool SaveSession( const std::string& aFilename, bool aAppend ) const;
+
+    /**
+     * Reads the sessions written by SaveSession().
+     * @return false if the file could not be read or is malformed
+     */
+    static bool LoadSessions( const std::string& aFilename, std::vector<SESSION>& aSessions );
+
 private:
     void dumpShape( const SHAPE* aSh );
 
     bool m_groupOpened;
     std::stringstream m_theLog;
+
+    SESSION m_session;
 };
 
 }
@@ -535,6 +535,7 @@ void NODE::addSolid( SOLID* aSolid )
 {
     linkJoint( aSolid->Pos(), aSolid->Layers(), aSolid->Net(), aSolid );
     m_index->Add( aSolid );
+    hashParent( aSolid );
 }
 
 void NODE::Add( std::unique_ptr< SOLID > aSolid )
@@ -547,6 +548,7 @@ void NODE::addVia( VIA* aVia )
 {
     linkJoint( aVia->Pos(), aVia->Layers(), aVia->Net(), aVia );
     m_index->Add( aVia );
+    hashParent( aVia );
 }
 
 void NODE::Add( std::unique_ptr< VIA > aVia )
@@ -590,6 +592,7 @@ void NODE::addSegment( SEGMENT* aSeg )
     linkJoint( aSeg->Seg().B, aSeg->Layers(), aSeg->Net(), aSeg );
 
     m_index->Add( aSeg );
+    hashParent( aSeg );
 }
 
 bool NODE::Add( std::unique_ptr< SEGMENT > aSegment, bool aAllowRedundant )
@@ -645,7 +648,10 @@ void NODE::doRemove( ITEM* aItem )
     // case 2: the item belongs to this branch or a parent, non-root branch,
     // or the root itself and we are the root: remove from the index
     else if( !aItem->BelongsTo( m_root ) || isRoot() )
+    {
         m_index->Remove( aItem );
+        unhashParent( aItem );
+    }
 
     // the item belongs to this particular branch: un-reference it
     if( aItem->BelongsTo( this ) )
@@ -656,6 +662,32 @@ void NODE::doRemove( ITEM* aItem )
 }
 
 
+void NODE::hashParent( ITEM* aItem )
+{
+    // The parent of the root items does not change: they are given one before being added
+    if( isRoot() && aItem->Parent() )
+        m_parentMap.emplace( aItem->Parent(), aItem );
+}
+
+
+void NODE::unhashParent( ITEM* aItem )
+{
+    if( !isRoot() || !aItem->Parent() )
+        return;
+
+    auto range = m_parentMap.equal_range( aItem->Parent() );
+
+    for( auto it = range.first; it != range.second; ++it )
+    {
+        if( it->second == aItem )
+        {
+            m_parentMap.erase( it );
+            break;
+        }
+    }
+}
+
+
 void NODE::removeSegmentIndex( SEGMENT* aSeg )
 {
     unlinkJoint( aSeg->Seg().A, aSeg->Layers(), aSeg->Net(), aSeg );
@@ -711,7 +743,8 @@ void NODE::removeViaIndex( VIA* aVia )
 
 void NODE::removeSolidIndex( SOLID* aSolid )
 {
-    // fixme: this fucks up the joints, but it's only used for marking colliding obstacles for the moment, so we don't care.
+    // Solids are removed from the root node when the board item they were made from changes
+    unlinkJoint( aSolid->Pos(), aSolid->Layers(), aSolid->Net(), aSolid );
 }
 
 
@@ -1329,6 +1362,12 @@ SEGMENT* NODE::findRedundantSegment( SEGMENT* aSeg )
 
 ITEM *NODE::FindItemByParent( const BOARD_CONNECTED_ITEM* aParent )
 {
+    if( isRoot() )
+    {
+        auto it = m_parentMap.find( aParent );
+        return it != m_parentMap.end() ? it->second : NULL;
+    }
+
     INDEX::NET_ITEMS_LIST* l_cur = m_index->GetItemsForNet( aParent->GetNetCode() );
 
     for( ITEM*item : *l_cur )
@@ -1338,4 +1377,13 @@ ITEM *NODE::FindItemByParent( const BOARD_CONNECTED_ITEM* aParent )
     return NULL;
 }
 
+
+void NODE::FindItemsByParent( const BOARD_CONNECTED_ITEM* aParent, ITEM_VECTOR& aItems ) const
+{
+    auto range = m_root->m_parentMap.equal_range( aParent );
+
+    for( auto it = range.first; it != range.second; ++it )
+        aItems.push_back( it->second );
+}
+
 }
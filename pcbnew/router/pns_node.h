@@ -406,6 +406,16 @@ public:
 
     ITEM* FindItemByParent( const BOARD_CONNECTED_ITEM* aParent );
 
+    /**
+     * Function FindItemsByParent()
+     *
+     * Collects all the items of the root node made from the board item aParent. The parent
+     * is only used as a key, so it may already be deleted.
+     * @param aParent the board item
+     * @param aItems receives the items found
+     */
+    void FindItemsByParent( const BOARD_CONNECTED_ITEM* aParent, ITEM_VECTOR& aItems ) const;
+
     bool HasChildren() const
     {
         return !m_children.empty();
@@ -449,6 +459,8 @@ private:
     void removeViaIndex( VIA* aVia );
 
     void doRemove( ITEM* aItem );
+    void hashParent( ITEM* aItem );
+    void unhashParent( ITEM* aItem );
     void unlinkParent();
     void releaseChildren();
     void releaseGarbage();
@@ -488,6 +500,9 @@ private:
     ///> hash of root's items that have been changed in this node
     std::unordered_set<ITEM*> m_override;
 
+    ///> items having a parent board item, hashed by their parent (only kept in the root node)
+    std::unordered_multimap<const BOARD_CONNECTED_ITEM*, ITEM*> m_parentMap;
+
     ///> worst case item-item clearance
     int m_maxClearance;
 
@@ -44,7 +44,9 @@
 #include "pns_router.h"
 #include "pns_shove.h"
 #include "pns_dragger.h"
+#include "pns_logger.h"
 #include "pns_topology.h"
+#include "pns_walkaround.h"
 #include "pns_diff_pair_placer.h"
 #include "pns_meander_placer.h"
 #include "pns_meander_skew_placer.h"
@@ -72,6 +74,8 @@ ROUTER::ROUTER()
     m_snapshotIter = 0;
     m_violation = false;
     m_iface = nullptr;
+    m_sessionLogger = nullptr;
+    m_iterationCount = 0;
 }
 
 
@@ -81,6 +85,15 @@ ROUTER* ROUTER::GetInstance()
 }
 
 
+WALKAROUND_WORKER* ROUTER::WalkaroundWorker()
+{
+    if( !m_walkaroundWorker )
+        m_walkaroundWorker.reset( new WALKAROUND_WORKER );
+
+    return m_walkaroundWorker.get();
+}
+
+
 ROUTER::~ROUTER()
 {
     ClearWorld();
@@ -90,11 +103,20 @@ ROUTER::~ROUTER()
 
 void ROUTER::SyncWorld()
 {
+    // Patch the current world when the interface knows what changed on the board
+    if( m_world )
+    {
+        m_world->KillChildren();
+        m_placer.reset();
+
+        if( m_iface->UpdateWorld( m_world.get() ) )
+            return;
+    }
+
     ClearWorld();
 
     m_world = std::unique_ptr<NODE>( new NODE );
     m_iface->SyncWorld( m_world.get() );
-
 }
 
 void ROUTER::ClearWorld()
@@ -152,6 +174,12 @@ bool ROUTER::StartDragging( const VECTOR2I& aP, ITEM* aStartItem, int aDragMode
         return false;
     }
 
+    if( m_sessionLogger )
+    {
+        m_sessionLogger->NewSession( m_mode, m_settings, m_sizes );
+        m_sessionLogger->LogEvent( LOGGER::EVT_START_DRAG, aP, aStartItem, aDragMode );
+    }
+
     return true;
 }
 
@@ -215,6 +243,12 @@ bool ROUTER::StartRouting( const VECTOR2I& aP, ITEM* aStartItem, int aLayer )
     if( !rv )
         return false;
 
+    if( m_sessionLogger )
+    {
+        m_sessionLogger->NewSession( m_mode, m_settings, m_sizes );
+        m_sessionLogger->LogEvent( LOGGER::EVT_START_ROUTE, aP, aStartItem, aLayer );
+    }
+
     m_currentEnd = aP;
     m_state = ROUTE_TRACK;
     return rv;
@@ -230,6 +264,9 @@ void ROUTER::DisplayItems( const ITEM_SET& aItems )
 
 void ROUTER::Move( const VECTOR2I& aP, ITEM* endItem )
 {
+    if( m_sessionLogger && m_state != IDLE )
+        m_sessionLogger->LogEvent( LOGGER::EVT_MOVE, aP, endItem );
+
     m_currentEnd = aP;
 
     switch( m_state )
@@ -375,6 +412,9 @@ bool ROUTER::FixRoute( const VECTOR2I& aP, ITEM* aEndItem, bool aForceFinish )
 {
     bool rv = false;
 
+    if( m_sessionLogger && m_state != IDLE )
+        m_sessionLogger->LogEvent( LOGGER::EVT_FIX, aP, aEndItem, aForceFinish );
+
     switch( m_state )
     {
     case ROUTE_TRACK:
@@ -413,6 +453,14 @@ void ROUTER::StopRouting()
     if( !RoutingInProgress() )
         return;
 
+    if( m_sessionLogger )
+    {
+        m_sessionLogger->LogEvent( LOGGER::EVT_STOP, m_currentEnd );
+
+        if( !m_sessionLogger->SaveSession( m_sessionFile, true ) )
+            wxLogTrace( "PNS", "Cannot save the routing session to '%s'", m_sessionFile.c_str() );
+    }
+
     m_placer.reset();
     m_dragger.reset();
 
@@ -428,6 +476,9 @@ void ROUTER::FlipPosture()
 {
     if( m_state == ROUTE_TRACK )
     {
+        if( m_sessionLogger )
+            m_sessionLogger->LogEvent( LOGGER::EVT_FLIP_POSTURE, m_currentEnd );
+
         m_placer->FlipPosture();
     }
 }
@@ -438,6 +489,9 @@ void ROUTER::SwitchLayer( int aLayer )
     switch( m_state )
     {
     case ROUTE_TRACK:
+        if( m_sessionLogger )
+            m_sessionLogger->LogEvent( LOGGER::EVT_SWITCH_LAYER, m_currentEnd, nullptr, aLayer );
+
         m_placer->SetLayer( aLayer );
         break;
     default:
@@ -450,6 +504,9 @@ void ROUTER::ToggleViaPlacement()
 {
     if( m_state == ROUTE_TRACK )
     {
+        if( m_sessionLogger )
+            m_sessionLogger->LogEvent( LOGGER::EVT_TOGGLE_VIA, m_currentEnd );
+
         bool toggle = !m_placer->IsPlacingVia();
         m_placer->ToggleVia( toggle );
     }
@@ -473,6 +530,13 @@ int ROUTER::GetCurrentLayer() const
 }
 
 
+void ROUTER::SetSessionLogger( LOGGER* aLogger, const std::string& aFilename )
+{
+    m_sessionLogger = aLogger;
+    m_sessionFile = aFilename;
+}
+
+
 void ROUTER::DumpLog()
 {
     LOGGER* logger = nullptr;
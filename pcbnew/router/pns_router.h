@@ -22,9 +22,11 @@
 #ifndef __PNS_ROUTER_H
 #define __PNS_ROUTER_H
 
+#include <atomic>
 #include <list>
 
 #include <memory>
+#include <string>
 #include <core/optional.h>
 #include <boost/unordered_set.hpp>
 
@@ -60,6 +62,8 @@ class VIA;
 class RULE_RESOLVER;
 class SHOVE;
 class DRAGGER;
+class LOGGER;
+class WALKAROUND_WORKER;
 
 enum ROUTER_MODE {
     PNS_MODE_ROUTE_SINGLE = 1,
@@ -91,6 +95,12 @@ enum DRAG_MODE
 
         virtual void SetRouter( ROUTER* aRouter ) = 0;
         virtual void SyncWorld( NODE* aNode ) = 0;
+
+        /**
+         * Applies to aNode the changes made to the board since aNode was last synchronised.
+         * @return false if the changes are not known: aNode must be rebuilt with SyncWorld()
+         */
+        virtual bool UpdateWorld( NODE* aNode ) = 0;
         virtual void AddItem( ITEM* aItem ) = 0;
         virtual void RemoveItem( ITEM* aItem ) = 0;
         virtual void DisplayItem( const ITEM* aItem, int aColor = -1, int aClearance = -1, bool aEdit = false ) = 0;
@@ -160,6 +170,24 @@ public:
 
     void DumpLog();
 
+    /**
+     * Records each routing or dragging session in aLogger, and appends it to the file
+     * aFilename when it ends, so it can be replayed against the same board.
+     * @param aLogger is the session log, nullptr to stop recording
+     */
+    void SetSessionLogger( LOGGER* aLogger, const std::string& aFilename );
+
+    ///> Adds aCount to the number of iterations run by the shove and walkaround algorithms.
+    ///> Can be called from the speculative walkaround threads.
+    void CountIterations( int aCount ) { m_iterationCount += aCount; }
+
+    ///> Returns the number of shove and walkaround iterations since the router creation
+    long long IterationCount() const { return m_iterationCount; }
+
+    ///> Returns the thread walking the second direction of the speculative walkarounds,
+    ///> started on the first call
+    WALKAROUND_WORKER* WalkaroundWorker();
+
     RULE_RESOLVER* GetRuleResolver() const
     {
         return m_iface->GetRuleResolver();
@@ -271,6 +299,12 @@ private:
 
     wxString m_toolStatusbarName;
     wxString m_failureReason;
+
+    LOGGER*     m_sessionLogger;
+    std::string m_sessionFile;
+    std::atomic<long long> m_iterationCount;
+
+    std::unique_ptr<WALKAROUND_WORKER> m_walkaroundWorker;
 };
 
 }
@@ -142,6 +142,13 @@ public:
     bool GetSnapToTracks() const { return m_snapToTracks; }
     bool GetSnapToPads() const { return m_snapToPads; }
 
+    ///> Returns true if the walkaround directions are evaluated concurrently.
+    bool SpeculativeRouting() const { return m_speculativeRouting; }
+
+    ///> Enables/disables the concurrent evaluation of the walkaround directions. The best
+    ///> path found within the walkaround time limit is kept instead of the first one.
+    void SetSpeculativeRouting( bool aEnable ) { m_speculativeRouting = aEnable; }
+
 private:
     bool m_shoveVias;
     bool m_startDiagonal;
@@ -156,6 +163,7 @@ private:
     bool m_inlineDragEnabled;
     bool m_snapToTracks;
     bool m_snapToPads;
+    bool m_speculativeRouting;
 
     PNS_MODE m_routingMode;
     PNS_OPTIMIZATION_EFFORT m_optimizerEffort;
@@ -20,6 +20,7 @@
  */
 
 #include <wx/numdlg.h>
+#include <wx/filename.h>
 
 #include <functional>
 using namespace std::placeholders;
@@ -37,6 +38,7 @@ using namespace std::placeholders;
 #include <dialogs/dialog_pns_diff_pair_dimensions.h>
 #include <dialogs/dialog_pns_length_tuning_settings.h>
 #include <dialogs/dialog_track_via_size.h>
+#include <advanced_config.h>
 #include <base_units.h>
 #include <bitmaps.h>
 #include <hotkeys.h>
@@ -51,6 +53,7 @@ using namespace std::placeholders;
 #include "pns_solid.h"
 #include "pns_via.h"
 #include "pns_router.h"
+#include "pns_logger.h"
 #include "pns_meander_placer.h" // fixme: move settings to separate header
 #include "pns_tune_status_popup.h"
 #include "pns_topology.h"
@@ -68,6 +71,7 @@ TOOL_BASE::TOOL_BASE( const std::string& aToolName ) :
     m_gridHelper = nullptr;
     m_iface = nullptr;
     m_router = nullptr;
+    m_routerOutdated = false;
 
     m_startItem = nullptr;
     m_startLayer = 0;
@@ -89,19 +93,48 @@ TOOL_BASE::~TOOL_BASE()
 
 void TOOL_BASE::Reset( RESET_REASON aReason )
 {
+    // The board or the view was replaced: the router is rebuilt at the next invocation
+    if( aReason != RUN )
+    {
+        m_routerOutdated = true;
+        return;
+    }
+
     delete m_gridHelper;
-    delete m_iface;
-    delete m_router;
 
-    m_iface = new PNS_KICAD_IFACE;
-    m_iface->SetBoard( board() );
-    m_iface->SetView( getView() );
-    m_iface->SetHostTool( this );
-    m_iface->SetDisplayOptions( (PCB_DISPLAY_OPTIONS*) frame()->GetDisplayOptions() );
+    if( !m_router || m_routerOutdated )
+    {
+        delete m_iface;
+        delete m_router;
+
+        m_iface = new PNS_KICAD_IFACE;
+        m_iface->SetBoard( board() );
+        m_iface->SetView( getView() );
+        m_iface->SetHostTool( this );
+        m_iface->SetDisplayOptions( (PCB_DISPLAY_OPTIONS*) frame()->GetDisplayOptions() );
+
+        m_router = new ROUTER;
+        m_router->SetInterface( m_iface );
+        m_router->ClearWorld();
+
+        m_routerOutdated = false;
+    }
+
+    // Checked at each invocation, as the board file name can change
+    if( ADVANCED_CFG::GetCfg().m_recordRouterSessions && !board()->GetFileName().IsEmpty() )
+    {
+        wxFileName sessionFile( board()->GetFileName() );
+        sessionFile.SetExt( "pns_sessions" );
+
+        if( !m_sessionLogger )
+            m_sessionLogger.reset( new LOGGER );
+
+        m_router->SetSessionLogger( m_sessionLogger.get(),
+                                    sessionFile.GetFullPath().ToStdString() );
+    }
 
-    m_router = new ROUTER;
-    m_router->SetInterface( m_iface );
-    m_router->ClearWorld();
+    // The world is kept between invocations, and only updated with the board changes
+    // made meanwhile
     m_router->SyncWorld();
     m_router->LoadSettings( m_savedSettings );
     m_router->UpdateSizes( m_savedSizes );
@@ -110,6 +143,21 @@ void TOOL_BASE::Reset( RESET_REASON aReason )
 }
 
 
+void TOOL_BASE::BoardItemsChanged( const std::vector<BOARD_ITEM*>& aChangedItems,
+                                   const std::vector<REMOVED_BOARD_ITEM>& aRemovedItems )
+{
+    if( m_iface )
+        m_iface->BoardItemsChanged( aChangedItems, aRemovedItems );
+}
+
+
+void TOOL_BASE::InvalidateWorld()
+{
+    if( m_iface )
+        m_iface->InvalidateWorld();
+}
+
+
 ITEM* TOOL_BASE::pickSingleItem( const VECTOR2I& aWhere, int aNet, int aLayer, bool aIgnorePads,
 								 const std::vector<ITEM*> aAvoidItems)
 {
@@ -51,6 +51,16 @@ public:
 
     ROUTER* Router() const;
 
+    /**
+     * Records the board items changed by a commit: the router world is updated with them
+     * at the next invocation of the tool.
+     */
+    void BoardItemsChanged( const std::vector<BOARD_ITEM*>& aChangedItems,
+                            const std::vector<REMOVED_BOARD_ITEM>& aRemovedItems );
+
+    ///> Rebuilds the router world at the next invocation, after changes made outside commits
+    void InvalidateWorld();
+
 protected:
     bool checkSnap( ITEM* aItem );
     const VECTOR2I snapToItem( bool aEnabled, ITEM* aItem, VECTOR2I aP);
@@ -76,6 +86,9 @@ protected:
     GRID_HELPER* m_gridHelper;
     PNS_KICAD_IFACE* m_iface;
     ROUTER* m_router;
+    bool m_routerOutdated;                ///< The board or the view changed since the router was made
+
+    std::unique_ptr<LOGGER> m_sessionLogger; ///< Records the routing sessions, if enabled
 };
 
 }
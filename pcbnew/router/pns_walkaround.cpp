@@ -19,6 +19,8 @@
  * with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <cassert>
+
 #include <core/optional.h>
 
 #include <geometry/shape_line_chain.h>
@@ -30,6 +32,70 @@
 
 namespace PNS {
 
+WALKAROUND_WORKER::WALKAROUND_WORKER() :
+    m_busy( false ),
+    m_quit( false )
+{
+    m_thread = std::thread( &WALKAROUND_WORKER::loop, this );
+}
+
+
+WALKAROUND_WORKER::~WALKAROUND_WORKER()
+{
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        m_quit = true;
+    }
+
+    m_cond.notify_all();
+    m_thread.join();
+}
+
+
+void WALKAROUND_WORKER::Run( const std::function<void()>& aJob )
+{
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+
+        assert( !m_busy );
+        m_job = aJob;
+        m_busy = true;
+    }
+
+    m_cond.notify_all();
+}
+
+
+void WALKAROUND_WORKER::Wait()
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+
+    m_cond.wait( lock, [this]() { return !m_busy; } );
+}
+
+
+void WALKAROUND_WORKER::loop()
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+
+    while( true )
+    {
+        m_cond.wait( lock, [this]() { return m_busy || m_quit; } );
+
+        if( m_quit )
+            return;
+
+        lock.unlock();
+        m_job();
+        lock.lock();
+
+        m_job = nullptr;
+        m_busy = false;
+        m_cond.notify_all();
+    }
+}
+
+
 void WALKAROUND::start( const LINE& aInitialPath )
 {
     m_iteration = 0;
@@ -151,6 +217,8 @@ WALKAROUND::WALKAROUND_STATUS WALKAROUND::Route( const LINE& aInitialPath,
     WALKAROUND_STATUS s_cw = IN_PROGRESS, s_ccw = IN_PROGRESS;
     SHAPE_LINE_CHAIN best_path;
 
+    m_pathOptimized = false;
+
     // special case for via-in-the-middle-of-track placement
     if( aInitialPath.PointCount() <= 1 )
     {
@@ -161,6 +229,17 @@ WALKAROUND::WALKAROUND_STATUS WALKAROUND::Route( const LINE& aInitialPath,
         return DONE;
     }
 
+    if( m_speculative && !m_forceWinding )
+    {
+        bool done = ( routeSpeculative( aInitialPath, aWalkPath ) == DONE );
+        WALKAROUND_STATUS st = finishRoute( aInitialPath, aWalkPath, done, aOptimize );
+
+        // The walkers optimized the paths they found, and the cursor approach did not cut it
+        m_pathOptimized = ( st == DONE && m_speculativeEffort && !m_cursorApproachMode );
+
+        return st;
+    }
+
     start( aInitialPath );
 
     m_currentObstacle[0] = m_currentObstacle[1] = nearestObstacle( aInitialPath );
@@ -179,6 +258,8 @@ WALKAROUND::WALKAROUND_STATUS WALKAROUND::Route( const LINE& aInitialPath,
 
     while( m_iteration < m_iterationLimit )
     {
+        Router()->CountIterations( 1 );
+
         if( s_cw != STUCK )
             s_cw = singleStep( path_cw, true );
 
@@ -222,6 +303,104 @@ WALKAROUND::WALKAROUND_STATUS WALKAROUND::Route( const LINE& aInitialPath,
             aWalkPath = ( len_cw < len_ccw ? path_cw : path_ccw );
     }
 
+    return finishRoute( aInitialPath, aWalkPath, s_ccw == DONE || s_cw == DONE, aOptimize );
+}
+
+
+WALKAROUND::WALKAROUND_STATUS WALKAROUND::walkDirection( const LINE& aInitialPath, LINE& aPath,
+        bool aCw, TIME_LIMIT aBudget, const std::atomic<bool>& aOtherDone )
+{
+    WALKAROUND_STATUS st = IN_PROGRESS;
+    bool budgetStarted = false;
+
+    start( aInitialPath );
+
+    m_currentObstacle[0] = m_currentObstacle[1] = nearestObstacle( aInitialPath );
+    m_recursiveBlockageCount = 0;
+    m_forceSingleDirection = false;
+
+    aPath = aInitialPath;
+
+    while( st == IN_PROGRESS && m_iteration < m_iterationLimit )
+    {
+        // once the other direction has found its way, keep looking only within the budget
+        if( aOtherDone )
+        {
+            if( !budgetStarted )
+            {
+                aBudget.Restart();
+                budgetStarted = true;
+            }
+            else if( aBudget.Expired() )
+            {
+                break;
+            }
+        }
+
+        Router()->CountIterations( 1 );
+
+        st = singleStep( aPath, aCw );
+        m_iteration++;
+    }
+
+    if( st == DONE && m_speculativeEffort )
+        OPTIMIZER::Optimize( &aPath, m_speculativeEffort, m_world );
+
+    return st;
+}
+
+
+WALKAROUND::WALKAROUND_STATUS WALKAROUND::routeSpeculative( const LINE& aInitialPath,
+        LINE& aWalkPath )
+{
+    LINE paths[2] = { aInitialPath, aInitialPath };
+    WALKAROUND_STATUS status[2] = { IN_PROGRESS, IN_PROGRESS };
+    std::atomic<bool> done[2];
+    const TIME_LIMIT budget = Settings().WalkaroundTimeLimit();
+
+    done[0] = false;
+    done[1] = false;
+
+    // Each direction gets its own walker, as the walk state (current obstacles, blockage
+    // and iteration counters) is shared between directions in a single instance.
+    // The world is only queried, never modified, so both can walk it at once.
+    auto walk = [&]( int aDir )
+    {
+        WALKAROUND walker( m_world, Router() );
+
+        walker.m_itemMask = m_itemMask;
+        walker.m_restrictedSet = m_restrictedSet;
+        walker.m_forceLongerPath = m_forceLongerPath;
+        walker.m_speculativeEffort = m_speculativeEffort;
+
+        status[aDir] = walker.walkDirection( aInitialPath, paths[aDir], aDir == 0, budget,
+                                             done[1 - aDir] );
+        done[aDir] = ( status[aDir] == DONE );
+    };
+
+    WALKAROUND_WORKER* worker = Router()->WalkaroundWorker();
+
+    worker->Run( [&]() { walk( 1 ); } );
+    walk( 0 );
+    worker->Wait();
+
+    int len_cw  = paths[0].CLine().Length();
+    int len_ccw = paths[1].CLine().Length();
+
+    if( done[0] != done[1] )
+        aWalkPath = done[0] ? paths[0] : paths[1];
+    else if( m_forceLongerPath )
+        aWalkPath = ( len_cw > len_ccw ? paths[0] : paths[1] );
+    else
+        aWalkPath = ( len_cw < len_ccw ? paths[0] : paths[1] );
+
+    return ( done[0] || done[1] ) ? DONE : STUCK;
+}
+
+
+WALKAROUND::WALKAROUND_STATUS WALKAROUND::finishRoute( const LINE& aInitialPath,
+        LINE& aWalkPath, bool aDone, bool aOptimize )
+{
     if( m_cursorApproachMode )
     {
         // int len_cw = path_cw.GetCLine().Length();
@@ -265,7 +444,7 @@ WALKAROUND::WALKAROUND_STATUS WALKAROUND::Route( const LINE& aInitialPath,
     if( aWalkPath.CPoint( 0 ) != aInitialPath.CPoint( 0 ) )
         return STUCK;
 
-    WALKAROUND_STATUS st = s_ccw == DONE || s_cw == DONE ? DONE : STUCK;
+    WALKAROUND_STATUS st = aDone ? DONE : STUCK;
 
     if( st == DONE )
     {
@@ -22,7 +22,12 @@
 #ifndef __PNS_WALKAROUND_H
 #define __PNS_WALKAROUND_H
 
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
 #include <set>
+#include <thread>
 
 #include "pns_line.h"
 #include "pns_node.h"
@@ -32,6 +37,45 @@
 
 namespace PNS {
 
+/**
+ * Class WALKAROUND_WORKER
+ *
+ * A thread walking the second direction of the speculative walkarounds.  It is kept by
+ * the router (see ROUTER::WalkaroundWorker()), so that a thread is not started on each
+ * routing step.
+ */
+class WALKAROUND_WORKER
+{
+public:
+    WALKAROUND_WORKER();
+    ~WALKAROUND_WORKER();
+
+    /**
+     * Function Run()
+     *
+     * Starts aJob on the worker thread.  The previous job must be finished.
+     */
+    void Run( const std::function<void()>& aJob );
+
+    /**
+     * Function Wait()
+     *
+     * Waits for the job started by Run() to finish.
+     */
+    void Wait();
+
+private:
+    void loop();
+
+    std::mutex              m_mutex;
+    std::condition_variable m_cond;
+    std::function<void()>   m_job;
+    bool                    m_busy;
+    bool                    m_quit;
+    std::thread             m_thread;
+};
+
+
 class WALKAROUND : public ALGO_BASE
 {
     static const int DefaultIterationLimit = 50;
@@ -53,6 +97,9 @@ public:
         m_recursiveCollision[0] = m_recursiveCollision[1] = false;
         m_iteration = 0;
         m_forceCw = false;
+        m_speculative = false;
+        m_speculativeEffort = 0;
+        m_pathOptimized = false;
     }
 
     ~WALKAROUND() {};
@@ -118,9 +165,31 @@ public:
             m_restrictedSet.clear();
     }
 
+    /**
+     * Function SetSpeculative()
+     *
+     * Walks around the obstacles in both directions at once on separate threads and keeps
+     * the best path found within the walkaround time limit, instead of the first one.
+     * Has no effect when the winding is forced.
+     * @param aOptimizerEffort is the optimization applied to each path before comparing them
+     */
+    void SetSpeculative( bool aEnabled, int aOptimizerEffort = 0 )
+    {
+        m_speculative = aEnabled;
+        m_speculativeEffort = aOptimizerEffort;
+    }
+
     WALKAROUND_STATUS Route( const LINE& aInitialPath, LINE& aWalkPath,
             bool aOptimize = true );
 
+    /**
+     * Function PathOptimized()
+     *
+     * @return true if the path found by the last Route() call was already optimized with
+     * the effort passed to SetSpeculative()
+     */
+    bool PathOptimized() const { return m_pathOptimized; }
+
     virtual LOGGER* Logger() override
     {
         return &m_logger;
@@ -132,6 +201,12 @@ private:
     WALKAROUND_STATUS singleStep( LINE& aPath, bool aWindingDirection );
     NODE::OPT_OBSTACLE nearestObstacle( const LINE& aPath );
 
+    WALKAROUND_STATUS routeSpeculative( const LINE& aInitialPath, LINE& aWalkPath );
+    WALKAROUND_STATUS walkDirection( const LINE& aInitialPath, LINE& aPath, bool aCw,
+            TIME_LIMIT aBudget, const std::atomic<bool>& aOtherDone );
+    WALKAROUND_STATUS finishRoute( const LINE& aInitialPath, LINE& aWalkPath, bool aDone,
+            bool aOptimize );
+
     NODE* m_world;
 
     int m_recursiveBlockageCount;
@@ -142,6 +217,9 @@ private:
     bool m_cursorApproachMode;
     bool m_forceWinding;
     bool m_forceCw;
+    bool m_speculative;
+    int m_speculativeEffort;
+    bool m_pathOptimized;
     VECTOR2I m_cursorPos;
     NODE::OPT_OBSTACLE m_currentObstacle[2];
     bool m_recursiveCollision[2];
@@ -664,7 +664,7 @@ void POINT_EDITOR::finishItem()
             // Fix me: try to make it working on Linux.
             //
             #ifdef __WINDOWS__
-            WX_PROGRESS_REPORTER reporter( getEditFrame<PCB_BASE_FRAME>(), _( "Refill Zones" ), 4 );
+            WX_PROGRESS_REPORTER reporter( getEditFrame<PCB_BASE_FRAME>(), _( "Refill Zones" ), 5 );
             filler.SetProgressReporter( &reporter );
             #endif
             filler.Fill( { zone } );
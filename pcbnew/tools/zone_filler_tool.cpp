@@ -40,6 +40,7 @@
 #include "selection_tool.h"
 #include "zone_filler_tool.h"
 #include "zone_filler.h"
+#include "zone_fill_cache.h"
 
 // Zone actions
 TOOL_ACTION PCB_ACTIONS::zoneFill( "pcbnew.ZoneFiller.zoneFill",
@@ -75,6 +76,38 @@ ZONE_FILLER_TOOL::~ZONE_FILLER_TOOL()
 
 void ZONE_FILLER_TOOL::Reset( RESET_REASON aReason )
 {
+    if( aReason == MODEL_RELOAD )
+        m_fillCache.reset();
+}
+
+
+ZONE_FILL_CACHE* ZONE_FILLER_TOOL::GetFillCache()
+{
+    wxString fileName = ZONE_FILL_CACHE::GetCacheFileName( board() );
+
+    if( fileName.IsEmpty() )
+        return nullptr;
+
+    // The board was saved under a new name
+    if( !m_fillCache || m_fillCache->GetFileName() != fileName )
+    {
+        m_fillCache.reset( new ZONE_FILL_CACHE( fileName ) );
+        m_fillCache->Load();
+    }
+
+    return m_fillCache.get();
+}
+
+
+void ZONE_FILLER_TOOL::SaveFillCache( bool aPrune )
+{
+    if( !m_fillCache )
+        return;
+
+    if( aPrune )
+        m_fillCache->Prune( board() );
+
+    m_fillCache->Save();
 }
 
 // Zone actions
@@ -94,12 +127,14 @@ int ZONE_FILLER_TOOL::ZoneFill( const TOOL_EVENT& aEvent )
     }
 
     std::unique_ptr<WX_PROGRESS_REPORTER> progressReporter(
-            new WX_PROGRESS_REPORTER( frame(), _( "Fill Zone" ), 4 )
+            new WX_PROGRESS_REPORTER( frame(), _( "Fill Zone" ), 5 )
             );
 
     ZONE_FILLER filler( board(), &commit );
     filler.SetProgressReporter( progressReporter.get() );
+    filler.SetFillCache( GetFillCache() );
     filler.Fill( toFill );
+    SaveFillCache( false );
 
     canvas()->Refresh();
 
@@ -119,14 +154,18 @@ int ZONE_FILLER_TOOL::ZoneFillAll( const TOOL_EVENT& aEvent )
     }
 
     std::unique_ptr<WX_PROGRESS_REPORTER> progressReporter(
-            new WX_PROGRESS_REPORTER( frame(), _( "Fill All Zones" ), 4 )
+            new WX_PROGRESS_REPORTER( frame(), _( "Fill All Zones" ), 5 )
             );
 
     ZONE_FILLER filler( board(), &commit );
     filler.SetProgressReporter( progressReporter.get() );
+    filler.SetFillCache( GetFillCache() );
 
     if( filler.Fill( toFill ) )
+    {
         frame()->m_ZoneFillsDirty = false;
+        SaveFillCache( true );
+    }
 
     canvas()->Refresh();
 
@@ -25,10 +25,13 @@
 #ifndef ZONE_FILLER_TOOL_H
 #define ZONE_FILLER_TOOL_H
 
+#include <memory>
+
 #include <tools/pcb_tool_base.h>
 
 
 class PCB_EDIT_FRAME;
+class ZONE_FILL_CACHE;
 
 /**
  * Class ZONE_FILLER_TOOL
@@ -50,9 +53,26 @@ public:
     int ZoneUnfill( const TOOL_EVENT& aEvent );
     int ZoneUnfillAll( const TOOL_EVENT& aEvent );
 
+    /**
+     * Function GetFillCache
+     * @return the zone fill cache of the current board, loaded from the disk on first use,
+     * or nullptr if the board has no file name
+     */
+    ZONE_FILL_CACHE* GetFillCache();
+
+    /**
+     * Function SaveFillCache
+     * Writes the zone fill cache to the disk, if it was modified.
+     * @param aPrune = true to remove the entries not used by the board.  Only valid when
+     * all the zones were given to the zone filler.
+     */
+    void SaveFillCache( bool aPrune );
+
 private:
     ///> Sets up handlers for various events.
     void setTransitions() override;
+
+    std::unique_ptr<ZONE_FILL_CACHE> m_fillCache;
 };
 
 #endif
@@ -25,7 +25,9 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
 
+#include <algorithm>
 #include <functional>
+#include <unordered_set>
 using namespace std::placeholders;
 #include <fctsys.h>
 #include <class_drawpanel.h>
@@ -412,6 +414,10 @@ void PCB_BASE_EDIT_FRAME::PutDataInPreviousState( PICKED_ITEMS_LIST* aList, bool
     auto view = GetGalCanvas()->GetView();
     auto connectivity = GetBoard()->GetConnectivity();
 
+    // The changes reported to OnBoardItemsChanged(), like the changes of a commit
+    std::vector<BOARD_ITEM*>        changedItems;
+    std::vector<REMOVED_BOARD_ITEM> removedItems;
+
     // Undo in the reverse order of list creation: (this can allow stacked changes
     // like the same item can be changes and deleted in the same complex command
 
@@ -491,15 +497,25 @@ void PCB_BASE_EDIT_FRAME::PutDataInPreviousState( PICKED_ITEMS_LIST* aList, bool
             view->Remove( item );
             connectivity->Remove( item );
 
+            // The pads and graphic items of a module are swapped with those of the image:
+            // the current ones leave the board
+            if( item->Type() == PCB_MODULE_T )
+            {
+                for( const BOARD_ITEM* child : REMOVED_BOARD_ITEM( item ).m_children )
+                    removedItems.emplace_back( child );
+            }
+
             SwapItemData( item, image );
 
             view->Add( item );
             connectivity->Add( item );
+            changedItems.push_back( item );
         }
         break;
 
         case UR_NEW:        /* new items are deleted */
             aList->SetPickedItemStatus( UR_DELETED, ii );
+            removedItems.emplace_back( item );
             GetModel()->Remove( item );
             view->Remove( item );
             break;
@@ -508,6 +524,7 @@ void PCB_BASE_EDIT_FRAME::PutDataInPreviousState( PICKED_ITEMS_LIST* aList, bool
             aList->SetPickedItemStatus( UR_NEW, ii );
             GetModel()->Add( item );
             view->Add( item );
+            changedItems.push_back( item );
             build_item_list = true;
             break;
 
@@ -515,6 +532,7 @@ void PCB_BASE_EDIT_FRAME::PutDataInPreviousState( PICKED_ITEMS_LIST* aList, bool
             item->Move( aRedoCommand ? aList->m_TransformPoint : -aList->m_TransformPoint );
             view->Update( item, KIGFX::GEOMETRY );
             connectivity->Update( item );
+            changedItems.push_back( item );
             break;
 
         case UR_ROTATED:
@@ -522,6 +540,7 @@ void PCB_BASE_EDIT_FRAME::PutDataInPreviousState( PICKED_ITEMS_LIST* aList, bool
                           aRedoCommand ? m_rotationAngle : -m_rotationAngle );
             view->Update( item, KIGFX::GEOMETRY );
             connectivity->Update( item );
+            changedItems.push_back( item );
             break;
 
         case UR_ROTATED_CLOCKWISE:
@@ -529,12 +548,14 @@ void PCB_BASE_EDIT_FRAME::PutDataInPreviousState( PICKED_ITEMS_LIST* aList, bool
                           aRedoCommand ? -m_rotationAngle : m_rotationAngle );
             view->Update( item, KIGFX::GEOMETRY );
             connectivity->Update( item );
+            changedItems.push_back( item );
             break;
 
         case UR_FLIPPED:
             item->Flip( aList->m_TransformPoint );
             view->Update( item, KIGFX::LAYERS );
             connectivity->Update( item );
+            changedItems.push_back( item );
             break;
 
         case UR_DRILLORIGIN:
@@ -574,6 +595,29 @@ void PCB_BASE_EDIT_FRAME::PutDataInPreviousState( PICKED_ITEMS_LIST* aList, bool
     selTool->RebuildSelection();
 
     GetBoard()->SanitizeNetcodes();
+
+    // Report the restored items like a commit does, without the markers.  An item changed
+    // and then removed by the same command is only reported as removed.  The callers do not
+    // all call OnModify() next: the changes are reported as not followed by it, and the
+    // router world is rebuilt after an undo or a redo.
+    if( IsType( FRAME_PCB ) )
+    {
+        std::unordered_set<const BOARD_ITEM*> removedSet;
+
+        for( const REMOVED_BOARD_ITEM& removed : removedItems )
+            removedSet.insert( removed.m_item );
+
+        changedItems.erase( std::remove_if( changedItems.begin(), changedItems.end(),
+                                            [&]( BOARD_ITEM* aItem )
+                                            {
+                                                return aItem->Type() == PCB_MARKER_T
+                                                       || removedSet.count( aItem ) > 0;
+                                            } ),
+                            changedItems.end() );
+
+        if( !changedItems.empty() || !removedItems.empty() )
+            OnBoardItemsChanged( changedItems, removedItems, false );
+    }
 }
 
 
@@ -0,0 +1,480 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+
+#include <cstdint>
+#include <cstring>
+#include <set>
+
+#include <wx/ffile.h>
+#include <wx/filefn.h>
+#include <wx/filename.h>
+
+#include <class_board.h>
+#include <class_zone.h>
+
+#include "zone_fill_cache.h"
+#include "zone_filler.h"
+
+
+// The file starts with this signature, followed by the format version and the version
+// of the fill algorithm which computed the cached fills
+static const char     s_cacheSignature[8] = { 'K', 'Z', 'F', 'C', 'A', 'C', 'H', 'E' };
+static const uint32_t s_cacheVersion = 2;
+static const uint32_t s_fillAlgorithmVersion = ZONE_FILL_ALGORITHM_VERSION;
+
+// Entries are keyed by the 16 bytes of their obstacles hash
+static const size_t   s_keyLength = 16;
+
+
+/**
+ * Appends the raw bytes of a value to a write buffer
+ */
+template <typename T>
+static void writeValue( std::string& aBuffer, T aValue )
+{
+    aBuffer.append( reinterpret_cast<const char*>( &aValue ), sizeof( T ) );
+}
+
+
+/**
+ * Reads raw values from a buffer loaded from a cache file.  Reading past the end
+ * of the buffer sets the error flag and returns zeros.
+ */
+class CACHE_READER
+{
+public:
+    CACHE_READER( const std::vector<char>& aBuffer ) :
+        m_buffer( aBuffer ), m_pos( 0 ), m_error( false )
+    {
+    }
+
+    template <typename T>
+    T Read()
+    {
+        T value = 0;
+
+        if( m_pos + sizeof( T ) > m_buffer.size() )
+        {
+            m_error = true;
+            return value;
+        }
+
+        memcpy( &value, m_buffer.data() + m_pos, sizeof( T ) );
+        m_pos += sizeof( T );
+        return value;
+    }
+
+    std::string ReadString( size_t aLength )
+    {
+        if( m_pos + aLength > m_buffer.size() )
+        {
+            m_error = true;
+            return std::string();
+        }
+
+        std::string value( m_buffer.data() + m_pos, aLength );
+        m_pos += aLength;
+        return value;
+    }
+
+    /**
+     * @return true if aCount items of at least aItemSize bytes can still be read.
+     * Used to reject corrupted counts before allocating anything.
+     */
+    bool CanRead( uint32_t aCount, size_t aItemSize )
+    {
+        if( (uint64_t) aCount * aItemSize > m_buffer.size() - m_pos )
+            m_error = true;
+
+        return !m_error;
+    }
+
+    void SetError() { m_error = true; }
+
+    bool Error() const { return m_error; }
+
+private:
+    const std::vector<char>& m_buffer;
+    size_t                   m_pos;
+    bool                     m_error;
+};
+
+
+static void writePolySet( std::string& aBuffer, const SHAPE_POLY_SET& aPolySet )
+{
+    writeValue<uint32_t>( aBuffer, aPolySet.OutlineCount() );
+
+    for( int ii = 0; ii < aPolySet.OutlineCount(); ii++ )
+    {
+        const SHAPE_POLY_SET::POLYGON& poly = aPolySet.CPolygon( ii );
+
+        writeValue<uint32_t>( aBuffer, poly.size() );
+
+        for( const SHAPE_LINE_CHAIN& chain : poly )
+        {
+            writeValue<uint8_t>( aBuffer, chain.IsClosed() );
+            writeValue<uint32_t>( aBuffer, chain.PointCount() );
+
+            for( int jj = 0; jj < chain.PointCount(); jj++ )
+            {
+                writeValue<int32_t>( aBuffer, chain.CPoint( jj ).x );
+                writeValue<int32_t>( aBuffer, chain.CPoint( jj ).y );
+            }
+        }
+    }
+}
+
+
+static bool readPolySet( CACHE_READER& aReader, SHAPE_POLY_SET& aPolySet )
+{
+    uint32_t polyCount = aReader.Read<uint32_t>();
+
+    if( !aReader.CanRead( polyCount, sizeof( uint32_t ) ) )
+        return false;
+
+    for( uint32_t ii = 0; ii < polyCount; ii++ )
+    {
+        uint32_t chainCount = aReader.Read<uint32_t>();
+
+        if( !aReader.CanRead( chainCount, sizeof( uint8_t ) + sizeof( uint32_t ) ) )
+            return false;
+
+        for( uint32_t jj = 0; jj < chainCount; jj++ )
+        {
+            SHAPE_LINE_CHAIN chain;
+            bool             closed = aReader.Read<uint8_t>() != 0;
+            uint32_t         pointCount = aReader.Read<uint32_t>();
+
+            if( !aReader.CanRead( pointCount, 2 * sizeof( int32_t ) ) )
+                return false;
+
+            for( uint32_t kk = 0; kk < pointCount; kk++ )
+            {
+                int x = aReader.Read<int32_t>();
+                int y = aReader.Read<int32_t>();
+
+                // Keep the points exactly as they were stored, to keep the polygon
+                // hash used to validate the triangulation
+                chain.Append( x, y, true );
+            }
+
+            chain.SetClosed( closed );
+
+            if( jj == 0 )
+                aPolySet.AddOutline( chain );
+            else
+                aPolySet.AddHole( chain, aPolySet.OutlineCount() - 1 );
+        }
+    }
+
+    return !aReader.Error();
+}
+
+
+ZONE_FILL_CACHE::ZONE_FILL_CACHE( const wxString& aFileName ) :
+    m_fileName( aFileName ), m_modified( false )
+{
+}
+
+
+wxString ZONE_FILL_CACHE::GetCacheFileName( const BOARD* aBoard )
+{
+    if( aBoard->GetFileName().IsEmpty() )
+        return wxEmptyString;
+
+    wxFileName fn( aBoard->GetFileName() );
+    fn.SetExt( wxT( "zone-fill-cache" ) );
+
+    return fn.GetFullPath();
+}
+
+
+std::string ZONE_FILL_CACHE::key( const MD5_HASH& aHash )
+{
+    // The raw digest: MD5_HASH::Format() does not give a fixed length string
+    return std::string( reinterpret_cast<const char*>( aHash.GetDigest() ), s_keyLength );
+}
+
+
+bool ZONE_FILL_CACHE::Load()
+{
+    m_entries.clear();
+    m_modified = false;
+
+    if( !wxFileName::FileExists( m_fileName ) )
+        return false;
+
+    wxFFile file( m_fileName, wxT( "rb" ) );
+
+    if( !file.IsOpened() )
+        return false;
+
+    std::vector<char> buffer( file.Length() );
+
+    if( file.Read( buffer.data(), buffer.size() ) != buffer.size() )
+        return false;
+
+    CACHE_READER reader( buffer );
+
+    if( reader.ReadString( sizeof( s_cacheSignature ) )
+                    != std::string( s_cacheSignature, sizeof( s_cacheSignature ) )
+            || reader.Read<uint32_t>() != s_cacheVersion
+            || reader.Read<uint32_t>() != s_fillAlgorithmVersion )
+    {
+        return false;
+    }
+
+    uint32_t entryCount = reader.Read<uint32_t>();
+
+    for( uint32_t ii = 0; ii < entryCount && !reader.Error(); ii++ )
+    {
+        std::string hashKey = reader.ReadString( s_keyLength );
+        ENTRY       entry;
+
+        if( !readPolySet( reader, entry.m_filledPolys ) )
+            break;
+
+        uint32_t triCount = reader.Read<uint32_t>();
+
+        if( !reader.CanRead( triCount, 2 * sizeof( uint32_t ) ) )
+            break;
+
+        entry.m_triangulation.resize( triCount );
+
+        for( SHAPE_POLY_SET::TRIANGULATED_POLYGON& tri : entry.m_triangulation )
+        {
+            uint32_t vertexCount = reader.Read<uint32_t>();
+
+            if( !reader.CanRead( vertexCount, 2 * sizeof( int32_t ) ) )
+                break;
+
+            for( uint32_t jj = 0; jj < vertexCount; jj++ )
+            {
+                int x = reader.Read<int32_t>();
+                int y = reader.Read<int32_t>();
+                tri.AddVertex( VECTOR2I( x, y ) );
+            }
+
+            uint32_t triangleCount = reader.Read<uint32_t>();
+
+            if( !reader.CanRead( triangleCount, 3 * sizeof( uint32_t ) ) )
+                break;
+
+            for( uint32_t jj = 0; jj < triangleCount; jj++ )
+            {
+                uint32_t a = reader.Read<uint32_t>();
+                uint32_t b = reader.Read<uint32_t>();
+                uint32_t c = reader.Read<uint32_t>();
+
+                // A corrupted index would be used to draw the zone
+                if( a >= vertexCount || b >= vertexCount || c >= vertexCount )
+                {
+                    reader.SetError();
+                    break;
+                }
+
+                tri.AddTriangle( a, b, c );
+            }
+        }
+
+        if( reader.Error() )
+            break;
+
+        m_entries[hashKey] = std::move( entry );
+    }
+
+    if( reader.Error() )
+    {
+        m_entries.clear();
+        return false;
+    }
+
+    return true;
+}
+
+
+bool ZONE_FILL_CACHE::Save()
+{
+    if( !m_modified )
+        return true;
+
+    std::string buffer;
+
+    buffer.append( s_cacheSignature, sizeof( s_cacheSignature ) );
+    writeValue<uint32_t>( buffer, s_cacheVersion );
+    writeValue<uint32_t>( buffer, s_fillAlgorithmVersion );
+    writeValue<uint32_t>( buffer, m_entries.size() );
+
+    for( const auto& item : m_entries )
+    {
+        const ENTRY& entry = item.second;
+
+        buffer.append( item.first );
+        writePolySet( buffer, entry.m_filledPolys );
+        writeValue<uint32_t>( buffer, entry.m_triangulation.size() );
+
+        for( const SHAPE_POLY_SET::TRIANGULATED_POLYGON& tri : entry.m_triangulation )
+        {
+            writeValue<uint32_t>( buffer, tri.GetVertexCount() );
+
+            for( size_t ii = 0; ii < tri.GetVertexCount(); ii++ )
+            {
+                writeValue<int32_t>( buffer, tri.GetVertex( ii ).x );
+                writeValue<int32_t>( buffer, tri.GetVertex( ii ).y );
+            }
+
+            writeValue<uint32_t>( buffer, tri.GetTriangleCount() );
+
+            for( size_t ii = 0; ii < tri.GetTriangleCount(); ii++ )
+            {
+                const SHAPE_POLY_SET::TRIANGULATED_POLYGON::TRI& t = tri.GetTriangleIndices( ii );
+
+                writeValue<uint32_t>( buffer, t.a );
+                writeValue<uint32_t>( buffer, t.b );
+                writeValue<uint32_t>( buffer, t.c );
+            }
+        }
+    }
+
+    // Write a temporary file first, so that an interrupted save does not leave
+    // a truncated cache behind
+    wxString tmpFileName = m_fileName + wxT( ".tmp" );
+
+    {
+        wxFFile file( tmpFileName, wxT( "wb" ) );
+
+        if( !file.IsOpened() || file.Write( buffer.data(), buffer.size() ) != buffer.size() )
+            return false;
+    }
+
+    if( !wxRenameFile( tmpFileName, m_fileName, true ) )
+        return false;
+
+    m_modified = false;
+    return true;
+}
+
+
+const ZONE_FILL_CACHE::ENTRY* ZONE_FILL_CACHE::Find( const MD5_HASH& aObstaclesHash ) const
+{
+    if( !aObstaclesHash.IsValid() )
+        return nullptr;
+
+    auto it = m_entries.find( key( aObstaclesHash ) );
+
+    return it == m_entries.end() ? nullptr : &it->second;
+}
+
+
+void ZONE_FILL_CACHE::Store( const MD5_HASH& aObstaclesHash, const SHAPE_POLY_SET& aFilledPolys )
+{
+    if( !aObstaclesHash.IsValid() || !aFilledPolys.IsTriangulationUpToDate() )
+        return;
+
+    ENTRY& entry = m_entries[key( aObstaclesHash )];
+
+    entry.m_filledPolys = aFilledPolys;
+    entry.m_triangulation.clear();
+
+    for( unsigned ii = 0; ii < aFilledPolys.TriangulatedPolyCount(); ii++ )
+        entry.m_triangulation.push_back( *aFilledPolys.TriangulatedPolygon( ii ) );
+
+    m_modified = true;
+}
+
+
+void ZONE_FILL_CACHE::StoreFills( const BOARD* aBoard )
+{
+    for( int ii = 0; ii < aBoard->GetAreaCount(); ii++ )
+    {
+        const ZONE_CONTAINER* zone = aBoard->GetArea( ii );
+
+        if( zone->IsFilled() && !Find( zone->GetObstaclesHash() ) )
+            Store( zone->GetObstaclesHash(), zone->GetFilledPolysList() );
+    }
+}
+
+
+int ZONE_FILL_CACHE::Restore( BOARD* aBoard ) const
+{
+    // The entries by the hash of their filled areas
+    std::map<std::string, std::map<std::string, ENTRY>::const_iterator> fills;
+
+    for( auto it = m_entries.begin(); it != m_entries.end(); ++it )
+        fills[key( it->second.m_filledPolys.GetHash() )] = it;
+
+    int restored = 0;
+
+    for( int ii = 0; ii < aBoard->GetAreaCount(); ii++ )
+    {
+        ZONE_CONTAINER* zone = aBoard->GetArea( ii );
+        SHAPE_POLY_SET& filledPolys = zone->FilledPolysList();
+
+        if( !zone->IsFilled() || filledPolys.IsEmpty() || filledPolys.IsTriangulationUpToDate() )
+            continue;
+
+        auto it = fills.find( key( filledPolys.GetHash() ) );
+
+        if( it == fills.end() )
+            continue;
+
+        // The filled areas are the ones computed for the obstacles of the entry: the zone
+        // filler still compares this hash with the one of the current obstacles
+        MD5_HASH obstaclesHash;
+        obstaclesHash.SetDigest( reinterpret_cast<const uint8_t*>( it->second->first.data() ) );
+
+        filledPolys.SetTriangulation( it->second->second.m_triangulation );
+        zone->SetObstaclesHash( obstaclesHash );
+        restored++;
+    }
+
+    return restored;
+}
+
+
+void ZONE_FILL_CACHE::Prune( const BOARD* aBoard )
+{
+    std::set<std::string> usedKeys;
+
+    for( int ii = 0; ii < aBoard->GetAreaCount(); ii++ )
+    {
+        const ZONE_CONTAINER* zone = aBoard->GetArea( ii );
+
+        if( zone->IsFilled() && zone->GetObstaclesHash().IsValid() )
+            usedKeys.insert( key( zone->GetObstaclesHash() ) );
+    }
+
+    for( auto it = m_entries.begin(); it != m_entries.end(); )
+    {
+        if( usedKeys.count( it->first ) )
+        {
+            ++it;
+        }
+        else
+        {
+            it = m_entries.erase( it );
+            m_modified = true;
+        }
+    }
+}
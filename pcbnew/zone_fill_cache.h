@@ -0,0 +1,129 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+
+#ifndef ZONE_FILL_CACHE_H
+#define ZONE_FILL_CACHE_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <wx/string.h>
+
+#include <md5_hash.h>
+#include <geometry/shape_poly_set.h>
+
+class BOARD;
+
+/**
+ * Class ZONE_FILL_CACHE
+ * Stores on disk, next to the board file, the filled areas of zones and their triangulation,
+ * keyed by the hash of everything the fill depends on (see ZONE_FILLER::hashSameNetZones()).
+ * A zone whose obstacles hash is found in the cache gets its filled areas back without
+ * being filled again.
+ * The cache file is a local build artifact: it uses the byte order of the host, and is
+ * silently ignored if it cannot be read.
+ */
+class ZONE_FILL_CACHE
+{
+public:
+    struct ENTRY
+    {
+        SHAPE_POLY_SET m_filledPolys;     ///< the final (fractured) filled areas
+        std::vector<SHAPE_POLY_SET::TRIANGULATED_POLYGON> m_triangulation;
+    };
+
+    ZONE_FILL_CACHE( const wxString& aFileName );
+
+    /**
+     * Function GetCacheFileName
+     * @return the name of the cache file of aBoard, or an empty string if the board
+     * has no file name
+     */
+    static wxString GetCacheFileName( const BOARD* aBoard );
+
+    const wxString& GetFileName() const { return m_fileName; }
+
+    /**
+     * Function Load
+     * Reads the cache file.  A missing or invalid file gives an empty cache.
+     * @return true if the file was read
+     */
+    bool Load();
+
+    /**
+     * Function Save
+     * Writes the cache file, if it was modified since it was loaded or saved.
+     * @return false if the file could not be written
+     */
+    bool Save();
+
+    bool IsModified() const { return m_modified; }
+
+    /**
+     * Function Find
+     * @return the entry stored for aObstaclesHash, or nullptr if there is none
+     */
+    const ENTRY* Find( const MD5_HASH& aObstaclesHash ) const;
+
+    /**
+     * Function Store
+     * Stores the filled areas of a zone.  They are stored only if their triangulation
+     * is up to date, since restoring them must not need any computation.
+     */
+    void Store( const MD5_HASH& aObstaclesHash, const SHAPE_POLY_SET& aFilledPolys );
+
+    /**
+     * Function StoreFills
+     * Stores the filled areas of the zones of aBoard whose obstacles hash is known and
+     * not yet in the cache, typically before the board is saved.
+     */
+    void StoreFills( const BOARD* aBoard );
+
+    /**
+     * Function Restore
+     * Gives back their triangulation and obstacles hash to the zones of a board just
+     * loaded, when their filled areas are exactly the ones of a cache entry.  The zones
+     * whose filled areas changed since they were cached are left as they are.
+     * @return the number of restored zones
+     */
+    int Restore( BOARD* aBoard ) const;
+
+    /**
+     * Function Prune
+     * Removes the entries which are not the current fill of a zone of aBoard.
+     * Must be called only when the obstacles hash of every filled zone is known, i.e.
+     * after all zones went through ZONE_FILLER::Fill().
+     */
+    void Prune( const BOARD* aBoard );
+
+private:
+    static std::string key( const MD5_HASH& aHash );
+
+    wxString                     m_fileName;
+    std::map<std::string, ENTRY> m_entries;
+    bool                         m_modified;
+};
+
+#endif // ZONE_FILL_CACHE_H
@@ -28,6 +28,7 @@
 #include <mutex>
 #include <algorithm>
 #include <future>
+#include <unordered_set>
 
 #include <class_board.h>
 #include <class_zone.h>
@@ -50,6 +51,7 @@
 #include <confirm.h>
 
 #include "zone_filler.h"
+#include "zone_fill_cache.h"
 
 
 class PROGRESS_REPORTER_HIDER
@@ -83,7 +85,8 @@ static const bool s_DumpZonesWhenFilling = false;
 
 
 ZONE_FILLER::ZONE_FILLER(  BOARD* aBoard, COMMIT* aCommit ) :
-    m_board( aBoard ), m_commit( aCommit ), m_progressReporter( nullptr )
+    m_board( aBoard ), m_commit( aCommit ), m_progressReporter( nullptr ),
+    m_fillCache( nullptr )
 {
 }
 
@@ -99,6 +102,12 @@ void ZONE_FILLER::SetProgressReporter( WX_PROGRESS_REPORTER* aReporter )
 }
 
 
+void ZONE_FILLER::SetFillCache( ZONE_FILL_CACHE* aCache )
+{
+    m_fillCache = aCache;
+}
+
+
 bool ZONE_FILLER::Fill( const std::vector<ZONE_CONTAINER*>& aZones, bool aCheck )
 {
     std::vector<CN_ZONE_ISOLATED_ISLAND_LIST> toFill;
@@ -109,17 +118,91 @@ bool ZONE_FILLER::Fill( const std::vector<ZONE_CONTAINER*>& aZones, bool aCheck
     if( !lock )
         return false;
 
+    std::vector<ZONE_CONTAINER*> candidates;
+
+    for( auto zone : aZones )
+    {
+        // Keepout zones are not filled
+        if( !zone->GetIsKeepout() )
+            candidates.push_back( zone );
+    }
+
     if( m_progressReporter )
     {
         m_progressReporter->Report( _( "Checking zone fills..." ) );
-        m_progressReporter->SetMaxProgress( toFill.size() );
+        m_progressReporter->SetMaxProgress( candidates.size() );
     }
 
-    for( auto zone : aZones )
+    // Compute the obstacles hash of each zone.  The zones whose hash did not change since
+    // their last fill are up to date and are skipped.  The feature holes the hashes are
+    // built from are kept for the zones to refill.
+    std::vector<MD5_HASH>       obstaclesHashes( candidates.size() );
+    std::vector<SHAPE_POLY_SET> features( candidates.size() );
+    std::atomic<size_t>         nextItem( 0 );
+    size_t                      parallelThreadCount =
+            std::min<size_t>( std::thread::hardware_concurrency(), candidates.size() );
+    std::vector<std::future<size_t>> returns( parallelThreadCount );
+
+    auto hash_lambda = [&] ( PROGRESS_REPORTER* aReporter ) -> size_t
     {
-        // Keepout zones are not filled
-        if( zone->GetIsKeepout() )
+        size_t num = 0;
+
+        for( size_t i = nextItem++; i < candidates.size(); i = nextItem++ )
+        {
+            ZONE_CONTAINER* zone = candidates[i];
+
+            if( zone->IsOnCopperLayer() )
+                buildZoneFeatureHoleList( zone, features[i] );
+
+            obstaclesHashes[i] = buildObstaclesHash( zone, features[i] );
+
+            if( m_progressReporter )
+                m_progressReporter->AdvanceProgress();
+
+            num++;
+        }
+
+        return num;
+    };
+
+    if( parallelThreadCount <= 1 )
+        hash_lambda( m_progressReporter );
+    else
+    {
+        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+            returns[ii] = std::async( std::launch::async, hash_lambda, m_progressReporter );
+
+        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+        {
+            // Here we balance returns with a 100ms timeout to allow UI updating
+            std::future_status status;
+            do
+            {
+                if( m_progressReporter )
+                    m_progressReporter->KeepRefreshing();
+
+                status = returns[ii].wait_for( std::chrono::milliseconds( 100 ) );
+            } while( status != std::future_status::ready );
+        }
+    }
+
+    hashSameNetZones( candidates, obstaclesHashes );
+
+    std::vector<size_t>          toFillIndex;
+    std::vector<ZONE_CONTAINER*> fromCache;
+    bool                         outOfDate = false;
+
+    for( size_t i = 0; i < candidates.size(); ++i )
+    {
+        ZONE_CONTAINER* zone = candidates[i];
+
+        // The zone is up to date: nothing it depends on changed since the last fill
+        if( zone->IsFilled() && zone->GetObstaclesHash().IsValid()
+                && zone->GetObstaclesHash() == obstaclesHashes[i] )
+        {
+            features[i].RemoveAllContours();
             continue;
+        }
 
         if( m_commit )
             m_commit->Modify( zone );
@@ -128,18 +211,47 @@ bool ZONE_FILLER::Fill( const std::vector<ZONE_CONTAINER*>& aZones, bool aCheck
         // to know if the current filled areas are up to date
         zone->BuildHashValue();
 
+        // The zone was already filled with the same obstacles, maybe in a previous session
+        const ZONE_FILL_CACHE::ENTRY* cached =
+                m_fillCache ? m_fillCache->Find( obstaclesHashes[i] ) : nullptr;
+
+        if( cached )
+        {
+            zone->FilledPolysList() = cached->m_filledPolys;
+            zone->FilledPolysList().SetTriangulation( cached->m_triangulation );
+            zone->RawPolysList().RemoveAllContours();
+            zone->SetObstaclesHash( obstaclesHashes[i] );
+            zone->SetIsFilled( true );
+
+            if( aCheck && zone->GetHashValue() != zone->GetFilledPolysList().GetHash() )
+                outOfDate = true;
+
+            fromCache.push_back( zone );
+            features[i].RemoveAllContours();
+            continue;
+        }
+
         // Add the zone to the list of zones to test or refill
         toFill.emplace_back( CN_ZONE_ISOLATED_ISLAND_LIST(zone) );
+        toFillIndex.push_back( i );
 
         // Remove existing fill first to prevent drawing invalid polygons
         // on some platforms
         zone->UnFill();
     }
 
-    std::atomic<size_t> nextItem( 0 );
-    size_t              parallelThreadCount =
-            std::min<size_t>( std::thread::hardware_concurrency(), aZones.size() );
-    std::vector<std::future<size_t>> returns( parallelThreadCount );
+    if( toFill.empty() && fromCache.empty() )
+        return true;
+
+    if( m_progressReporter )
+    {
+        m_progressReporter->AdvancePhase();
+        m_progressReporter->Report( _( "Filling zones..." ) );
+        m_progressReporter->SetMaxProgress( toFill.size() );
+    }
+
+    nextItem = 0;
+    parallelThreadCount = std::min<size_t>( parallelThreadCount, toFill.size() );
 
     auto fill_lambda = [&] ( PROGRESS_REPORTER* aReporter ) -> size_t
     {
@@ -148,11 +260,14 @@ bool ZONE_FILLER::Fill( const std::vector<ZONE_CONTAINER*>& aZones, bool aCheck
         for( size_t i = nextItem++; i < toFill.size(); i = nextItem++ )
         {
             ZONE_CONTAINER* zone = toFill[i].m_zone;
-            SHAPE_POLY_SET rawPolys, finalPolys;
-            fillSingleZone( zone, rawPolys, finalPolys );
+            size_t          idx = toFillIndex[i];
+            SHAPE_POLY_SET  rawPolys, finalPolys;
+
+            fillSingleZone( zone, features[idx], rawPolys, finalPolys );
 
             zone->SetRawPolysList( rawPolys );
             zone->SetFilledPolysList( finalPolys );
+            zone->SetObstaclesHash( obstaclesHashes[idx] );
             zone->SetIsFilled( true );
 
             if( m_progressReporter )
@@ -194,10 +309,11 @@ bool ZONE_FILLER::Fill( const std::vector<ZONE_CONTAINER*>& aZones, bool aCheck
     }
 
     connectivity->SetProgressReporter( m_progressReporter );
-    connectivity->FindIsolatedCopperIslands( toFill );
+
+    if( !toFill.empty() )
+        connectivity->FindIsolatedCopperIslands( toFill );
 
     // Now remove insulated copper islands and islands outside the board edge
-    bool outOfDate = false;
     SHAPE_POLY_SET boardOutline;
     bool clip_to_brd_outlines = m_board->GetBoardPolygonOutlines( boardOutline );
 
@@ -304,6 +420,15 @@ bool ZONE_FILLER::Fill( const std::vector<ZONE_CONTAINER*>& aZones, bool aCheck
         }
     }
 
+    if( m_fillCache )
+    {
+        for( auto& zone : toFill )
+        {
+            m_fillCache->Store( zone.m_zone->GetObstaclesHash(),
+                                zone.m_zone->GetFilledPolysList() );
+        }
+    }
+
     if( m_progressReporter )
     {
         m_progressReporter->AdvancePhase();
@@ -322,6 +447,9 @@ bool ZONE_FILLER::Fill( const std::vector<ZONE_CONTAINER*>& aZones, bool aCheck
         for( auto& i : toFill )
             connectivity->Update( i.m_zone );
 
+        for( auto zone : fromCache )
+            connectivity->Update( zone );
+
         connectivity->RecalculateRatsnest();
     }
 
@@ -668,6 +796,219 @@ void ZONE_FILLER::buildZoneFeatureHoleList( const ZONE_CONTAINER* aZone,
     }
 }
 
+/**
+ * Adds the corners of a polygon set to a hash
+ */
+static void hashPolySet( MD5_HASH& aHash, const SHAPE_POLY_SET& aPolys )
+{
+    aHash.Hash( aPolys.OutlineCount() );
+
+    for( int ii = 0; ii < aPolys.OutlineCount(); ii++ )
+    {
+        const SHAPE_POLY_SET::POLYGON& poly = aPolys.CPolygon( ii );
+
+        aHash.Hash( (int) poly.size() );
+
+        for( const SHAPE_LINE_CHAIN& chain : poly )
+        {
+            aHash.Hash( chain.PointCount() );
+
+            for( int jj = 0; jj < chain.PointCount(); jj++ )
+            {
+                aHash.Hash( chain.CPoint( jj ).x );
+                aHash.Hash( chain.CPoint( jj ).y );
+            }
+        }
+    }
+}
+
+
+MD5_HASH ZONE_FILLER::buildObstaclesHash( const ZONE_CONTAINER* aZone,
+        const SHAPE_POLY_SET& aFeatures ) const
+{
+    MD5_HASH hash;
+
+    // The zone itself
+    hashPolySet( hash, *aZone->Outline() );
+    hash.Hash( aZone->GetLayer() );
+    hash.Hash( aZone->GetNetCode() );
+    hash.Hash( aZone->GetPriority() );
+    hash.Hash( aZone->GetClearance() );
+    hash.Hash( aZone->GetZoneClearance() );
+    hash.Hash( aZone->GetMinThickness() );
+    hash.Hash( aZone->GetFillMode() );
+    hash.Hash( aZone->GetPadConnection() );
+    hash.Hash( aZone->GetThermalReliefGap() );
+    hash.Hash( aZone->GetThermalReliefCopperBridge() );
+    hash.Hash( aZone->GetArcSegmentCount() );
+    hash.Hash( aZone->GetHatchFillTypeThickness() );
+    hash.Hash( aZone->GetHatchFillTypeGap() );
+    hash.Hash( KiROUND( aZone->GetHatchFillTypeOrientation() * 10 ) );
+    hash.Hash( aZone->GetHatchFillTypeSmoothingLevel() );
+    hash.Hash( KiROUND( aZone->GetHatchFillTypeSmoothingValue() * 1000 ) );
+    hash.Hash( aZone->GetCornerSmoothingType() );
+    hash.Hash( (int) aZone->GetCornerRadius() );
+
+    if( !aZone->IsOnCopperLayer() )
+    {
+        hash.Finalize();
+        return hash;
+    }
+
+    // The items the filled areas are clipped by
+    hashPolySet( hash, aFeatures );
+
+    // The items of the zone net: they are not obstacles, but the thermal stubs and
+    // the insulated islands removal depend on them
+    if( aZone->GetNetCode() > 0 )
+    {
+        EDA_RECT zone_boundingbox = aZone->GetBoundingBox();
+        int      biggest_clearance = m_board->GetDesignSettings().GetBiggestClearanceValue();
+
+        zone_boundingbox.Inflate( std::max( biggest_clearance, aZone->GetClearance() ) );
+
+        for( auto module : m_board->Modules() )
+        {
+            for( auto pad : module->Pads() )
+            {
+                if( pad->GetNetCode() != aZone->GetNetCode() )
+                    continue;
+
+                if( !pad->IsOnLayer( aZone->GetLayer() ) )
+                    continue;
+
+                if( !pad->GetBoundingBox().Intersects( zone_boundingbox ) )
+                    continue;
+
+                hash.Hash( pad->ShapePos().x );
+                hash.Hash( pad->ShapePos().y );
+                hash.Hash( pad->GetSize().x );
+                hash.Hash( pad->GetSize().y );
+                hash.Hash( KiROUND( pad->GetOrientation() ) );
+                hash.Hash( pad->GetShape() );
+                hash.Hash( pad->GetAttribute() );
+                hash.Hash( pad->GetDrillShape() );
+                hash.Hash( pad->GetDrillSize().x );
+                hash.Hash( pad->GetDrillSize().y );
+                hash.Hash( pad->GetOffset().x );
+                hash.Hash( pad->GetOffset().y );
+
+                if( pad->GetShape() == PAD_SHAPE_CUSTOM )
+                {
+                    hash.Hash( pad->GetAnchorPadShape() );
+                    hash.Hash( pad->GetCustomShapeInZoneOpt() );
+                    hashPolySet( hash, pad->GetCustomShapeAsPolygon() );
+                }
+
+                hash.Hash( aZone->GetPadConnection( pad ) );
+                hash.Hash( aZone->GetThermalReliefGap( pad ) );
+                hash.Hash( aZone->GetThermalReliefCopperBridge( pad ) );
+            }
+        }
+
+        for( auto track : m_board->Tracks() )
+        {
+            if( track->GetNetCode() != aZone->GetNetCode() )
+                continue;
+
+            if( !track->IsOnLayer( aZone->GetLayer() ) )
+                continue;
+
+            if( !track->GetBoundingBox().Intersects( zone_boundingbox ) )
+                continue;
+
+            hash.Hash( track->Type() );
+            hash.Hash( track->GetStart().x );
+            hash.Hash( track->GetStart().y );
+            hash.Hash( track->GetEnd().x );
+            hash.Hash( track->GetEnd().y );
+            hash.Hash( track->GetWidth() );
+        }
+    }
+
+    hash.Finalize();
+    return hash;
+}
+
+
+/**
+ * Returns true if the filled areas of two zones depend on each other: the insulated islands
+ * of a zone can be connected through the filled areas of another zone of the same net
+ */
+static bool sameNetZonesOverlap( const ZONE_CONTAINER* aZoneA, const ZONE_CONTAINER* aZoneB )
+{
+    return aZoneA->GetNetCode() > 0 && aZoneA->GetNetCode() == aZoneB->GetNetCode()
+           && !aZoneA->GetIsKeepout() && !aZoneB->GetIsKeepout()
+           && aZoneA->CommonLayerExists( aZoneB->GetLayerSet() )
+           && aZoneA->GetBoundingBox().Intersects( aZoneB->GetBoundingBox() );
+}
+
+
+void ZONE_FILLER::hashSameNetZones( const std::vector<ZONE_CONTAINER*>& aZones,
+        std::vector<MD5_HASH>& aHashes ) const
+{
+    // Gather the zones in groups of overlapping zones of the same net, directly or through
+    // other zones of the group
+    std::vector<size_t> group( aZones.size() );
+
+    for( size_t ii = 0; ii < aZones.size(); ++ii )
+        group[ii] = ii;
+
+    auto groupOf = [&]( size_t aIdx ) -> size_t
+    {
+        while( group[aIdx] != aIdx )
+            aIdx = group[aIdx] = group[group[aIdx]];
+
+        return aIdx;
+    };
+
+    for( size_t ii = 0; ii < aZones.size(); ++ii )
+    {
+        for( size_t jj = ii + 1; jj < aZones.size(); ++jj )
+        {
+            if( sameNetZonesOverlap( aZones[ii], aZones[jj] ) )
+                group[groupOf( jj )] = groupOf( ii );
+        }
+    }
+
+    std::unordered_set<const ZONE_CONTAINER*> filledZones( aZones.begin(), aZones.end() );
+    std::vector<MD5_HASH>                     hashes( aZones.size() );
+
+    auto hashDigest = []( MD5_HASH& aHash, const MD5_HASH& aDigest )
+    {
+        uint8_t digest[16];
+
+        std::copy( aDigest.GetDigest(), aDigest.GetDigest() + 16, digest );
+        aHash.Hash( digest, 16 );
+    };
+
+    for( size_t ii = 0; ii < aZones.size(); ++ii )
+    {
+        hashDigest( hashes[ii], aHashes[ii] );
+
+        // The zones of the group are filled again together
+        for( size_t jj = 0; jj < aZones.size(); ++jj )
+        {
+            if( jj != ii && groupOf( jj ) == groupOf( ii ) )
+                hashDigest( hashes[ii], aHashes[jj] );
+        }
+
+        // The other zones keep their filled areas
+        for( int jj = 0; jj < m_board->GetAreaCount(); jj++ )
+        {
+            const ZONE_CONTAINER* zone = m_board->GetArea( jj );
+
+            if( !filledZones.count( zone ) && sameNetZonesOverlap( aZones[ii], zone ) )
+                hashPolySet( hashes[ii], zone->GetFilledPolysList() );
+        }
+
+        hashes[ii].Finalize();
+    }
+
+    aHashes = hashes;
+}
+
+
 /**
  * Function ComputeRawFilledAreas
  * Supports a min thickness area constraint.
@@ -699,6 +1040,7 @@ void ZONE_FILLER::buildZoneFeatureHoleList( const ZONE_CONTAINER* aZone,
  */
 void ZONE_FILLER::computeRawFilledAreas( const ZONE_CONTAINER* aZone,
         const SHAPE_POLY_SET& aSmoothedOutline,
+        const SHAPE_POLY_SET& aFeatures,
         SHAPE_POLY_SET& aRawPolys,
         SHAPE_POLY_SET& aFinalPolys ) const
 {
@@ -719,13 +1061,11 @@ void ZONE_FILLER::computeRawFilledAreas( const ZONE_CONTAINER* aZone,
     solidAreas.Inflate( -outline_half_thickness, numSegs );
     solidAreas.Simplify( SHAPE_POLY_SET::PM_FAST );
 
-    SHAPE_POLY_SET holes;
+    SHAPE_POLY_SET holes = aFeatures;
 
     if( s_DumpZonesWhenFilling )
         dumper->Write( &solidAreas, "solid-areas" );
 
-    buildZoneFeatureHoleList( aZone, holes );
-
     if( s_DumpZonesWhenFilling )
         dumper->Write( &holes, "feature-holes" );
 
@@ -747,15 +1087,16 @@ void ZONE_FILLER::computeRawFilledAreas( const ZONE_CONTAINER* aZone,
     if( s_DumpZonesWhenFilling )
         dumper->Write( &solidAreas, "solid-areas-minus-holes" );
 
+    // The fractured areas are built in place in aFinalPolys: a zone can have a lot of
+    // vertices, and each copy of a SHAPE_POLY_SET reallocates all its contours
     if( !aZone->IsOnCopperLayer() )
     {
-        SHAPE_POLY_SET areas_fractured = solidAreas;
-        areas_fractured.Fracture( SHAPE_POLY_SET::PM_FAST );
+        aFinalPolys = solidAreas;
+        aFinalPolys.Fracture( SHAPE_POLY_SET::PM_FAST );
 
         if( s_DumpZonesWhenFilling )
-            dumper->Write( &areas_fractured, "areas_fractured" );
+            dumper->Write( &aFinalPolys, "areas_fractured" );
 
-        aFinalPolys = areas_fractured;
         aRawPolys = aFinalPolys;
 
         if( s_DumpZonesWhenFilling )
@@ -792,23 +1133,19 @@ void ZONE_FILLER::computeRawFilledAreas( const ZONE_CONTAINER* aZone,
             dumper->Write( &thermalHoles, "thermal-holes" );
 
         // put these areas in m_FilledPolysList
-        SHAPE_POLY_SET th_fractured = solidAreas;
-        th_fractured.Fracture( SHAPE_POLY_SET::PM_FAST );
+        aFinalPolys = solidAreas;
+        aFinalPolys.Fracture( SHAPE_POLY_SET::PM_FAST );
 
         if( s_DumpZonesWhenFilling )
-            dumper->Write( &th_fractured, "th_fractured" );
-
-        aFinalPolys = th_fractured;
+            dumper->Write( &aFinalPolys, "th_fractured" );
     }
     else
     {
-        SHAPE_POLY_SET areas_fractured = solidAreas;
-        areas_fractured.Fracture( SHAPE_POLY_SET::PM_FAST );
+        aFinalPolys = solidAreas;
+        aFinalPolys.Fracture( SHAPE_POLY_SET::PM_FAST );
 
         if( s_DumpZonesWhenFilling )
-            dumper->Write( &areas_fractured, "areas_fractured" );
-
-        aFinalPolys = areas_fractured;
+            dumper->Write( &aFinalPolys, "areas_fractured" );
     }
 
     aRawPolys = aFinalPolys;
@@ -821,8 +1158,8 @@ void ZONE_FILLER::computeRawFilledAreas( const ZONE_CONTAINER* aZone,
  * The solid areas can be more than one on copper layers, and do not have holes
  * ( holes are linked by overlapping segments to the main outline)
  */
-bool ZONE_FILLER::fillSingleZone( ZONE_CONTAINER* aZone, SHAPE_POLY_SET& aRawPolys,
-                                  SHAPE_POLY_SET& aFinalPolys ) const
+bool ZONE_FILLER::fillSingleZone( ZONE_CONTAINER* aZone, const SHAPE_POLY_SET& aFeatures,
+                                  SHAPE_POLY_SET& aRawPolys, SHAPE_POLY_SET& aFinalPolys ) const
 {
     SHAPE_POLY_SET smoothedPoly;
 
@@ -835,7 +1172,7 @@ bool ZONE_FILLER::fillSingleZone( ZONE_CONTAINER* aZone, SHAPE_POLY_SET& aRawPol
 
     if( aZone->IsOnCopperLayer() )
     {
-        computeRawFilledAreas( aZone, smoothedPoly, aRawPolys, aFinalPolys );
+        computeRawFilledAreas( aZone, smoothedPoly, aFeatures, aRawPolys, aFinalPolys );
     }
     else
     {
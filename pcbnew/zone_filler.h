@@ -29,11 +29,16 @@
 #include <vector>
 #include <class_zone.h>
 
+/// Version of the zone fill algorithm.  Must be incremented by any change giving different
+/// filled areas for the same zones and obstacles, to discard the fills cached by older versions.
+#define ZONE_FILL_ALGORITHM_VERSION     1
+
 class WX_PROGRESS_REPORTER;
 class BOARD;
 class COMMIT;
 class SHAPE_POLY_SET;
 class SHAPE_LINE_CHAIN;
+class ZONE_FILL_CACHE;
 
 class ZONE_FILLER
 {
@@ -42,6 +47,23 @@ public:
     ~ZONE_FILLER();
 
     void SetProgressReporter( WX_PROGRESS_REPORTER* aReporter );
+
+    /**
+     * Function SetFillCache
+     * Sets the cache of filled areas used by Fill().  A zone found in the cache is not
+     * filled again, and the zones filled by Fill() are stored in the cache.
+     * The cache is not saved by the filler.
+     */
+    void SetFillCache( ZONE_FILL_CACHE* aCache );
+
+    /**
+     * Function Fill
+     * Fills the given zones.  A zone which is filled and whose outline, settings and
+     * surrounding items did not change since its last fill is up to date, and is skipped.
+     * @param aZones are the zones to fill
+     * @param aCheck = true to ask the user before refilling zones that are out of date
+     * @return false if the fill was cancelled or the connectivity is busy
+     */
     bool Fill( const std::vector<ZONE_CONTAINER*>& aZones, bool aCheck = false );
 
 private:
@@ -49,6 +71,28 @@ private:
     void buildZoneFeatureHoleList( const ZONE_CONTAINER* aZone,
             SHAPE_POLY_SET& aFeatures ) const;
 
+    /**
+     * Function buildObstaclesHash
+     * Computes the hash of everything the filled areas of a zone depend on, but the other
+     * zones of its net: the zone outline and settings, the feature holes built by
+     * buildZoneFeatureHoleList(), and the pads and tracks of the zone net inside the zone
+     * (they drive thermal stubs and island removal).
+     * @param aFeatures is the feature hole list of the zone (unused for non copper zones)
+     */
+    MD5_HASH buildObstaclesHash( const ZONE_CONTAINER* aZone,
+            const SHAPE_POLY_SET& aFeatures ) const;
+
+    /**
+     * Function hashSameNetZones
+     * Adds to the obstacles hash of each zone the hashes of the overlapping zones of its net,
+     * and the filled areas of the ones that are not filled with it: the insulated islands
+     * removal depends on them.  Two fills with the same final hash give the same filled areas.
+     * @param aZones are the zones to fill
+     * @param aHashes are the hashes of aZones built by buildObstaclesHash(), and the final hashes
+     */
+    void hashSameNetZones( const std::vector<ZONE_CONTAINER*>& aZones,
+            std::vector<MD5_HASH>& aHashes ) const;
+
     /**
      * Function computeRawFilledAreas
      * Add non copper areas polygons (pads and tracks with clearance)
@@ -63,6 +107,7 @@ private:
      */
     void computeRawFilledAreas( const ZONE_CONTAINER* aZone,
             const SHAPE_POLY_SET& aSmoothedOutline,
+            const SHAPE_POLY_SET& aFeatures,
             SHAPE_POLY_SET& aRawPolys,
             SHAPE_POLY_SET& aFinalPolys ) const;
 
@@ -89,6 +134,7 @@ private:
      * in order to have drawable (and plottable) filled polygons.
      * @return true if OK, false if the solid polygons cannot be built
      * @param aZone is the zone to fill
+     * @param aFeatures is the feature hole list of the zone, built by buildZoneFeatureHoleList()
      * @param aRawPolys: A reference to a SHAPE_POLY_SET buffer to store
      * filled solid areas polygons (with holes)
      * @param aFinalPolys: A reference to a SHAPE_POLY_SET buffer to store polygons with no holes
@@ -96,7 +142,7 @@ private:
      * by aZone->GetMinThickness() / 2 to be drawn with a outline thickness = aZone->GetMinThickness()
      * aFinalPolys are polygons that will be drawn on screen and plotted
      */
-    bool fillSingleZone( ZONE_CONTAINER* aZone,
+    bool fillSingleZone( ZONE_CONTAINER* aZone, const SHAPE_POLY_SET& aFeatures,
             SHAPE_POLY_SET& aRawPolys, SHAPE_POLY_SET& aFinalPolys ) const;
 
     /**
@@ -111,6 +157,7 @@ private:
     BOARD* m_board;
     COMMIT* m_commit;
     WX_PROGRESS_REPORTER* m_progressReporter;
+    ZONE_FILL_CACHE* m_fillCache;
 };
 
 #endif
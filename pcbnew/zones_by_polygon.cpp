@@ -968,7 +968,7 @@ void PCB_EDIT_FRAME::Edit_Zone_Params( wxDC* DC, ZONE_CONTAINER* aZone )
         wxString title;
         title.Printf( _( "Refill %d Zones" ), (int)zones_to_refill.size() );
         std::unique_ptr<WX_PROGRESS_REPORTER> progressReporter(
-                                new WX_PROGRESS_REPORTER( this, title, 4 ) );
+                                new WX_PROGRESS_REPORTER( this, title, 5 ) );
 
         filler.SetProgressReporter( progressReporter.get() );
         filler.Fill( zones_to_refill );
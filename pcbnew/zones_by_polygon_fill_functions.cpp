@@ -50,6 +50,7 @@
 
 #include <widgets/progress_reporter.h>
 #include <zone_filler.h>
+#include <tools/zone_filler_tool.h>
 
 
 void PCB_EDIT_FRAME::Fill_All_Zones()
@@ -72,14 +73,18 @@ void PCB_EDIT_FRAME::Check_All_Zones( wxWindow* aActiveWindow )
     BOARD_COMMIT commit( this );
 
     std::unique_ptr<WX_PROGRESS_REPORTER> progressReporter(
-            new WX_PROGRESS_REPORTER( aActiveWindow, _( "Checking Zones" ), 4 ) );
+            new WX_PROGRESS_REPORTER( aActiveWindow, _( "Checking Zones" ), 5 ) );
+
+    ZONE_FILLER_TOOL* fillerTool = GetToolManager()->GetTool<ZONE_FILLER_TOOL>();
 
     ZONE_FILLER filler( GetBoard(), &commit );
     filler.SetProgressReporter( progressReporter.get() );
+    filler.SetFillCache( fillerTool->GetFillCache() );
 
     if( filler.Fill( toFill, true ) )
     {
         m_ZoneFillsDirty = false;
+        fillerTool->SaveFillCache( true );
 
         if( IsGalCanvasActive() && GetGalCanvas() )
             GetGalCanvas()->ForceRefresh();
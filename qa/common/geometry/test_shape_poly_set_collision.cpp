@@ -160,6 +160,37 @@ BOOST_AUTO_TEST_CASE( Collide )
     BOOST_CHECK( common.holeyPolySet.Collide( VECTOR2I( 11, 11 ), 5 ) );
 }
 
+/**
+ * This test checks that the spatial index gives the same answers as the plain queries, and
+ * that it is dropped when the set is modified.
+ */
+BOOST_AUTO_TEST_CASE( SpatialIndex )
+{
+    SHAPE_POLY_SET indexed = common.holeyPolySet;
+
+    indexed.CacheSpatialIndex();
+    BOOST_CHECK( indexed.IsSpatialIndexValid() );
+
+    for( int x = -10; x <= 110; x++ )
+    {
+        for( int y = -10; y <= 110; y++ )
+        {
+            VECTOR2I point( x, y );
+
+            BOOST_TEST_CONTEXT( "Point " << x << ", " << y )
+            {
+                BOOST_CHECK_EQUAL( indexed.Contains( point ),
+                                   common.holeyPolySet.Contains( point ) );
+                BOOST_CHECK_EQUAL( indexed.Collide( point, 3 ),
+                                   common.holeyPolySet.Collide( point, 3 ) );
+            }
+        }
+    }
+
+    indexed.Move( VECTOR2I( 1, 1 ) );
+    BOOST_CHECK( !indexed.IsSpatialIndexValid() );
+}
+
 /**
  * This test checks the behaviour of the CollideVertex method, testing whether the collision with
  * vertices is well detected
@@ -144,6 +144,11 @@ BOOST_AUTO_TEST_CASE( SegDistance )
 
             // right answer?
             BOOST_CHECK_PREDICATE( KI_TEST::IsWithin<int>, ( dist )( c.m_exp_dist )( 1 ) );
+
+            // same answer from the spatial index
+            polyset.CacheSpatialIndex();
+
+            BOOST_CHECK_EQUAL( polyset.Distance( c.m_seg, c.m_seg_width ), dist );
         }
     }
 }
@@ -0,0 +1,309 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_shape_poly_set_spatial_index.cpp
+ * Test the spatial index used by the SHAPE_POLY_SET queries.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <cmath>
+#include <future>
+#include <random>
+
+#include <geometry/shape_line_chain.h>
+#include <geometry/shape_poly_set.h>
+
+
+namespace
+{
+
+/**
+ * A star shaped closed contour around aCenter, with aVertexCount vertices at random
+ * distances between aMinRadius and aMaxRadius.
+ */
+SHAPE_LINE_CHAIN starContour( std::mt19937& aRng, const VECTOR2I& aCenter, int aMinRadius,
+                              int aMaxRadius, int aVertexCount )
+{
+    std::uniform_int_distribution<int> radius( aMinRadius, aMaxRadius );
+    SHAPE_LINE_CHAIN                   contour;
+
+    for( int i = 0; i < aVertexCount; i++ )
+    {
+        double angle = 2 * M_PI * i / aVertexCount;
+        int    r = radius( aRng );
+
+        contour.Append( aCenter.x + (int) std::lround( r * cos( angle ) ),
+                        aCenter.y + (int) std::lround( r * sin( angle ) ) );
+    }
+
+    contour.SetClosed( true );
+
+    return contour;
+}
+
+
+/**
+ * A set of three star polygons, each one with a star hole: large enough to be indexed.
+ */
+SHAPE_POLY_SET starPolySet( std::mt19937& aRng )
+{
+    SHAPE_POLY_SET polySet;
+
+    for( int i = 0; i < 3; i++ )
+    {
+        VECTOR2I center( i * 25000, ( i % 2 ) * 5000 );
+
+        polySet.AddOutline( starContour( aRng, center, 5000, 10000, 100 ) );
+        polySet.AddHole( starContour( aRng, center, 1000, 4000, 40 ) );
+    }
+
+    return polySet;
+}
+
+
+/**
+ * Checks that the queries of aIndexed, answered by its spatial index, give the same
+ * results as the ones of aPlain, which is never indexed.  The points are the vertices of
+ * the set, the middles of its edges and aCount random points.
+ */
+void checkSameQueries( SHAPE_POLY_SET& aIndexed, SHAPE_POLY_SET& aPlain, std::mt19937& aRng,
+                       int aCount )
+{
+    std::vector<VECTOR2I> points;
+    BOX2I                 bbox = aPlain.BBox( 2000 );
+
+    for( auto it = aPlain.CIterateWithHoles(); it; it++ )
+        points.push_back( *it );
+
+    for( auto it = aPlain.IterateSegmentsWithHoles(); it; it++ )
+        points.push_back( ( ( *it ).A + ( *it ).B ) / 2 );
+
+    std::uniform_int_distribution<int> x( bbox.GetX(), bbox.GetRight() );
+    std::uniform_int_distribution<int> y( bbox.GetY(), bbox.GetBottom() );
+    std::uniform_int_distribution<int> length( -3000, 3000 );
+
+    for( int i = 0; i < aCount; i++ )
+        points.emplace_back( x( aRng ), y( aRng ) );
+
+    aIndexed.CacheSpatialIndex();
+
+    for( const VECTOR2I& point : points )
+    {
+        SEG seg( point, point + VECTOR2I( length( aRng ), length( aRng ) ) );
+
+        // The plain set would index itself after a few queries: each one is made on
+        // a set never queried since its last change
+        BOOST_TEST_CONTEXT( "Point " << point.x << ", " << point.y )
+        {
+            aPlain.InvalidateSpatialIndex();
+            BOOST_CHECK_EQUAL( aIndexed.Contains( point ), aPlain.Contains( point ) );
+
+            aPlain.InvalidateSpatialIndex();
+            BOOST_CHECK_EQUAL( aIndexed.Collide( point, 500 ), aPlain.Collide( point, 500 ) );
+
+            aPlain.InvalidateSpatialIndex();
+            BOOST_CHECK_EQUAL( aIndexed.Distance( point ), aPlain.Distance( point ) );
+
+            aPlain.InvalidateSpatialIndex();
+            BOOST_CHECK_EQUAL( aIndexed.Collide( seg, 500 ), aPlain.Collide( seg, 500 ) );
+
+            aPlain.InvalidateSpatialIndex();
+            BOOST_CHECK_EQUAL( aIndexed.Distance( seg, 100 ), aPlain.Distance( seg, 100 ) );
+        }
+    }
+
+    BOOST_CHECK( aIndexed.IsSpatialIndexValid() );
+    BOOST_CHECK( !aPlain.IsSpatialIndexValid() );
+}
+
+} // namespace
+
+
+BOOST_AUTO_TEST_SUITE( ShapePolySetSpatialIndex )
+
+
+/**
+ * The indexed queries give the same results as the plain ones on random sets.
+ */
+BOOST_AUTO_TEST_CASE( SameAsPlainQueries )
+{
+    std::mt19937 rng( 18 );
+
+    for( int i = 0; i < 4; i++ )
+    {
+        BOOST_TEST_CONTEXT( "Set " << i )
+        {
+            SHAPE_POLY_SET indexed = starPolySet( rng );
+            SHAPE_POLY_SET plain = indexed;
+
+            checkSameQueries( indexed, plain, rng, 4000 );
+        }
+    }
+}
+
+
+/**
+ * A set changed through the accessors after its index was built is indexed again from
+ * its new contours.
+ */
+BOOST_AUTO_TEST_CASE( ChangeAfterIndex )
+{
+    std::mt19937   rng( 18 );
+    SHAPE_POLY_SET indexed = starPolySet( rng );
+    SHAPE_POLY_SET plain = indexed;
+
+    checkSameQueries( indexed, plain, rng, 1000 );
+
+    // Push a vertex of the first outline away from its center, at the origin
+    for( SHAPE_POLY_SET* polySet : { &indexed, &plain } )
+        polySet->Outline( 0 ).Point( 10 ) = polySet->COutline( 0 ).CPoint( 10 ) * 3 / 2;
+
+    BOOST_CHECK( !indexed.IsSpatialIndexValid() );
+    checkSameQueries( indexed, plain, rng, 1000 );
+
+    // Pull a vertex of the second hole towards its center
+    const VECTOR2I center( 25000, 5000 );
+
+    for( SHAPE_POLY_SET* polySet : { &indexed, &plain } )
+    {
+        VECTOR2I& corner = polySet->Hole( 1, 0 ).Point( 20 );
+        corner = center + ( corner - center ) / 2;
+    }
+
+    BOOST_CHECK( !indexed.IsSpatialIndexValid() );
+    checkSameQueries( indexed, plain, rng, 1000 );
+
+    // A contour changed through a reference taken before the index was built needs an
+    // explicit InvalidateSpatialIndex()
+    SHAPE_LINE_CHAIN& outline = indexed.Outline( 2 );
+
+    indexed.CacheSpatialIndex();
+    outline.Point( 30 ) = outline.CPoint( 30 ) * 3 / 2 - VECTOR2I( 25000, 0 );
+    plain.Outline( 2 ).Point( 30 ) = outline.CPoint( 30 );
+    indexed.InvalidateSpatialIndex();
+
+    checkSameQueries( indexed, plain, rng, 1000 );
+}
+
+
+/**
+ * Chamfering or filleting a set builds a new set: the index of the original one is kept.
+ */
+BOOST_AUTO_TEST_CASE( ChamferKeepsIndex )
+{
+    std::mt19937   rng( 18 );
+    SHAPE_POLY_SET polySet = starPolySet( rng );
+
+    polySet.CacheSpatialIndex();
+
+    SHAPE_POLY_SET chamfered = polySet.Chamfer( 0 );
+
+    BOOST_CHECK( polySet.IsSpatialIndexValid() );
+    BOOST_CHECK_EQUAL( chamfered.TotalVertices(), polySet.TotalVertices() );
+
+    polySet.Fillet( 100, 10 );
+    BOOST_CHECK( polySet.IsSpatialIndexValid() );
+
+    // A null segment is removed from the chamfered set only
+    int      vertexCount = polySet.TotalVertices();
+    VECTOR2I corner = polySet.COutline( 0 ).CPoint( 1 );
+
+    polySet.Outline( 0 ).Insert( 1, corner );
+    polySet.CacheSpatialIndex();
+
+    chamfered = polySet.Chamfer( 0 );
+
+    BOOST_CHECK( polySet.IsSpatialIndexValid() );
+    BOOST_CHECK_EQUAL( polySet.TotalVertices(), vertexCount + 1 );
+    BOOST_CHECK_EQUAL( chamfered.TotalVertices(), vertexCount );
+}
+
+
+/**
+ * The DRC chamfers the zone outlines while other jobs query them: the chamfers must not
+ * drop the index under the queries.
+ */
+BOOST_AUTO_TEST_CASE( ConcurrentChamferAndDistance )
+{
+    const int             queryCount = 2000;
+    std::mt19937          rng( 18 );
+    SHAPE_POLY_SET        polySet = starPolySet( rng );
+    std::vector<VECTOR2I> points;
+    std::vector<int>      expected;
+
+    std::uniform_int_distribution<int> x( -12000, 62000 );
+    std::uniform_int_distribution<int> y( -12000, 17000 );
+
+    for( int i = 0; i < queryCount; i++ )
+    {
+        points.emplace_back( x( rng ), y( rng ) );
+        expected.push_back( polySet.Distance( points.back() ) );
+    }
+
+    polySet.CacheSpatialIndex();
+
+    std::vector<std::future<std::vector<int>>> queries;
+    std::vector<std::future<void>>             chamfers;
+
+    for( int i = 0; i < 2; i++ )
+    {
+        queries.push_back( std::async( std::launch::async,
+                [&]()
+                {
+                    std::vector<int> distances;
+
+                    for( const VECTOR2I& point : points )
+                        distances.push_back( polySet.Distance( point ) );
+
+                    return distances;
+                } ) );
+
+        chamfers.push_back( std::async( std::launch::async,
+                [&]()
+                {
+                    for( int j = 0; j < 20; j++ )
+                    {
+                        polySet.Chamfer( 0 );
+                        polySet.Fillet( 100, 10 );
+                    }
+                } ) );
+    }
+
+    for( std::future<void>& chamfer : chamfers )
+        chamfer.wait();
+
+    for( std::future<std::vector<int>>& query : queries )
+    {
+        std::vector<int> distances = query.get();
+
+        BOOST_CHECK_EQUAL_COLLECTIONS( distances.begin(), distances.end(), expected.begin(),
+                                       expected.end() );
+    }
+
+    BOOST_CHECK( polySet.IsSpatialIndexValid() );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
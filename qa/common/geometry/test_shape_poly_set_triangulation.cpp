@@ -0,0 +1,196 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_shape_poly_set_triangulation.cpp
+ * Test the triangulation cached by SHAPE_POLY_SET::CacheTriangulation().
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+#include <geometry/shape_line_chain.h>
+#include <geometry/shape_poly_set.h>
+
+
+namespace
+{
+
+// Horizontal distance between the outlines of the test sets
+const int OUTLINE_PITCH = 1000;
+
+
+/**
+ * A self-intersecting outline, which can only be triangulated once it is split
+ * in two triangles by a re-fracture.
+ */
+SHAPE_LINE_CHAIN bowTie( int aX )
+{
+    SHAPE_LINE_CHAIN outline;
+
+    outline.Append( aX, 0 );
+    outline.Append( aX + 500, 500 );
+    outline.Append( aX + 500, 0 );
+    outline.Append( aX, 500 );
+    outline.SetClosed( true );
+
+    return outline;
+}
+
+
+SHAPE_LINE_CHAIN circle( int aX, int aVertexCount )
+{
+    SHAPE_LINE_CHAIN outline;
+
+    for( int i = 0; i < aVertexCount; i++ )
+    {
+        double angle = 2 * M_PI * i / aVertexCount;
+
+        outline.Append( aX + 250 + (int) std::lround( 250 * cos( angle ) ),
+                        250 + (int) std::lround( 250 * sin( angle ) ) );
+    }
+
+    outline.SetClosed( true );
+
+    return outline;
+}
+
+
+/**
+ * Gives the outline each triangulated polygon comes from, by its position.
+ */
+std::vector<int> triangulatedOutlines( const SHAPE_POLY_SET& aPolySet )
+{
+    std::vector<int> outlines;
+
+    for( unsigned i = 0; i < aPolySet.TriangulatedPolyCount(); i++ )
+    {
+        const SHAPE_POLY_SET::TRIANGULATED_POLYGON* tri = aPolySet.TriangulatedPolygon( i );
+        int                                         minX = INT_MAX;
+
+        for( size_t j = 0; j < tri->GetVertexCount(); j++ )
+            minX = std::min( minX, tri->GetVertex( j ).x );
+
+        outlines.push_back( minX / OUTLINE_PITCH );
+    }
+
+    return outlines;
+}
+
+} // namespace
+
+
+BOOST_AUTO_TEST_SUITE( ShapePolySetTriangulation )
+
+
+/**
+ * The triangulation of an outline retried after a re-fracture takes the place of the
+ * outline.
+ */
+BOOST_AUTO_TEST_CASE( RetriedOutlineKeepsOrder )
+{
+    SHAPE_POLY_SET polySet;
+
+    polySet.AddOutline( circle( 0, 16 ) );
+    polySet.AddOutline( bowTie( OUTLINE_PITCH ) );
+    polySet.AddOutline( circle( 2 * OUTLINE_PITCH, 16 ) );
+
+    polySet.CacheTriangulation();
+
+    BOOST_CHECK( polySet.IsTriangulationUpToDate() );
+
+    // The bow tie is split in two triangles
+    const std::vector<int> expected = { 0, 1, 1, 2 };
+    const std::vector<int> outlines = triangulatedOutlines( polySet );
+
+    BOOST_CHECK_EQUAL_COLLECTIONS( outlines.begin(), outlines.end(), expected.begin(),
+                                   expected.end() );
+}
+
+
+/**
+ * The triangulation of a set large enough to be shared between threads does not depend
+ * on the thread count, including the outlines retried after a re-fracture.
+ */
+BOOST_AUTO_TEST_CASE( SameForAnyThreadCount )
+{
+    const int      outlineCount = 64;
+    SHAPE_POLY_SET polySet;
+
+    for( int i = 0; i < outlineCount; i++ )
+    {
+        if( i % 7 == 3 )
+            polySet.AddOutline( bowTie( i * OUTLINE_PITCH ) );
+        else
+            polySet.AddOutline( circle( i * OUTLINE_PITCH, 512 ) );
+    }
+
+    SHAPE_POLY_SET reference = polySet;
+    reference.CacheTriangulation( 1 );
+
+    BOOST_REQUIRE( reference.IsTriangulationUpToDate() );
+
+    std::vector<int> outlines = triangulatedOutlines( reference );
+
+    BOOST_CHECK( std::is_sorted( outlines.begin(), outlines.end() ) );
+    BOOST_CHECK_EQUAL( outlines.front(), 0 );
+    BOOST_CHECK_EQUAL( outlines.back(), outlineCount - 1 );
+    BOOST_CHECK_EQUAL( reference.TriangulatedPolyCount(), outlineCount + ( outlineCount + 3 ) / 7 );
+
+    for( size_t threads : { 2, 4, 8 } )
+    {
+        BOOST_TEST_CONTEXT( threads << " threads" )
+        {
+            SHAPE_POLY_SET copy = polySet;
+            copy.CacheTriangulation( threads );
+
+            BOOST_REQUIRE_EQUAL( copy.TriangulatedPolyCount(), reference.TriangulatedPolyCount() );
+
+            for( unsigned i = 0; i < copy.TriangulatedPolyCount(); i++ )
+            {
+                const auto* tri = copy.TriangulatedPolygon( i );
+                const auto* expectedTri = reference.TriangulatedPolygon( i );
+
+                BOOST_REQUIRE_EQUAL( tri->GetVertexCount(), expectedTri->GetVertexCount() );
+                BOOST_REQUIRE_EQUAL( tri->GetTriangleCount(), expectedTri->GetTriangleCount() );
+
+                for( size_t j = 0; j < tri->GetVertexCount(); j++ )
+                    BOOST_CHECK( tri->GetVertex( j ) == expectedTri->GetVertex( j ) );
+
+                for( size_t j = 0; j < tri->GetTriangleCount(); j++ )
+                {
+                    const auto& t = tri->GetTriangleIndices( j );
+                    const auto& e = expectedTri->GetTriangleIndices( j );
+
+                    BOOST_CHECK( t.a == e.a && t.b == e.b && t.c == e.c );
+                }
+            }
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
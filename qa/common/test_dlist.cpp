@@ -0,0 +1,288 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_dlist.cpp
+ * Test the contiguous index of DLIST, and the range iteration which uses it.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <base_struct.h>
+#include <core/iterators.h>
+#include <dlist.h>
+
+#include <functional>
+
+
+namespace
+{
+
+class TEST_ITEM : public EDA_ITEM
+{
+public:
+    TEST_ITEM( int aValue ) : EDA_ITEM( NOT_USED ), m_value( aValue )
+    {
+    }
+
+    TEST_ITEM* Next() const { return static_cast<TEST_ITEM*>( Pnext ); }
+    TEST_ITEM* Back() const { return static_cast<TEST_ITEM*>( Pback ); }
+
+    wxString GetClass() const override
+    {
+        return wxT( "TEST_ITEM" );
+    }
+
+#if defined(DEBUG)
+    void Show( int nestLevel, std::ostream& os ) const override { ShowDummy( os ); }
+#endif
+
+    int m_value;
+};
+
+
+/**
+ * @return the values of the list items, following the Next() pointers
+ */
+std::vector<int> linkedValues( const DLIST<TEST_ITEM>& aList )
+{
+    std::vector<int> values;
+
+    for( TEST_ITEM* item = aList.GetFirst(); item; item = item->Next() )
+        values.push_back( item->m_value );
+
+    return values;
+}
+
+
+/**
+ * @return the values of the list items, using range iteration
+ */
+std::vector<int> rangeValues( const DLIST<TEST_ITEM>& aList )
+{
+    std::vector<int> values;
+
+    for( TEST_ITEM* item : DLIST_ITERATOR_WRAPPER<TEST_ITEM>( aList ) )
+        values.push_back( item->m_value );
+
+    return values;
+}
+
+} // namespace
+
+
+struct DLIST_INDEX_FIXTURE
+{
+    DLIST_INDEX_FIXTURE()
+    {
+        for( unsigned ii = 0; ii < 2 * DHEAD::INDEX_MIN_COUNT; ii++ )
+            m_list.PushBack( new TEST_ITEM( ii ) );
+    }
+
+    /**
+     * Walks the list until it gets an index, and checks the index matches the list.
+     */
+    std::shared_ptr<const DHEAD::ITEM_INDEX> buildIndex()
+    {
+        std::vector<int> expected = linkedValues( m_list );
+
+        // The first walk after a change does not build the index
+        std::vector<int> walked = rangeValues( m_list );
+        BOOST_CHECK_EQUAL_COLLECTIONS( walked.begin(), walked.end(), expected.begin(),
+                                       expected.end() );
+
+        auto index = m_list.GetIndex();
+        BOOST_REQUIRE( index );
+        BOOST_CHECK_EQUAL( index->m_generation, m_list.GetGeneration() );
+        BOOST_REQUIRE_EQUAL( index->m_items.size(), m_list.GetCount() );
+
+        TEST_ITEM* item = m_list.GetFirst();
+
+        for( EDA_ITEM* indexed : index->m_items )
+        {
+            BOOST_CHECK_EQUAL( indexed, item );
+            item = item->Next();
+        }
+
+        walked = rangeValues( m_list );
+        BOOST_CHECK_EQUAL_COLLECTIONS( walked.begin(), walked.end(), expected.begin(),
+                                       expected.end() );
+
+        return index;
+    }
+
+    /**
+     * Checks a change of the list invalidates its index, and the range iteration follows
+     * the change.
+     */
+    void checkInvalidated( const std::function<void()>& aChange )
+    {
+        auto     index = buildIndex();
+        unsigned generation = m_list.GetGeneration();
+
+        aChange();
+
+        BOOST_CHECK_NE( m_list.GetGeneration(), generation );
+        BOOST_CHECK_NE( index->m_generation, m_list.GetGeneration() );
+
+        std::vector<int> expected = linkedValues( m_list );
+        std::vector<int> walked = rangeValues( m_list );
+
+        BOOST_CHECK_EQUAL_COLLECTIONS( walked.begin(), walked.end(), expected.begin(),
+                                       expected.end() );
+
+        // The next index has the new sequence
+        buildIndex();
+    }
+
+    DLIST<TEST_ITEM> m_list;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( DListIndex, DLIST_INDEX_FIXTURE )
+
+
+BOOST_AUTO_TEST_CASE( ShortListNotIndexed )
+{
+    DLIST<TEST_ITEM> list;
+
+    for( unsigned ii = 0; ii < DHEAD::INDEX_MIN_COUNT - 1; ii++ )
+        list.PushBack( new TEST_ITEM( ii ) );
+
+    for( int walk = 0; walk < 3; walk++ )
+    {
+        std::vector<int> expected = linkedValues( list );
+        std::vector<int> walked = rangeValues( list );
+
+        BOOST_CHECK_EQUAL_COLLECTIONS( walked.begin(), walked.end(), expected.begin(),
+                                       expected.end() );
+        BOOST_CHECK( !list.GetIndex() );
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE( IndexBuiltOnSecondWalk )
+{
+    auto index = buildIndex();
+
+    // An unchanged list keeps its index
+    BOOST_CHECK( m_list.GetIndex() == index );
+}
+
+
+BOOST_AUTO_TEST_CASE( InvalidatedOnInsert )
+{
+    checkInvalidated( [&]()
+    {
+        TEST_ITEM* middle = m_list.GetFirst();
+
+        for( unsigned ii = 0; ii < m_list.GetCount() / 2; ii++ )
+            middle = middle->Next();
+
+        m_list.Insert( new TEST_ITEM( -1 ), middle );
+    } );
+}
+
+
+BOOST_AUTO_TEST_CASE( InvalidatedOnRemove )
+{
+    checkInvalidated( [&]()
+    {
+        delete m_list.Remove( m_list.GetFirst()->Next() );
+    } );
+}
+
+
+BOOST_AUTO_TEST_CASE( InvalidatedOnPushBack )
+{
+    checkInvalidated( [&]()
+    {
+        m_list.PushBack( new TEST_ITEM( -1 ) );
+    } );
+}
+
+
+BOOST_AUTO_TEST_CASE( InvalidatedOnPushFront )
+{
+    checkInvalidated( [&]()
+    {
+        m_list.PushFront( new TEST_ITEM( -1 ) );
+    } );
+}
+
+
+BOOST_AUTO_TEST_CASE( InvalidatedOnPop )
+{
+    checkInvalidated( [&]()
+    {
+        delete m_list.PopFront();
+        delete m_list.PopBack();
+    } );
+}
+
+
+BOOST_AUTO_TEST_CASE( InvalidatedOnAppendList )
+{
+    DLIST<TEST_ITEM> other;
+
+    other.PushBack( new TEST_ITEM( -1 ) );
+    other.PushBack( new TEST_ITEM( -2 ) );
+
+    checkInvalidated( [&]()
+    {
+        m_list.Append( other );
+    } );
+
+    BOOST_CHECK_EQUAL( other.GetCount(), 0 );
+}
+
+
+/**
+ * A list modified during a range walk is walked as a linked list from there on.
+ */
+BOOST_AUTO_TEST_CASE( ChangeDuringWalk )
+{
+    buildIndex();
+
+    std::vector<int> walked;
+
+    for( TEST_ITEM* item : DLIST_ITERATOR_WRAPPER<TEST_ITEM>( m_list ) )
+    {
+        walked.push_back( item->m_value );
+
+        // Remove the next item, and add one at the end
+        if( item->m_value == 10 )
+        {
+            delete m_list.Remove( item->Next() );
+            m_list.PushBack( new TEST_ITEM( -1 ) );
+        }
+    }
+
+    std::vector<int> expected = linkedValues( m_list );
+
+    BOOST_CHECK_EQUAL_COLLECTIONS( walked.begin(), walked.end(), expected.begin(),
+                                   expected.end() );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,388 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_dsnlexer.cpp
+ * Test the DSNLEXER number conversion and the memory mapped line reader.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <dsnlexer.h>
+#include <richio.h>
+
+
+namespace
+{
+
+/**
+ * A token as seen by a parser.
+ */
+struct TOKEN
+{
+    int         m_tok;
+    std::string m_text;
+    int         m_line;
+    int         m_offset;
+    bool        m_numberValid;
+    double      m_number;
+
+    bool operator==( const TOKEN& aOther ) const
+    {
+        return m_tok == aOther.m_tok && m_text == aOther.m_text && m_line == aOther.m_line
+               && m_offset == aOther.m_offset && m_numberValid == aOther.m_numberValid
+               && ( !m_numberValid || m_number == aOther.m_number );
+    }
+};
+
+
+std::ostream& operator<<( std::ostream& os, const TOKEN& aToken )
+{
+    return os << aToken.m_tok << " \"" << aToken.m_text << "\" at " << aToken.m_line << ":"
+              << aToken.m_offset;
+}
+
+
+std::vector<TOKEN> readTokens( DSNLEXER& aLexer )
+{
+    std::vector<TOKEN> tokens;
+    int                tok;
+
+    do
+    {
+        TOKEN token;
+
+        tok = aLexer.NextTok();
+        token.m_tok = tok;
+        token.m_text = aLexer.CurText();
+        token.m_line = aLexer.CurLineNumber();
+        token.m_offset = aLexer.CurOffset();
+        token.m_numberValid = aLexer.CurNumber( token.m_number );
+        tokens.push_back( token );
+    } while( tok != DSN_EOF );
+
+    return tokens;
+}
+
+
+/**
+ * Checks the value given by CurNumber() for every number token of aText is the value
+ * given by strtod(), and returns how many numbers had a value.
+ */
+int checkSameAsStrtod( const std::string& aText )
+{
+    DSNLEXER lexer( aText );
+    int      converted = 0;
+
+    for( const TOKEN& token : readTokens( lexer ) )
+    {
+        if( token.m_tok != DSN_NUMBER || !token.m_numberValid )
+            continue;
+
+        double expected = strtod( token.m_text.c_str(), NULL );
+
+        BOOST_TEST_CONTEXT( token.m_text )
+        {
+            BOOST_CHECK_EQUAL( token.m_number, expected );
+            BOOST_CHECK_EQUAL( std::signbit( token.m_number ), std::signbit( expected ) );
+        }
+
+        converted++;
+    }
+
+    return converted;
+}
+
+} // namespace
+
+
+BOOST_AUTO_TEST_SUITE( DsnLexerNumber )
+
+
+/**
+ * Numbers converted while lexing, with signs, fractions and exponents.
+ */
+BOOST_AUTO_TEST_CASE( ExactNumbers )
+{
+    const std::vector<std::string> numbers = {
+        "0", "-0", "+0", "1", "-1", "+1", "1.5", "-1.5", "+1.5", ".5", "-.5", "5.", "-5.",
+        "0.1", "-0.001", "123.456", "1e3", "1E3", "1e+3", "1e-3", "-2.5e-7", "+2.5E+7",
+        "1e22", "1e-22", "9007199254740992", "0.000000000000000000000000001", "0e999",
+        "000000000000000000000001.5", "1.000000000000000000000", "3.14159265358979"
+    };
+
+    for( const std::string& number : numbers )
+    {
+        BOOST_TEST_CONTEXT( number )
+        {
+            BOOST_CHECK_EQUAL( checkSameAsStrtod( number ), 1 );
+        }
+    }
+}
+
+
+/**
+ * Numbers which cannot be converted exactly with a single operation are left to
+ * the caller.
+ */
+BOOST_AUTO_TEST_CASE( InexactNumbers )
+{
+    const std::vector<std::string> numbers = {
+        "9007199254740993", "12345678901234567890", "1e23", "1e-23", "1e400", "1e-400",
+        "1.5e99999"
+    };
+
+    for( const std::string& number : numbers )
+    {
+        BOOST_TEST_CONTEXT( number )
+        {
+            DSNLEXER lexer( number );
+            double   value;
+
+            BOOST_CHECK_EQUAL( lexer.NextTok(), DSN_NUMBER );
+            BOOST_CHECK( !lexer.CurNumber( value ) );
+        }
+    }
+}
+
+
+/**
+ * Tokens which are not numbers have no value.
+ */
+BOOST_AUTO_TEST_CASE( NotNumbers )
+{
+    DSNLEXER lexer( "(x 1e \"2\" - 1.5.2 e3)" );
+
+    for( const TOKEN& token : readTokens( lexer ) )
+    {
+        BOOST_TEST_CONTEXT( token )
+        {
+            BOOST_CHECK( !token.m_numberValid );
+        }
+    }
+}
+
+
+/**
+ * Board coordinates as they are written by the board formatter, and random doubles
+ * printed at every precision.
+ */
+BOOST_AUTO_TEST_CASE( SameAsStrtod )
+{
+    std::string text = "(";
+    int         count = 0;
+
+    srand( 17 );
+
+    for( int i = 0; i < 20000; i++ )
+    {
+        double value = ( rand() - RAND_MAX / 2 ) / 1e6 * ( 1 + rand() % 1000 );
+        char   buf[64];
+
+        snprintf( buf, sizeof( buf ), "%.6f %.*g %ue%d ", value, 1 + i % 17, value,
+                  (unsigned) rand(), i % 60 - 30 );
+        text += buf;
+        count += 3;
+
+        if( i % 8 == 0 )
+            text += "\n";
+    }
+
+    text += ")";
+
+    // The most of these numbers are converted while lexing
+    BOOST_CHECK_GT( checkSameAsStrtod( text ), count / 2 );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
+
+
+/**
+ * A temporary directory for the files read by MAPPED_FILE_LINE_READER.
+ */
+struct MAPPED_FILE_FIXTURE
+{
+    MAPPED_FILE_FIXTURE()
+    {
+        m_dir = boost::filesystem::temp_directory_path()
+                / boost::filesystem::unique_path( "qa_dsnlexer_%%%%-%%%%" );
+        boost::filesystem::create_directories( m_dir );
+        m_fileName = m_dir / "test.kicad_pcb";
+    }
+
+    ~MAPPED_FILE_FIXTURE()
+    {
+        boost::system::error_code ec;
+        boost::filesystem::remove_all( m_dir, ec );
+    }
+
+    wxString writeFile( const std::string& aContents )
+    {
+        std::ofstream file( m_fileName.string(), std::ios::binary | std::ios::trunc );
+
+        file.write( aContents.data(), aContents.size() );
+        file.close();
+
+        BOOST_REQUIRE_EQUAL( boost::filesystem::file_size( m_fileName ), aContents.size() );
+        return wxString( m_fileName.string() );
+    }
+
+    /**
+     * Checks the mapped reader gives the same lines and tokens as FILE_LINE_READER.
+     */
+    void checkSameAsFileReader( const std::string& aContents )
+    {
+        wxString fileName = writeFile( aContents );
+
+        {
+            MAPPED_FILE_LINE_READER mapped( fileName );
+            FILE_LINE_READER        reference( fileName );
+
+            while( reference.ReadLine() )
+            {
+                BOOST_REQUIRE( mapped.ReadLine() );
+                BOOST_REQUIRE_EQUAL( mapped.Length(), reference.Length() );
+                BOOST_CHECK_EQUAL( std::string( mapped.Line(), mapped.Length() ),
+                                   std::string( reference.Line(), reference.Length() ) );
+                BOOST_CHECK_EQUAL( mapped.LineNumber(), reference.LineNumber() );
+            }
+
+            BOOST_CHECK( !mapped.ReadLine() );
+        }
+
+        MAPPED_FILE_LINE_READER mapped( fileName );
+        FILE_LINE_READER        reference( fileName );
+        DSNLEXER                mappedLexer( NULL, 0, &mapped );
+        DSNLEXER                referenceLexer( NULL, 0, &reference );
+
+        std::vector<TOKEN> tokens = readTokens( mappedLexer );
+        std::vector<TOKEN> expected = readTokens( referenceLexer );
+
+        BOOST_CHECK_EQUAL_COLLECTIONS( tokens.begin(), tokens.end(), expected.begin(),
+                                       expected.end() );
+    }
+
+    boost::filesystem::path m_dir;
+    boost::filesystem::path m_fileName;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( MappedFileLineReader, MAPPED_FILE_FIXTURE )
+
+
+BOOST_AUTO_TEST_CASE( MissingFile )
+{
+    wxString fileName( m_fileName.string() );
+
+    BOOST_CHECK_THROW( MAPPED_FILE_LINE_READER reader( fileName ), IO_ERROR );
+}
+
+
+BOOST_AUTO_TEST_CASE( EmptyFile )
+{
+    MAPPED_FILE_LINE_READER reader( writeFile( "" ) );
+
+    BOOST_CHECK( !reader.ReadLine() );
+}
+
+
+BOOST_AUTO_TEST_CASE( LineEnds )
+{
+    checkSameAsFileReader( "(kicad_pcb (version 4)\n  (at 1.5 -2.25)\n)\n" );
+    checkSameAsFileReader( "(kicad_pcb (version 4)\r\n  (at 1.5 -2.25)\r\n)\r\n" );
+    checkSameAsFileReader( "\n\n(a \"quoted\\n\\\"string\\x41\\101\")\n\n" );
+}
+
+
+/**
+ * The last token ends at the end of the file, with no line end after it.
+ */
+BOOST_AUTO_TEST_CASE( NumberAtEndOfFile )
+{
+    for( const std::string& number : { "1", "-1.5", "2.5e-3", "+7E+2", "0." } )
+    {
+        BOOST_TEST_CONTEXT( number )
+        {
+            checkSameAsFileReader( "(at 10 20)\n(width " + number );
+
+            MAPPED_FILE_LINE_READER reader( writeFile( "(width " + number ) );
+            DSNLEXER                lexer( NULL, 0, &reader );
+            double                  value;
+
+            BOOST_CHECK_EQUAL( lexer.NextTok(), DSN_LEFT );
+            BOOST_CHECK_EQUAL( lexer.NextTok(), DSN_SYMBOL );
+            BOOST_CHECK_EQUAL( lexer.NextTok(), DSN_NUMBER );
+            BOOST_CHECK_EQUAL( lexer.CurText(), number );
+            BOOST_REQUIRE( lexer.CurNumber( value ) );
+            BOOST_CHECK_EQUAL( value, strtod( number.c_str(), NULL ) );
+            BOOST_CHECK_EQUAL( lexer.NextTok(), DSN_EOF );
+        }
+    }
+}
+
+
+/**
+ * Files filling whole pages of the mapping, so a read past the end of the file would be
+ * a read past the end of the mapping.
+ */
+BOOST_AUTO_TEST_CASE( PageSizedFiles )
+{
+    const size_t pageSize = boost::interprocess::mapped_region::get_page_size();
+
+    for( size_t size : { pageSize - 1, pageSize, pageSize + 1, 2 * pageSize } )
+    {
+        BOOST_TEST_CONTEXT( "File size " << size )
+        {
+            std::string contents;
+
+            while( contents.size() < size )
+                contents += "(xy 12.345678 -0.5) ";
+
+            // End the file with a number
+            contents.resize( size );
+            contents.back() = '7';
+
+            checkSameAsFileReader( contents );
+
+            // and with an escape sequence of an unterminated string
+            contents.replace( size - 4, 4, " \"\\x" );
+
+            wxString                fileName = writeFile( contents );
+            MAPPED_FILE_LINE_READER reader( fileName );
+            DSNLEXER                lexer( NULL, 0, &reader );
+
+            BOOST_CHECK_THROW( readTokens( lexer ), PARSE_ERROR );
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
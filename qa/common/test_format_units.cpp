@@ -27,7 +27,54 @@
 #include <base_units.h>
 
 #include <algorithm>
+#include <cmath>
+#include <cstdio>
 #include <iostream>
+#include <limits>
+#include <vector>
+
+
+namespace
+{
+
+/**
+ * The printf based formatting FormatInternalUnits() used for all units, kept as the
+ * reference of the integer formatting of the board units.
+ */
+std::string printfFormatInternalUnits( int aValue )
+{
+    char    buf[50];
+    double  engUnits = aValue;
+    int     len;
+
+#ifndef EESCHEMA
+    engUnits /= IU_PER_MM;
+#endif
+
+    if( engUnits != 0.0 && fabs( engUnits ) <= 0.0001 )
+    {
+        len = snprintf( buf, sizeof(buf), "%.10f", engUnits );
+
+        while( --len > 0 && buf[len] == '0' )
+            buf[len] = '\0';
+
+#ifndef EESCHEMA
+        if( buf[len] == '.' )
+            buf[len] = '\0';
+        else
+#endif
+            ++len;
+    }
+    else
+    {
+        len = snprintf( buf, sizeof(buf), "%.10g", engUnits );
+    }
+
+    return std::string( buf, len );
+}
+
+} // namespace
+
 
 struct UnitFixture
 {
@@ -75,4 +122,121 @@ BOOST_AUTO_TEST_CASE( wxPointUnitFormat )
 }
 
 
+/**
+ * Check formatting single values: signs, values below the printf "%.10f" threshold of
+ * 0.0001 mm, trailing zeros and the limits of the int range
+ */
+BOOST_AUTO_TEST_CASE( SingleValueFormat )
+{
+    struct CASE
+    {
+        int         m_value;
+        std::string m_expected;
+    };
+
+    const std::vector<CASE> cases = {
+#ifdef EESCHEMA
+        { 0, "0" },
+        { 1, "1" },
+        { -1, "-1" },
+        { 100, "100" },
+        { 101, "101" },
+        { 500, "500" },
+        { 1000, "1000" },
+        { 1230000, "1230000" },
+        { -1000000, "-1000000" },
+        { std::numeric_limits<int>::max(), "2147483647" },
+        { std::numeric_limits<int>::min(), "-2147483648" },
+#elif GERBVIEW
+        { 0, "0" },
+        { 1, "0.00001" },
+        { -1, "-0.00001" },
+        { 100, "0.001" },
+        { 101, "0.00101" },
+        { 500, "0.005" },
+        { 1000, "0.01" },
+        { 1230000, "12.3" },
+        { -1000000, "-10" },
+        { std::numeric_limits<int>::max(), "21474.83647" },
+        { std::numeric_limits<int>::min(), "-21474.83648" },
+#elif PCBNEW
+        { 0, "0" },
+        { 1, "0.000001" },
+        { -1, "-0.000001" },
+        { 100, "0.0001" },
+        { 101, "0.000101" },
+        { 500, "0.0005" },
+        { 1000, "0.001" },
+        { 1230000, "1.23" },
+        { -1000000, "-1" },
+        { std::numeric_limits<int>::max(), "2147.483647" },
+        { std::numeric_limits<int>::min(), "-2147.483648" },
+#endif
+    };
+
+    for( const CASE& c : cases )
+    {
+        BOOST_TEST_CONTEXT( "Value " << c.m_value )
+        {
+            BOOST_CHECK_EQUAL( FormatInternalUnits( c.m_value ), c.m_expected );
+        }
+    }
+}
+
+
+/**
+ * Check the formatting gives the printf output: all the values around zero, the powers
+ * of ten and their neighbours, and a sweep over the whole int range
+ */
+BOOST_AUTO_TEST_CASE( SameAsPrintf )
+{
+    std::vector<int> values;
+
+    for( int value = -200000; value <= 200000; value++ )
+        values.push_back( value );
+
+    for( int64_t power = 1; power <= std::numeric_limits<int>::max(); power *= 10 )
+    {
+        for( int64_t value : { power - 1, power, power + 1, 3 * power, 7 * power } )
+        {
+            if( value <= std::numeric_limits<int>::max() )
+            {
+                values.push_back( value );
+                values.push_back( -value );
+            }
+        }
+    }
+
+    for( int64_t value = std::numeric_limits<int>::min(); value <= std::numeric_limits<int>::max();
+            value += 4099 )
+    {
+        values.push_back( value );
+    }
+
+    values.push_back( std::numeric_limits<int>::max() );
+    values.push_back( std::numeric_limits<int>::max() - 1 );
+    values.push_back( std::numeric_limits<int>::min() );
+    values.push_back( std::numeric_limits<int>::min() + 1 );
+
+    int failures = 0;
+
+    for( int value : values )
+    {
+        std::string formatted = FormatInternalUnits( value );
+        std::string expected = printfFormatInternalUnits( value );
+
+        // One report per value would flood the log on a regression
+        if( formatted != expected && failures++ < 10 )
+        {
+            BOOST_TEST_CONTEXT( "Value " << value )
+            {
+                BOOST_CHECK_EQUAL( formatted, expected );
+            }
+        }
+    }
+
+    BOOST_CHECK_EQUAL( failures, 0 );
+}
+
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,361 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_gerber_plotter.cpp
+ * Checks the output of the gerber plotter is the one of its previous, fprintf based, output.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include <wx/datetime.h>
+#include <wx/filefn.h>
+
+#include <build_version.h>
+#include <macros.h>
+#include <plotter.h>
+
+
+namespace
+{
+
+/**
+ * Gives the tests access to the output functions of the gerber plotter.
+ */
+class TEST_GERBER_PLOTTER : public GERBER_PLOTTER
+{
+public:
+    using GERBER_PLOTTER::emitDcode;
+    using GERBER_PLOTTER::selectAperture;
+
+    void CloseFile()
+    {
+        fclose( outputFile );
+        outputFile = nullptr;
+    }
+};
+
+
+/**
+ * The gerber plotter with its previous output: the whole plot, header included, is written
+ * to the temporary file, which is then copied line by line to the gerber file, the aperture
+ * list being inserted after the header.
+ *
+ * The plot functions are the ones of GERBER_PLOTTER: the coordinates and D codes they wrote
+ * are formatted again with fprintf when the temporary file is copied.
+ */
+class REFERENCE_GERBER_PLOTTER : public GERBER_PLOTTER
+{
+public:
+    bool StartPlot() override
+    {
+        finalFile = outputFile;
+
+        m_workFilename = filename + wxT( ".tmp" );
+        workFile = wxFopen( m_workFilename, wxT( "wt" ) );
+        outputFile = workFile;
+
+        if( outputFile == NULL )
+            return false;
+
+        for( unsigned ii = 0; ii < m_headerExtraLines.GetCount(); ii++ )
+        {
+            if( !m_headerExtraLines[ii].IsEmpty() )
+                fprintf( outputFile, "%s\n", TO_UTF8( m_headerExtraLines[ii] ) );
+        }
+
+        int leadingDigitCount = m_gerberUnitInch ? 3 : 4;
+
+        fprintf( outputFile, "%%FSLAX%d%dY%d%d*%%\n",
+                 leadingDigitCount, m_gerberUnitFmt,
+                 leadingDigitCount, m_gerberUnitFmt );
+        fprintf( outputFile,
+                 "G04 Gerber Fmt %d.%d, Leading zero omitted, Abs format (unit %s)*\n",
+                 leadingDigitCount, m_gerberUnitFmt,
+                 m_gerberUnitInch ? "inch" : "mm" );
+
+        wxString   Title = creator + wxT( " " ) + GetBuildVersion();
+        wxDateTime date = wxDateTime::Now();
+        fprintf( outputFile, "G04 Created by KiCad (%s) date %s*\n",
+                 TO_UTF8( Title ), TO_UTF8( date.FormatISOCombined( ' ' ) ) );
+
+        if( m_gerberUnitInch )
+            fputs( "%MOIN*%\n", outputFile );
+        else
+            fputs( "%MOMM*%\n", outputFile );
+
+        fputs( "%LPD*%\n", outputFile );
+        fputs( "G04 APERTURE LIST*\n", outputFile );
+
+        return true;
+    }
+
+    bool EndPlot() override
+    {
+        char line[1024];
+
+        fputs( "M02*\n", outputFile );
+        fflush( outputFile );
+
+        fclose( workFile );
+        workFile = wxFopen( m_workFilename, wxT( "rt" ) );
+        outputFile = finalFile;
+
+        while( fgets( line, 1024, workFile ) )
+        {
+            int  x, y, dcode;
+            char end;
+
+            // The records written by emitDcode() and selectAperture()
+            if( sscanf( line, "X%dY%dD%d%c", &x, &y, &dcode, &end ) == 4 && end == '*' )
+                fprintf( outputFile, "X%dY%dD%02d*\n", x, y, dcode );
+            else if( sscanf( line, "D%d%c", &dcode, &end ) == 2 && end == '*'
+                     && dcode >= FIRST_DCODE_VALUE )
+                fprintf( outputFile, "D%d*\n", dcode );
+            else
+                fputs( line, outputFile );
+
+            if( strcmp( strtok( line, "\n\r" ), "G04 APERTURE LIST*" ) == 0 )
+            {
+                writeApertureList();
+                fputs( "G04 APERTURE END LIST*\n", outputFile );
+            }
+        }
+
+        fclose( workFile );
+        fclose( finalFile );
+        ::wxRemoveFile( m_workFilename );
+        outputFile = 0;
+
+        return true;
+    }
+};
+
+
+std::string readFile( const boost::filesystem::path& aPath )
+{
+    std::ifstream file( aPath.string(), std::ios::binary );
+
+    return std::string( std::istreambuf_iterator<char>( file ),
+                        std::istreambuf_iterator<char>() );
+}
+
+
+/**
+ * @return the lines of a gerber file, without the one holding the creation date
+ */
+std::vector<std::string> gerberLines( const std::string& aContents )
+{
+    std::vector<std::string> lines;
+    std::istringstream       stream( aContents );
+    std::string              line;
+
+    while( std::getline( stream, line ) )
+    {
+        if( line.compare( 0, 22, "G04 Created by KiCad (" ) != 0 )
+            lines.push_back( line );
+    }
+
+    return lines;
+}
+
+
+/**
+ * Set up a plotter as pcbnew does, with nanometre internal units.
+ */
+void setupPlotter( GERBER_PLOTTER& aPlotter )
+{
+    aPlotter.SetViewport( wxPoint( 0, 0 ), 2540, 1.0, false );
+    aPlotter.SetGerberCoordinatesFormat( 6 );
+    aPlotter.SetCreator( wxT( "QA" ) );
+    aPlotter.AddLineToHeader( wxT( "%TF.FileFunction,Copper,L1,Top*%" ) );
+}
+
+
+/**
+ * Plot shapes on both sides of the origin, using the apertures and the regions.
+ */
+void plotShapes( GERBER_PLOTTER& aPlotter )
+{
+    for( int ii = -5; ii <= 5; ii++ )
+    {
+        wxPoint pos( ii * 1234567, ii * -765431 );
+
+        aPlotter.ThickSegment( pos, pos + wxPoint( 500000, 250000 ), 150000 + ii * 1000,
+                               FILLED, nullptr );
+        aPlotter.FlashPadCircle( pos, 800000 + ii * 2000, FILLED, nullptr );
+        aPlotter.FlashPadRect( pos + wxPoint( 0, 2000000 ), wxSize( 1000000, 600000 ), 900,
+                               FILLED, nullptr );
+        aPlotter.FlashPadOval( pos - wxPoint( 0, 2000000 ), wxSize( 600000, 1200000 ), 0,
+                               FILLED, nullptr );
+        aPlotter.Circle( pos, 3000000, NO_FILL, 100000 );
+    }
+
+    std::vector<wxPoint> corners = { wxPoint( -9000000, -9000000 ), wxPoint( 9000000, -9000000 ),
+                                     wxPoint( 9000000, 9000000 ), wxPoint( -9000000, 9000000 ),
+                                     wxPoint( -9000000, -9000000 ) };
+
+    aPlotter.PlotPoly( corners, FILLED_SHAPE, 0 );
+    aPlotter.Rect( wxPoint( -1, -1 ), wxPoint( 1, 1 ), NO_FILL, 0 );
+    aPlotter.Arc( wxPoint( 0, 0 ), 0, 2700, 5000000, NO_FILL, 120000 );
+}
+
+
+struct GERBER_PLOTTER_FIXTURE
+{
+    GERBER_PLOTTER_FIXTURE()
+    {
+        m_dir = boost::filesystem::temp_directory_path()
+                / boost::filesystem::unique_path( "qa_gerber_plotter_%%%%-%%%%" );
+        boost::filesystem::create_directories( m_dir );
+    }
+
+    ~GERBER_PLOTTER_FIXTURE()
+    {
+        boost::system::error_code ec;
+        boost::filesystem::remove_all( m_dir, ec );
+    }
+
+    /**
+     * Plot the shapes with aPlotter to the file aName.
+     * @return the contents of the file
+     */
+    std::string plot( GERBER_PLOTTER& aPlotter, const std::string& aName )
+    {
+        boost::filesystem::path path = m_dir / aName;
+
+        setupPlotter( aPlotter );
+
+        BOOST_REQUIRE( aPlotter.OpenFile( wxString( path.string() ) ) );
+        BOOST_REQUIRE( aPlotter.StartPlot() );
+
+        plotShapes( aPlotter );
+
+        BOOST_REQUIRE( aPlotter.EndPlot() );
+        BOOST_CHECK( !boost::filesystem::exists( path.string() + ".tmp" ) );
+
+        return readFile( path );
+    }
+
+    boost::filesystem::path m_dir;
+};
+
+} // namespace
+
+
+BOOST_FIXTURE_TEST_SUITE( GerberPlotter, GERBER_PLOTTER_FIXTURE )
+
+
+/**
+ * The plot is the one of the previous output code, except for the creation date.
+ */
+BOOST_AUTO_TEST_CASE( SameAsPreviousOutput )
+{
+    GERBER_PLOTTER           plotter;
+    REFERENCE_GERBER_PLOTTER reference;
+
+    std::string contents = plot( plotter, "plot.gbr" );
+    std::string expected = plot( reference, "reference.gbr" );
+
+    // Coordinates of both signs, and the aperture list, were written
+    BOOST_CHECK_NE( contents.find( "X-" ), std::string::npos );
+    BOOST_CHECK_NE( contents.find( "Y-" ), std::string::npos );
+    BOOST_CHECK_NE( contents.find( "%ADD10" ), std::string::npos );
+
+    std::vector<std::string> lines = gerberLines( contents );
+    std::vector<std::string> expectedLines = gerberLines( expected );
+
+    // Only the date line was left out, and it has the same length in both files
+    BOOST_CHECK_EQUAL( lines.size() + 1,
+                       (size_t) std::count( contents.begin(), contents.end(), '\n' ) );
+    BOOST_CHECK_EQUAL( contents.size(), expected.size() );
+    BOOST_CHECK_EQUAL_COLLECTIONS( lines.begin(), lines.end(),
+                                   expectedLines.begin(), expectedLines.end() );
+}
+
+
+/**
+ * The coordinates and D codes are written as fprintf would, at the limits of the int range
+ */
+BOOST_AUTO_TEST_CASE( SameAsPrintf )
+{
+    const std::vector<int> coords = { 0, 1, -1, 9, -9, 10, -10, 99, -100, 123456789, -123456789,
+                                      INT_MAX, INT_MAX - 1, INT_MAX - 10, INT_MIN, INT_MIN + 1,
+                                      INT_MIN + 10 };
+    const std::vector<int> dcodes = { 0, 1, 2, 3, 9, 10, 11, 99, 100, 12345, -1, -10 };
+
+    boost::filesystem::path path = m_dir / "dcodes.gbr";
+    TEST_GERBER_PLOTTER     plotter;
+    std::string             expected;
+    char                    buffer[64];
+
+    setupPlotter( plotter );
+    BOOST_REQUIRE( plotter.OpenFile( wxString( path.string() ) ) );
+
+    for( int x : coords )
+    {
+        for( int y : coords )
+        {
+            for( int dcode : dcodes )
+            {
+                plotter.emitDcode( DPOINT( x, y ), dcode );
+
+                snprintf( buffer, sizeof( buffer ), "X%dY%dD%02d*\n", x, y, dcode );
+                expected += buffer;
+            }
+        }
+    }
+
+    // The new apertures get the D codes 10 to 1009
+    for( int ii = 0; ii < 1000; ii++ )
+    {
+        plotter.selectAperture( wxSize( ii + 1, ii + 1 ), APERTURE::Circle, 0 );
+
+        snprintf( buffer, sizeof( buffer ), "D%d*\n", FIRST_DCODE_VALUE + ii );
+        expected += buffer;
+    }
+
+    plotter.CloseFile();
+
+    std::string              contents = readFile( path );
+    std::vector<std::string> lines = gerberLines( contents );
+    std::vector<std::string> expectedLines = gerberLines( expected );
+
+    BOOST_CHECK_EQUAL( contents.size(), expected.size() );
+    BOOST_CHECK_EQUAL_COLLECTIONS( lines.begin(), lines.end(),
+                                   expectedLines.begin(), expectedLines.end() );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
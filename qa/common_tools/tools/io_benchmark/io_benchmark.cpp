@@ -24,6 +24,7 @@
 #include "io_benchmark.h"
 
 #include <wx/wx.h>
+#include <dsnlexer.h>
 #include <richio.h>
 
 #include <chrono>
@@ -36,6 +37,7 @@
 #include <wx/wfstream.h>
 #include <wx/filename.h>
 
+#include <qa_utils/bench_report.h>
 #include <qa_utils/stdstream_line_reader.h>
 
 
@@ -45,6 +47,7 @@ using TIME_PT = std::chrono::time_point<CLOCK>;
 
 struct BENCH_REPORT
 {
+    /// Lines read by the line reading benchmarks, tokens by the lexer ones
     unsigned linesRead;
 
     /**
@@ -54,7 +57,7 @@ struct BENCH_REPORT
      */
     unsigned charAcc;
 
-    std::chrono::milliseconds benchDurMs;
+    std::chrono::microseconds benchDur;
 };
 
 
@@ -304,6 +307,29 @@ static void bench_wxbis_reuse( const wxFileName& aFile, int aReps, BENCH_REPORT&
     }
 }
 
+/**
+ * Benchmark the DSNLEXER tokenisation of the file read by a given LINE_READER
+ * implementation, without any keyword table: every symbol is looked up and
+ * reported as DSN_SYMBOL.  The LINE_READER is recreated for each cycle.
+ */
+template<typename LR>
+static void bench_dsnlexer( const wxFileName& aFile, int aReps, BENCH_REPORT& report )
+{
+    for( int i = 0; i < aReps; ++i)
+    {
+        LR fstr( aFile.GetFullPath() );
+        DSNLEXER lexer( nullptr, 0, &fstr );
+        int tok;
+
+        while( ( tok = lexer.NextTok() ) != DSN_EOF )
+        {
+            report.linesRead++;
+            report.charAcc += (unsigned char) lexer.CurText()[0] + tok;
+        }
+    }
+}
+
+
 /**
  * List of available benchmarks
  */
@@ -313,6 +339,7 @@ static std::vector<BENCHMARK> benchmarkList =
     { 'F', bench_fstream_reuse, "std::fstream, reused" },
     { 'r', bench_line_reader<FILE_LINE_READER>, "RichIO FILE_L_R" },
     { 'R', bench_line_reader_reuse<FILE_LINE_READER>, "RichIO FILE_L_R, reused" },
+    { 'm', bench_line_reader<MAPPED_FILE_LINE_READER>, "RichIO MAPPED_FILE_L_R" },
     { 'n', bench_line_reader<IFSTREAM_LINE_READER>, "std::ifstream L_R" },
     { 'N', bench_line_reader_reuse<IFSTREAM_LINE_READER>, "std::ifstream L_R, reused" },
     { 's', bench_string_lr, "RichIO STRING_L_R"},
@@ -325,6 +352,8 @@ static std::vector<BENCHMARK> benchmarkList =
     { 'B', bench_wxbis_reuse<wxFileInputStream>, "wxFileIStream, buf'd, reused" },
     { 'c', bench_wxbis<wxFFileInputStream>, "wxFFileIStream. buf'd" },
     { 'C', bench_wxbis_reuse<wxFFileInputStream>, "wxFFileIStream, buf'd, reused" },
+    { 'd', bench_dsnlexer<FILE_LINE_READER>, "DSNLEXER, FILE_L_R" },
+    { 'D', bench_dsnlexer<MAPPED_FILE_LINE_READER>, "DSNLEXER, MAPPED_FILE_L_R" },
 };
 
 
@@ -370,10 +399,10 @@ BENCH_REPORT executeBenchMark( const BENCHMARK& aBenchmark, int aReps,
     aBenchmark.func( aFilename, aReps, report );
     TIME_PT end = CLOCK::now();
 
-    using std::chrono::milliseconds;
+    using std::chrono::microseconds;
     using std::chrono::duration_cast;
 
-    report.benchDurMs = duration_cast<milliseconds>( end - start );
+    report.benchDur = duration_cast<microseconds>( end - start );
 
     return report;
 }
@@ -383,10 +412,13 @@ int io_benchmark_func( int argc, char* argv[] )
 {
     auto& os = std::cout;
 
-    if (argc < 3)
+    KI_TEST::BENCH_FORMAT format = KI_TEST::BENCH_FORMAT::TEXT;
+
+    if( argc < 3 || ( argc >= 5 && !KI_TEST::ParseBenchFormat( argv[4], format ) ) )
     {
-        os << "Usage: " << argv[0] << " <FILE> <REPS> [" << getBenchFlags() << "]\n\n";
-        os << "Benchmarks:\n";
+        os << "Usage: " << argv[0] << " <FILE> <REPS> [" << getBenchFlags()
+           << "|-] [text|csv|json]\n\n";
+        os << "Benchmarks (all of them if none or '-' is given):\n";
         os << getBenchDescriptions();
         return KI_TEST::RET_CODES::BAD_CMDLINE;
     }
@@ -398,14 +430,19 @@ int io_benchmark_func( int argc, char* argv[] )
 
     // get the benchmark to do, or all of them if nothing given
     wxString bench;
-    if ( argc == 4 )
+    if ( argc >= 4 && wxString( argv[3] ) != "-" )
         bench = argv[3];
 
-    os << "IO Bench Mark Util" << std::endl;
+    if( format == KI_TEST::BENCH_FORMAT::TEXT )
+    {
+        os << "IO Bench Mark Util" << std::endl;
 
-    os << "  Benchmark file: " << inFile.GetFullPath() << std::endl;
-    os << "  Repetitions:    " << (int) reps << std::endl;
-    os << std::endl;
+        os << "  Benchmark file: " << inFile.GetFullPath() << std::endl;
+        os << "  Repetitions:    " << (int) reps << std::endl;
+        os << std::endl;
+    }
+
+    std::vector<KI_TEST::BENCH_RESULT> results;
 
     for( auto& bmark : benchmarkList )
     {
@@ -414,17 +451,38 @@ int io_benchmark_func( int argc, char* argv[] )
 
         BENCH_REPORT report = executeBenchMark( bmark, reps, inFile );
 
-        os << wxString::Format( "%-30s %u lines, acc: %u in %u ms",
-                bmark.name, report.linesRead, report.charAcc, (int) report.benchDurMs.count() )
-            << std::endl;;
+        if( format == KI_TEST::BENCH_FORMAT::TEXT )
+        {
+            os << wxString::Format( "%-30s %u lines, acc: %u in %u ms",
+                    bmark.name, report.linesRead, report.charAcc,
+                    (int) ( report.benchDur.count() / 1000 ) )
+                << std::endl;;
+        }
+
+        KI_TEST::BENCH_RESULT result;
+
+        result.m_name = bmark.name.ToStdString();
+        result.m_source = inFile.GetFullPath().ToStdString();
+        result.m_reps = (unsigned) reps;
+        result.m_bytes = (size_t) inFile.GetSize().GetValue();
+        result.m_items = reps > 0 ? report.linesRead / reps : 0;
+        result.m_duration = report.benchDur;
+        result.m_peakRss = KI_TEST::GetPeakRss();
+
+        results.push_back( result );
     }
 
+    if( format == KI_TEST::BENCH_FORMAT::TEXT )
+        os << std::endl;
+
+    KI_TEST::PrintBenchResults( os, results, format );
+
     return KI_TEST::RET_CODES::OK;
 }
 
 
 KI_TEST::UTILITY_PROGRAM io_benchmark_tool = {
     "io_benchmark",
-    "Benchmark various kinds of IO methods",
+    "Benchmark various kinds of IO methods and the s-expression lexer",
     io_benchmark_func,
 };
\ No newline at end of file
@@ -23,6 +23,13 @@
 
 #include "drc_test_utils.h"
 
+#include <tuple>
+
+#include <class_board.h>
+#include <class_module.h>
+#include <class_pad.h>
+#include <class_track.h>
+
 
 std::ostream& operator<<( std::ostream& os, const MARKER_PCB& aMarker )
 {
@@ -43,4 +50,109 @@ bool IsDrcMarkerOfType( const MARKER_PCB& aMarker, int aErrorCode )
     return aMarker.GetReporter().GetErrorCode() == aErrorCode;
 }
 
+
+bool DRC_MARKER_KEY::operator==( const DRC_MARKER_KEY& aOther ) const
+{
+    return m_code == aOther.m_code && m_pos == aOther.m_pos && m_mainItem == aOther.m_mainItem
+           && m_auxItem == aOther.m_auxItem;
+}
+
+
+bool DRC_MARKER_KEY::operator<( const DRC_MARKER_KEY& aOther ) const
+{
+    return std::make_tuple( m_code, m_pos.x, m_pos.y, m_mainItem, m_auxItem )
+           < std::make_tuple( aOther.m_code, aOther.m_pos.x, aOther.m_pos.y, aOther.m_mainItem,
+                     aOther.m_auxItem );
+}
+
+
+std::ostream& operator<<( std::ostream& os, const DRC_MARKER_KEY& aKey )
+{
+    os << "DRC_MARKER_KEY[ type=" << aKey.m_code << " pos=(" << aKey.m_pos.x << ", "
+       << aKey.m_pos.y << ") ]";
+    return os;
+}
+
+
+std::vector<DRC_MARKER_KEY> GetDrcMarkerKeys( const std::vector<MARKER_PCB*>& aMarkers )
+{
+    std::vector<DRC_MARKER_KEY> keys;
+
+    for( const MARKER_PCB* marker : aMarkers )
+    {
+        const DRC_ITEM& item = marker->GetReporter();
+
+        keys.push_back( { item.GetErrorCode(), marker->GetPosition(), item.GetMainItemWeakRef(),
+                item.GetAuxItemWeakRef() } );
+    }
+
+    return keys;
+}
+
+
+std::unique_ptr<BOARD> MakeClearanceTestBoard( int aCols, int aRows )
+{
+    auto board = std::make_unique<BOARD>();
+
+    // The pad gaps are 0.1 mm, less than the default clearance
+    const int padSize = Millimeter2iu( 1.0 );
+    const int pitch = Millimeter2iu( 1.1 );
+    const int rowPitch = 2 * pitch;
+
+    for( int row = 0; row < aRows; row++ )
+    {
+        MODULE* module = new MODULE( board.get() );
+
+        module->SetReference( wxString::Format( "U%d", row + 1 ) );
+        module->SetPosition( wxPoint( 0, row * rowPitch ) );
+
+        for( int col = 0; col < aCols; col++ )
+        {
+            D_PAD*  pad = new D_PAD( module );
+            wxPoint offset( col * pitch, 0 );
+
+            pad->SetName( wxString::Format( "%d", col + 1 ) );
+            pad->SetShape( PAD_SHAPE_RECT );
+            pad->SetSize( wxSize( padSize, padSize ) );
+
+            if( col % 5 == 0 )
+            {
+                pad->SetAttribute( PAD_ATTRIB_STANDARD );
+                pad->SetLayerSet( D_PAD::StandardMask() );
+                pad->SetDrillSize( wxSize( Millimeter2iu( 0.6 ), Millimeter2iu( 0.6 ) ) );
+            }
+            else if( col % 5 == 2 )
+            {
+                pad->SetAttribute( PAD_ATTRIB_SMD );
+                pad->SetLayerSet( LSET( 3, B_Cu, B_Paste, B_Mask ) );
+            }
+            else
+            {
+                pad->SetAttribute( PAD_ATTRIB_SMD );
+                pad->SetLayerSet( D_PAD::SMDMask() );
+            }
+
+            pad->SetPos0( offset );
+            pad->SetPosition( module->GetPosition() + offset );
+            module->Add( pad );
+        }
+
+        board->Add( module );
+
+        // Every other track passes 0.025 mm from its row of pads
+        TRACK* track = new TRACK( board.get() );
+        int    y = row * rowPitch + ( row % 2 ? padSize / 2 + Millimeter2iu( 0.15 ) : pitch );
+
+        track->SetLayer( F_Cu );
+        track->SetWidth( Millimeter2iu( 0.25 ) );
+        track->SetStart( wxPoint( 0, y ) );
+        track->SetEnd( wxPoint( aCols * pitch, y ) );
+        board->Add( track );
+    }
+
+    board->BuildConnectivity();
+
+    return board;
+}
+
 } // namespace KI_TEST
\ No newline at end of file
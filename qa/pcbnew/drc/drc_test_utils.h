@@ -30,9 +30,13 @@
 #define QA_PCBNEW_DRC_TEST_UTILS__H
 
 #include <iostream>
+#include <memory>
+#include <vector>
 
 #include <class_marker_pcb.h>
 
+class BOARD;
+
 /**
  * Define a stream function for logging #MARKER_PCB test assertions.
  *
@@ -58,6 +62,40 @@ namespace KI_TEST
  */
 bool IsDrcMarkerOfType( const MARKER_PCB& aMarker, int aErrorCode );
 
+/**
+ * The identity of a DRC marker: its error code, its position and the items it refers to.
+ * Used to compare the markers of two DRC runs on the same board.
+ */
+struct DRC_MARKER_KEY
+{
+    int         m_code;
+    wxPoint     m_pos;
+    const void* m_mainItem;
+    const void* m_auxItem;
+
+    bool operator==( const DRC_MARKER_KEY& aOther ) const;
+    bool operator<( const DRC_MARKER_KEY& aOther ) const;
+};
+
+std::ostream& operator<<( std::ostream& os, const DRC_MARKER_KEY& aKey );
+
+/**
+ * @return the keys of a list of markers, in the same order
+ */
+std::vector<DRC_MARKER_KEY> GetDrcMarkerKeys( const std::vector<MARKER_PCB*>& aMarkers );
+
+/**
+ * Build a board with a grid of pads, one footprint per row, and a track along each row.
+ *
+ * The pads are too close to each other for the default clearance, every other track is
+ * too close to its row of pads, and some pads are through hole or on the back side, so
+ * the pad, hole and track clearance tests all report errors.
+ *
+ * @param aCols is the number of pads in each row
+ * @param aRows is the number of rows
+ */
+std::unique_ptr<BOARD> MakeClearanceTestBoard( int aCols, int aRows );
+
 } // namespace KI_TEST
 
 #endif // QA_PCBNEW_DRC_TEST_UTILS__H
\ No newline at end of file
@@ -0,0 +1,326 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <algorithm>
+
+#include <class_board.h>
+#include <class_module.h>
+#include <class_pad.h>
+#include <class_pcb_text.h>
+#include <class_track.h>
+#include <class_zone.h>
+#include <pcb_base_frame.h>
+#include <drc.h>
+
+#include "drc_test_utils.h"
+
+
+/**
+ * A board with one violation of each kind maintained by the incremental DRC:
+ * - U1, U2 and U3 have one pad each and no courtyard,
+ * - the track T1 passes 0.1 mm from the pad of U1,
+ * - the track T2 crosses the keepout area K,
+ * - the track T3 is away from the copper text X.
+ */
+struct INCREMENTAL_DRC_FIXTURE
+{
+    INCREMENTAL_DRC_FIXTURE() : m_board( std::make_unique<BOARD>() )
+    {
+        m_board->GetDesignSettings().m_RequireCourtyards = true;
+
+        m_u1 = addModule( "U1", wxPoint( 0, 0 ) );
+        m_u2 = addModule( "U2", wxPoint( Millimeter2iu( 10 ), 0 ) );
+        m_u3 = addModule( "U3", wxPoint( Millimeter2iu( 20 ), 0 ) );
+
+        m_t1 = addTrack( wxPoint( Millimeter2iu( -2 ), Millimeter2iu( 0.725 ) ),
+                         wxPoint( Millimeter2iu( 2 ), Millimeter2iu( 0.725 ) ) );
+        m_t2 = addTrack( wxPoint( 0, Millimeter2iu( 10 ) ),
+                         wxPoint( Millimeter2iu( 20 ), Millimeter2iu( 10 ) ) );
+        m_t3 = addTrack( wxPoint( Millimeter2iu( 25 ), Millimeter2iu( 5 ) ),
+                         wxPoint( Millimeter2iu( 35 ), Millimeter2iu( 5 ) ) );
+
+        m_keepout = new ZONE_CONTAINER( m_board.get() );
+        m_keepout->SetLayer( F_Cu );
+        m_keepout->SetIsKeepout( true );
+        m_keepout->SetDoNotAllowTracks( true );
+        m_keepout->Outline()->NewOutline();
+        m_keepout->Outline()->Append( Millimeter2iu( 5 ), Millimeter2iu( 8 ) );
+        m_keepout->Outline()->Append( Millimeter2iu( 8 ), Millimeter2iu( 8 ) );
+        m_keepout->Outline()->Append( Millimeter2iu( 8 ), Millimeter2iu( 12 ) );
+        m_keepout->Outline()->Append( Millimeter2iu( 5 ), Millimeter2iu( 12 ) );
+        m_board->Add( m_keepout );
+
+        m_text = new TEXTE_PCB( m_board.get() );
+        m_text->SetText( "TEXT" );
+        m_text->SetLayer( F_Cu );
+        m_text->SetTextPos( wxPoint( Millimeter2iu( 30 ), 0 ) );
+        m_text->SetTextSize( wxSize( Millimeter2iu( 1 ), Millimeter2iu( 1 ) ) );
+        m_text->SetThickness( Millimeter2iu( 0.15 ) );
+        m_board->Add( m_text );
+
+        m_board->BuildConnectivity();
+
+        // The reference markers of the incremental test
+        DRC drc( m_board.get(), MILLIMETRES );
+        drc.RunTestsHeadless( [&]( MARKER_PCB* aMarker ) { m_board->Add( aMarker ); } );
+
+        // The incremental DRC keeps its index between the changes of a test
+        m_drc = std::make_unique<DRC>( m_board.get(), MILLIMETRES );
+    }
+
+    MODULE* addModule( const wxString& aReference, const wxPoint& aPos )
+    {
+        MODULE* module = new MODULE( m_board.get() );
+        D_PAD*  pad = new D_PAD( module );
+
+        module->SetReference( aReference );
+        module->SetPosition( aPos );
+
+        pad->SetShape( PAD_SHAPE_RECT );
+        pad->SetAttribute( PAD_ATTRIB_SMD );
+        pad->SetLayerSet( D_PAD::SMDMask() );
+        pad->SetSize( wxSize( Millimeter2iu( 1 ), Millimeter2iu( 1 ) ) );
+        pad->SetPosition( aPos );
+        module->Add( pad );
+
+        m_board->Add( module );
+        return module;
+    }
+
+    TRACK* addTrack( const wxPoint& aStart, const wxPoint& aEnd )
+    {
+        TRACK* track = new TRACK( m_board.get() );
+
+        track->SetLayer( F_Cu );
+        track->SetWidth( Millimeter2iu( 0.25 ) );
+        track->SetStart( aStart );
+        track->SetEnd( aEnd );
+        m_board->Add( track );
+        return track;
+    }
+
+    /**
+     * Update the board markers with the incremental DRC.
+     */
+    void testChanges( const std::vector<BOARD_ITEM*>&         aChangedItems,
+                      const std::vector<REMOVED_BOARD_ITEM>& aRemovedItems = {} )
+    {
+        std::vector<MARKER_PCB*> staleMarkers;
+        std::vector<MARKER_PCB*> newMarkers;
+
+        m_board->BuildConnectivity();
+        m_drc->TestChangedItems( aChangedItems, aRemovedItems, staleMarkers, newMarkers );
+
+        for( MARKER_PCB* marker : staleMarkers )
+        {
+            m_board->Remove( marker );
+            delete marker;
+        }
+
+        for( MARKER_PCB* marker : newMarkers )
+            m_board->Add( marker );
+    }
+
+    /**
+     * @return the sorted keys of the board markers
+     */
+    std::vector<KI_TEST::DRC_MARKER_KEY> boardMarkers() const
+    {
+        std::vector<MARKER_PCB*> markers;
+
+        for( int ii = 0; ii < m_board->GetMARKERCount(); ++ii )
+            markers.push_back( m_board->GetMARKER( ii ) );
+
+        std::vector<KI_TEST::DRC_MARKER_KEY> keys = KI_TEST::GetDrcMarkerKeys( markers );
+        std::sort( keys.begin(), keys.end() );
+        return keys;
+    }
+
+    /**
+     * @return the sorted keys of the markers of a full DRC run
+     */
+    std::vector<KI_TEST::DRC_MARKER_KEY> fullDrcMarkers() const
+    {
+        std::vector<MARKER_PCB*> markers;
+        DRC                      drc( m_board.get(), MILLIMETRES );
+
+        drc.RunTestsHeadless( [&]( MARKER_PCB* aMarker ) { markers.push_back( aMarker ); } );
+
+        std::vector<KI_TEST::DRC_MARKER_KEY> keys = KI_TEST::GetDrcMarkerKeys( markers );
+        std::sort( keys.begin(), keys.end() );
+
+        for( MARKER_PCB* marker : markers )
+            delete marker;
+
+        return keys;
+    }
+
+    int countMarkers( int aErrorCode ) const
+    {
+        int count = 0;
+
+        for( int ii = 0; ii < m_board->GetMARKERCount(); ++ii )
+        {
+            if( KI_TEST::IsDrcMarkerOfType( *m_board->GetMARKER( ii ), aErrorCode ) )
+                count++;
+        }
+
+        return count;
+    }
+
+    void checkMatchesFullDrc() const
+    {
+        std::vector<KI_TEST::DRC_MARKER_KEY> incremental = boardMarkers();
+        std::vector<KI_TEST::DRC_MARKER_KEY> full = fullDrcMarkers();
+
+        BOOST_CHECK_EQUAL_COLLECTIONS(
+                incremental.begin(), incremental.end(), full.begin(), full.end() );
+    }
+
+    std::unique_ptr<BOARD> m_board;
+    std::unique_ptr<DRC>   m_drc;
+    MODULE*                m_u1;
+    MODULE*                m_u2;
+    MODULE*                m_u3;
+    TRACK*                 m_t1;
+    TRACK*                 m_t2;
+    TRACK*                 m_t3;
+    ZONE_CONTAINER*        m_keepout;
+    TEXTE_PCB*             m_text;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( DrcIncremental, INCREMENTAL_DRC_FIXTURE )
+
+
+BOOST_AUTO_TEST_CASE( InitialMarkers )
+{
+    BOOST_CHECK_EQUAL( countMarkers( DRCE_TRACK_NEAR_PAD ), 1 );
+    BOOST_CHECK_EQUAL( countMarkers( DRCE_TRACK_INSIDE_KEEPOUT ), 1 );
+    BOOST_CHECK_EQUAL( countMarkers( DRCE_TRACK_NEAR_COPPER ), 0 );
+    BOOST_CHECK_EQUAL( countMarkers( DRCE_MISSING_COURTYARD_IN_FOOTPRINT ), 3 );
+}
+
+
+BOOST_AUTO_TEST_CASE( MoveTrack )
+{
+    // T1 leaves the pad of U1
+    m_t1->Move( wxPoint( 0, Millimeter2iu( 3 ) ) );
+    testChanges( { m_t1 } );
+
+    BOOST_CHECK_EQUAL( countMarkers( DRCE_TRACK_NEAR_PAD ), 0 );
+    checkMatchesFullDrc();
+
+    // T3 crosses the copper text
+    m_t3->Move( wxPoint( 0, Millimeter2iu( -4.7 ) ) );
+    testChanges( { m_t3 } );
+
+    BOOST_CHECK_EQUAL( countMarkers( DRCE_TRACK_NEAR_COPPER ), 1 );
+    checkMatchesFullDrc();
+}
+
+
+BOOST_AUTO_TEST_CASE( MoveKeepoutAndText )
+{
+    m_keepout->Move( wxPoint( Millimeter2iu( 35 ), 0 ) );
+    testChanges( { m_keepout } );
+
+    BOOST_CHECK_EQUAL( countMarkers( DRCE_TRACK_INSIDE_KEEPOUT ), 0 );
+    checkMatchesFullDrc();
+
+    // The text moves onto T3
+    m_text->Move( wxPoint( 0, Millimeter2iu( 5 ) ) );
+    testChanges( { m_text } );
+
+    BOOST_CHECK_EQUAL( countMarkers( DRCE_TRACK_NEAR_COPPER ), 1 );
+    checkMatchesFullDrc();
+
+    // A new track crosses the moved keepout area
+    TRACK* track = addTrack( wxPoint( Millimeter2iu( 38 ), Millimeter2iu( 10 ) ),
+                             wxPoint( Millimeter2iu( 45 ), Millimeter2iu( 10 ) ) );
+    testChanges( { track } );
+
+    BOOST_CHECK_EQUAL( countMarkers( DRCE_TRACK_INSIDE_KEEPOUT ), 1 );
+    checkMatchesFullDrc();
+}
+
+
+BOOST_AUTO_TEST_CASE( MoveAndDeleteModules )
+{
+    // The pad of U1 leaves T1 for T2
+    m_u1->Move( wxPoint( Millimeter2iu( 15 ), Millimeter2iu( 10.7 ) ) );
+    testChanges( { m_u1 } );
+
+    BOOST_CHECK_EQUAL( countMarkers( DRCE_TRACK_NEAR_PAD ), 1 );
+    checkMatchesFullDrc();
+
+    // The removed module is captured before it is removed, and deleted after the test
+    std::unique_ptr<MODULE>         removedModule( m_u3 );
+    std::vector<REMOVED_BOARD_ITEM> removed = { REMOVED_BOARD_ITEM( m_u3 ) };
+
+    m_board->Remove( m_u3 );
+    testChanges( {}, removed );
+
+    BOOST_CHECK_EQUAL( countMarkers( DRCE_MISSING_COURTYARD_IN_FOOTPRINT ), 2 );
+    checkMatchesFullDrc();
+}
+
+
+BOOST_AUTO_TEST_CASE( DeleteAndAddTracks )
+{
+    // T1 is removed from the index with its marker
+    std::unique_ptr<TRACK>          removedTrack( m_t1 );
+    std::vector<REMOVED_BOARD_ITEM> removed = { REMOVED_BOARD_ITEM( m_t1 ) };
+
+    m_board->Remove( m_t1 );
+    testChanges( {}, removed );
+
+    BOOST_CHECK_EQUAL( countMarkers( DRCE_TRACK_NEAR_PAD ), 0 );
+    checkMatchesFullDrc();
+
+    // A new track passes near the pad of U2
+    TRACK* track = addTrack( wxPoint( Millimeter2iu( 8 ), Millimeter2iu( -0.725 ) ),
+                             wxPoint( Millimeter2iu( 12 ), Millimeter2iu( -0.725 ) ) );
+    testChanges( { track } );
+
+    BOOST_CHECK_EQUAL( countMarkers( DRCE_TRACK_NEAR_PAD ), 1 );
+    checkMatchesFullDrc();
+
+    // U2 leaves the new track, then U1 comes under it: the pads are found where they are
+    // now, not where the index first saw them
+    m_u2->Move( wxPoint( 0, Millimeter2iu( 5 ) ) );
+    testChanges( { m_u2 } );
+
+    BOOST_CHECK_EQUAL( countMarkers( DRCE_TRACK_NEAR_PAD ), 0 );
+    checkMatchesFullDrc();
+
+    m_u1->Move( wxPoint( Millimeter2iu( 10 ), 0 ) );
+    testChanges( { m_u1 } );
+
+    BOOST_CHECK_EQUAL( countMarkers( DRCE_TRACK_NEAR_PAD ), 1 );
+    checkMatchesFullDrc();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,74 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <class_board.h>
+#include <drc.h>
+
+#include "drc_test_utils.h"
+
+
+/**
+ * Run the headless DRC on a board, with a given number of threads.
+ * @return the keys of the markers, in the order they were reported
+ */
+static std::vector<KI_TEST::DRC_MARKER_KEY> runDrc( BOARD& aBoard, size_t aThreadCount )
+{
+    std::vector<MARKER_PCB*> markers;
+    DRC                      drc( &aBoard, MILLIMETRES );
+
+    drc.SetMaxThreadCount( aThreadCount );
+    drc.RunTestsHeadless( [&]( MARKER_PCB* aMarker ) { markers.push_back( aMarker ); } );
+
+    std::vector<KI_TEST::DRC_MARKER_KEY> keys = KI_TEST::GetDrcMarkerKeys( markers );
+
+    for( MARKER_PCB* marker : markers )
+        delete marker;
+
+    return keys;
+}
+
+
+BOOST_AUTO_TEST_SUITE( DrcParallel )
+
+
+/**
+ * The concurrent clearance tests report the markers of a serial run, in the same order.
+ * The board has enough pads to be split in several pad and track jobs.
+ */
+BOOST_AUTO_TEST_CASE( ParallelMatchesSerial )
+{
+    std::unique_ptr<BOARD> board = KI_TEST::MakeClearanceTestBoard( 60, 40 );
+
+    // The footprints have no courtyard: the courtyard test reports them too
+    board->GetDesignSettings().m_RequireCourtyards = true;
+
+    std::vector<KI_TEST::DRC_MARKER_KEY> serial = runDrc( *board, 1 );
+    std::vector<KI_TEST::DRC_MARKER_KEY> parallel = runDrc( *board, 8 );
+
+    BOOST_CHECK( !serial.empty() );
+    BOOST_CHECK_EQUAL_COLLECTIONS( serial.begin(), serial.end(), parallel.begin(), parallel.end() );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
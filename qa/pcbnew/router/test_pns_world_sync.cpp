@@ -0,0 +1,316 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <algorithm>
+#include <tuple>
+
+#include <class_board.h>
+#include <class_module.h>
+#include <class_pad.h>
+#include <class_pcb_text.h>
+#include <class_track.h>
+#include <pcb_base_frame.h>
+
+#include <router/pns_kicad_iface.h>
+#include <router/pns_node.h>
+#include <router/pns_router.h>
+#include <router/pns_solid.h>
+
+#include <geometry/shape_rect.h>
+
+
+namespace
+{
+
+/**
+ * What the comparison of two worlds looks at in a router item.
+ */
+struct WORLD_ITEM
+{
+    int                         m_kind;
+    int                         m_net;
+    int                         m_layerStart;
+    int                         m_layerEnd;
+    const BOARD_CONNECTED_ITEM* m_parent;
+    VECTOR2I                    m_bboxOrigin;
+    VECTOR2I                    m_bboxEnd;
+
+    WORLD_ITEM( const PNS::ITEM* aItem ) :
+            m_kind( aItem->Kind() ),
+            m_net( aItem->Net() ),
+            m_layerStart( aItem->Layers().Start() ),
+            m_layerEnd( aItem->Layers().End() ),
+            m_parent( aItem->Parent() ),
+            m_bboxOrigin( aItem->Shape()->BBox().GetOrigin() ),
+            m_bboxEnd( aItem->Shape()->BBox().GetEnd() )
+    {
+    }
+
+    std::tuple<int, int, int, int, const BOARD_CONNECTED_ITEM*, int, int, int, int> key() const
+    {
+        return std::make_tuple( m_kind, m_net, m_layerStart, m_layerEnd, m_parent, m_bboxOrigin.x,
+                                m_bboxOrigin.y, m_bboxEnd.x, m_bboxEnd.y );
+    }
+
+    bool operator==( const WORLD_ITEM& aOther ) const
+    {
+        return key() == aOther.key();
+    }
+
+    bool operator<( const WORLD_ITEM& aOther ) const
+    {
+        return key() < aOther.key();
+    }
+};
+
+
+std::ostream& operator<<( std::ostream& os, const WORLD_ITEM& aItem )
+{
+    os << "ITEM[ kind " << aItem.m_kind << ", net " << aItem.m_net << ", layers "
+       << aItem.m_layerStart << "-" << aItem.m_layerEnd << ", parent " << aItem.m_parent
+       << ", bbox " << aItem.m_bboxOrigin << " " << aItem.m_bboxEnd << " ]";
+    return os;
+}
+
+
+/**
+ * Collects every item found by a query.
+ */
+class WORLD_ITEM_COLLECTOR : public PNS::OBSTACLE_VISITOR
+{
+public:
+    WORLD_ITEM_COLLECTOR( const PNS::ITEM* aProbe, std::vector<WORLD_ITEM>& aItems ) :
+            PNS::OBSTACLE_VISITOR( aProbe ),
+            m_items( aItems )
+    {
+    }
+
+    bool operator()( PNS::ITEM* aCandidate ) override
+    {
+        m_items.emplace_back( aCandidate );
+        return true;
+    }
+
+private:
+    std::vector<WORLD_ITEM>& m_items;
+};
+
+
+/**
+ * Returns the sorted items of a world.
+ */
+std::vector<WORLD_ITEM> worldItems( PNS::NODE* aWorld )
+{
+    std::vector<WORLD_ITEM> items;
+
+    // A probe on all the copper layers reaches all the subindices of the world
+    PNS::SOLID probe;
+    probe.SetShape( new SHAPE_RECT( -100000000, -100000000, 200000000, 200000000 ) );
+    probe.SetLayers( LAYER_RANGE( F_Cu, B_Cu ) );
+    probe.SetNet( -1 );
+
+    WORLD_ITEM_COLLECTOR collector( &probe, items );
+    aWorld->QueryColliding( &probe, collector );
+
+    std::sort( items.begin(), items.end() );
+    return items;
+}
+
+} // namespace
+
+
+/**
+ * A board with a module, tracks, a via and a copper text, and a router world synced from it.
+ */
+struct PNS_WORLD_SYNC_FIXTURE
+{
+    PNS_WORLD_SYNC_FIXTURE() : m_board( std::make_unique<BOARD>() )
+    {
+        m_module = addModule( "U1", wxPoint( 0, 0 ) );
+        m_track = addTrack( wxPoint( Millimeter2iu( -5 ), Millimeter2iu( 5 ) ),
+                            wxPoint( Millimeter2iu( 5 ), Millimeter2iu( 5 ) ) );
+        addTrack( wxPoint( Millimeter2iu( 5 ), Millimeter2iu( 5 ) ),
+                  wxPoint( Millimeter2iu( 10 ), Millimeter2iu( 10 ) ) );
+
+        VIA* via = new VIA( m_board.get() );
+        via->SetPosition( wxPoint( Millimeter2iu( 10 ), Millimeter2iu( 10 ) ) );
+        via->SetWidth( Millimeter2iu( 0.6 ) );
+        via->SetDrill( Millimeter2iu( 0.3 ) );
+        via->SetLayerPair( F_Cu, B_Cu );
+        m_board->Add( via );
+
+        TEXTE_PCB* text = new TEXTE_PCB( m_board.get() );
+        text->SetText( "TEXT" );
+        text->SetLayer( F_Cu );
+        text->SetTextPos( wxPoint( Millimeter2iu( 20 ), 0 ) );
+        text->SetTextSize( wxSize( Millimeter2iu( 1 ), Millimeter2iu( 1 ) ) );
+        text->SetThickness( Millimeter2iu( 0.15 ) );
+        m_board->Add( text );
+
+        m_iface.SetBoard( m_board.get() );
+        m_router.SetInterface( &m_iface );
+        m_router.SyncWorld();
+    }
+
+    MODULE* addModule( const wxString& aReference, const wxPoint& aPos )
+    {
+        MODULE* module = new MODULE( m_board.get() );
+
+        module->SetReference( aReference );
+        module->SetPosition( aPos );
+
+        for( int i = 0; i < 2; ++i )
+        {
+            D_PAD* pad = new D_PAD( module );
+
+            pad->SetShape( PAD_SHAPE_CIRCLE );
+            pad->SetAttribute( i == 0 ? PAD_ATTRIB_STANDARD : PAD_ATTRIB_SMD );
+            pad->SetLayerSet( i == 0 ? D_PAD::StandardMask() : D_PAD::SMDMask() );
+            pad->SetSize( wxSize( Millimeter2iu( 1 ), Millimeter2iu( 1 ) ) );
+            pad->SetDrillSize( wxSize( i == 0 ? Millimeter2iu( 0.5 ) : 0, 0 ) );
+            pad->SetPosition( aPos + wxPoint( Millimeter2iu( 2 * i ), 0 ) );
+            module->Add( pad );
+        }
+
+        m_board->Add( module );
+        return module;
+    }
+
+    TRACK* addTrack( const wxPoint& aStart, const wxPoint& aEnd )
+    {
+        TRACK* track = new TRACK( m_board.get() );
+
+        track->SetLayer( F_Cu );
+        track->SetWidth( Millimeter2iu( 0.25 ) );
+        track->SetStart( aStart );
+        track->SetEnd( aEnd );
+        m_board->Add( track );
+        return track;
+    }
+
+    /**
+     * Reports a commit to the interface, updates the world and checks it against a world
+     * synced from scratch.
+     */
+    void checkUpdatedWorld( const std::vector<BOARD_ITEM*>&         aChangedItems,
+                            const std::vector<REMOVED_BOARD_ITEM>& aRemovedItems = {} )
+    {
+        m_iface.BoardItemsChanged( aChangedItems, aRemovedItems );
+        BOOST_CHECK( m_iface.UpdateWorld( m_router.GetWorld() ) );
+
+        PNS_KICAD_IFACE freshIface;
+        PNS::ROUTER     freshRouter;
+
+        freshIface.SetBoard( m_board.get() );
+        freshRouter.SetInterface( &freshIface );
+        freshRouter.SyncWorld();
+
+        const std::vector<WORLD_ITEM> updated = worldItems( m_router.GetWorld() );
+        const std::vector<WORLD_ITEM> fresh = worldItems( freshRouter.GetWorld() );
+
+        BOOST_CHECK_EQUAL_COLLECTIONS( updated.begin(), updated.end(), fresh.begin(),
+                                       fresh.end() );
+    }
+
+    std::unique_ptr<BOARD> m_board;
+    PNS_KICAD_IFACE        m_iface;
+    PNS::ROUTER            m_router;
+    MODULE*                m_module;
+    TRACK*                 m_track;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( PNSWorldSync, PNS_WORLD_SYNC_FIXTURE )
+
+
+BOOST_AUTO_TEST_CASE( InitialWorld )
+{
+    BOOST_CHECK( !worldItems( m_router.GetWorld() ).empty() );
+
+    checkUpdatedWorld( {} );
+}
+
+
+BOOST_AUTO_TEST_CASE( AddItems )
+{
+    TRACK*  track = addTrack( wxPoint( Millimeter2iu( 10 ), Millimeter2iu( 10 ) ),
+                              wxPoint( Millimeter2iu( 10 ), Millimeter2iu( 20 ) ) );
+    MODULE* module = addModule( "U2", wxPoint( Millimeter2iu( 30 ), Millimeter2iu( 30 ) ) );
+
+    checkUpdatedWorld( { track, module } );
+}
+
+
+BOOST_AUTO_TEST_CASE( MoveItems )
+{
+    m_track->Move( wxPoint( 0, Millimeter2iu( 1 ) ) );
+    checkUpdatedWorld( { m_track } );
+
+    m_module->Move( wxPoint( Millimeter2iu( 3 ), Millimeter2iu( -2 ) ) );
+    checkUpdatedWorld( { m_module } );
+
+    // A pad changed on its own is synced with its module
+    D_PAD* pad = m_module->PadsList().GetFirst();
+    pad->SetPosition( pad->GetPosition() + wxPoint( 0, Millimeter2iu( 1 ) ) );
+    checkUpdatedWorld( { pad } );
+}
+
+
+BOOST_AUTO_TEST_CASE( DeleteItems )
+{
+    // The removed items are deleted before the world update, and are only used as keys
+    std::unique_ptr<D_PAD> pad( m_module->PadsList().GetLast() );
+    REMOVED_BOARD_ITEM     removedPad( pad.get() );
+    m_module->Remove( pad.get() );
+    pad.reset();
+    checkUpdatedWorld( {}, { removedPad } );
+
+    REMOVED_BOARD_ITEM removedTrack( m_track );
+    m_board->Remove( m_track );
+    delete m_track;
+    checkUpdatedWorld( {}, { removedTrack } );
+
+    REMOVED_BOARD_ITEM removedModule( m_module );
+    m_board->Remove( m_module );
+    delete m_module;
+    checkUpdatedWorld( {}, { removedModule } );
+}
+
+
+BOOST_AUTO_TEST_CASE( AddMoveAndDeleteInOneCommit )
+{
+    TRACK* track = addTrack( wxPoint( Millimeter2iu( -10 ), 0 ),
+                             wxPoint( Millimeter2iu( -10 ), Millimeter2iu( 10 ) ) );
+    m_module->Move( wxPoint( Millimeter2iu( 1 ), 0 ) );
+
+    REMOVED_BOARD_ITEM removedTrack( m_track );
+    m_board->Remove( m_track );
+    delete m_track;
+
+    checkUpdatedWorld( { track, m_module }, { removedTrack } );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,177 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_autoplacer_scan.cpp
+ * Test the search of the footprint positions by AR_PLACEMENT_SCANNER against an
+ * exhaustive search.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <cmath>
+
+#include <autorouter/ar_autoplacer.h>
+
+
+namespace
+{
+
+/**
+ * The position of lowest cost, found as the autoplacer did before the scanner: a single
+ * thread scanning every position column by column, the last position winning on equal
+ * costs.
+ */
+bool exhaustiveSearch( int aCols, int aRows, const AR_PLACEMENT_SCANNER::COST_FUNCTION& aCost,
+                       AR_PLACEMENT_SCANNER::CANDIDATE& aBest )
+{
+    bool found = false;
+
+    for( int col = 0; col < aCols; col++ )
+    {
+        for( int row = 0; row < aRows; row++ )
+        {
+            double score;
+
+            if( !aCost( col, row, score ) )
+                continue;
+
+            if( !found || score <= aBest.m_score )
+            {
+                aBest = { col, row, score };
+                found = true;
+            }
+        }
+    }
+
+    return found;
+}
+
+
+void checkSameAsExhaustive( int aCols, int aRows, const AR_PLACEMENT_SCANNER::COST_FUNCTION& aCost )
+{
+    AR_PLACEMENT_SCANNER::CANDIDATE expected = { -1, -1, 0.0 };
+    bool expectedFound = exhaustiveSearch( aCols, aRows, aCost, expected );
+
+    for( size_t threads : { 1, 2, 3, 8 } )
+    {
+        BOOST_TEST_CONTEXT( threads << " threads" )
+        {
+            AR_PLACEMENT_SCANNER            scanner( aCols, aRows, aCost, threads );
+            AR_PLACEMENT_SCANNER::CANDIDATE best = { -1, -1, 0.0 };
+
+            BOOST_REQUIRE_EQUAL( scanner.FindBest( best ), expectedFound );
+
+            if( expectedFound )
+            {
+                BOOST_CHECK_EQUAL( best.m_col, expected.m_col );
+                BOOST_CHECK_EQUAL( best.m_row, expected.m_row );
+                BOOST_CHECK_EQUAL( best.m_score, expected.m_score );
+            }
+        }
+    }
+}
+
+} // namespace
+
+
+BOOST_AUTO_TEST_SUITE( AutoplacerScan )
+
+
+/**
+ * Small grids are searched in full, with the same result as the exhaustive search,
+ * including the positions of equal cost.
+ */
+BOOST_AUTO_TEST_CASE( SmallGridSameAsExhaustive )
+{
+    // Plateaus of equal cost, and positions where the footprint cannot be put
+    auto plateaus = []( int aCol, int aRow, double& aScore )
+    {
+        if( ( aCol * 7 + aRow * 3 ) % 11 == 0 )
+            return false;
+
+        aScore = std::abs( aCol / 4 - 5 ) + std::abs( aRow / 3 - 2 );
+        return true;
+    };
+
+    checkSameAsExhaustive( 37, 23, plateaus );
+    checkSameAsExhaustive( 1, 50, plateaus );
+    checkSameAsExhaustive( 50, 1, plateaus );
+
+    auto pseudoRandom = []( int aCol, int aRow, double& aScore )
+    {
+        unsigned hash = ( aCol * 2654435761u ) ^ ( aRow * 40503u );
+
+        if( hash % 5 == 0 )
+            return false;
+
+        aScore = hash % 97;
+        return true;
+    };
+
+    checkSameAsExhaustive( 60, 60, pseudoRandom );
+}
+
+
+BOOST_AUTO_TEST_CASE( NoRoom )
+{
+    auto full = []( int aCol, int aRow, double& aScore )
+    {
+        return false;
+    };
+
+    checkSameAsExhaustive( 20, 20, full );
+    checkSameAsExhaustive( 100, 100, full );
+    checkSameAsExhaustive( 0, 10, full );
+}
+
+
+/**
+ * Large grids are searched coarse to fine, which finds the lowest cost when the cost
+ * grows away from it.
+ */
+BOOST_AUTO_TEST_CASE( LargeGrid )
+{
+    auto bowl = []( int aCol, int aRow, double& aScore )
+    {
+        aScore = std::hypot( aCol - 71.3, aRow - 18.6 );
+        return true;
+    };
+
+    checkSameAsExhaustive( 120, 90, bowl );
+
+    // The coarse pass finds no room, then the whole grid is searched
+    auto lastColumn = []( int aCol, int aRow, double& aScore )
+    {
+        if( aCol != 109 )
+            return false;
+
+        aScore = std::abs( aRow - 50 );
+        return true;
+    };
+
+    checkSameAsExhaustive( 110, 110, lastColumn );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,348 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_connectivity_clusters.cpp
+ * Test the connectivity clusters found by the union-find search against a breadth-first
+ * search of the item connections.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <algorithm>
+#include <deque>
+#include <random>
+#include <set>
+
+#include <class_board.h>
+#include <class_module.h>
+#include <class_pad.h>
+#include <class_track.h>
+#include <class_zone.h>
+#include <netinfo.h>
+#include <connectivity/connectivity_algo.h>
+#include <connectivity/connectivity_data.h>
+
+
+namespace
+{
+
+using CLUSTER_SET = std::set<std::vector<CN_ITEM*>>;
+
+
+bool isSearched( CN_ITEM* aItem, bool aWithinAnyNet, const KICAD_T aTypes[], int aSingleNet )
+{
+    if( aWithinAnyNet && aItem->Net() <= 0 )
+        return false;
+
+    if( !aItem->Valid() )
+        return false;
+
+    if( aSingleNet >= 0 && aItem->Net() != aSingleNet )
+        return false;
+
+    for( int i = 0; aTypes[i] != EOT; i++ )
+    {
+        if( aItem->Parent()->Type() == aTypes[i] )
+            return true;
+    }
+
+    return false;
+}
+
+
+/**
+ * The clusters found by the breadth-first search SearchClusters() used before the
+ * union-find, with a visited set instead of the visited flags of the items.
+ */
+CLUSTER_SET bfsClusters( CN_LIST& aItems, CN_CONNECTIVITY_ALGO::CLUSTER_SEARCH_MODE aMode,
+                         const KICAD_T aTypes[], int aSingleNet )
+{
+    bool               withinAnyNet = ( aMode != CN_CONNECTIVITY_ALGO::CSM_PROPAGATE );
+    std::set<CN_ITEM*> searched;
+    std::set<CN_ITEM*> visited;
+    CLUSTER_SET        clusters;
+
+    for( CN_ITEM* item : aItems )
+    {
+        if( isSearched( item, withinAnyNet, aTypes, aSingleNet ) )
+            searched.insert( item );
+    }
+
+    for( CN_ITEM* root : aItems )
+    {
+        if( !searched.count( root ) || !visited.insert( root ).second )
+            continue;
+
+        std::deque<CN_ITEM*>  queue = { root };
+        std::vector<CN_ITEM*> cluster;
+
+        while( !queue.empty() )
+        {
+            CN_ITEM* current = queue.front();
+
+            queue.pop_front();
+            cluster.push_back( current );
+
+            for( CN_ITEM* n : current->ConnectedItems() )
+            {
+                if( withinAnyNet && n->Net() != root->Net() )
+                    continue;
+
+                // The former search could also step onto an item left out by the filter
+                // when its stale visited flag was clear: see FilteredItemsLeftOut
+                if( !searched.count( n ) )
+                    continue;
+
+                if( visited.insert( n ).second )
+                    queue.push_back( n );
+            }
+        }
+
+        std::sort( cluster.begin(), cluster.end() );
+        clusters.insert( cluster );
+    }
+
+    return clusters;
+}
+
+
+CLUSTER_SET clusterSet( const CN_CONNECTIVITY_ALGO::CLUSTERS& aClusters )
+{
+    CLUSTER_SET clusters;
+
+    for( const CN_CLUSTER_PTR& cluster : aClusters )
+    {
+        std::vector<CN_ITEM*> items( cluster->begin(), cluster->end() );
+
+        std::sort( items.begin(), items.end() );
+        clusters.insert( items );
+    }
+
+    return clusters;
+}
+
+} // namespace
+
+
+/**
+ * Pads, tracks, vias and a filled zone on three nets, with a track shorting two nets, and
+ * enough random track segments for the union-find to run on several threads.
+ */
+struct CONNECTIVITY_CLUSTERS_FIXTURE
+{
+    CONNECTIVITY_CLUSTERS_FIXTURE() : m_board( std::make_unique<BOARD>() )
+    {
+        for( int net = 1; net <= 3; net++ )
+            m_board->Add( new NETINFO_ITEM( m_board.get(), wxString::Format( "NET%d", net ),
+                                            net ) );
+
+        MODULE* module = new MODULE( m_board.get() );
+        m_board->Add( module );
+
+        m_padA = addPad( module, wxPoint( 0, 0 ), 1 );
+        m_padB = addPad( module, wxPoint( Millimeter2iu( 10 ), 0 ), 1 );
+        addPad( module, wxPoint( Millimeter2iu( 20 ), 0 ), 2 );
+        addPad( module, wxPoint( Millimeter2iu( 25 ), 0 ), 2 );
+
+        // Pads A and B are connected only by this track
+        m_track = addTrack( wxPoint( 0, 0 ), wxPoint( Millimeter2iu( 10 ), 0 ), 1 );
+
+        // A short between the nets 1 and 2
+        addTrack( wxPoint( Millimeter2iu( 10 ), 0 ), wxPoint( Millimeter2iu( 20 ), 0 ), 1 );
+
+        VIA* via = new VIA( m_board.get() );
+        via->SetPosition( wxPoint( Millimeter2iu( 10 ), 0 ) );
+        via->SetViaType( VIA_THROUGH );
+        via->SetLayerPair( F_Cu, B_Cu );
+        via->SetWidth( Millimeter2iu( 0.6 ) );
+        via->SetDrill( Millimeter2iu( 0.3 ) );
+        m_board->Add( via );
+        via->SetNetCode( 1 );
+
+        // A zone of the net 2 joining its two pads
+        ZONE_CONTAINER* zone = new ZONE_CONTAINER( m_board.get() );
+        zone->SetLayer( F_Cu );
+        zone->Outline()->NewOutline();
+        zone->Outline()->Append( Millimeter2iu( 18 ), Millimeter2iu( -2 ) );
+        zone->Outline()->Append( Millimeter2iu( 27 ), Millimeter2iu( -2 ) );
+        zone->Outline()->Append( Millimeter2iu( 27 ), Millimeter2iu( 2 ) );
+        zone->Outline()->Append( Millimeter2iu( 18 ), Millimeter2iu( 2 ) );
+
+        SHAPE_POLY_SET fill = *zone->Outline();
+        zone->SetFilledPolysList( fill );
+        zone->SetIsFilled( true );
+        m_board->Add( zone );
+        zone->SetNetCode( 2 );
+
+        // Chains of segments with random gaps and nets, to get many clusters
+        std::mt19937 rng( 3 );
+
+        for( int row = 0; row < 60; row++ )
+        {
+            for( int col = 0; col < 50; col++ )
+            {
+                int     x = Millimeter2iu( 40 ) + col * Millimeter2iu( 1 );
+                int     y = Millimeter2iu( 10 ) + row * Millimeter2iu( 1 );
+                int     length = rng() % 4 ? Millimeter2iu( 1 ) : Millimeter2iu( 0.5 );
+
+                addTrack( wxPoint( x, y ), wxPoint( x + length, y ), 1 + rng() % 3 );
+            }
+        }
+
+        m_board->BuildConnectivity();
+        m_algo = m_board->GetConnectivity()->GetConnectivityAlgo();
+    }
+
+    D_PAD* addPad( MODULE* aModule, const wxPoint& aPos, int aNet )
+    {
+        D_PAD* pad = new D_PAD( aModule );
+
+        pad->SetShape( PAD_SHAPE_CIRCLE );
+        pad->SetAttribute( PAD_ATTRIB_SMD );
+        pad->SetLayerSet( D_PAD::SMDMask() );
+        pad->SetSize( wxSize( Millimeter2iu( 1 ), Millimeter2iu( 1 ) ) );
+        pad->SetPosition( aPos );
+        aModule->Add( pad );
+        pad->SetNetCode( aNet );
+
+        return pad;
+    }
+
+    TRACK* addTrack( const wxPoint& aStart, const wxPoint& aEnd, int aNet )
+    {
+        TRACK* track = new TRACK( m_board.get() );
+
+        track->SetStart( aStart );
+        track->SetEnd( aEnd );
+        track->SetWidth( Millimeter2iu( 0.25 ) );
+        track->SetLayer( F_Cu );
+        m_board->Add( track );
+        track->SetNetCode( aNet );
+
+        return track;
+    }
+
+    void checkSameAsBfs( CN_CONNECTIVITY_ALGO::CLUSTER_SEARCH_MODE aMode, const KICAD_T aTypes[],
+                         int aSingleNet )
+    {
+        CLUSTER_SET found = clusterSet( m_algo->SearchClusters( aMode, aTypes, aSingleNet ) );
+        CLUSTER_SET expected = bfsClusters( m_algo->ItemList(), aMode, aTypes, aSingleNet );
+
+        BOOST_CHECK_GT( found.size(), 0 );
+        BOOST_CHECK_EQUAL( found.size(), expected.size() );
+        BOOST_CHECK( found == expected );
+    }
+
+    std::unique_ptr<BOARD>                m_board;
+    std::shared_ptr<CN_CONNECTIVITY_ALGO> m_algo;
+    D_PAD*                                m_padA;
+    D_PAD*                                m_padB;
+    TRACK*                                m_track;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( ConnectivityClusters, CONNECTIVITY_CLUSTERS_FIXTURE )
+
+
+BOOST_AUTO_TEST_CASE( SameAsBreadthFirstSearch )
+{
+    const KICAD_T all[] = { PCB_TRACE_T, PCB_PAD_T, PCB_VIA_T, PCB_ZONE_AREA_T, PCB_MODULE_T,
+                            EOT };
+
+    for( auto mode : { CN_CONNECTIVITY_ALGO::CSM_PROPAGATE,
+                       CN_CONNECTIVITY_ALGO::CSM_CONNECTIVITY_CHECK,
+                       CN_CONNECTIVITY_ALGO::CSM_RATSNEST } )
+    {
+        BOOST_TEST_CONTEXT( "Mode " << mode )
+        {
+            checkSameAsBfs( mode, all, -1 );
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE( SameAsBreadthFirstSearchFiltered )
+{
+    const KICAD_T copper[] = { PCB_TRACE_T, PCB_VIA_T, EOT };
+    const KICAD_T noZones[] = { PCB_TRACE_T, PCB_PAD_T, PCB_VIA_T, PCB_MODULE_T, EOT };
+
+    for( auto mode : { CN_CONNECTIVITY_ALGO::CSM_PROPAGATE,
+                       CN_CONNECTIVITY_ALGO::CSM_CONNECTIVITY_CHECK } )
+    {
+        BOOST_TEST_CONTEXT( "Mode " << mode << ", tracks and vias" )
+        {
+            checkSameAsBfs( mode, copper, -1 );
+        }
+
+        BOOST_TEST_CONTEXT( "Mode " << mode << ", no zones" )
+        {
+            checkSameAsBfs( mode, noZones, -1 );
+        }
+
+        BOOST_TEST_CONTEXT( "Mode " << mode << ", net 2" )
+        {
+            checkSameAsBfs( mode, noZones, 2 );
+        }
+    }
+}
+
+
+/**
+ * The clusters hold only the items matching the filter, and items connected only through
+ * a filtered out item are in different clusters.  The former search could step onto the
+ * filtered out items whose visited flag was left clear by an earlier search.
+ */
+BOOST_AUTO_TEST_CASE( FilteredItemsLeftOut )
+{
+    const KICAD_T pads[] = { PCB_PAD_T, EOT };
+
+    auto clusters = m_algo->SearchClusters( CN_CONNECTIVITY_ALGO::CSM_CONNECTIVITY_CHECK, pads,
+                                            -1 );
+
+    for( const CN_CLUSTER_PTR& cluster : clusters )
+    {
+        for( CN_ITEM* item : *cluster )
+            BOOST_CHECK_EQUAL( item->Parent()->Type(), PCB_PAD_T );
+
+        BOOST_CHECK( !( cluster->Contains( m_padA ) && cluster->Contains( m_padB ) ) );
+    }
+
+    // With the tracks, the pads are connected
+    const KICAD_T padsAndTracks[] = { PCB_PAD_T, PCB_TRACE_T, EOT };
+
+    clusters = m_algo->SearchClusters( CN_CONNECTIVITY_ALGO::CSM_CONNECTIVITY_CHECK,
+                                       padsAndTracks, -1 );
+
+    int joined = std::count_if( clusters.begin(), clusters.end(),
+            [&]( const CN_CLUSTER_PTR& aCluster )
+            {
+                return aCluster->Contains( m_padA ) && aCluster->Contains( m_padB )
+                       && aCluster->Contains( m_track );
+            } );
+
+    BOOST_CHECK_EQUAL( joined, 1 );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,222 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <fstream>
+#include <map>
+#include <sstream>
+
+#include <boost/filesystem.hpp>
+
+#include <class_board.h>
+#include <class_module.h>
+#include <class_pad.h>
+#include <class_track.h>
+#include <pcbplot.h>
+
+#include <exporters/fabrication_job.h>
+
+
+namespace
+{
+
+/**
+ * Returns the contents of the files of a directory, by file name.  The lines holding the
+ * creation date are skipped: they differ between two runs.
+ */
+std::map<std::string, std::string> readPlotFiles( const boost::filesystem::path& aDir )
+{
+    std::map<std::string, std::string> files;
+
+    for( const auto& entry : boost::filesystem::directory_iterator( aDir ) )
+    {
+        std::ifstream     file( entry.path().string(), std::ios::binary );
+        std::stringstream contents;
+        std::string       line;
+
+        while( std::getline( file, line ) )
+        {
+            if( line.find( "CreationDate" ) == std::string::npos )
+                contents << line << '\n';
+        }
+
+        files[entry.path().filename().string()] = contents.str();
+    }
+
+    return files;
+}
+
+} // namespace
+
+
+/**
+ * A board with pads of all the shapes, with solder mask and paste margins, and tracks.
+ */
+struct FABRICATION_JOB_FIXTURE
+{
+    FABRICATION_JOB_FIXTURE() : m_board( std::make_unique<BOARD>() )
+    {
+        m_board->SetFileName( "fabrication.kicad_pcb" );
+
+        m_module = new MODULE( m_board.get() );
+        m_module->SetReference( "U1" );
+        m_board->Add( m_module );
+
+        const PAD_SHAPE_T shapes[] = { PAD_SHAPE_CIRCLE, PAD_SHAPE_OVAL, PAD_SHAPE_RECT,
+                                       PAD_SHAPE_TRAPEZOID, PAD_SHAPE_ROUNDRECT,
+                                       PAD_SHAPE_CUSTOM };
+        int x = 0;
+
+        for( PAD_SHAPE_T shape : shapes )
+        {
+            for( bool smd : { false, true } )
+            {
+                D_PAD* pad = new D_PAD( m_module );
+
+                pad->SetShape( shape );
+                pad->SetSize( wxSize( Millimeter2iu( 1.5 ), Millimeter2iu( 1 ) ) );
+                pad->SetPosition( wxPoint( x, smd ? Millimeter2iu( 3 ) : 0 ) );
+                pad->SetAttribute( smd ? PAD_ATTRIB_SMD : PAD_ATTRIB_STANDARD );
+                pad->SetLayerSet( smd ? D_PAD::SMDMask() : D_PAD::StandardMask() );
+                pad->SetDrillSize( smd ? wxSize( 0, 0 )
+                                       : wxSize( Millimeter2iu( 0.5 ), Millimeter2iu( 0.5 ) ) );
+                pad->SetLocalSolderMaskMargin( Millimeter2iu( 0.1 ) );
+                pad->SetLocalSolderPasteMargin( Millimeter2iu( -0.05 ) );
+
+                if( shape == PAD_SHAPE_TRAPEZOID )
+                    pad->SetDelta( wxSize( 0, Millimeter2iu( 0.3 ) ) );
+
+                if( shape == PAD_SHAPE_CUSTOM )
+                {
+                    pad->SetAnchorPadShape( PAD_SHAPE_CIRCLE );
+                    pad->SetSize( wxSize( Millimeter2iu( 0.8 ), Millimeter2iu( 0.8 ) ) );
+                    pad->AddPrimitive( wxPoint( 0, 0 ), wxPoint( Millimeter2iu( 1 ), 0 ),
+                                       Millimeter2iu( 0.4 ) );
+                    pad->MergePrimitivesAsPolygon();
+                }
+
+                m_module->Add( pad );
+            }
+
+            x += Millimeter2iu( 3 );
+        }
+
+        for( int ii = 0; ii < 10; ++ii )
+        {
+            TRACK* track = new TRACK( m_board.get() );
+
+            track->SetLayer( ii % 2 ? B_Cu : F_Cu );
+            track->SetWidth( Millimeter2iu( 0.25 ) );
+            track->SetStart( wxPoint( 0, Millimeter2iu( 5 + ii ) ) );
+            track->SetEnd( wxPoint( Millimeter2iu( 20 ), Millimeter2iu( 6 + ii ) ) );
+            m_board->Add( track );
+        }
+
+        m_plotOpts.SetFormat( PLOT_FORMAT_GERBER );
+        m_plotOpts.SetCreateGerberJobFile( true );
+        m_plotOpts.SetLayerSelection( LSET( 6, F_Cu, B_Cu, F_Mask, B_Mask, F_Paste, B_Paste ) );
+    }
+
+    ~FABRICATION_JOB_FIXTURE()
+    {
+        for( const auto& dir : m_outputDirs )
+            boost::filesystem::remove_all( dir );
+    }
+
+    /**
+     * Runs a job on aThreadCount threads, and returns the contents of its files.
+     */
+    std::map<std::string, std::string> runJob( size_t aThreadCount )
+    {
+        boost::filesystem::path dir = boost::filesystem::temp_directory_path()
+                                      / boost::filesystem::unique_path( "qa_fab_%%%%-%%%%" );
+
+        boost::filesystem::create_directories( dir );
+        m_outputDirs.push_back( dir );
+
+        FABRICATION_JOB job( m_board.get(), m_plotOpts, dir.string() );
+        job.SetMaxThreadCount( aThreadCount );
+        BOOST_CHECK( job.Run( nullptr ) );
+
+        return readPlotFiles( dir );
+    }
+
+    std::unique_ptr<BOARD>               m_board;
+    MODULE*                              m_module;
+    PCB_PLOT_PARAMS                      m_plotOpts;
+    std::vector<boost::filesystem::path> m_outputDirs;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( FabricationJob, FABRICATION_JOB_FIXTURE )
+
+
+/**
+ * The files written by several threads are the same as the files written by one thread
+ */
+BOOST_AUTO_TEST_CASE( ThreadedMatchesSerial )
+{
+    const std::map<std::string, std::string> serial = runJob( 1 );
+    const std::map<std::string, std::string> threaded = runJob( 4 );
+
+    // One file per layer, and the job file
+    BOOST_CHECK_EQUAL( serial.size(), 7 );
+    BOOST_REQUIRE_EQUAL( serial.size(), threaded.size() );
+
+    for( const auto& file : serial )
+    {
+        BOOST_TEST_CONTEXT( "File " << file.first )
+        {
+            BOOST_REQUIRE( threaded.count( file.first ) );
+            BOOST_CHECK( !file.second.empty() );
+            BOOST_CHECK( file.second == threaded.at( file.first ) );
+        }
+    }
+}
+
+
+/**
+ * Plotting the mask and paste layers leaves the board pads untouched
+ */
+BOOST_AUTO_TEST_CASE( BoardPadsUnchanged )
+{
+    std::vector<std::pair<wxSize, wxSize>> padSizes;
+
+    for( D_PAD* pad : m_module->Pads() )
+        padSizes.emplace_back( pad->GetSize(), pad->GetDelta() );
+
+    runJob( 4 );
+
+    size_t ii = 0;
+
+    for( D_PAD* pad : m_module->Pads() )
+    {
+        BOOST_CHECK( pad->GetSize() == padSizes[ii].first );
+        BOOST_CHECK( pad->GetDelta() == padSizes[ii].second );
+        ++ii;
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
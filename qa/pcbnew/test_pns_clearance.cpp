@@ -0,0 +1,277 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_pns_clearance.cpp
+ * Test the clearances given to the router by PNS_PCBNEW_RULE_RESOLVER against the
+ * netclass and pad clearances of the board.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <class_board.h>
+#include <class_module.h>
+#include <class_pad.h>
+#include <netclass.h>
+#include <netinfo.h>
+
+#include <router/pns_kicad_iface.h>
+#include <router/pns_router.h>
+#include <router/pns_segment.h>
+#include <router/pns_solid.h>
+
+
+/**
+ * Nets in three netclasses, one net having a pad with a clearance of its own and one a
+ * module with a clearance of its own, and a segment and a pad item on each net.
+ */
+struct PNS_CLEARANCE_FIXTURE
+{
+    PNS_CLEARANCE_FIXTURE() : m_board( std::make_unique<BOARD>() )
+    {
+        BOARD_DESIGN_SETTINGS& settings = m_board->GetDesignSettings();
+
+        settings.GetDefault()->SetClearance( Millimeter2iu( 0.2 ) );
+
+        NETCLASSPTR power = std::make_shared<NETCLASS>( "Power" );
+        power->SetClearance( Millimeter2iu( 0.5 ) );
+        settings.m_NetClasses.Add( power );
+
+        NETCLASSPTR fine = std::make_shared<NETCLASS>( "Fine" );
+        fine->SetClearance( Millimeter2iu( 0.1 ) );
+        settings.m_NetClasses.Add( fine );
+
+        for( int net = 1; net <= 7; net++ )
+        {
+            wxString name = wxString::Format( "NET%d", net );
+
+            m_board->Add( new NETINFO_ITEM( m_board.get(), name, net ) );
+
+            if( net == 3 || net == 4 )
+                power->Add( name );
+            else if( net == 5 )
+                fine->Add( name );
+        }
+
+        m_board->SynchronizeNetsAndNetClasses();
+
+        // Nets 4 and 6 have a pad with a clearance of its own, net 7 a module with a
+        // clearance of its own, and all have a pad following the netclass
+        MODULE* module = addModule( 0 );
+        MODULE* localModule = addModule( Millimeter2iu( 0.3 ) );
+
+        for( int net = -1; net <= 7; net++ )
+        {
+            m_items.push_back( makeSegment( net ) );
+
+            if( net == 4 )
+                m_items.push_back( makeSolid( addPad( module, net, Millimeter2iu( 0.3 ) ) ) );
+
+            if( net == 6 )
+                m_items.push_back( makeSolid( addPad( module, net, Millimeter2iu( 0.4 ) ) ) );
+
+            if( net == 7 )
+                m_items.push_back( makeSolid( addPad( localModule, net, 0 ) ) );
+
+            if( net >= 0 )
+                m_items.push_back( makeSolid( addPad( module, net, 0 ) ) );
+        }
+
+        m_resolver = std::make_unique<PNS_PCBNEW_RULE_RESOLVER>( m_board.get(), &m_router );
+    }
+
+    MODULE* addModule( int aClearance )
+    {
+        MODULE* module = new MODULE( m_board.get() );
+
+        module->SetLocalClearance( aClearance );
+        m_board->Add( module );
+
+        return module;
+    }
+
+    D_PAD* addPad( MODULE* aModule, int aNet, int aClearance )
+    {
+        D_PAD* pad = new D_PAD( aModule );
+
+        pad->SetLocalClearance( aClearance );
+        aModule->Add( pad );
+        pad->SetNetCode( aNet );
+
+        return pad;
+    }
+
+    std::unique_ptr<PNS::ITEM> makeSegment( int aNet )
+    {
+        auto segment = std::make_unique<PNS::SEGMENT>();
+
+        segment->SetNet( aNet );
+
+        return std::move( segment );
+    }
+
+    std::unique_ptr<PNS::ITEM> makeSolid( D_PAD* aPad )
+    {
+        auto solid = std::make_unique<PNS::SOLID>();
+
+        solid->SetParent( aPad );
+        solid->SetNet( aPad->GetNetCode() );
+
+        return std::move( solid );
+    }
+
+    /**
+     * The clearance of an item as it was looked up on every call before the clearance
+     * matrix: the local clearance of a pad or of its module, else its netclass clearance.
+     */
+    int itemClearance( const PNS::ITEM* aItem ) const
+    {
+        if( aItem->Parent() && aItem->Parent()->Type() == PCB_PAD_T )
+        {
+            const D_PAD* pad = static_cast<const D_PAD*>( aItem->Parent() );
+
+            if( pad->GetLocalClearance() > 0 )
+                return pad->GetLocalClearance();
+
+            if( pad->GetParent()->GetLocalClearance() > 0 )
+                return pad->GetParent()->GetLocalClearance();
+        }
+
+        if( aItem->Net() < 0 )
+            return m_board->GetDesignSettings().GetDefault()->GetClearance();
+
+        return m_board->FindNet( aItem->Net() )->GetNetClass()->GetClearance();
+    }
+
+    int expectedClearance( const PNS::ITEM* aA, const PNS::ITEM* aB ) const
+    {
+        return std::max( itemClearance( aA ), itemClearance( aB ) );
+    }
+
+    const PNS::ITEM* segment( int aNet ) const
+    {
+        for( const auto& item : m_items )
+        {
+            if( item->Net() == aNet && item->OfKind( PNS::ITEM::SEGMENT_T ) )
+                return item.get();
+        }
+
+        return nullptr;
+    }
+
+    /**
+     * Gives the first pad item of aNet with the local clearance aLocalClearance, which is
+     * the pad of the module with a clearance of its own for the net 7.
+     */
+    const PNS::ITEM* pad( int aNet, int aLocalClearance ) const
+    {
+        for( const auto& item : m_items )
+        {
+            if( item->Net() == aNet && item->OfKind( PNS::ITEM::SOLID_T )
+                    && static_cast<D_PAD*>( item->Parent() )->GetLocalClearance()
+                               == aLocalClearance )
+                return item.get();
+        }
+
+        return nullptr;
+    }
+
+    std::unique_ptr<BOARD>                    m_board;
+    PNS::ROUTER                               m_router;
+    std::unique_ptr<PNS_PCBNEW_RULE_RESOLVER> m_resolver;
+    std::vector<std::unique_ptr<PNS::ITEM>>   m_items;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( PnsClearance, PNS_CLEARANCE_FIXTURE )
+
+
+/**
+ * Every pair of items gets the clearance of the former per call lookup.
+ */
+BOOST_AUTO_TEST_CASE( SameAsNetclassLookup )
+{
+    for( const auto& a : m_items )
+    {
+        for( const auto& b : m_items )
+        {
+            BOOST_TEST_CONTEXT( "Nets " << a->Net() << " (" << a->KindStr() << ") and "
+                                        << b->Net() << " (" << b->KindStr() << ")" )
+            {
+                BOOST_CHECK_EQUAL( m_resolver->Clearance( a.get(), b.get() ),
+                                   expectedClearance( a.get(), b.get() ) );
+            }
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE( ClassPairs )
+{
+    // The larger clearance of the two netclasses, in both orders
+    BOOST_CHECK_EQUAL( m_resolver->Clearance( segment( 1 ), segment( 3 ) ), Millimeter2iu( 0.5 ) );
+    BOOST_CHECK_EQUAL( m_resolver->Clearance( segment( 3 ), segment( 1 ) ), Millimeter2iu( 0.5 ) );
+    BOOST_CHECK_EQUAL( m_resolver->Clearance( segment( 5 ), segment( 1 ) ), Millimeter2iu( 0.2 ) );
+    BOOST_CHECK_EQUAL( m_resolver->Clearance( segment( 5 ), segment( 3 ) ), Millimeter2iu( 0.5 ) );
+
+    // Items of no net follow the default netclass
+    BOOST_CHECK_EQUAL( m_resolver->Clearance( segment( -1 ), segment( 5 ) ), Millimeter2iu( 0.2 ) );
+    BOOST_CHECK_EQUAL( m_resolver->Clearance( segment( -1 ), segment( 4 ) ), Millimeter2iu( 0.5 ) );
+}
+
+
+BOOST_AUTO_TEST_CASE( SingleClass )
+{
+    BOOST_CHECK_EQUAL( m_resolver->Clearance( segment( 1 ), segment( 2 ) ), Millimeter2iu( 0.2 ) );
+    BOOST_CHECK_EQUAL( m_resolver->Clearance( segment( 3 ), segment( 4 ) ), Millimeter2iu( 0.5 ) );
+    BOOST_CHECK_EQUAL( m_resolver->Clearance( segment( 5 ), segment( 5 ) ), Millimeter2iu( 0.1 ) );
+    BOOST_CHECK_EQUAL( m_resolver->Clearance( segment( 5 ), pad( 5, 0 ) ), Millimeter2iu( 0.1 ) );
+}
+
+
+BOOST_AUTO_TEST_CASE( LocalClearances )
+{
+    // The pad clearance replaces the netclass clearance of the pad only
+    BOOST_CHECK_EQUAL( m_resolver->Clearance( pad( 6, Millimeter2iu( 0.4 ) ), segment( 1 ) ),
+                       Millimeter2iu( 0.4 ) );
+    BOOST_CHECK_EQUAL( m_resolver->Clearance( segment( 1 ), pad( 6, Millimeter2iu( 0.4 ) ) ),
+                       Millimeter2iu( 0.4 ) );
+    BOOST_CHECK_EQUAL( m_resolver->Clearance( pad( 6, 0 ), segment( 1 ) ), Millimeter2iu( 0.2 ) );
+    BOOST_CHECK_EQUAL( m_resolver->Clearance( segment( 6 ), segment( 5 ) ), Millimeter2iu( 0.2 ) );
+
+    // The module clearance is used by its pads having none
+    BOOST_CHECK_EQUAL( m_resolver->Clearance( pad( 7, 0 ), segment( 5 ) ), Millimeter2iu( 0.3 ) );
+
+    // The pad clearance is used even when smaller than the netclass clearance
+    BOOST_CHECK_EQUAL( m_resolver->Clearance( pad( 4, Millimeter2iu( 0.3 ) ), segment( 1 ) ),
+                       Millimeter2iu( 0.3 ) );
+    BOOST_CHECK_EQUAL( m_resolver->Clearance( pad( 4, 0 ), segment( 1 ) ), Millimeter2iu( 0.5 ) );
+    BOOST_CHECK_EQUAL( m_resolver->Clearance( pad( 6, Millimeter2iu( 0.4 ) ), segment( 3 ) ),
+                       Millimeter2iu( 0.5 ) );
+    BOOST_CHECK_EQUAL( m_resolver->Clearance( pad( 6, Millimeter2iu( 0.4 ) ),
+                                              pad( 6, Millimeter2iu( 0.4 ) ) ),
+                       Millimeter2iu( 0.4 ) );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,249 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_ratsnest.cpp
+ * Test the ratsnest updates of a large net, whose triangulation is updated incrementally,
+ * against a ratsnest computed from scratch.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <algorithm>
+#include <functional>
+#include <random>
+
+#include <class_board.h>
+#include <class_module.h>
+#include <class_pad.h>
+#include <netinfo.h>
+#include <connectivity/connectivity_algo.h>
+#include <connectivity/connectivity_data.h>
+#include <ratsnest_data.h>
+
+
+namespace
+{
+
+/**
+ * An edge of the ratsnest, by the positions of its ends
+ */
+using POSITION_EDGE = std::pair<std::pair<int, int>, std::pair<int, int>>;
+
+
+std::vector<POSITION_EDGE> positionEdges( const RN_NET* aNet, uint64_t& aTotalWeight )
+{
+    std::vector<POSITION_EDGE> edges;
+
+    aTotalWeight = 0;
+
+    for( const CN_EDGE& edge : aNet->GetUnconnected() )
+    {
+        std::pair<int, int> source( edge.GetSourcePos().x, edge.GetSourcePos().y );
+        std::pair<int, int> target( edge.GetTargetPos().x, edge.GetTargetPos().y );
+
+        edges.emplace_back( std::min( source, target ), std::max( source, target ) );
+        aTotalWeight += edge.GetWeight();
+    }
+
+    std::sort( edges.begin(), edges.end() );
+
+    return edges;
+}
+
+} // namespace
+
+
+/**
+ * A net with more than a hundred pads at scattered positions, each pad in its own module.
+ * Some pads share their position with another one.
+ */
+struct RATSNEST_FIXTURE
+{
+    RATSNEST_FIXTURE() : m_board( std::make_unique<BOARD>() )
+    {
+        m_board->Add( new NETINFO_ITEM( m_board.get(), "NET1", 1 ) );
+        m_board->Add( new NETINFO_ITEM( m_board.get(), "NET2", 2 ) );
+
+        // Not std::uniform_int_distribution: its output depends on the standard library
+        std::mt19937 rng( 42 );
+
+        for( int ii = 0; ii < 120; ii++ )
+        {
+            wxPoint pos( (int) ( rng() % Millimeter2iu( 100 ) ),
+                         (int) ( rng() % Millimeter2iu( 100 ) ) );
+
+            addPad( pos );
+
+            // Duplicate anchors
+            if( ii % 10 == 0 )
+                addPad( pos );
+        }
+
+        m_board->BuildConnectivity();
+    }
+
+    ~RATSNEST_FIXTURE()
+    {
+        for( MODULE* module : m_removed )
+            delete module;
+    }
+
+    void addPad( const wxPoint& aPos )
+    {
+        MODULE* module = new MODULE( m_board.get() );
+        D_PAD*  pad = new D_PAD( module );
+
+        pad->SetShape( PAD_SHAPE_CIRCLE );
+        pad->SetAttribute( PAD_ATTRIB_SMD );
+        pad->SetLayerSet( D_PAD::SMDMask() );
+        pad->SetSize( wxSize( Millimeter2iu( 0.2 ), Millimeter2iu( 0.2 ) ) );
+        module->Add( pad );
+        module->SetPosition( aPos );
+        pad->SetNetCode( 1 );
+
+        m_board->Add( module, ADD_APPEND );
+        m_modules.push_back( module );
+    }
+
+    void removeModule( MODULE* aModule )
+    {
+        m_board->Remove( aModule );
+        m_modules.erase( std::find( m_modules.begin(), m_modules.end(), aModule ) );
+        m_removed.push_back( aModule );
+    }
+
+    /**
+     * Updates the ratsnest of the board, and checks it gives the same spanning tree as
+     * a ratsnest computed from scratch.
+     */
+    void checkRatsnest()
+    {
+        std::shared_ptr<CONNECTIVITY_DATA> connectivity = m_board->GetConnectivity();
+
+        connectivity->RecalculateRatsnest();
+
+        CONNECTIVITY_DATA fresh;
+        fresh.Build( m_board.get() );
+
+        uint64_t updatedWeight, freshWeight;
+
+        std::vector<POSITION_EDGE> updated =
+                positionEdges( connectivity->GetRatsnestForNet( 1 ), updatedWeight );
+        std::vector<POSITION_EDGE> expected =
+                positionEdges( fresh.GetRatsnestForNet( 1 ), freshWeight );
+
+        BOOST_CHECK_EQUAL( updatedWeight, freshWeight );
+        BOOST_CHECK( updated == expected );
+    }
+
+    std::unique_ptr<BOARD> m_board;
+    std::vector<MODULE*>   m_modules;
+    std::vector<MODULE*>   m_removed;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( Ratsnest, RATSNEST_FIXTURE )
+
+
+BOOST_AUTO_TEST_CASE( InitialRatsnest )
+{
+    checkRatsnest();
+
+    BOOST_CHECK( !m_board->GetConnectivity()->GetRatsnestForNet( 1 )->GetEdges().empty() );
+}
+
+
+/**
+ * Removes the nodes on the bounding box of the net first, then the others one by one.
+ * The net goes below the size of incrementally updated nets on the way.
+ */
+BOOST_AUTO_TEST_CASE( RemoveNodes )
+{
+    checkRatsnest();
+
+    auto boundaryModule = [&]( const std::function<bool( const wxPoint&, const wxPoint& )>& aLess )
+    {
+        return *std::min_element( m_modules.begin(), m_modules.end(),
+                [&]( MODULE* aA, MODULE* aB )
+                {
+                    return aLess( aA->GetPosition(), aB->GetPosition() );
+                } );
+    };
+
+    const std::function<bool( const wxPoint&, const wxPoint& )> boundaries[] = {
+        []( const wxPoint& aA, const wxPoint& aB ) { return aA.x < aB.x; },
+        []( const wxPoint& aA, const wxPoint& aB ) { return aA.x > aB.x; },
+        []( const wxPoint& aA, const wxPoint& aB ) { return aA.y < aB.y; },
+        []( const wxPoint& aA, const wxPoint& aB ) { return aA.y > aB.y; },
+    };
+
+    for( const auto& boundary : boundaries )
+    {
+        BOOST_TEST_CONTEXT( "Boundary node, " << m_modules.size() << " nodes" )
+        {
+            removeModule( boundaryModule( boundary ) );
+            checkRatsnest();
+        }
+    }
+
+    std::mt19937 rng( 7 );
+
+    while( m_modules.size() > 2 )
+    {
+        BOOST_TEST_CONTEXT( m_modules.size() << " nodes" )
+        {
+            removeModule( m_modules[rng() % m_modules.size()] );
+            checkRatsnest();
+        }
+    }
+}
+
+
+/**
+ * Removes one of two pads at the same position: the position stays in the triangulation.
+ */
+BOOST_AUTO_TEST_CASE( RemoveDuplicateAnchors )
+{
+    checkRatsnest();
+
+    for( size_t ii = 1; ii < m_modules.size(); )
+    {
+        if( m_modules[ii]->GetPosition() == m_modules[ii - 1]->GetPosition() )
+        {
+            BOOST_TEST_CONTEXT( "Duplicate at " << m_modules[ii]->GetPosition().x << ","
+                                                << m_modules[ii]->GetPosition().y )
+            {
+                removeModule( m_modules[ii] );
+                checkRatsnest();
+            }
+        }
+        else
+        {
+            ii++;
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,414 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_zone_fill_cache.cpp
+ * Test reading the zone fill cache file back, and rejecting truncated and corrupted files.
+ * Test restoring the zone triangulations of a reopened board from the cache.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include <boost/filesystem.hpp>
+
+#include <md5_hash.h>
+
+#include <class_board.h>
+#include <class_zone.h>
+#include <netinfo.h>
+#include <zone_fill_cache.h>
+#include <zone_filler.h>
+
+
+namespace
+{
+
+// Offsets of the fields in a cache file holding a single one-outline entry
+const size_t SIGNATURE_OFFSET = 0;
+const size_t VERSION_OFFSET = 8;
+const size_t ALGORITHM_VERSION_OFFSET = 12;
+const size_t ENTRY_COUNT_OFFSET = 16;
+const size_t OUTLINE_COUNT_OFFSET = 36;
+const size_t POINT_COUNT_OFFSET = 45;
+
+
+std::vector<char> readFile( const boost::filesystem::path& aPath )
+{
+    std::ifstream file( aPath.string(), std::ios::binary );
+
+    return std::vector<char>( std::istreambuf_iterator<char>( file ),
+                              std::istreambuf_iterator<char>() );
+}
+
+
+void writeFile( const boost::filesystem::path& aPath, const std::vector<char>& aContents )
+{
+    std::ofstream file( aPath.string(), std::ios::binary | std::ios::trunc );
+
+    file.write( aContents.data(), aContents.size() );
+}
+
+
+void writeUint32( std::vector<char>& aContents, size_t aOffset, uint32_t aValue )
+{
+    memcpy( aContents.data() + aOffset, &aValue, sizeof( aValue ) );
+}
+
+} // namespace
+
+
+/**
+ * A cache file holding the triangulated fill of a square with a hole.
+ */
+struct ZONE_FILL_CACHE_FIXTURE
+{
+    ZONE_FILL_CACHE_FIXTURE()
+    {
+        m_dir = boost::filesystem::temp_directory_path()
+                / boost::filesystem::unique_path( "qa_zone_fill_cache_%%%%-%%%%" );
+        boost::filesystem::create_directories( m_dir );
+        m_fileName = m_dir / "board.zone-fill-cache";
+
+        m_polys.NewOutline();
+        m_polys.Append( 0, 0 );
+        m_polys.Append( 1000, 0 );
+        m_polys.Append( 1000, 1000 );
+        m_polys.Append( 0, 1000 );
+        m_polys.NewHole();
+        m_polys.Append( 200, 200 );
+        m_polys.Append( 200, 800 );
+        m_polys.Append( 800, 800 );
+        m_polys.Append( 800, 200 );
+        m_polys.Fracture( SHAPE_POLY_SET::PM_FAST );
+        m_polys.CacheTriangulation();
+
+        m_hash.Hash( 42 );
+        m_hash.Finalize();
+
+        ZONE_FILL_CACHE cache( fileName() );
+        cache.Store( m_hash, m_polys );
+        BOOST_REQUIRE( cache.Save() );
+
+        m_contents = readFile( m_fileName );
+        BOOST_REQUIRE_GT( m_contents.size(), POINT_COUNT_OFFSET + sizeof( uint32_t ) );
+    }
+
+    ~ZONE_FILL_CACHE_FIXTURE()
+    {
+        boost::system::error_code ec;
+        boost::filesystem::remove_all( m_dir, ec );
+    }
+
+    wxString fileName() const
+    {
+        return wxString( m_fileName.string() );
+    }
+
+    /**
+     * Writes aContents to the cache file and checks it is rejected as a whole.
+     */
+    void checkRejected( const std::vector<char>& aContents )
+    {
+        writeFile( m_fileName, aContents );
+
+        ZONE_FILL_CACHE cache( fileName() );
+
+        BOOST_CHECK( !cache.Load() );
+        BOOST_CHECK( cache.Find( m_hash ) == nullptr );
+    }
+
+    boost::filesystem::path m_dir;
+    boost::filesystem::path m_fileName;
+    SHAPE_POLY_SET          m_polys;
+    MD5_HASH                m_hash;
+    std::vector<char>       m_contents;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( ZoneFillCache, ZONE_FILL_CACHE_FIXTURE )
+
+
+/**
+ * The fill and its triangulation are read back as they were stored.
+ */
+BOOST_AUTO_TEST_CASE( RoundTrip )
+{
+    ZONE_FILL_CACHE cache( fileName() );
+
+    BOOST_REQUIRE( cache.Load() );
+
+    const ZONE_FILL_CACHE::ENTRY* entry = cache.Find( m_hash );
+
+    BOOST_REQUIRE( entry != nullptr );
+    BOOST_CHECK( entry->m_filledPolys.GetHash() == m_polys.GetHash() );
+    BOOST_REQUIRE_EQUAL( entry->m_triangulation.size(), m_polys.TriangulatedPolyCount() );
+
+    for( size_t ii = 0; ii < entry->m_triangulation.size(); ii++ )
+    {
+        const auto& expected = *m_polys.TriangulatedPolygon( ii );
+        const auto& tri = entry->m_triangulation[ii];
+
+        BOOST_CHECK_EQUAL( tri.GetVertexCount(), expected.GetVertexCount() );
+        BOOST_CHECK_EQUAL( tri.GetTriangleCount(), expected.GetTriangleCount() );
+    }
+
+    MD5_HASH otherHash;
+    otherHash.Hash( 43 );
+    otherHash.Finalize();
+
+    BOOST_CHECK( cache.Find( otherHash ) == nullptr );
+}
+
+
+BOOST_AUTO_TEST_CASE( MissingFile )
+{
+    boost::filesystem::remove( m_fileName );
+
+    ZONE_FILL_CACHE cache( fileName() );
+
+    BOOST_CHECK( !cache.Load() );
+    BOOST_CHECK( cache.Find( m_hash ) == nullptr );
+}
+
+
+/**
+ * A file cut at any length is rejected, without keeping the entries read before the cut.
+ */
+BOOST_AUTO_TEST_CASE( TruncatedFile )
+{
+    for( size_t length = 0; length < m_contents.size(); length++ )
+    {
+        BOOST_TEST_CONTEXT( "Length " << length )
+        {
+            checkRejected( std::vector<char>( m_contents.begin(), m_contents.begin() + length ) );
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE( CorruptHeader )
+{
+    std::vector<char> contents = m_contents;
+
+    BOOST_TEST_CONTEXT( "Signature" )
+    {
+        contents[SIGNATURE_OFFSET] = 'X';
+        checkRejected( contents );
+        contents = m_contents;
+    }
+
+    BOOST_TEST_CONTEXT( "Format version" )
+    {
+        writeUint32( contents, VERSION_OFFSET, 1 );
+        checkRejected( contents );
+        contents = m_contents;
+    }
+
+    // Fills computed by another version of the algorithm must not be reused
+    BOOST_TEST_CONTEXT( "Fill algorithm version" )
+    {
+        writeUint32( contents, ALGORITHM_VERSION_OFFSET, ZONE_FILL_ALGORITHM_VERSION + 1 );
+        checkRejected( contents );
+    }
+}
+
+
+/**
+ * Counts larger than the file are rejected before allocating anything.
+ */
+BOOST_AUTO_TEST_CASE( CorruptCounts )
+{
+    BOOST_TEST_CONTEXT( "One entry too many" )
+    {
+        std::vector<char> contents = m_contents;
+
+        writeUint32( contents, ENTRY_COUNT_OFFSET, 2 );
+        checkRejected( contents );
+    }
+
+    const size_t offsets[] = { ENTRY_COUNT_OFFSET, OUTLINE_COUNT_OFFSET, POINT_COUNT_OFFSET };
+
+    for( size_t offset : offsets )
+    {
+        for( uint32_t value : { 0x10000000u, 0xFFFFFFFFu } )
+        {
+            BOOST_TEST_CONTEXT( "Offset " << offset << ", count " << value )
+            {
+                std::vector<char> contents = m_contents;
+
+                writeUint32( contents, offset, value );
+                checkRejected( contents );
+            }
+        }
+    }
+}
+
+
+/**
+ * A triangle using a vertex out of its polygon is rejected: it would be used to draw the zone.
+ */
+BOOST_AUTO_TEST_CASE( CorruptTriangleIndex )
+{
+    std::vector<char> contents = m_contents;
+
+    // The file ends with the last vertex index of the last triangle
+    writeUint32( contents, contents.size() - sizeof( uint32_t ), 0xFFFFFFFF );
+    checkRejected( contents );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
+
+
+/**
+ * A board with a filled zone, whose fill is stored in the cache file, and the same board
+ * as it is loaded again: with the same filled areas, but no triangulation.
+ */
+struct ZONE_FILL_RESTORE_FIXTURE : public ZONE_FILL_CACHE_FIXTURE
+{
+    ZONE_FILL_RESTORE_FIXTURE()
+    {
+        m_zone = addZone( m_board );
+        m_board.BuildConnectivity();
+
+        ZONE_FILLER filler( &m_board );
+        BOOST_REQUIRE( filler.Fill( { m_zone } ) );
+        BOOST_REQUIRE( m_zone->GetFilledPolysList().IsTriangulationUpToDate() );
+        BOOST_REQUIRE( m_zone->GetObstaclesHash().IsValid() );
+
+        ZONE_FILL_CACHE cache( fileName() );
+        cache.StoreFills( &m_board );
+        BOOST_REQUIRE( cache.Save() );
+
+        m_contents = readFile( m_fileName );
+
+        // The filled areas as read from the board file
+        m_loadedZone = addZone( m_loadedBoard );
+
+        const SHAPE_POLY_SET& filledPolys = m_zone->GetFilledPolysList();
+
+        for( int ii = 0; ii < filledPolys.OutlineCount(); ii++ )
+        {
+            m_loadedZone->FilledPolysList().AddOutline( filledPolys.COutline( ii ) );
+
+            for( int jj = 0; jj < filledPolys.HoleCount( ii ); jj++ )
+                m_loadedZone->FilledPolysList().AddHole( filledPolys.CHole( ii, jj ) );
+        }
+
+        m_loadedZone->SetIsFilled( true );
+    }
+
+    ZONE_CONTAINER* addZone( BOARD& aBoard )
+    {
+        ZONE_CONTAINER* zone = new ZONE_CONTAINER( &aBoard );
+
+        zone->SetLayer( F_Cu );
+        zone->Outline()->NewOutline();
+        zone->Outline()->Append( 0, 0 );
+        zone->Outline()->Append( Millimeter2iu( 10 ), 0 );
+        zone->Outline()->Append( Millimeter2iu( 10 ), Millimeter2iu( 10 ) );
+        zone->Outline()->Append( 0, Millimeter2iu( 10 ) );
+        aBoard.Add( zone );
+        return zone;
+    }
+
+    int restore()
+    {
+        ZONE_FILL_CACHE cache( fileName() );
+        cache.Load();
+
+        return cache.Restore( &m_loadedBoard );
+    }
+
+    BOARD           m_board;
+    BOARD           m_loadedBoard;
+    ZONE_CONTAINER* m_zone;
+    ZONE_CONTAINER* m_loadedZone;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( ZoneFillCacheRestore, ZONE_FILL_RESTORE_FIXTURE )
+
+
+/**
+ * A zone loaded with the filled areas it was saved with gets their triangulation back,
+ * and the obstacles hash they were computed for.
+ */
+BOOST_AUTO_TEST_CASE( RoundTrip )
+{
+    BOOST_CHECK_EQUAL( restore(), 1 );
+
+    const SHAPE_POLY_SET& expected = m_zone->GetFilledPolysList();
+    const SHAPE_POLY_SET& filledPolys = m_loadedZone->GetFilledPolysList();
+
+    BOOST_REQUIRE( filledPolys.IsTriangulationUpToDate() );
+    BOOST_CHECK( m_loadedZone->GetObstaclesHash() == m_zone->GetObstaclesHash() );
+    BOOST_REQUIRE_EQUAL( filledPolys.TriangulatedPolyCount(), expected.TriangulatedPolyCount() );
+
+    for( unsigned ii = 0; ii < filledPolys.TriangulatedPolyCount(); ii++ )
+    {
+        BOOST_CHECK_EQUAL( filledPolys.TriangulatedPolygon( ii )->GetTriangleCount(),
+                           expected.TriangulatedPolygon( ii )->GetTriangleCount() );
+    }
+}
+
+
+/**
+ * A zone whose filled areas changed since they were cached is left as it was loaded.
+ */
+BOOST_AUTO_TEST_CASE( StaleFill )
+{
+    VECTOR2I& corner = m_loadedZone->FilledPolysList().Outline( 0 ).Point( 0 );
+    corner.x += 1;
+
+    BOOST_CHECK_EQUAL( restore(), 0 );
+    BOOST_CHECK( !m_loadedZone->GetFilledPolysList().IsTriangulationUpToDate() );
+    BOOST_CHECK( !m_loadedZone->GetObstaclesHash().IsValid() );
+}
+
+
+/**
+ * Nothing is restored from a truncated cache file.
+ */
+BOOST_AUTO_TEST_CASE( TruncatedFile )
+{
+    for( size_t length : { (size_t) 0, m_contents.size() / 2, m_contents.size() - 1 } )
+    {
+        BOOST_TEST_CONTEXT( "Length " << length )
+        {
+            writeFile( m_fileName,
+                       std::vector<char>( m_contents.begin(), m_contents.begin() + length ) );
+
+            BOOST_CHECK_EQUAL( restore(), 0 );
+            BOOST_CHECK( !m_loadedZone->GetFilledPolysList().IsTriangulationUpToDate() );
+            BOOST_CHECK( !m_loadedZone->GetObstaclesHash().IsValid() );
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
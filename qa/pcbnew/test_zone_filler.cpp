@@ -0,0 +1,184 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <algorithm>
+
+#include <class_board.h>
+#include <class_module.h>
+#include <class_pad.h>
+#include <class_zone.h>
+#include <netinfo.h>
+#include <zone_filler.h>
+
+
+/**
+ * Two overlapping zones of the net GND, and a module with a through hole pad and a custom
+ * pad of the net GND inside the first zone.
+ */
+struct ZONE_FILLER_FIXTURE
+{
+    ZONE_FILLER_FIXTURE() : m_board( std::make_unique<BOARD>() )
+    {
+        m_board->Add( new NETINFO_ITEM( m_board.get(), "GND", 1 ) );
+
+        m_zoneA = addZone( wxPoint( 0, 0 ), wxPoint( Millimeter2iu( 20 ), Millimeter2iu( 20 ) ) );
+        m_zoneB = addZone( wxPoint( Millimeter2iu( 15 ), Millimeter2iu( 15 ) ),
+                           wxPoint( Millimeter2iu( 30 ), Millimeter2iu( 30 ) ) );
+
+        MODULE* module = new MODULE( m_board.get() );
+        m_board->Add( module );
+
+        m_thtPad = new D_PAD( module );
+        m_thtPad->SetShape( PAD_SHAPE_CIRCLE );
+        m_thtPad->SetAttribute( PAD_ATTRIB_STANDARD );
+        m_thtPad->SetLayerSet( D_PAD::StandardMask() );
+        m_thtPad->SetSize( wxSize( Millimeter2iu( 2 ), Millimeter2iu( 2 ) ) );
+        m_thtPad->SetDrillSize( wxSize( Millimeter2iu( 1 ), Millimeter2iu( 1 ) ) );
+        m_thtPad->SetPosition( wxPoint( Millimeter2iu( 5 ), Millimeter2iu( 5 ) ) );
+        module->Add( m_thtPad );
+        m_thtPad->SetNetCode( 1 );
+
+        m_customPad = new D_PAD( module );
+        m_customPad->SetShape( PAD_SHAPE_CUSTOM );
+        m_customPad->SetAnchorPadShape( PAD_SHAPE_CIRCLE );
+        m_customPad->SetAttribute( PAD_ATTRIB_SMD );
+        m_customPad->SetLayerSet( D_PAD::SMDMask() );
+        m_customPad->SetSize( wxSize( Millimeter2iu( 1 ), Millimeter2iu( 1 ) ) );
+        m_customPad->SetPosition( wxPoint( Millimeter2iu( 10 ), Millimeter2iu( 10 ) ) );
+        m_customPad->AddPrimitive( wxPoint( 0, 0 ), wxPoint( Millimeter2iu( 2 ), 0 ),
+                                   Millimeter2iu( 0.5 ) );
+        m_customPad->MergePrimitivesAsPolygon();
+        module->Add( m_customPad );
+        m_customPad->SetNetCode( 1 );
+
+        m_board->BuildConnectivity();
+        fill();
+    }
+
+    ZONE_CONTAINER* addZone( const wxPoint& aStart, const wxPoint& aEnd )
+    {
+        ZONE_CONTAINER* zone = new ZONE_CONTAINER( m_board.get() );
+
+        zone->SetLayer( F_Cu );
+        zone->Outline()->NewOutline();
+        zone->Outline()->Append( aStart.x, aStart.y );
+        zone->Outline()->Append( aEnd.x, aStart.y );
+        zone->Outline()->Append( aEnd.x, aEnd.y );
+        zone->Outline()->Append( aStart.x, aEnd.y );
+        m_board->Add( zone );
+        zone->SetNetCode( 1 );
+        return zone;
+    }
+
+    /**
+     * Fills the zones, and returns the zones which were filled again
+     */
+    std::vector<ZONE_CONTAINER*> fill()
+    {
+        // A zone that is not refilled keeps this marker in its filled areas
+        const VECTOR2I marker( Millimeter2iu( -100 ), Millimeter2iu( -100 ) );
+
+        for( ZONE_CONTAINER* zone : { m_zoneA, m_zoneB } )
+        {
+            zone->FilledPolysList().NewOutline();
+            zone->FilledPolysList().Append( marker.x, marker.y );
+            zone->FilledPolysList().Append( marker.x + 1000, marker.y );
+            zone->FilledPolysList().Append( marker.x + 1000, marker.y + 1000 );
+        }
+
+        ZONE_FILLER filler( m_board.get() );
+        BOOST_REQUIRE( filler.Fill( { m_zoneA, m_zoneB } ) );
+
+        std::vector<ZONE_CONTAINER*> refilled;
+
+        for( ZONE_CONTAINER* zone : { m_zoneA, m_zoneB } )
+        {
+            BOOST_CHECK( zone->IsFilled() );
+
+            if( !zone->GetFilledPolysList().BBox().Contains( marker ) )
+                refilled.push_back( zone );
+        }
+
+        return refilled;
+    }
+
+    std::unique_ptr<BOARD> m_board;
+    ZONE_CONTAINER*        m_zoneA;
+    ZONE_CONTAINER*        m_zoneB;
+    D_PAD*                 m_thtPad;
+    D_PAD*                 m_customPad;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( ZoneFiller, ZONE_FILLER_FIXTURE )
+
+
+BOOST_AUTO_TEST_CASE( UpToDateZonesSkipped )
+{
+    BOOST_CHECK( fill().empty() );
+}
+
+
+BOOST_AUTO_TEST_CASE( PadDrillChange )
+{
+    m_thtPad->SetDrillSize( wxSize( Millimeter2iu( 1.2 ), Millimeter2iu( 1.2 ) ) );
+
+    const std::vector<ZONE_CONTAINER*> refilled = fill();
+    BOOST_CHECK( std::find( refilled.begin(), refilled.end(), m_zoneA ) != refilled.end() );
+
+    BOOST_CHECK( fill().empty() );
+}
+
+
+BOOST_AUTO_TEST_CASE( PadPrimitiveChange )
+{
+    m_customPad->DeletePrimitivesList();
+    m_customPad->AddPrimitive( wxPoint( 0, 0 ), wxPoint( 0, Millimeter2iu( 2 ) ),
+                               Millimeter2iu( 0.5 ) );
+    m_customPad->MergePrimitivesAsPolygon();
+
+    const std::vector<ZONE_CONTAINER*> refilled = fill();
+    BOOST_CHECK( std::find( refilled.begin(), refilled.end(), m_zoneA ) != refilled.end() );
+
+    BOOST_CHECK( fill().empty() );
+}
+
+
+/**
+ * The insulated islands of a zone depend on the filled areas of the zones of its net:
+ * the overlapping zones are filled again together
+ */
+BOOST_AUTO_TEST_CASE( SameNetZoneChange )
+{
+    m_zoneB->Outline()->Vertex( 2 ) = VECTOR2I( Millimeter2iu( 32 ), Millimeter2iu( 32 ) );
+
+    const std::vector<ZONE_CONTAINER*> refilled = fill();
+    BOOST_CHECK_EQUAL( refilled.size(), 2 );
+
+    BOOST_CHECK( fill().empty() );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -24,7 +24,9 @@
 #include <qa_utils/utility_program.h>
 
 #include "tools/drc_tool/drc_tool.h"
+#include "tools/pcb_io_benchmark/pcb_io_benchmark.h"
 #include "tools/pcb_parser/pcb_parser_tool.h"
+#include "tools/pns_replay/pns_replay.h"
 #include "tools/polygon_generator/polygon_generator.h"
 #include "tools/polygon_triangulation/polygon_triangulation.h"
 
@@ -36,7 +38,9 @@
  */
 const static std::vector<KI_TEST::UTILITY_PROGRAM*> known_tools = {
     &drc_tool,
+    &pcb_io_benchmark_tool,
     &pcb_parser_tool,
+    &pns_replay_tool,
     &polygon_generator_tool,
     &polygon_triangulation_tool,
 };
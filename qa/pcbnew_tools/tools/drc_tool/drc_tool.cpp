@@ -24,6 +24,9 @@
 #include "drc_tool.h"
 
 #include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <sstream>
 #include <string>
 
 #include <common.h>
@@ -33,8 +36,12 @@
 #include <pcbnew_utils/board_file_utils.h>
 
 // DRC
+#include <drc.h>
 #include <drc/courtyard_overlap.h>
 #include <drc/drc_marker_factory.h>
+#include <drc_item.h>
+#include <zone_fill_cache.h>
+#include <zone_filler.h>
 
 #include <qa_utils/scoped_timer.h>
 #include <qa_utils/stdstream_line_reader.h>
@@ -208,6 +215,240 @@ private:
 };
 
 
+/**
+ * Escape a string to be written as a JSON string value (quotes included)
+ */
+static std::string jsonString( const wxString& aStr )
+{
+    std::ostringstream out;
+
+    out << '"';
+
+    for( char c : std::string( aStr.ToUTF8() ) )
+    {
+        switch( c )
+        {
+        case '"':  out << "\\\""; break;
+        case '\\': out << "\\\\"; break;
+        case '\n': out << "\\n"; break;
+        case '\r': out << "\\r"; break;
+        case '\t': out << "\\t"; break;
+        default:
+            if( (unsigned char) c < 0x20 )
+            {
+                char buf[8];
+                snprintf( buf, sizeof( buf ), "\\u%04x", (unsigned char) c );
+                out << buf;
+            }
+            else
+            {
+                out << c;
+            }
+        }
+    }
+
+    out << '"';
+    return out.str();
+}
+
+
+/**
+ * DRC runner to run the complete DRC of Pcbnew, with the design rules of the board.
+ * This runs the same tests as the DRC dialog (except the zone fill and schematic
+ * checks), without any editor frame.
+ */
+class DRC_FULL_RUNNER
+{
+public:
+    struct OPTIONS
+    {
+        bool        m_refill_zones;
+        bool        m_use_zone_cache;
+        std::string m_json_file;
+    };
+
+    DRC_FULL_RUNNER( const DRC_RUNNER::EXECUTION_CONTEXT& aExecCtx, const OPTIONS& aOptions )
+            : m_exec_context( aExecCtx ), m_options( aOptions )
+    {
+    }
+
+    ~DRC_FULL_RUNNER()
+    {
+        for( MARKER_PCB* marker : m_markers )
+            delete marker;
+    }
+
+    /**
+     * Run the DRC on the board
+     * @return the number of errors found (markers and unconnected items)
+     */
+    int Execute( BOARD& aBoard, const std::string& aBoardName )
+    {
+        if( m_exec_context.m_verbose )
+            std::cout << "Running DRC check: Full DRC" << std::endl;
+
+        DRC_TIMINGS timings;
+
+        // The zone filler and the connectivity tests need an up to date connectivity
+        aBoard.BuildConnectivity();
+
+        if( m_options.m_refill_zones )
+        {
+            DRC_DURATION duration;
+            std::clock_t cpuStart = std::clock();
+            {
+                SCOPED_TIMER<DRC_DURATION> timer( duration );
+                ZONE_FILLER                filler( &aBoard );
+                std::unique_ptr<ZONE_FILL_CACHE> cache;
+
+                if( m_options.m_use_zone_cache && !aBoard.GetFileName().IsEmpty() )
+                {
+                    cache.reset( new ZONE_FILL_CACHE(
+                            ZONE_FILL_CACHE::GetCacheFileName( &aBoard ) ) );
+                    cache->Load();
+                    filler.SetFillCache( cache.get() );
+                }
+
+                filler.Fill( aBoard.Zones() );
+
+                if( cache )
+                {
+                    cache->Prune( &aBoard );
+
+                    if( !cache->Save() )
+                    {
+                        std::cerr << "Cannot write " << cache->GetFileName().ToStdString()
+                                  << std::endl;
+                    }
+                }
+            }
+
+            double cpuTime = double( std::clock() - cpuStart ) / CLOCKS_PER_SEC;
+
+            timings.push_back( { "zone_fill", duration,
+                                 DRC_DURATION( (long long) ( cpuTime * 1e6 ) ) } );
+        }
+
+        DRC drc( &aBoard, EDA_UNITS_T::MILLIMETRES );
+
+        DRC_DURATION duration;
+        {
+            SCOPED_TIMER<DRC_DURATION> timer( duration );
+            drc.RunTestsHeadless( [&]( MARKER_PCB* aMarker ) { m_markers.push_back( aMarker ); },
+                                  &timings );
+        }
+
+        const DRC_LIST& unconnected = drc.GetUnconnectedItems();
+
+        if( m_exec_context.m_print_times )
+            reportTimings( timings, duration );
+
+        if( m_exec_context.m_print_markers )
+            reportMarkers( unconnected );
+
+        if( !m_options.m_json_file.empty() )
+            writeJson( aBoardName, timings, duration, unconnected );
+
+        return m_markers.size() + unconnected.size();
+    }
+
+private:
+    void reportTimings( const DRC_TIMINGS& aTimings, const DRC_DURATION& aTotal ) const
+    {
+        for( const DRC_TEST_TIMING& timing : aTimings )
+        {
+            std::cout << timing.m_testName << ": " << timing.m_wallTime.count() << "us (CPU "
+                      << timing.m_cpuTime.count() << "us)" << std::endl;
+        }
+
+        std::cout << "Took: " << aTotal.count() << "us" << std::endl;
+    }
+
+    void reportMarkers( const DRC_LIST& aUnconnected ) const
+    {
+        std::cout << "DRC markers: " << m_markers.size() << std::endl;
+
+        int index = 0;
+
+        for( const MARKER_PCB* marker : m_markers )
+            std::cout << index++ << ": " << marker->GetReporter().ShowReport( EDA_UNITS_T::MILLIMETRES );
+
+        std::cout << "Unconnected items: " << aUnconnected.size() << std::endl;
+    }
+
+    static void writeJsonItem( std::ostream& aOut, const DRC_ITEM& aItem )
+    {
+        auto writePos = [&]( const wxPoint& aPos )
+        {
+            aOut << "[" << aPos.x << ", " << aPos.y << "]";
+        };
+
+        aOut << "    { \"code\": " << aItem.GetErrorCode()
+             << ", \"description\": " << jsonString( aItem.GetErrorText() )
+             << ", \"main\": " << jsonString( aItem.GetMainText() ) << ", \"main_pos\": ";
+        writePos( aItem.GetPointA() );
+
+        if( aItem.HasSecondItem() )
+        {
+            aOut << ", \"aux\": " << jsonString( aItem.GetAuxiliaryText() ) << ", \"aux_pos\": ";
+            writePos( aItem.GetPointB() );
+        }
+
+        aOut << " }";
+    }
+
+    /**
+     * Write the results as JSON.  Positions are in internal units (nanometres), times
+     * in microseconds.
+     */
+    void writeJson( const std::string& aBoardName, const DRC_TIMINGS& aTimings,
+                    const DRC_DURATION& aTotal, const DRC_LIST& aUnconnected ) const
+    {
+        std::ofstream out( m_options.m_json_file );
+
+        if( !out )
+        {
+            std::cerr << "Cannot write " << m_options.m_json_file << std::endl;
+            return;
+        }
+
+        out << "{\n  \"board\": " << jsonString( aBoardName ) << ",\n";
+
+        out << "  \"markers\": [";
+
+        for( size_t i = 0; i < m_markers.size(); ++i )
+        {
+            out << ( i ? ",\n" : "\n" );
+            writeJsonItem( out, m_markers[i]->GetReporter() );
+        }
+
+        out << "\n  ],\n  \"unconnected\": [";
+
+        for( size_t i = 0; i < aUnconnected.size(); ++i )
+        {
+            out << ( i ? ",\n" : "\n" );
+            writeJsonItem( out, *aUnconnected[i] );
+        }
+
+        out << "\n  ],\n  \"timings\": [";
+
+        for( size_t i = 0; i < aTimings.size(); ++i )
+        {
+            out << ( i ? ",\n" : "\n" );
+            out << "    { \"test\": " << jsonString( aTimings[i].m_testName )
+                << ", \"wall_us\": " << aTimings[i].m_wallTime.count()
+                << ", \"cpu_us\": " << aTimings[i].m_cpuTime.count() << " }";
+        }
+
+        out << "\n  ],\n  \"total_wall_us\": " << aTotal.count() << "\n}\n";
+    }
+
+    const DRC_RUNNER::EXECUTION_CONTEXT m_exec_context;
+    const OPTIONS                       m_options;
+    std::vector<MARKER_PCB*>            m_markers;
+};
+
+
 static const wxCmdLineEntryDesc g_cmdLineDesc[] = {
     {
             wxCMD_LINE_SWITCH,
@@ -241,6 +482,31 @@ static const wxCmdLineEntryDesc g_cmdLineDesc[] = {
             "all-checks",
             _( "perform all available DRC checks" ).mb_str(),
     },
+    {
+            wxCMD_LINE_SWITCH,
+            "f",
+            "full",
+            _( "perform the complete DRC, with the design rules of the board" ).mb_str(),
+    },
+    {
+            wxCMD_LINE_SWITCH,
+            "z",
+            "refill-zones",
+            _( "refill the zones before the complete DRC" ).mb_str(),
+    },
+    {
+            wxCMD_LINE_SWITCH,
+            "Z",
+            "zone-cache",
+            _( "use and update the zone fill cache of the board when refilling zones" ).mb_str(),
+    },
+    {
+            wxCMD_LINE_OPTION,
+            "j",
+            "json",
+            _( "write the complete DRC markers and timings to this JSON file" ).mb_str(),
+            wxCMD_LINE_VAL_STRING,
+    },
     {
             wxCMD_LINE_SWITCH,
             "C",
@@ -270,6 +536,9 @@ static const wxCmdLineEntryDesc g_cmdLineDesc[] = {
 enum PARSER_RET_CODES
 {
     PARSE_FAILED = KI_TEST::RET_CODES::TOOL_SPECIFIC,
+
+    /// The complete DRC found errors
+    DRC_ERRORS_FOUND,
 };
 
 
@@ -315,7 +584,32 @@ int drc_main_func( int argc, char** argv )
 
     const bool all = cl_parser.Found( "all-checks" );
 
-    // Run the DRC on the board
+    int ret = KI_TEST::RET_CODES::OK;
+
+    // The complete DRC uses the design settings of the board: run it first, as the
+    // runners below replace them with their own
+    if( cl_parser.Found( "full" ) )
+    {
+        wxString json_file;
+        cl_parser.Found( "json", &json_file );
+
+        DRC_FULL_RUNNER::OPTIONS options{
+            cl_parser.Found( "refill-zones" ),
+            cl_parser.Found( "zone-cache" ),
+            json_file.ToStdString(),
+        };
+
+        // The zone fill cache lives next to the board file
+        if( !filename.empty() )
+            board->SetFileName( filename );
+
+        DRC_FULL_RUNNER runner( exec_context, options );
+
+        if( runner.Execute( *board, filename.empty() ? "stdin" : filename ) > 0 )
+            ret = PARSER_RET_CODES::DRC_ERRORS_FOUND;
+    }
+
+    // Run the single checks on the board
     if( all || cl_parser.Found( "courtyard-overlap" ) )
     {
         DRC_COURTYARD_OVERLAP_RUNNER runner( exec_context );
@@ -328,7 +622,7 @@ int drc_main_func( int argc, char** argv )
         runner.Execute( *board );
     }
 
-    return KI_TEST::RET_CODES::OK;
+    return ret;
 }
 
 
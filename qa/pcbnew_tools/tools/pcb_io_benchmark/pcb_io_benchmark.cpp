@@ -0,0 +1,548 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file pcb_io_benchmark.cpp
+ * End-to-end benchmarks of the board and footprint library file formats, on a
+ * synthetic board of configurable size or on an existing board file.
+ */
+
+#include "pcb_io_benchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <set>
+
+#include <wx/cmdline.h>
+#include <wx/dir.h>
+#include <wx/filename.h>
+#include <wx/stdpaths.h>
+#include <wx/utils.h>
+
+#include <common.h>
+
+#include <class_board.h>
+#include <class_module.h>
+#include <class_pad.h>
+#include <class_track.h>
+#include <class_zone.h>
+#include <kicad_plugin.h>
+#include <pcb_lexer.h>
+#include <richio.h>
+
+#include <qa_utils/bench_report.h>
+#include <qa_utils/scoped_timer.h>
+
+
+using BENCH_DURATION = std::chrono::microseconds;
+
+
+/**
+ * Size of the synthetic board
+ */
+struct SYNTH_BOARD_SIZE
+{
+    long m_modules;
+    long m_padsPerModule;
+    long m_footprints;      ///< number of distinct footprints used by the modules
+    long m_tracks;          ///< number of track segments; a via is added every 8 segments
+    long m_zones;
+};
+
+
+/**
+ * Build a board with a regular grid of SMD modules, straight tracks and vias
+ * between them, and filled zones.  The content is meaningless but exercises the
+ * same code paths as a real design, and is the same for a given size.
+ */
+static std::unique_ptr<BOARD> makeSyntheticBoard( const SYNTH_BOARD_SIZE& aSize )
+{
+    const int pitch = Millimeter2iu( 10 );
+    const int cols = std::max( 1, (int) std::sqrt( (double) aSize.m_modules ) );
+    const int netCount = std::max( 1L, aSize.m_modules * aSize.m_padsPerModule / 4 );
+
+    std::unique_ptr<BOARD> board( new BOARD() );
+
+    board->SetCopperLayerCount( 2 );
+
+    for( int ii = 1; ii <= netCount; ++ii )
+        board->Add( new NETINFO_ITEM( board.get(), wxString::Format( "Net-%d", ii ), -1 ) );
+
+    auto netFor = [&]( long aIndex ) -> int
+    {
+        return (int) ( aIndex % netCount ) + 1;
+    };
+
+    for( long ii = 0; ii < aSize.m_modules; ++ii )
+    {
+        MODULE* module = new MODULE( board.get() );
+
+        module->SetFPID( LIB_ID( "bench",
+                wxString::Format( "FP_%ld", ii % std::max( 1L, aSize.m_footprints ) ) ) );
+        module->SetReference( wxString::Format( "U%ld", ii + 1 ) );
+        module->SetValue( "BENCH" );
+        module->SetTimeStamp( (timestamp_t) ii + 1 );
+
+        const long rowPads = ( aSize.m_padsPerModule + 1 ) / 2;
+
+        for( long jj = 0; jj < aSize.m_padsPerModule; ++jj )
+        {
+            D_PAD*  pad = new D_PAD( module );
+            wxPoint pos( Millimeter2iu( 0.65 ) * (int) ( jj % rowPads ),
+                         Millimeter2iu( 3.0 ) * (int) ( jj / rowPads ) );
+
+            pad->SetName( wxString::Format( "%ld", jj + 1 ) );
+            pad->SetShape( PAD_SHAPE_RECT );
+            pad->SetAttribute( PAD_ATTRIB_SMD );
+            pad->SetLayerSet( D_PAD::SMDMask() );
+            pad->SetSize( wxSize( Millimeter2iu( 0.4 ), Millimeter2iu( 1.2 ) ) );
+            pad->SetPosition( pos );
+            pad->SetPos0( pos );
+
+            module->Add( pad, ADD_APPEND );
+            pad->SetNetCode( netFor( ii * aSize.m_padsPerModule + jj ) );
+        }
+
+        module->SetPosition( wxPoint( pitch * (int) ( ii % cols ), pitch * (int) ( ii / cols ) ) );
+        board->Add( module, ADD_APPEND );
+    }
+
+    const int trackPitch = Millimeter2iu( 0.5 );
+
+    for( long ii = 0; ii < aSize.m_tracks; ++ii )
+    {
+        TRACK*       track = new TRACK( board.get() );
+        int          y = trackPitch * (int) ( ii / cols );
+        int          x = pitch * (int) ( ii % cols );
+        PCB_LAYER_ID layer = ( ii / 8 ) % 2 ? B_Cu : F_Cu;
+
+        track->SetStart( wxPoint( x, y ) );
+        track->SetEnd( wxPoint( x + pitch / 2, y + pitch / 4 ) );
+        track->SetWidth( Millimeter2iu( 0.25 ) );
+        track->SetLayer( layer );
+        board->Add( track, ADD_APPEND );
+        track->SetNetCode( netFor( ii / 8 ) );
+
+        if( ii % 8 == 7 )
+        {
+            VIA* via = new VIA( board.get() );
+
+            via->SetPosition( track->GetEnd() );
+            via->SetViaType( VIA_THROUGH );
+            via->SetLayerPair( F_Cu, B_Cu );
+            via->SetWidth( Millimeter2iu( 0.6 ) );
+            via->SetDrill( Millimeter2iu( 0.3 ) );
+            board->Add( via, ADD_APPEND );
+            via->SetNetCode( netFor( ii / 8 ) );
+        }
+    }
+
+    const int zoneSize = pitch * 3;
+
+    for( long ii = 0; ii < aSize.m_zones; ++ii )
+    {
+        ZONE_CONTAINER* zone = new ZONE_CONTAINER( board.get() );
+        int             x = zoneSize * (int) ( ii % cols );
+        int             y = zoneSize * (int) ( ii / cols );
+
+        zone->SetLayer( ii % 2 ? B_Cu : F_Cu );
+        zone->Outline()->NewOutline();
+
+        // A sawtooth outline, to get zones with a realistic vertex count
+        for( int kk = 0; kk <= 32; ++kk )
+            zone->Outline()->Append( x + zoneSize * kk / 32, y + ( kk % 2 ) * pitch / 8 );
+
+        zone->Outline()->Append( x + zoneSize, y + zoneSize );
+        zone->Outline()->Append( x, y + zoneSize );
+
+        SHAPE_POLY_SET fill = *zone->Outline();
+        zone->SetFilledPolysList( fill );
+        zone->SetIsFilled( true );
+
+        board->Add( zone, ADD_APPEND );
+        zone->SetNetCode( netFor( ii ) );
+    }
+
+    return board;
+}
+
+
+/**
+ * @return the number of top level items of a board (modules, tracks, vias and zones),
+ * the "items" of the board benchmarks
+ */
+static size_t countItems( BOARD* aBoard )
+{
+    return aBoard->m_Modules.GetCount() + aBoard->m_Track.GetCount() + aBoard->GetAreaCount();
+}
+
+
+/**
+ * @return the size of a file, or the total size of the files of a directory
+ */
+static size_t pathSize( const wxString& aPath )
+{
+    if( !wxDirExists( aPath ) )
+        return (size_t) wxFileName::GetSize( aPath ).GetValue();
+
+    wxArrayString files;
+    size_t        size = 0;
+
+    wxDir::GetAllFiles( aPath, &files );
+
+    for( const wxString& file : files )
+        size += (size_t) wxFileName::GetSize( file ).GetValue();
+
+    return size;
+}
+
+
+/**
+ * A benchmark of one of the file format operations
+ */
+struct PCB_IO_BENCHMARK
+{
+    char     m_triggerChar;
+    wxString m_name;
+
+    /// Run the operation once, and return the number of items processed
+    std::function<size_t()> m_func;
+};
+
+
+static void runBenchmark( const PCB_IO_BENCHMARK& aBench, const wxString& aSource, size_t aBytes,
+        unsigned aReps, std::vector<KI_TEST::BENCH_RESULT>& aResults )
+{
+    KI_TEST::BENCH_RESULT result;
+
+    result.m_name = aBench.m_name.ToStdString();
+    result.m_source = aSource.ToStdString();
+    result.m_reps = aReps;
+    result.m_bytes = aBytes;
+    result.m_items = 0;
+
+    {
+        SCOPED_TIMER<BENCH_DURATION> timer( result.m_duration );
+
+        for( unsigned ii = 0; ii < aReps; ++ii )
+            result.m_items = aBench.m_func();
+    }
+
+    result.m_peakRss = KI_TEST::GetPeakRss();
+    aResults.push_back( result );
+}
+
+
+static const wxCmdLineEntryDesc g_cmdLineDesc[] = {
+    {
+            wxCMD_LINE_SWITCH,
+            "h",
+            "help",
+            _( "displays help on the command line parameters" ).mb_str(),
+            wxCMD_LINE_VAL_NONE,
+            wxCMD_LINE_OPTION_HELP,
+    },
+    {
+            wxCMD_LINE_OPTION,
+            "b",
+            "benchmarks",
+            _( "benchmarks to run (default: all): s = save, l = load, t = tokenise, "
+               "f = footprint library enumeration, w = board item walk" ).mb_str(),
+            wxCMD_LINE_VAL_STRING,
+    },
+    {
+            wxCMD_LINE_OPTION,
+            "r",
+            "reps",
+            _( "repetitions of each benchmark (default: 5)" ).mb_str(),
+            wxCMD_LINE_VAL_NUMBER,
+    },
+    {
+            wxCMD_LINE_OPTION,
+            "m",
+            "modules",
+            _( "modules of the synthetic board (default: 1000)" ).mb_str(),
+            wxCMD_LINE_VAL_NUMBER,
+    },
+    {
+            wxCMD_LINE_OPTION,
+            "p",
+            "pads",
+            _( "pads per module of the synthetic board (default: 16)" ).mb_str(),
+            wxCMD_LINE_VAL_NUMBER,
+    },
+    {
+            wxCMD_LINE_OPTION,
+            "F",
+            "footprints",
+            _( "distinct footprints of the synthetic board (default: 100)" ).mb_str(),
+            wxCMD_LINE_VAL_NUMBER,
+    },
+    {
+            wxCMD_LINE_OPTION,
+            "t",
+            "tracks",
+            _( "track segments of the synthetic board (default: 20000)" ).mb_str(),
+            wxCMD_LINE_VAL_NUMBER,
+    },
+    {
+            wxCMD_LINE_OPTION,
+            "z",
+            "zones",
+            _( "zones of the synthetic board (default: 20)" ).mb_str(),
+            wxCMD_LINE_VAL_NUMBER,
+    },
+    {
+            wxCMD_LINE_OPTION,
+            "o",
+            "format",
+            _( "report format: text, csv or json (default: text)" ).mb_str(),
+            wxCMD_LINE_VAL_STRING,
+    },
+    {
+            wxCMD_LINE_SWITCH,
+            "k",
+            "keep",
+            _( "keep the files written by the benchmarks" ).mb_str(),
+    },
+    {
+            wxCMD_LINE_PARAM,
+            nullptr,
+            nullptr,
+            _( "board file to benchmark instead of the synthetic board" ).mb_str(),
+            wxCMD_LINE_VAL_STRING,
+            wxCMD_LINE_PARAM_OPTIONAL,
+    },
+    { wxCMD_LINE_NONE }
+};
+
+
+enum BENCHMARK_RET_CODES
+{
+    IO_FAILED = KI_TEST::RET_CODES::TOOL_SPECIFIC,
+};
+
+
+int pcb_io_benchmark_main_func( int argc, char** argv )
+{
+    wxMessageOutput::Set( new wxMessageOutputStderr );
+    wxCmdLineParser cl_parser( argc, argv );
+    cl_parser.SetDesc( g_cmdLineDesc );
+    cl_parser.AddUsageText(
+            _( "This program times the loading and saving of a board, the tokenisation of "
+               "the board file and the enumeration of a footprint library made from the "
+               "footprints of the board, and the walk over the board items.  The board is "
+               "either synthetic, of a given size, or read from the given file." ) );
+
+    int cmd_parsed_ok = cl_parser.Parse();
+    if( cmd_parsed_ok != 0 )
+    {
+        // Help and invalid input both stop here
+        return ( cmd_parsed_ok == -1 ) ? KI_TEST::RET_CODES::OK : KI_TEST::RET_CODES::BAD_CMDLINE;
+    }
+
+    long             reps = 5;
+    SYNTH_BOARD_SIZE size = { 1000, 16, 100, 20000, 20 };
+    wxString         benchmarks = "sltfw";
+    wxString         formatName = "text";
+
+    cl_parser.Found( "reps", &reps );
+    cl_parser.Found( "modules", &size.m_modules );
+    cl_parser.Found( "pads", &size.m_padsPerModule );
+    cl_parser.Found( "footprints", &size.m_footprints );
+    cl_parser.Found( "tracks", &size.m_tracks );
+    cl_parser.Found( "zones", &size.m_zones );
+    cl_parser.Found( "benchmarks", &benchmarks );
+    cl_parser.Found( "format", &formatName );
+
+    KI_TEST::BENCH_FORMAT format;
+
+    if( reps < 1 || size.m_modules < 0 || size.m_padsPerModule < 0 || size.m_tracks < 0
+            || size.m_zones < 0 || !KI_TEST::ParseBenchFormat( formatName.ToStdString(), format ) )
+    {
+        cl_parser.Usage();
+        return KI_TEST::RET_CODES::BAD_CMDLINE;
+    }
+
+    const bool keep = cl_parser.Found( "keep" );
+
+    wxFileName workDir( wxStandardPaths::Get().GetTempDir(), wxEmptyString );
+    workDir.AppendDir( wxString::Format( "pcb_io_benchmark_%lu", wxGetProcessId() ) );
+
+    const wxString boardFile = workDir.GetPathWithSep() + "bench.kicad_pcb";
+    const wxString libPath = workDir.GetPathWithSep() + "bench.pretty";
+
+    std::unique_ptr<BOARD>             board;
+    wxString                           source;
+    std::vector<KI_TEST::BENCH_RESULT> results;
+
+    try
+    {
+        if( cl_parser.GetParamCount() )
+        {
+            source = cl_parser.GetParam( 0 );
+
+            PCB_IO io;
+            board.reset( io.Load( source, nullptr ) );
+        }
+        else
+        {
+            source = wxString::Format( "synthetic:%ld modules,%ld pads,%ld tracks,%ld zones",
+                    size.m_modules, size.m_padsPerModule, size.m_tracks, size.m_zones );
+            board = makeSyntheticBoard( size );
+        }
+
+        if( !workDir.Mkdir( wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL ) )
+            THROW_IO_ERROR( wxString::Format( "cannot create directory \"%s\"",
+                    workDir.GetPath() ) );
+
+        // The board file is needed by all the benchmarks but the save one
+        PCB_IO( CTL_FOR_BOARD ).Save( boardFile, board.get() );
+
+        const PCB_IO_BENCHMARK saveBench = { 's', "PCB_IO::Save", [&]()
+        {
+            PCB_IO io;
+            io.Save( boardFile, board.get() );
+            return countItems( board.get() );
+        } };
+
+        const PCB_IO_BENCHMARK loadBench = { 'l', "PCB_IO::Load", [&]()
+        {
+            PCB_IO                 io;
+            std::unique_ptr<BOARD> loaded( io.Load( boardFile, nullptr ) );
+            return countItems( loaded.get() );
+        } };
+
+        const PCB_IO_BENCHMARK tokeniseBench = { 't', "PCB_LEXER tokenisation", [&]()
+        {
+            MAPPED_FILE_LINE_READER reader( boardFile );
+            PCB_LEXER               lexer( &reader );
+            size_t                  tokens = 0;
+
+            while( (int) lexer.NextTok() != DSN_EOF )
+                ++tokens;
+
+            return tokens;
+        } };
+
+        const PCB_IO_BENCHMARK enumerateBench = { 'f', "PCB_IO::FootprintEnumerate", [&]()
+        {
+            // A new plugin has no cache: the library is fully read each time
+            PCB_IO        io( CTL_FOR_LIBRARY );
+            wxArrayString names;
+
+            io.FootprintEnumerate( names, libPath );
+            return (size_t) names.GetCount();
+        } };
+
+        // Range iteration over the board lists, the walk of most board-wide passes
+        const PCB_IO_BENCHMARK walkBench = { 'w', "BOARD item walk", [&]()
+        {
+            size_t items = 0;
+            int    netCodes = 0;
+
+            for( TRACK* track : board->Tracks() )
+            {
+                netCodes |= track->GetNetCode();
+                ++items;
+            }
+
+            for( MODULE* module : board->Modules() )
+            {
+                for( D_PAD* pad : module->Pads() )
+                {
+                    netCodes |= pad->GetNetCode();
+                    ++items;
+                }
+
+                ++items;
+            }
+
+            for( BOARD_ITEM* item : board->Drawings() )
+            {
+                netCodes |= item->GetLayer();
+                ++items;
+            }
+
+            // Keeps the item loads from being optimized out
+            return netCodes < 0 ? 0 : items;
+        } };
+
+        for( const PCB_IO_BENCHMARK* bench : { &saveBench, &loadBench, &tokeniseBench } )
+        {
+            if( benchmarks.Contains( bench->m_triggerChar ) )
+                runBenchmark( *bench, source, pathSize( boardFile ), reps, results );
+        }
+
+        if( benchmarks.Contains( walkBench.m_triggerChar ) )
+            runBenchmark( walkBench, source, 0, reps, results );
+
+        if( benchmarks.Contains( enumerateBench.m_triggerChar ) )
+        {
+            PCB_IO             io( CTL_FOR_LIBRARY );
+            std::set<wxString> saved;
+
+            io.FootprintLibCreate( libPath );
+
+            for( MODULE* module : board->Modules() )
+            {
+                if( saved.insert( wxString( module->GetFPID().GetLibItemName() ) ).second )
+                    io.FootprintSave( libPath, module );
+            }
+
+            runBenchmark( enumerateBench, source, pathSize( libPath ), reps, results );
+        }
+    }
+    catch( const IO_ERROR& ioe )
+    {
+        std::cerr << ioe.What() << std::endl;
+
+        if( !keep )
+            workDir.Rmdir( wxPATH_RMDIR_RECURSIVE );
+
+        return BENCHMARK_RET_CODES::IO_FAILED;
+    }
+
+    if( keep )
+        std::cerr << "Files kept in " << workDir.GetPath() << std::endl;
+    else
+        workDir.Rmdir( wxPATH_RMDIR_RECURSIVE );
+
+    KI_TEST::PrintBenchResults( std::cout, results, format );
+
+    return KI_TEST::RET_CODES::OK;
+}
+
+
+/*
+ * Define the tool interface
+ */
+KI_TEST::UTILITY_PROGRAM pcb_io_benchmark_tool = {
+    "pcb_io_benchmark",
+    "Benchmark the loading and saving of PCB files and footprint libraries",
+    pcb_io_benchmark_main_func,
+};
@@ -0,0 +1,518 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file pns_replay.cpp
+ * Replays the interactive router sessions recorded on a board (see the RecordRouterSessions
+ * advanced config) through PNS::ROUTER, without the editor, and reports the latency of
+ * the router moves.
+ */
+
+#include "pns_replay.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <wx/cmdline.h>
+#include <wx/filename.h>
+
+#include <pcbnew_utils/board_file_utils.h>
+
+#include <class_board.h>
+
+#include <pns_debug_decorator.h>
+#include <pns_kicad_iface.h>
+#include <pns_logger.h>
+#include <pns_router.h>
+
+#include <qa_utils/bench_report.h>
+#include <qa_utils/scoped_timer.h>
+
+
+using PNS::LOGGER;
+
+
+/**
+ * A router interface with no view and no board commits: the routed items are only
+ * committed to the router world, so the board stays as loaded and every replay starts
+ * from the same state.
+ */
+class REPLAY_IFACE : public PNS_KICAD_IFACE
+{
+public:
+    void EraseView() override {}
+    void HideItem( PNS::ITEM* aItem ) override {}
+    void DisplayItem( const PNS::ITEM* aItem, int aColor = 0, int aClearance = 0,
+                      bool aEdit = false ) override {}
+    void AddItem( PNS::ITEM* aItem ) override {}
+    void RemoveItem( PNS::ITEM* aItem ) override {}
+    void Commit() override {}
+    void UpdateNet( int aNetCode ) override {}
+
+    PNS::DEBUG_DECORATOR* GetDebugDecorator() override
+    {
+        return &m_decorator;
+    }
+
+private:
+    PNS::DEBUG_DECORATOR m_decorator;    ///< the algorithms expect one, the base does nothing
+};
+
+
+/**
+ * The moves of the sessions of one kind, over all the repetitions
+ */
+struct REPLAY_STATS
+{
+    std::vector<double> m_latencies;    ///< of each move, in microseconds
+    long long           m_iterations = 0;
+    unsigned            m_sessions = 0;
+    unsigned            m_failedStarts = 0;
+};
+
+
+/**
+ * Finds the item passed to the router in a recorded call, from its kind, net, layers
+ * and anchors.
+ * @return the item, or nullptr if none was passed or it is not found
+ */
+static PNS::ITEM* findItem( PNS::ROUTER& aRouter, const LOGGER::EVENT_ENTRY& aEvent )
+{
+    if( !aEvent.m_itemKind )
+        return nullptr;
+
+    auto matches = [&]( PNS::ITEM* aItem )
+    {
+        return aItem->Kind() == aEvent.m_itemKind && aItem->Net() == aEvent.m_itemNet
+               && aItem->Layers().Start() == aEvent.m_itemLayerStart
+               && aItem->Layers().End() == aEvent.m_itemLayerEnd
+               && aItem->AnchorCount() > 0
+               && aItem->Anchor( 0 ) == aEvent.m_itemAnchorA
+               && aItem->Anchor( aItem->AnchorCount() - 1 ) == aEvent.m_itemAnchorB;
+    };
+
+    // The anchor is on the item for tracks and vias, the cursor was on it for the others
+    for( const VECTOR2I& p : { aEvent.m_itemAnchorA, aEvent.m_p } )
+    {
+        PNS::ITEM_SET candidates = aRouter.QueryHoverItems( p );
+
+        for( PNS::ITEM* item : candidates.Items() )
+        {
+            if( matches( item ) )
+                return item;
+        }
+    }
+
+    return nullptr;
+}
+
+
+/**
+ * @return true if the session does not begin with its start call, and cannot be replayed
+ */
+static bool isTruncated( const LOGGER::SESSION& aSession )
+{
+    if( aSession.m_events.empty() )
+        return true;
+
+    LOGGER::EVENT_TYPE type = aSession.m_events.front().m_type;
+
+    return type != LOGGER::EVT_START_ROUTE && type != LOGGER::EVT_START_DRAG;
+}
+
+
+static std::string sessionKind( const LOGGER::SESSION& aSession )
+{
+    if( aSession.m_events.front().m_type == LOGGER::EVT_START_DRAG )
+        return "drag";
+
+    switch( aSession.m_routerMode )
+    {
+    case PNS::PNS_MODE_ROUTE_SINGLE:    return "route";
+    case PNS::PNS_MODE_ROUTE_DIFF_PAIR: return "diff pair";
+    default:                            return "tune";
+    }
+}
+
+
+/**
+ * Replays a session on the current router world.  The routes fixed by the session are
+ * committed to the world, as they were in the editor.
+ * @param aRoutingMode is the PNS_MODE to replay the session with, or -1 for the recorded one
+ * @param aSpeculative enables the speculative walkaround
+ */
+static void replaySession( PNS::ROUTER& aRouter, BOARD& aBoard, const LOGGER::SESSION& aSession,
+        int aRoutingMode, bool aSpeculative, REPLAY_STATS& aStats )
+{
+    const LOGGER::EVENT_ENTRY& start = aSession.m_events.front();
+
+    PNS::ROUTING_SETTINGS settings;
+
+    settings.SetMode( (PNS::PNS_MODE) ( aRoutingMode >= 0 ? aRoutingMode
+                                                           : aSession.m_routingMode ) );
+    settings.SetOptimizerEffort( (PNS::PNS_OPTIMIZATION_EFFORT) aSession.m_optimizerEffort );
+    settings.SetSpeculativeRouting( aSpeculative );
+
+    aRouter.SetMode( (PNS::ROUTER_MODE) aSession.m_routerMode );
+    aRouter.LoadSettings( settings );
+
+    PNS::ITEM*          startItem = findItem( aRouter, start );
+    PNS::SIZES_SETTINGS sizes( aRouter.Sizes() );
+
+    sizes.Init( &aBoard, startItem );
+    sizes.ClearLayerPairs();
+    sizes.AddLayerPair( aSession.m_layerTop, aSession.m_layerBottom );
+    sizes.SetTrackWidth( aSession.m_trackWidth );
+    sizes.SetViaDiameter( aSession.m_viaDiameter );
+    sizes.SetViaDrill( aSession.m_viaDrill );
+    sizes.SetViaType( (VIATYPE_T) aSession.m_viaType );
+    sizes.SetDiffPairWidth( aSession.m_diffPairWidth );
+    sizes.SetDiffPairGap( aSession.m_diffPairGap );
+    aRouter.UpdateSizes( sizes );
+
+    aStats.m_sessions++;
+
+    bool started = start.m_type == LOGGER::EVT_START_DRAG
+                           ? aRouter.StartDragging( start.m_p, startItem, start.m_arg )
+                           : aRouter.StartRouting( start.m_p, startItem, start.m_arg );
+
+    if( !started )
+    {
+        aStats.m_failedStarts++;
+        return;
+    }
+
+    for( size_t ii = 1; ii < aSession.m_events.size(); ++ii )
+    {
+        const LOGGER::EVENT_ENTRY& evt = aSession.m_events[ii];
+
+        switch( evt.m_type )
+        {
+        case LOGGER::EVT_MOVE:
+        {
+            // The item lookup stands for the hit test of the editor, it is not timed
+            PNS::ITEM*                endItem = findItem( aRouter, evt );
+            long long                 iterations = aRouter.IterationCount();
+            std::chrono::microseconds latency;
+
+            {
+                SCOPED_TIMER<std::chrono::microseconds> timer( latency );
+                aRouter.Move( evt.m_p, endItem );
+            }
+
+            aStats.m_latencies.push_back( (double) latency.count() );
+            aStats.m_iterations += aRouter.IterationCount() - iterations;
+            break;
+        }
+
+        case LOGGER::EVT_FIX:
+            aRouter.FixRoute( evt.m_p, findItem( aRouter, evt ), evt.m_arg != 0 );
+            break;
+
+        case LOGGER::EVT_SWITCH_LAYER:
+            aRouter.SwitchLayer( evt.m_arg );
+            break;
+
+        case LOGGER::EVT_TOGGLE_VIA:
+            aRouter.ToggleViaPlacement();
+            break;
+
+        case LOGGER::EVT_FLIP_POSTURE:
+            aRouter.FlipPosture();
+            break;
+
+        case LOGGER::EVT_STOP:
+            aRouter.StopRouting();
+            break;
+
+        default:
+            break;
+        }
+
+        if( !aRouter.RoutingInProgress() )
+            break;
+    }
+
+    aRouter.StopRouting();
+}
+
+
+/**
+ * @return the nearest-rank percentile aP (0 to 1) of sorted values
+ */
+static double percentile( const std::vector<double>& aSorted, double aP )
+{
+    if( aSorted.empty() )
+        return 0.0;
+
+    size_t rank = (size_t) std::ceil( aP * aSorted.size() );
+
+    return aSorted[std::min( std::max<size_t>( rank, 1 ), aSorted.size() ) - 1];
+}
+
+
+static KI_TEST::BENCH_RESULT makeResult( const std::string& aName, const std::string& aSource,
+        unsigned aReps, REPLAY_STATS& aStats )
+{
+    KI_TEST::BENCH_RESULT result;
+    std::vector<double>&  latencies = aStats.m_latencies;
+    double                total = 0.0;
+
+    std::sort( latencies.begin(), latencies.end() );
+
+    for( double latency : latencies )
+        total += latency;
+
+    const double moves = std::max<double>( latencies.size(), 1 );
+
+    result.m_name = aName;
+    result.m_source = aSource;
+    result.m_reps = aReps;
+    result.m_bytes = 0;
+    result.m_items = latencies.size() / aReps;
+    result.m_duration = std::chrono::microseconds( (long long) total );
+    result.m_peakRss = KI_TEST::GetPeakRss();
+
+    result.m_metrics = {
+        { "sessions", (double) aStats.m_sessions / aReps },
+        { "failed_starts", (double) aStats.m_failedStarts / aReps },
+        { "p50_us", percentile( latencies, 0.50 ) },
+        { "p90_us", percentile( latencies, 0.90 ) },
+        { "p99_us", percentile( latencies, 0.99 ) },
+        { "max_us", latencies.empty() ? 0.0 : latencies.back() },
+        { "iterations", (double) aStats.m_iterations / aReps },
+        { "iterations_per_move", aStats.m_iterations / moves },
+    };
+
+    return result;
+}
+
+
+/**
+ * A routing mode the sessions can be replayed with
+ */
+struct REPLAY_MODE
+{
+    char        m_triggerChar;
+    std::string m_name;
+    int         m_routingMode;      ///< PNS_MODE, -1 for the recorded one
+};
+
+
+static const std::vector<REPLAY_MODE> replayModes = {
+    { 'r', "recorded", -1 },
+    { 'w', "walkaround", PNS::RM_Walkaround },
+    { 's', "shove", PNS::RM_Shove },
+    { 'm', "mark obstacles", PNS::RM_MarkObstacles },
+};
+
+
+static const wxCmdLineEntryDesc g_cmdLineDesc[] = {
+    {
+            wxCMD_LINE_SWITCH,
+            "h",
+            "help",
+            _( "displays help on the command line parameters" ).mb_str(),
+            wxCMD_LINE_VAL_NONE,
+            wxCMD_LINE_OPTION_HELP,
+    },
+    {
+            wxCMD_LINE_OPTION,
+            "m",
+            "modes",
+            _( "routing modes to replay the sessions with (default: r): r = as recorded, "
+               "w = walkaround, s = shove, m = mark obstacles" ).mb_str(),
+            wxCMD_LINE_VAL_STRING,
+    },
+    {
+            wxCMD_LINE_SWITCH,
+            "p",
+            "speculative",
+            _( "evaluate both walkaround directions concurrently" ).mb_str(),
+            wxCMD_LINE_VAL_NONE,
+    },
+    {
+            wxCMD_LINE_OPTION,
+            "r",
+            "reps",
+            _( "repetitions of the replay (default: 1)" ).mb_str(),
+            wxCMD_LINE_VAL_NUMBER,
+    },
+    {
+            wxCMD_LINE_OPTION,
+            "o",
+            "format",
+            _( "report format: text, csv or json (default: text)" ).mb_str(),
+            wxCMD_LINE_VAL_STRING,
+    },
+    {
+            wxCMD_LINE_PARAM,
+            nullptr,
+            nullptr,
+            _( "board file" ).mb_str(),
+            wxCMD_LINE_VAL_STRING,
+    },
+    {
+            wxCMD_LINE_PARAM,
+            nullptr,
+            nullptr,
+            _( "session file (default: the board file with the .pns_sessions extension)" )
+                    .mb_str(),
+            wxCMD_LINE_VAL_STRING,
+            wxCMD_LINE_PARAM_OPTIONAL,
+    },
+    { wxCMD_LINE_NONE }
+};
+
+
+enum PNS_REPLAY_RET_CODES
+{
+    LOAD_FAILED = KI_TEST::RET_CODES::TOOL_SPECIFIC,
+    NO_SESSIONS,
+};
+
+
+int pns_replay_main_func( int argc, char** argv )
+{
+    wxMessageOutput::Set( new wxMessageOutputStderr );
+    wxCmdLineParser cl_parser( argc, argv );
+    cl_parser.SetDesc( g_cmdLineDesc );
+    cl_parser.AddUsageText(
+            _( "This program replays the interactive router sessions recorded on a board, "
+               "and reports the latency percentiles and the shove and walkaround iterations "
+               "of the router moves, for each kind of session (route, diff pair, tune, "
+               "drag).  The board must be the one the sessions were recorded on, as saved "
+               "before the first session." ) );
+
+    int cmd_parsed_ok = cl_parser.Parse();
+    if( cmd_parsed_ok != 0 )
+    {
+        // Help and invalid input both stop here
+        return ( cmd_parsed_ok == -1 ) ? KI_TEST::RET_CODES::OK : KI_TEST::RET_CODES::BAD_CMDLINE;
+    }
+
+    long     reps = 1;
+    wxString modes = "r";
+    wxString formatName = "text";
+
+    cl_parser.Found( "reps", &reps );
+    cl_parser.Found( "modes", &modes );
+    cl_parser.Found( "format", &formatName );
+
+    const bool speculative = cl_parser.Found( "speculative" );
+
+    KI_TEST::BENCH_FORMAT format;
+
+    if( reps < 1 || !KI_TEST::ParseBenchFormat( formatName.ToStdString(), format ) )
+    {
+        cl_parser.Usage();
+        return KI_TEST::RET_CODES::BAD_CMDLINE;
+    }
+
+    const wxString boardFile = cl_parser.GetParam( 0 );
+    wxFileName     sessionFile( boardFile );
+
+    sessionFile.SetExt( "pns_sessions" );
+
+    if( cl_parser.GetParamCount() > 1 )
+        sessionFile.Assign( cl_parser.GetParam( 1 ) );
+
+    std::vector<LOGGER::SESSION> sessions;
+
+    if( !LOGGER::LoadSessions( sessionFile.GetFullPath().ToStdString(), sessions ) )
+    {
+        std::cerr << "Cannot read the sessions of " << sessionFile.GetFullPath() << std::endl;
+        return LOAD_FAILED;
+    }
+
+    sessions.erase( std::remove_if( sessions.begin(), sessions.end(), isTruncated ),
+            sessions.end() );
+
+    if( sessions.empty() )
+    {
+        std::cerr << "No session in " << sessionFile.GetFullPath() << std::endl;
+        return NO_SESSIONS;
+    }
+
+    std::unique_ptr<BOARD> board = KI_TEST::ReadBoardFromFileOrStream( boardFile.ToStdString() );
+
+    if( !board )
+        return LOAD_FAILED;
+
+    REPLAY_IFACE iface;
+    PNS::ROUTER  router;
+
+    iface.SetBoard( board.get() );
+    router.SetInterface( &iface );
+
+    std::vector<KI_TEST::BENCH_RESULT> results;
+
+    for( const REPLAY_MODE& mode : replayModes )
+    {
+        if( modes.Find( mode.m_triggerChar ) == wxNOT_FOUND )
+            continue;
+
+        std::map<std::string, REPLAY_STATS> stats;
+
+        for( long rep = 0; rep < reps; ++rep )
+        {
+            // The sessions build on each other: each replay starts from the loaded board
+            router.ClearWorld();
+            router.SyncWorld();
+
+            for( const LOGGER::SESSION& session : sessions )
+            {
+                replaySession( router, *board, session, mode.m_routingMode, speculative,
+                               stats[sessionKind( session )] );
+            }
+        }
+
+        for( auto& kind : stats )
+        {
+            std::string name = mode.m_name + ( speculative ? " (speculative)/" : "/" );
+
+            results.push_back( makeResult( name + kind.first,
+                    sessionFile.GetFullName().ToStdString(), (unsigned) reps, kind.second ) );
+        }
+    }
+
+    KI_TEST::PrintBenchResults( std::cout, results, format );
+
+    return KI_TEST::RET_CODES::OK;
+}
+
+
+/*
+ * Define the tool interface
+ */
+KI_TEST::UTILITY_PROGRAM pns_replay_tool = {
+    "pns_replay",
+    "Replay recorded interactive router sessions and report their latency",
+    pns_replay_main_func,
+};
@@ -33,10 +33,19 @@
 #include <class_zone.h>
 #include <profile.h>
 
+#include <qa_utils/bench_report.h>
+
+#include <wx/cmdline.h>
+
+#include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
 #include <thread>
 #include <unordered_set>
 #include <utility>
+#include <vector>
 
 
 void unfracture( SHAPE_POLY_SET::POLYGON* aPoly, SHAPE_POLY_SET::POLYGON* aResult )
@@ -206,19 +215,11 @@ enum POLY_TRI_RET_CODES
 };
 
 
-int polygon_triangulation_main( int argc, char *argv[] )
+/**
+ * Triangulate all the zones of the board, one zone per thread
+ */
+static void triangulateZones( BOARD& aBoard )
 {
-    std::string filename;
-
-    if( argc > 1 )
-        filename = argv[1];
-
-    auto brd = KI_TEST::ReadBoardFromFileOrStream( filename );
-
-    if( !brd )
-        return POLY_TRI_RET_CODES::LOAD_FAILED;
-
-
     PROF_COUNTER cnt( "allBoard" );
 
 
@@ -228,18 +229,17 @@ int polygon_triangulation_main( int argc, char *argv[] )
     size_t parallelThreadCount = std::max<size_t>( std::thread::hardware_concurrency(), 2 );
     for( size_t ii = 0; ii < parallelThreadCount; ++ii )
     {
-        std::thread t = std::thread( [&brd, &zonesToTriangulate, &threadsFinished]() {
+        std::thread t = std::thread( [&aBoard, &zonesToTriangulate, &threadsFinished]() {
             for( size_t areaId = zonesToTriangulate.fetch_add( 1 );
-                        areaId < static_cast<size_t>( brd->GetAreaCount() );
+                        areaId < static_cast<size_t>( aBoard.GetAreaCount() );
                         areaId = zonesToTriangulate.fetch_add( 1 ) )
             {
-                auto zone = brd->GetArea( areaId );
+                auto zone = aBoard.GetArea( areaId );
                 SHAPE_POLY_SET poly = zone->GetFilledPolysList();
 
                 poly.CacheTriangulation();
 
                 (void) poly;
-                printf("zone %zu/%d\n", ( areaId + 1 ), brd->GetAreaCount() );
 #if 0
                 PROF_COUNTER unfrac("unfrac");
                 poly.Unfracture( SHAPE_POLY_SET::PM_FAST );
@@ -265,6 +265,195 @@ int polygon_triangulation_main( int argc, char *argv[] )
         std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
 
     cnt.Show();
+}
+
+
+/**
+ * Time the triangulation of the filled areas of the zones, one zone after the other, with
+ * 1, 2, 4... up to aMaxThreads threads triangulating the outlines of each zone.
+ */
+static void runScalingBenchmark( BOARD& aBoard, const std::string& aSource, size_t aMaxThreads,
+        unsigned aReps, bool aLargestOnly, std::vector<KI_TEST::BENCH_RESULT>& aResults )
+{
+    std::vector<const SHAPE_POLY_SET*> zonePolys;
+
+    for( int areaId = 0; areaId < aBoard.GetAreaCount(); ++areaId )
+    {
+        const SHAPE_POLY_SET& poly = aBoard.GetArea( areaId )->GetFilledPolysList();
+
+        if( poly.OutlineCount() )
+            zonePolys.push_back( &poly );
+    }
+
+    if( aLargestOnly && !zonePolys.empty() )
+    {
+        auto largest = std::max_element( zonePolys.begin(), zonePolys.end(),
+                []( const SHAPE_POLY_SET* aA, const SHAPE_POLY_SET* aB )
+                {
+                    return aA->TotalVertices() < aB->TotalVertices();
+                } );
+
+        zonePolys = { *largest };
+    }
+
+    std::vector<size_t> threadCounts;
+
+    for( size_t threads = 1; threads < aMaxThreads; threads *= 2 )
+        threadCounts.push_back( threads );
+
+    threadCounts.push_back( aMaxThreads );
+
+    for( size_t threads : threadCounts )
+    {
+        KI_TEST::BENCH_RESULT result;
+
+        result.m_name = "CacheTriangulation, " + std::to_string( threads ) + " thread(s)";
+        result.m_source = aSource;
+        result.m_reps = aReps;
+        result.m_bytes = 0;
+        result.m_items = 0;
+        result.m_duration = std::chrono::microseconds( 0 );
+
+        for( unsigned ii = 0; ii < aReps; ++ii )
+        {
+            // The copies are made before starting the clock: only the triangulation is timed
+            std::vector<SHAPE_POLY_SET> polys;
+
+            for( const SHAPE_POLY_SET* poly : zonePolys )
+                polys.push_back( *poly );
+
+            const auto start = std::chrono::steady_clock::now();
+
+            for( SHAPE_POLY_SET& poly : polys )
+                poly.CacheTriangulation( threads );
+
+            result.m_duration += std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - start );
+
+            result.m_items = 0;
+
+            for( const SHAPE_POLY_SET& poly : polys )
+                result.m_items += poly.TriangulatedPolyCount();
+        }
+
+        result.m_peakRss = KI_TEST::GetPeakRss();
+        aResults.push_back( result );
+    }
+}
+
+
+static const wxCmdLineEntryDesc g_cmdLineDesc[] = {
+    {
+            wxCMD_LINE_SWITCH,
+            "h",
+            "help",
+            _( "displays help on the command line parameters" ).mb_str(),
+            wxCMD_LINE_VAL_NONE,
+            wxCMD_LINE_OPTION_HELP,
+    },
+    {
+            wxCMD_LINE_SWITCH,
+            "s",
+            "scaling",
+            _( "time the triangulation of each zone with an increasing number of threads" )
+                    .mb_str(),
+    },
+    {
+            wxCMD_LINE_OPTION,
+            "j",
+            "threads",
+            _( "maximum number of threads of the scaling benchmark (default: all the "
+               "hardware threads)" ).mb_str(),
+            wxCMD_LINE_VAL_NUMBER,
+    },
+    {
+            wxCMD_LINE_OPTION,
+            "r",
+            "reps",
+            _( "repetitions of each scaling benchmark (default: 5)" ).mb_str(),
+            wxCMD_LINE_VAL_NUMBER,
+    },
+    {
+            wxCMD_LINE_SWITCH,
+            "l",
+            "largest",
+            _( "only benchmark the zone having the most vertices" ).mb_str(),
+    },
+    {
+            wxCMD_LINE_OPTION,
+            "o",
+            "format",
+            _( "report format: text, csv or json (default: text)" ).mb_str(),
+            wxCMD_LINE_VAL_STRING,
+    },
+    {
+            wxCMD_LINE_PARAM,
+            nullptr,
+            nullptr,
+            _( "board file (default: read from stdin)" ).mb_str(),
+            wxCMD_LINE_VAL_STRING,
+            wxCMD_LINE_PARAM_OPTIONAL,
+    },
+    { wxCMD_LINE_NONE }
+};
+
+
+int polygon_triangulation_main( int argc, char *argv[] )
+{
+    wxMessageOutput::Set( new wxMessageOutputStderr );
+    wxCmdLineParser cl_parser( argc, argv );
+    cl_parser.SetDesc( g_cmdLineDesc );
+    cl_parser.AddUsageText(
+            _( "This program triangulates the filled areas of the zones of a board.  With "
+               "--scaling, it times the triangulation of each zone split between 1, 2, 4... "
+               "threads instead." ) );
+
+    int cmd_parsed_ok = cl_parser.Parse();
+    if( cmd_parsed_ok != 0 )
+    {
+        // Help and invalid input both stop here
+        return ( cmd_parsed_ok == -1 ) ? KI_TEST::RET_CODES::OK : KI_TEST::RET_CODES::BAD_CMDLINE;
+    }
+
+    long     reps = 5;
+    long     maxThreads = std::max<long>( std::thread::hardware_concurrency(), 1 );
+    wxString formatName = "text";
+
+    cl_parser.Found( "reps", &reps );
+    cl_parser.Found( "threads", &maxThreads );
+    cl_parser.Found( "format", &formatName );
+
+    KI_TEST::BENCH_FORMAT format;
+
+    if( reps < 1 || maxThreads < 1
+            || !KI_TEST::ParseBenchFormat( formatName.ToStdString(), format ) )
+    {
+        cl_parser.Usage();
+        return KI_TEST::RET_CODES::BAD_CMDLINE;
+    }
+
+    std::string filename;
+
+    if( cl_parser.GetParamCount() )
+        filename = cl_parser.GetParam( 0 ).ToStdString();
+
+    auto brd = KI_TEST::ReadBoardFromFileOrStream( filename );
+
+    if( !brd )
+        return POLY_TRI_RET_CODES::LOAD_FAILED;
+
+    if( !cl_parser.Found( "scaling" ) )
+    {
+        triangulateZones( *brd );
+        return KI_TEST::RET_CODES::OK;
+    }
+
+    std::vector<KI_TEST::BENCH_RESULT> results;
+
+    runScalingBenchmark( *brd, filename.empty() ? "stdin" : filename, maxThreads, reps,
+            cl_parser.Found( "largest" ), results );
+
+    KI_TEST::PrintBenchResults( std::cout, results, format );
 
     return KI_TEST::RET_CODES::OK;
 }
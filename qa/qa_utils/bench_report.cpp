@@ -0,0 +1,207 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <qa_utils/bench_report.h>
+
+#include <cstdio>
+
+#if defined( __unix__ ) || defined( __APPLE__ )
+#include <sys/resource.h>
+#endif
+
+
+namespace KI_TEST
+{
+
+static double seconds( const BENCH_RESULT& aResult )
+{
+    return std::chrono::duration<double>( aResult.m_duration ).count();
+}
+
+
+double BENCH_RESULT::MegabytesPerSecond() const
+{
+    const double secs = seconds( *this );
+
+    if( secs <= 0.0 )
+        return 0.0;
+
+    return (double) m_bytes * m_reps / secs / 1e6;
+}
+
+
+double BENCH_RESULT::ItemsPerSecond() const
+{
+    const double secs = seconds( *this );
+
+    if( secs <= 0.0 )
+        return 0.0;
+
+    return (double) m_items * m_reps / secs;
+}
+
+
+bool ParseBenchFormat( const std::string& aName, BENCH_FORMAT& aFormat )
+{
+    if( aName == "text" )
+        aFormat = BENCH_FORMAT::TEXT;
+    else if( aName == "csv" )
+        aFormat = BENCH_FORMAT::CSV;
+    else if( aName == "json" )
+        aFormat = BENCH_FORMAT::JSON;
+    else
+        return false;
+
+    return true;
+}
+
+
+size_t GetPeakRss()
+{
+#if defined( __unix__ ) || defined( __APPLE__ )
+    struct rusage usage;
+
+    if( getrusage( RUSAGE_SELF, &usage ) != 0 )
+        return 0;
+
+#if defined( __APPLE__ )
+    return (size_t) usage.ru_maxrss;            // bytes
+#else
+    return (size_t) usage.ru_maxrss * 1024;     // kilobytes
+#endif
+
+#else
+    return 0;
+#endif
+}
+
+
+/**
+ * Quote a string for a CSV field or a JSON string.  Names and file names only
+ * need the quotes and the backslashes to be escaped.
+ */
+static std::string quoted( const std::string& aStr, char aEscape )
+{
+    std::string ret( 1, '"' );
+
+    for( char c : aStr )
+    {
+        if( c == '"' || ( aEscape == '\\' && c == '\\' ) )
+            ret += aEscape;
+
+        ret += c;
+    }
+
+    ret += '"';
+    return ret;
+}
+
+
+void PrintBenchResults( std::ostream& aStream, const std::vector<BENCH_RESULT>& aResults,
+        BENCH_FORMAT aFormat )
+{
+    char buf[512];
+
+    switch( aFormat )
+    {
+    case BENCH_FORMAT::TEXT:
+        for( const BENCH_RESULT& res : aResults )
+        {
+            snprintf( buf, sizeof( buf ),
+                    "%-32s %6u reps %10.1f ms %10.2f MB/s %12.0f items/s %8.1f MB peak RSS",
+                    res.m_name.c_str(), res.m_reps, res.m_duration.count() / 1000.0,
+                    res.MegabytesPerSecond(), res.ItemsPerSecond(), res.m_peakRss / 1e6 );
+            aStream << buf;
+
+            for( const auto& metric : res.m_metrics )
+            {
+                snprintf( buf, sizeof( buf ), " %s=%g", metric.first.c_str(), metric.second );
+                aStream << buf;
+            }
+
+            aStream << "\n";
+        }
+        break;
+
+    case BENCH_FORMAT::CSV:
+        aStream << "name,source,reps,bytes,items,duration_us,mb_per_s,items_per_s,peak_rss";
+
+        if( !aResults.empty() )
+        {
+            for( const auto& metric : aResults.front().m_metrics )
+                aStream << "," << metric.first;
+        }
+
+        aStream << "\n";
+
+        for( const BENCH_RESULT& res : aResults )
+        {
+            snprintf( buf, sizeof( buf ), ",%u,%zu,%zu,%lld,%.3f,%.1f,%zu", res.m_reps,
+                    res.m_bytes, res.m_items, (long long) res.m_duration.count(),
+                    res.MegabytesPerSecond(), res.ItemsPerSecond(), res.m_peakRss );
+            aStream << quoted( res.m_name, '"' ) << "," << quoted( res.m_source, '"' ) << buf;
+
+            for( const auto& metric : res.m_metrics )
+            {
+                snprintf( buf, sizeof( buf ), ",%g", metric.second );
+                aStream << buf;
+            }
+
+            aStream << "\n";
+        }
+        break;
+
+    case BENCH_FORMAT::JSON:
+        aStream << "[\n";
+
+        for( size_t ii = 0; ii < aResults.size(); ++ii )
+        {
+            const BENCH_RESULT& res = aResults[ii];
+
+            snprintf( buf, sizeof( buf ),
+                    "\"reps\": %u, \"bytes\": %zu, \"items\": %zu, \"duration_us\": %lld, "
+                    "\"mb_per_s\": %.3f, \"items_per_s\": %.1f, \"peak_rss\": %zu",
+                    res.m_reps, res.m_bytes, res.m_items, (long long) res.m_duration.count(),
+                    res.MegabytesPerSecond(), res.ItemsPerSecond(), res.m_peakRss );
+
+            aStream << "  { \"name\": " << quoted( res.m_name, '\\' )
+                    << ", \"source\": " << quoted( res.m_source, '\\' ) << ", " << buf;
+
+            for( const auto& metric : res.m_metrics )
+            {
+                snprintf( buf, sizeof( buf ), ", %s: %g", quoted( metric.first, '\\' ).c_str(),
+                        metric.second );
+                aStream << buf;
+            }
+
+            aStream << " }" << ( ii + 1 < aResults.size() ? ",\n" : "\n" );
+        }
+
+        aStream << "]\n";
+        break;
+    }
+
+    aStream.flush();
+}
+
+} // namespace KI_TEST
@@ -0,0 +1,96 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2019 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file bench_report.h
+ * Machine readable reports for the benchmarking QA programs
+ */
+
+#ifndef QA_UTILS_BENCH_REPORT__H
+#define QA_UTILS_BENCH_REPORT__H
+
+#include <chrono>
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace KI_TEST
+{
+
+/**
+ * The result of one benchmark: what was processed, and how long it took.
+ */
+struct BENCH_RESULT
+{
+    std::string               m_name;
+    std::string               m_source;   ///< the file or the data set benchmarked
+    unsigned                  m_reps;     ///< number of repetitions
+    size_t                    m_bytes;    ///< bytes processed by one repetition
+    size_t                    m_items;    ///< items processed by one repetition
+    std::chrono::microseconds m_duration; ///< duration of all the repetitions
+    size_t                    m_peakRss;  ///< peak resident set size after the benchmark, in bytes
+
+    /// Extra named values of the benchmark (latencies, counters), reported after the others.
+    /// The CSV header uses the names of the first result.
+    std::vector<std::pair<std::string, double>> m_metrics;
+
+    /// @return the throughput in MB/s (1 MB = 10^6 bytes), 0 if unknown
+    double MegabytesPerSecond() const;
+
+    /// @return the throughput in items/s, 0 if unknown
+    double ItemsPerSecond() const;
+};
+
+
+enum class BENCH_FORMAT
+{
+    TEXT,   ///< human readable table
+    CSV,    ///< one header line, then one line per result
+    JSON,   ///< an array of objects
+};
+
+
+/**
+ * Parse a report format name ("text", "csv" or "json").
+ * @return false if the name is unknown
+ */
+bool ParseBenchFormat( const std::string& aName, BENCH_FORMAT& aFormat );
+
+/**
+ * @return the peak resident set size of the process in bytes, or 0 if it is not
+ * available on this platform.  The peak is never reset, so the value reported after a
+ * benchmark also covers the ones run before it.
+ */
+size_t GetPeakRss();
+
+/**
+ * Write a set of results in the given format.
+ */
+void PrintBenchResults( std::ostream& aStream, const std::vector<BENCH_RESULT>& aResults,
+        BENCH_FORMAT aFormat );
+
+} // namespace KI_TEST
+
+#endif // QA_UTILS_BENCH_REPORT__H